@@ -95,7 +95,7 @@ ROOT_BUILD_OPTION(cefweb OFF "Chromium Embedded Framework web-based display")
 ROOT_BUILD_OPTION(clad ON "Enable clad, the cling automatic differentiation plugin.")
 ROOT_BUILD_OPTION(cling ON "Enable new CLING C++ interpreter")
 ROOT_BUILD_OPTION(cocoa OFF "Use native Cocoa/Quartz graphics backend (MacOS X only)")
-set(compression_default "lz4" CACHE STRING "ROOT compression algorithm used as a default, default option is lz4. Can be lz4, zlib, or lzma")
+set(compression_default "lz4" CACHE STRING "ROOT compression algorithm used as a default, default option is lz4. Can be lz4, zlib, lzma or zstd")
 ROOT_BUILD_OPTION(cuda OFF "Use CUDA if it is found in the system")
 ROOT_BUILD_OPTION(cxx11 ON "Build using C++11 compatible mode, requires gcc > 4.7.x or clang")
 ROOT_BUILD_OPTION(cxx14 OFF "Build using C++14 compatible mode, requires gcc > 4.9.x or clang")
@@ -170,6 +170,7 @@ ROOT_BUILD_OPTION(x11 ON "X11 support")
 ROOT_BUILD_OPTION(xft ON "Xft support (X11 antialiased fonts)")
 ROOT_BUILD_OPTION(xml ON "XML parser interface")
 ROOT_BUILD_OPTION(xrootd ON "Build xrootd file server and its client (if supported)")
+ROOT_BUILD_OPTION(zstd ON "Zstandard compression support, requires libzstd")
 ROOT_BUILD_OPTION(coverage OFF "Test coverage")
 
 option(fail-on-missing "Fail the configure step if a required external package is missing" OFF)
@@ -186,8 +187,8 @@ if (runtime_cxxmodules)
 endif(runtime_cxxmodules)
 
 #--- Compression algorithms in ROOT-------------------------------------------------------------
-if(NOT compression_default MATCHES "zlib|lz4|lzma")
-  message(STATUS "Not supported compression algorithm, ROOT compression algorithms are zlib, lzma and lz4. 
+if(NOT compression_default MATCHES "zlib|lz4|lzma|zstd")
+  message(STATUS "Not supported compression algorithm, ROOT compression algorithms are zlib, lzma, lz4 and zstd. 
     ROOT will fall back to default algorithm: lz4")
   set(compression_default "lz4" CACHE STRING "" FORCE)
 else()
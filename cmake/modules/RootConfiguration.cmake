@@ -471,6 +471,11 @@ if(lz4)
 else()
   set(haslz4compression undef)
 endif()
+if(zstd)
+  set(haszstd define)
+else()
+  set(haszstd undef)
+endif()
 if(cocoa)
   set(hascocoa define)
 else()
@@ -513,14 +518,22 @@ if(compression_default STREQUAL "lz4")
   set(uselz4 define)
   set(usezlib undef)
   set(uselzma undef)
+  set(usezstd undef)
 elseif(compression_default STREQUAL "zlib")
   set(uselz4 undef)
   set(usezlib define)
   set(uselzma undef)
+  set(usezstd undef)
 elseif(compression_default STREQUAL "lzma")
   set(uselz4 undef)
   set(usezlib undef)
   set(uselzma define)
+  set(usezstd undef)
+elseif(compression_default STREQUAL "zstd")
+  set(uselz4 undef)
+  set(usezlib undef)
+  set(uselzma undef)
+  set(usezstd define)
 endif()
 if(runtime_cxxmodules)
   set(usecxxmodules define)
@@ -269,7 +269,7 @@ function(ROOT_GENERATE_DICTIONARY dictionary)
     # FIXME: Glob these folders.
     set(core_folders base clib clingutils cont dictgen doc foundation lzma lz4
                      macosx meta metacling multiproc newdelete pcre rint
-                     rootcling_stage1 textinput thread unix winnt zip)
+                     rootcling_stage1 textinput thread unix winnt zip zstd)
     foreach(core_folder ${core_folders})
       string(REPLACE "${CMAKE_SOURCE_DIR}/core/${core_folder}/inc/" ""  headerfiles "${headerfiles}")
     endforeach()
@@ -262,6 +262,27 @@ if(builtin_lz4)
   add_subdirectory(builtins/lz4)
 endif()
 
+#---Check for ZSTD-------------------------------------------------------------------
+if(zstd)
+  message(STATUS "Looking for ZSTD")
+  foreach(suffix FOUND INCLUDE_DIR LIBRARY LIBRARY_DEBUG LIBRARY_RELEASE)
+    unset(ZSTD_${suffix} CACHE)
+  endforeach()
+  find_package(ZSTD)
+  if(NOT ZSTD_FOUND)
+    if(fail-on-missing)
+      message(FATAL_ERROR "ZSTD library not found and is required (zstd option enabled)")
+    else()
+      message(STATUS "ZSTD not found. Switching off zstd option")
+      set(zstd OFF CACHE BOOL "Disabled because ZSTD not found (${zstd_description})" FORCE)
+    endif()
+  endif()
+endif()
+if(compression_default STREQUAL "zstd" AND NOT zstd)
+  message(STATUS "ZSTD support is disabled, ROOT will fall back to default algorithm: lz4")
+  set(compression_default "lz4" CACHE STRING "" FORCE)
+endif()
+
 #---Check for X11 which is mandatory lib on Unix--------------------------------------
 if(x11)
   message(STATUS "Looking for X11")
@@ -83,6 +83,9 @@ namespace Internal {
       TParTreeProcessingRAII()  { EnableParTreeProcessing();  }
       ~TParTreeProcessingRAII() { DisableParTreeProcessing(); }
    };
+
+   // Free the tables retired by the lock-free class name cache of TClass::GetClass
+   void ReleaseRetiredClassNameTables();
 } } // End ROOT::Internal
 
 namespace ROOT {
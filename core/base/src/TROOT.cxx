@@ -967,6 +967,9 @@ TROOT::~TROOT()
 
       fMessageHandlers->Delete(); SafeDelete(fMessageHandlers);
 
+      // No more concurrent TClass::GetClass is expected past this point
+      ROOT::Internal::ReleaseRetiredClassNameTables();
+
 #ifdef R__COMPLETE_MEM_TERMINATION
       SafeDelete(fCanvases);
       SafeDelete(fTasks);
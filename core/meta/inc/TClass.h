@@ -66,6 +66,7 @@ namespace ROOT {
    }
    namespace Internal {
       class TCheckHashRecursiveRemoveConsistency;
+      class TStreamerInfoVersionCache;
    }
 }
 
@@ -242,6 +243,7 @@ private:
    EState             fState;           //!Current 'state' of the class (Emulated,Interpreted,Loaded)
    mutable std::atomic<TVirtualStreamerInfo*>  fCurrentInfo;     //!cached current streamer info.
    mutable std::atomic<TVirtualStreamerInfo*>  fLastReadInfo;    //!cached streamer info used in the last read.
+   mutable std::atomic<ROOT::Internal::TStreamerInfoVersionCache*> fCompiledInfos{nullptr}; //!lock-free lookup of the compiled streamer infos by version.
    TVirtualRefProxy  *fRefProxy;        //!Pointer to reference proxy if this class represents a reference
    ROOT::Detail::TSchemaRuleSet *fSchemaRules;  //! Schema evolution rules
 
@@ -266,12 +268,14 @@ private:
    void ForceReload (TClass* oldcl);
    void LoadClassInfo() const;
 
+   static TClass     *GetClassImpl(const char *name, Bool_t load, Bool_t silent);
    static TClass     *LoadClassDefault(const char *requestedname, Bool_t silent);
    static TClass     *LoadClassCustom(const char *requestedname, Bool_t silent);
 
    void               SetClassVersion(Version_t version);
    void               SetClassSize(Int_t sizof) { fSizeof = sizof; }
    TVirtualStreamerInfo* DetermineCurrentStreamerInfo();
+   void               CacheCompiledStreamerInfo(Int_t version, TVirtualStreamerInfo *info) const;
 
    void SetStreamerImpl();
 
@@ -408,7 +412,8 @@ public:
       else return DetermineCurrentStreamerInfo();
    }
    TVirtualStreamerInfo     *GetLastReadInfo() const { return fLastReadInfo; }
-   void                      SetLastReadInfo(TVirtualStreamerInfo *info) { fLastReadInfo = info; }
+   void                      SetLastReadInfo(TVirtualStreamerInfo *info);
+   TVirtualStreamerInfo     *FindCompiledStreamerInfo(Int_t version) const;
    TList             *GetListOfDataMembers(Bool_t load = kTRUE);
    TList             *GetListOfEnums(Bool_t load = kTRUE);
    TList             *GetListOfFunctionTemplates(Bool_t load = kTRUE);
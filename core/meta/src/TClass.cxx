@@ -63,6 +63,7 @@ a 'using namespace std;' has been applied to and with:
 #include "TROOT.h"
 #include "TRealData.h"
 #include "TCheckHashRecursiveRemoveConsistency.h" // Private header
+#include "TClassLookupCache.h" // Private header
 #include "TStreamer.h"
 #include "TStreamerElement.h"
 #include "TVirtualStreamerInfo.h"
@@ -438,6 +439,30 @@ DeclIdMap_t *TClass::GetDeclIdMap() {
 #endif
 }
 
+namespace {
+   /// Map from the names passed to TClass::GetClass to the loaded classes
+   /// they resolve to, readable without lock.
+   ROOT::Internal::TClassNameCache &GetClassNameCache()
+   {
+#ifdef R__COMPLETE_MEM_TERMINATION
+      static ROOT::Internal::TClassNameCache gClassNameCacheObject;
+      return gClassNameCacheObject;
+#else
+      static ROOT::Internal::TClassNameCache *gClassNameCache = new ROOT::Internal::TClassNameCache;
+      return *gClassNameCache;
+#endif
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Free the tables the class name cache retired while growing. Called by
+/// TROOT's destructor, once no lookup can be running anymore.
+
+void ROOT::Internal::ReleaseRetiredClassNameTables()
+{
+   GetClassNameCache().ReleaseRetiredTables();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// static: Add a class to the list and map of classes.
 
@@ -473,6 +498,7 @@ void TClass::RemoveClass(TClass *oldcl)
 
    R__LOCKGUARD(gInterpreterMutex);
    gROOT->GetListOfClasses()->Remove(oldcl);
+   GetClassNameCache().Remove(oldcl);
    if (oldcl->GetTypeInfo()) {
       GetIdMap()->Remove(oldcl->GetTypeInfo()->name());
    }
@@ -1628,6 +1654,9 @@ TClass::~TClass()
 
    if (fDeclFileLine >= -1)
       TClass::RemoveClass(this);
+   else
+      GetClassNameCache().Remove(this);
+   delete fCompiledInfos.load();
 
    gCling->ClassInfo_Delete(fClassInfo);
    fClassInfo=0;
@@ -2888,6 +2917,22 @@ TClass *TClass::GetClass(const char *name, Bool_t load, Bool_t silent)
 {
    if (!name || !name[0]) return 0;
 
+   // Steady-state fast path: the names already resolved to a loaded class,
+   // whether normalized or not, are found without taking any lock.
+   TClass *cl = GetClassNameCache().Find(name);
+   if (cl && (cl->IsLoaded() || cl->TestBit(kUnloading))) return cl;
+
+   cl = GetClassImpl(name, load, silent);
+   if (cl && cl->IsLoaded()) GetClassNameCache().Insert(name, cl);
+   return cl;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Implementation of GetClass(const char*,Bool_t,Bool_t), without the lookup
+/// in the cache of already resolved names.
+
+TClass *TClass::GetClassImpl(const char *name, Bool_t load, Bool_t silent)
+{
    if (strstr(name, "(anonymous)")) return 0;
    if (strncmp(name,"class ",6)==0) name += 6;
    if (strncmp(name,"struct ",7)==0) name += 7;
@@ -4432,6 +4477,13 @@ TVirtualStreamerInfo* TClass::GetStreamerInfo(Int_t version /* = 0 */) const
    if (sinfo && sinfo->GetClassVersion() == version)
       return sinfo;
 
+   // The other versions already built and compiled are also found without lock.
+   if (auto compiled = fCompiledInfos.load(std::memory_order_acquire)) {
+      sinfo = compiled->Find(version);
+      if (sinfo)
+         return sinfo;
+   }
+
    // Note that the access to fClassVersion above is technically not thread-safe with a low probably of problems.
    // fClassVersion is not an atomic and is modified TClass::SetClassVersion (called from RootClassVersion via
    // ROOT::ResetClassVersion) and is 'somewhat' protected by the atomic fVersionUsed.
@@ -4495,13 +4547,64 @@ TVirtualStreamerInfo* TClass::GetStreamerInfo(Int_t version /* = 0 */) const
    if (version == fClassVersion)
       fCurrentInfo = sinfo;
 
-   // If the compilation succeeded, remember this StreamerInfo.
-   if (sinfo->IsCompiled())
+   // If the compilation succeeded, remember this StreamerInfo. Do not cache the
+   // current version's info under a requested version that does not exist: the
+   // lock-free lookups must not hand out the wrong layout for that version.
+   if (sinfo->IsCompiled()) {
       fLastReadInfo = sinfo;
+      if (sinfo->GetClassVersion() == version)
+         CacheCompiledStreamerInfo(version, sinfo);
+   }
 
    return sinfo;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Return the compiled TVirtualStreamerInfo for `version` (0 meaning the
+/// current version) if it was already built, or nullptr otherwise.
+/// This never takes a lock and is thus suited for the I/O hot paths; use
+/// GetStreamerInfo() as fallback.
+
+TVirtualStreamerInfo *TClass::FindCompiledStreamerInfo(Int_t version) const
+{
+   if (version == 0)
+      version = fClassVersion;
+   TVirtualStreamerInfo *guess = fLastReadInfo;
+   if (guess && guess->GetClassVersion() == version)
+      return guess;
+   auto compiled = fCompiledInfos.load(std::memory_order_acquire);
+   return compiled ? compiled->Find(version) : nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Record `info` as the compiled TVirtualStreamerInfo to be returned by
+/// GetStreamerInfo(version) and FindCompiledStreamerInfo(version). A null
+/// info removes the entry. The caller must hold gInterpreterMutex.
+
+void TClass::CacheCompiledStreamerInfo(Int_t version, TVirtualStreamerInfo *info) const
+{
+   auto compiled = fCompiledInfos.load(std::memory_order_relaxed);
+   if (!compiled) {
+      if (!info)
+         return;
+      compiled = new ROOT::Internal::TStreamerInfoVersionCache;
+      fCompiledInfos.store(compiled, std::memory_order_release);
+   }
+   compiled->Set(version, info);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Remember `info` as the StreamerInfo used in the last read, making it also
+/// available to FindCompiledStreamerInfo() if it is compiled.
+
+void TClass::SetLastReadInfo(TVirtualStreamerInfo *info)
+{
+   R__LOCKGUARD(gInterpreterMutex);
+   fLastReadInfo = info;
+   if (info && info->IsCompiled())
+      CacheCompiledStreamerInfo(info->GetClassVersion(), info);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// For the case where the requestor class is emulated and this class is abstract,
 /// returns a pointer to the TVirtualStreamerInfo object for version with an emulated
@@ -6723,7 +6826,10 @@ TVirtualStreamerInfo *TClass::FindStreamerInfo(UInt_t checksum) const
          if (info && info->GetCheckSum() == checksum) {
             // R__ASSERT(i==info->GetClassVersion() || (i==-1&&info->GetClassVersion()==1));
             info->BuildOld();
-            if (info->IsCompiled()) fLastReadInfo = info;
+            if (info->IsCompiled()) {
+               fLastReadInfo = info;
+               CacheCompiledStreamerInfo(info->GetClassVersion(), info);
+            }
             return info;
          }
       }
@@ -6960,6 +7066,8 @@ void TClass::RegisterStreamerInfo(TVirtualStreamerInfo *info)
                GetName(),slot);
       }
       fStreamerInfo->AddAtAndExpand(info, slot);
+      if (fCompiledInfos.load())
+         CacheCompiledStreamerInfo(slot, info->IsCompiled() ? info : nullptr);
       if (fState <= kForwardDeclared) {
          fState = kEmulated;
          if (fCheckSum==0 && slot==fClassVersion) fCheckSum = info->GetCheckSum();
@@ -6977,6 +7085,11 @@ void TClass::RemoveStreamerInfo(Int_t slot)
       R__LOCKGUARD(gInterpreterMutex);
       TVirtualStreamerInfo *info = (TVirtualStreamerInfo*)fStreamerInfo->At(slot);
       fStreamerInfo->RemoveAt(fClassVersion);
+      // Other versions might have been resolved to the deleted info.
+      if (auto compiled = fCompiledInfos.load())
+         compiled->Clear();
+      if (fLastReadInfo == info)
+         fLastReadInfo = nullptr;
       delete info;
       if (fState == kEmulated && fStreamerInfo->GetEntries() == 0) {
          fState = kForwardDeclared;
@@ -0,0 +1,161 @@
+// @(#)root/meta:$Id$
+
+/*************************************************************************
+ * Copyright (C) 1995-2018, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#include "TClassLookupCache.h"
+#include "TString.h"
+
+#include <cstring>
+
+namespace ROOT {
+namespace Internal {
+
+////////////////////////////////////////////////////////////////////////////////
+/// Create an empty table of `capacity` slots, a power of two.
+
+TClassNameCache::Table::Table(UInt_t capacity) : fMask(capacity - 1), fSlots(new std::atomic<Entry *>[capacity])
+{
+   for (UInt_t i = 0; i < capacity; ++i)
+      fSlots[i].store(nullptr, std::memory_order_relaxed);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Put `entry` in the first free slot of its probe sequence.
+
+void TClassNameCache::Place(Table &table, Entry *entry)
+{
+   UInt_t i = entry->fHash & table.fMask;
+   while (table.fSlots[i].load(std::memory_order_relaxed))
+      i = (i + 1) & table.fMask;
+   table.fSlots[i].store(entry, std::memory_order_release);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return the class registered for `name`, or nullptr. Lock-free.
+
+TClass *TClassNameCache::Find(const char *name) const
+{
+   const Table *table = fTable.load(std::memory_order_acquire);
+   if (!table)
+      return nullptr;
+
+   const UInt_t hash = TString::Hash(name, strlen(name));
+   for (UInt_t i = hash & table->fMask;; i = (i + 1) & table->fMask) {
+      const Entry *entry = table->fSlots[i].load(std::memory_order_acquire);
+      if (!entry)
+         return nullptr;
+      if (entry->fHash == hash && entry->fName == name)
+         return entry->fClass.load(std::memory_order_acquire);
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Register `cl` as the class `name` resolves to.
+
+void TClassNameCache::Insert(const char *name, TClass *cl)
+{
+   std::lock_guard<std::mutex> lock(fWriteMutex);
+
+   const UInt_t hash = TString::Hash(name, strlen(name));
+   Table *table = fTable.load(std::memory_order_relaxed);
+   if (table) {
+      for (UInt_t i = hash & table->fMask;; i = (i + 1) & table->fMask) {
+         Entry *entry = table->fSlots[i].load(std::memory_order_relaxed);
+         if (!entry)
+            break;
+         if (entry->fHash == hash && entry->fName == name) {
+            if (entry->fClass.load(std::memory_order_relaxed) != cl) {
+               entry->fClass.store(cl, std::memory_order_release);
+               fEntriesOfClass[cl].push_back(entry);
+            }
+            return;
+         }
+      }
+   }
+
+   // Keep the load factor below one half so that the probe sequences stay short.
+   if (!table || 2 * (fEntries.size() + 1) > table->fMask + 1) {
+      const UInt_t capacity = table ? 2 * (table->fMask + 1) : 1024;
+      std::unique_ptr<Table> grown(new Table(capacity));
+      for (auto &entry : fEntries)
+         Place(*grown, entry.get());
+      table = grown.get();
+      // The previous table stays alive for the readers still probing it, see ReleaseRetiredTables.
+      fTables.emplace_back(std::move(grown));
+      fTable.store(table, std::memory_order_release);
+   }
+
+   fEntries.emplace_back(new Entry(hash, name, cl));
+   fEntriesOfClass[cl].push_back(fEntries.back().get());
+   Place(*table, fEntries.back().get());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Forget all the names resolving to `cl`, e.g. because it is being deleted.
+
+void TClassNameCache::Remove(const TClass *cl)
+{
+   std::lock_guard<std::mutex> lock(fWriteMutex);
+
+   auto iter = fEntriesOfClass.find(cl);
+   if (iter == fEntriesOfClass.end())
+      return;
+   for (auto entry : iter->second) {
+      // The entry might have been re-pointed to another class since.
+      TClass *expected = const_cast<TClass *>(cl);
+      entry->fClass.compare_exchange_strong(expected, nullptr);
+   }
+   fEntriesOfClass.erase(iter);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Free all the tables but the current one. Only call this when no Find can
+/// be in flight anymore, e.g. at shutdown.
+
+void TClassNameCache::ReleaseRetiredTables()
+{
+   std::lock_guard<std::mutex> lock(fWriteMutex);
+
+   if (fTables.size() > 1)
+      fTables.erase(fTables.begin(), fTables.end() - 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Record `info` (possibly nullptr) as the compiled StreamerInfo of `version`.
+
+void TStreamerInfoVersionCache::Set(Int_t version, TVirtualStreamerInfo *info)
+{
+   if (version < -1 || version > kMaxVersion || Find(version) == info)
+      return;
+
+   const Infos_t *current = fCurrent.load(std::memory_order_relaxed);
+   std::unique_ptr<Infos_t> infos(current ? new Infos_t(*current) : new Infos_t);
+   const UInt_t idx = version + 1;
+   if (infos->size() <= idx)
+      infos->resize(idx + 1, nullptr);
+   (*infos)[idx] = info;
+   fCurrent.store(infos.get(), std::memory_order_release);
+   fPublished.emplace_back(std::move(infos));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Forget all the recorded StreamerInfos.
+
+void TStreamerInfoVersionCache::Clear()
+{
+   const Infos_t *current = fCurrent.load(std::memory_order_relaxed);
+   if (!current || current->empty())
+      return;
+   std::unique_ptr<Infos_t> infos(new Infos_t);
+   fCurrent.store(infos.get(), std::memory_order_release);
+   fPublished.emplace_back(std::move(infos));
+}
+
+} // namespace Internal
+} // namespace ROOT
@@ -0,0 +1,113 @@
+// @(#)root/meta:$Id$
+
+/*************************************************************************
+ * Copyright (C) 1995-2018, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef ROOT_TClassLookupCache
+#define ROOT_TClassLookupCache
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TClassLookupCache                                                    //
+//                                                                      //
+// Read-mostly caches allowing the steady-state lookups of TClass and   //
+// TVirtualStreamerInfo done during I/O to proceed without taking any   //
+// lock. Readers only perform atomic loads; writers serialize among     //
+// themselves and publish immutable data, which is never freed while    //
+// readers may still see it.                                            //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class TClass;
+class TVirtualStreamerInfo;
+
+namespace ROOT {
+namespace Internal {
+
+/// Map from a class name, as passed to TClass::GetClass, to the loaded
+/// TClass it resolves to. The names need not be normalized: each spelling
+/// seen is a separate entry, so that typedef resolution and normalization
+/// are only done once per spelling.
+///
+/// The table is an open-addressing hash table that only grows. Entries are
+/// never moved nor deleted: removing a class only resets the TClass pointer
+/// of its entries. When the table grows a new table is published and the
+/// old one is retired: a reader may still be probing it, and readers do not
+/// announce themselves, so it cannot be freed until no reader is left, i.e.
+/// at TROOT shutdown (see ReleaseRetiredTables). The leak is bounded: the
+/// capacity doubles on each growth, so all the retired tables together have
+/// fewer slots than the current one, which holds one pointer per slot.
+class TClassNameCache {
+private:
+   struct Entry {
+      UInt_t fHash;
+      std::string fName;
+      std::atomic<TClass *> fClass;
+      Entry(UInt_t hash, const char *name, TClass *cl) : fHash(hash), fName(name), fClass(cl) {}
+   };
+   struct Table {
+      UInt_t fMask;
+      std::unique_ptr<std::atomic<Entry *>[]> fSlots;
+      explicit Table(UInt_t capacity);
+   };
+
+   std::atomic<Table *> fTable{nullptr};
+   std::vector<std::unique_ptr<Table>> fTables;   // Current and retired tables.
+   std::vector<std::unique_ptr<Entry>> fEntries;  // All entries, in insertion order.
+   std::unordered_map<const TClass *, std::vector<Entry *>> fEntriesOfClass;
+   std::mutex fWriteMutex;
+
+   static void Place(Table &table, Entry *entry);
+
+public:
+   TClass *Find(const char *name) const;
+   void Insert(const char *name, TClass *cl);
+   void Remove(const TClass *cl);
+   void ReleaseRetiredTables();
+};
+
+/// Per-class map from version number to compiled StreamerInfo. The current
+/// content is an immutable array indexed by version+1 and replaced as a
+/// whole on update; all the published arrays are kept until the cache is
+/// deleted together with its TClass. Updates happen when a StreamerInfo
+/// is compiled, i.e. a handful of times per class.
+/// The writers must hold gInterpreterMutex.
+class TStreamerInfoVersionCache {
+private:
+   using Infos_t = std::vector<TVirtualStreamerInfo *>;
+
+   std::atomic<const Infos_t *> fCurrent{nullptr};
+   std::vector<std::unique_ptr<const Infos_t>> fPublished;
+
+public:
+   /// Largest version for which the StreamerInfo is cached.
+   static constexpr Int_t kMaxVersion = 4096;
+
+   TVirtualStreamerInfo *Find(Int_t version) const
+   {
+      const Infos_t *infos = fCurrent.load(std::memory_order_acquire);
+      const UInt_t idx = version + 1;
+      return (infos && idx < infos->size()) ? (*infos)[idx] : nullptr;
+   }
+   void Set(Int_t version, TVirtualStreamerInfo *info);
+   void Clear();
+};
+
+} // namespace Internal
+} // namespace ROOT
+
+#endif
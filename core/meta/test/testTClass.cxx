@@ -1,9 +1,13 @@
 #include "TClass.h"
 #include "THashTable.h"
 #include "TInterpreter.h"
+#include "TVirtualStreamerInfo.h"
 
 #include "gtest/gtest.h"
 
+#include <thread>
+#include <vector>
+
 TEST(TClass, DictCheck)
 {
    gInterpreter->ProcessLine(".L stlDictCheck.h+");
@@ -21,4 +25,54 @@ TEST(TClass, DictCheck)
    }
 
    EXPECT_TRUE(classesWithoutDictionary.IsEmpty()) << errMsg;
-}
\ No newline at end of file
+}
+
+TEST(TClass, NameLookupCache)
+{
+   auto named = TClass::GetClass("TNamed");
+   ASSERT_NE(nullptr, named);
+   // Non-normalized spellings resolve to the same class, also when served
+   // from the lookup cache.
+   for (int i = 0; i < 3; ++i) {
+      EXPECT_EQ(named, TClass::GetClass("class TNamed"));
+      EXPECT_EQ(TClass::GetClass("vector<int>"), TClass::GetClass("std::vector<int>"));
+      EXPECT_EQ(nullptr, TClass::GetClass("NoSuchClassForTClassTest"));
+   }
+
+   std::vector<TClass *> results(4);
+   std::vector<std::thread> threads;
+   for (std::size_t t = 0; t < results.size(); ++t)
+      threads.emplace_back([&results, t] {
+         for (int i = 0; i < 1000; ++i)
+            results[t] = TClass::GetClass("std::vector<int>");
+      });
+   for (auto &thr : threads)
+      thr.join();
+   for (auto cl : results)
+      EXPECT_EQ(TClass::GetClass("vector<int>"), cl);
+}
+
+TEST(TClass, CompiledStreamerInfoCache)
+{
+   auto named = TClass::GetClass("TNamed");
+   ASSERT_NE(nullptr, named);
+   auto info = named->GetStreamerInfo();
+   ASSERT_NE(nullptr, info);
+   EXPECT_EQ(info, named->FindCompiledStreamerInfo(0));
+   EXPECT_EQ(info, named->FindCompiledStreamerInfo(named->GetClassVersion()));
+   EXPECT_EQ(info, named->GetStreamerInfo(named->GetClassVersion()));
+   EXPECT_EQ(nullptr, named->FindCompiledStreamerInfo(named->GetClassVersion() + 100));
+}
+
+TEST(TClass, StreamerInfoFallbackNotCached)
+{
+   auto cl = TClass::GetClass("TObjArray");
+   ASSERT_NE(nullptr, cl);
+   const auto missing = cl->GetClassVersion() - 1;
+   // A version without StreamerInfo falls back to the current version's info ...
+   auto fallback = cl->GetStreamerInfo(missing);
+   ASSERT_NE(nullptr, fallback);
+   EXPECT_EQ(cl->GetClassVersion(), fallback->GetClassVersion());
+   // ... which must not be remembered as the info of the missing version.
+   EXPECT_EQ(nullptr, cl->FindCompiledStreamerInfo(missing));
+}
@@ -25,8 +25,11 @@ namespace ROOT {
 ///    compression usually results in greater compression factors, but takes
 ///    more CPU time and memory when compressing. LZMA memory usage is particularly
 ///    high for compression levels 8 and 9.
-///  - Finally, the LZ4 package results in worse compression ratios
+///  - The LZ4 package results in worse compression ratios
 ///    than ZLIB but achieves much faster decompression rates.
+///  - Finally, the ZSTD (Zstandard) package reaches compression ratios close to
+///    LZMA while decompressing nearly as fast as LZ4. It is only available if
+///    ROOT was built with the zstd option.
 ///
 /// The current algorithms support level 1 to 9. The higher the level the greater
 /// the compression and more CPU time and memory resources used during compression.
@@ -38,6 +41,7 @@ namespace ROOT {
 ///   since in the case of LZMA we don't care about compression/decompression speed)
 ///   [207 - 208]
 ///  - LZ4 is recommended to be used with compression level 4 [404]
+///  - ZSTD is recommended to be used with compression level 5 [505]
 
 
 enum ECompressionAlgorithm {
@@ -51,6 +55,8 @@ enum ECompressionAlgorithm {
    kOldCompressionAlgo,
    /// Use LZ4 compression
    kLZ4,
+   /// Use ZSTD compression
+   kZSTD,
    /// Undefined compression algorithm (must be kept the last of the list in case a new algorithm is added).
    kUndefinedCompressionAlgorithm
 };
@@ -10,6 +10,8 @@
  *************************************************************************/
 #include "Compression.h"
 
+#include <stddef.h>
+
 /**
  * These are definitions of various free functions for the C-style compression routines in ROOT.
  */
@@ -33,6 +35,27 @@ extern "C" void R__unzip(int *srcsize, unsigned char *src, int *tgtsize, unsigne
 
 extern "C" int R__unzip_header(int *srcsize, unsigned char *src, int *tgtsize);
 
+/**
+ * Compression against a trained dictionary, for small buffers of similar content (e.g. TTree baskets of
+ * a given branch) that otherwise compress poorly because each one starts from an empty window.
+ * Dictionaries are only supported by the ZSTD algorithm: without ZSTD support R__zip_train_dict
+ * returns 0 and R__zipWithDict falls back to ZLIB without dictionary.
+ */
+extern "C" int R__zip_train_dict(char *dict, int dictcapacity, const char *samples, const size_t *samplesizes,
+                                 unsigned int nsamples);
+
+/// Returns the ID of a dictionary produced by R__zip_train_dict, 0 if it is not a valid dictionary.
+extern "C" unsigned int R__zip_dict_id(const char *dict, int dictsize);
+
+extern "C" void R__zipWithDict(int cxlevel, int *srcsize, char *src, int *tgtsize, char *tgt, int *irep,
+                               const char *dict, int dictsize);
+
+/// Returns the ID of the dictionary needed to uncompress src, 0 if it can be uncompressed with R__unzip.
+extern "C" unsigned int R__unzip_dict_id(int srcsize, unsigned char *src);
+
+extern "C" void R__unzipWithDict(int *srcsize, unsigned char *src, int *tgtsize, unsigned char *tgt, int *irep,
+                                 const char *dict, int dictsize);
+
 enum { kMAXZIPBUF = 0xffffff };
 
 #endif
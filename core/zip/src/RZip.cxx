@@ -12,6 +12,9 @@
 #include "Bits.h"
 #include "ZipLZMA.h"
 #include "ZipLZ4.h"
+#ifdef R__HAS_ZSTD
+#include "ZipZSTD.h"
+#endif
 
 #include "zlib.h"
 
@@ -37,6 +40,7 @@ static void R__unzipZLIB(int *srcsize, unsigned char *src, int *tgtsize, unsigne
    R__ZipMode = 1 : ZLIB compression algorithm is used (default)
    R__ZipMode = 2 : LZMA compression algorithm is used
    R__ZipMode = 4 : LZ4  compression algorithm is used
+   R__ZipMode = 5 : ZSTD compression algorithm is used
    R__ZipMode = 0 or 3 : a very old compression algorithm is used
    (the very old algorithm is supported for backward compatibility)
    The LZMA algorithm requires the external XZ package be installed when linking
@@ -46,9 +50,15 @@ static void R__unzipZLIB(int *srcsize, unsigned char *src, int *tgtsize, unsigne
   The LZ4 algorithm requires the external LZ4 package to be installed when linking
   is done.  LZ4 typically has the worst compression ratios, but much faster decompression
   speeds - sometimes by an order of magnitude.
+
+  The ZSTD algorithm requires the external Zstandard package to be installed when
+  linking is done. ZSTD reaches compression ratios similar to LZMA with decompression
+  speeds close to LZ4.
 */
 #ifdef R__HAS_DEFAULT_LZ4
 enum ROOT::ECompressionAlgorithm R__ZipMode = ROOT::ECompressionAlgorithm::kLZ4;
+#elif defined(R__HAS_DEFAULT_ZSTD)
+enum ROOT::ECompressionAlgorithm R__ZipMode = ROOT::ECompressionAlgorithm::kZSTD;
 #else
 enum ROOT::ECompressionAlgorithm R__ZipMode = ROOT::ECompressionAlgorithm::kZLIB;
 #endif
@@ -72,6 +82,8 @@ unsigned long R__crc32(unsigned long crc, const unsigned char* buf, unsigned int
 /*                      1 = zlib */
 /*                      2 = lzma */
 /*                      3 = old */
+/*                      4 = lz4 */
+/*                      5 = zstd */
 void R__zipMultipleAlgorithm(int cxlevel, int *srcsize, char *src, int *tgtsize, char *tgt, int *irep, ROOT::ECompressionAlgorithm compressionAlgorithm)
      /* int cxlevel;                      compression level */
 {
@@ -97,6 +109,14 @@ void R__zipMultipleAlgorithm(int cxlevel, int *srcsize, char *src, int *tgtsize,
   } else if (compressionAlgorithm == ROOT::ECompressionAlgorithm::kLZ4) {
      R__zipLZ4(cxlevel, srcsize, src, tgtsize, tgt, irep);
      return;
+  } else if (compressionAlgorithm == ROOT::ECompressionAlgorithm::kZSTD) {
+#ifdef R__HAS_ZSTD
+     R__zipZSTD(cxlevel, srcsize, src, tgtsize, tgt, irep);
+#else
+     // Without Zstandard support, fall back to ZLIB so that the output stays readable everywhere.
+     R__zipZLIB(cxlevel, srcsize, src, tgtsize, tgt, irep);
+#endif
+     return;
   } else if (compressionAlgorithm == ROOT::ECompressionAlgorithm::kOldCompressionAlgo || compressionAlgorithm == ROOT::ECompressionAlgorithm::kUseGlobalCompressionSetting) {
      R__zipOld(cxlevel, srcsize, src, tgtsize, tgt, irep);
      return;
@@ -269,10 +289,20 @@ static int is_valid_header_lz4(unsigned char *src)
    return src[0] == 'L' && src[1] == '4';
 }
 
+static int is_valid_header_zstd(unsigned char *src)
+{
+   return src[0] == 'Z' && src[1] == 'S' && src[2] == 1;
+}
+
+static int is_valid_header_zstd_dict(unsigned char *src)
+{
+   return src[0] == 'Z' && src[1] == 'S' && src[2] == 2;
+}
+
 static int is_valid_header(unsigned char *src)
 {
    return is_valid_header_zlib(src) || is_valid_header_old(src) || is_valid_header_lzma(src) ||
-          is_valid_header_lz4(src);
+          is_valid_header_lz4(src) || is_valid_header_zstd(src) || is_valid_header_zstd_dict(src);
 }
 
 int R__unzip_header(int *srcsize, uch *src, int *tgtsize)
@@ -364,6 +394,16 @@ void R__unzip(int *srcsize, uch *src, int *tgtsize, uch *tgt, int *irep)
   } else if (is_valid_header_lz4(src)) {
      R__unzipLZ4(srcsize, src, tgtsize, tgt, irep);
      return;
+  } else if (is_valid_header_zstd(src)) {
+#ifdef R__HAS_ZSTD
+     R__unzipZSTD(srcsize, src, tgtsize, tgt, irep);
+#else
+     fprintf(stderr, "R__unzip: buffer is ZSTD compressed but ROOT was built without ZSTD support\n");
+#endif
+     return;
+  } else if (is_valid_header_zstd_dict(src)) {
+     fprintf(stderr, "R__unzip: buffer was compressed against a dictionary, use R__unzipWithDict\n");
+     return;
   }
 
   /* Old zlib format */
@@ -384,6 +424,82 @@ void R__unzip(int *srcsize, uch *src, int *tgtsize, uch *tgt, int *irep)
   *irep = isize;
 }
 
+/**
+ * Below are the routines for dictionary based (de)compression.
+ */
+
+int R__zip_train_dict(char *dict, int dictcapacity, const char *samples, const size_t *samplesizes,
+                      unsigned int nsamples)
+{
+#ifdef R__HAS_ZSTD
+   return R__trainZSTDDict(dict, dictcapacity, samples, samplesizes, nsamples);
+#else
+   (void)dict; (void)dictcapacity; (void)samples; (void)samplesizes; (void)nsamples;
+   return 0;
+#endif
+}
+
+unsigned int R__zip_dict_id(const char *dict, int dictsize)
+{
+#ifdef R__HAS_ZSTD
+   return R__getZSTDDictID(dict, dictsize);
+#else
+   (void)dict; (void)dictsize;
+   return 0;
+#endif
+}
+
+void R__zipWithDict(int cxlevel, int *srcsize, char *src, int *tgtsize, char *tgt, int *irep, const char *dict,
+                    int dictsize)
+{
+  if (*srcsize < 1 + HDRSIZE + 1 || cxlevel <= 0) {
+     *irep = 0;
+     return;
+  }
+
+#ifdef R__HAS_ZSTD
+  R__zipZSTDDict(cxlevel, srcsize, src, tgtsize, tgt, irep, dict, dictsize);
+#else
+  (void)dict; (void)dictsize;
+  R__zipZLIB(cxlevel, srcsize, src, tgtsize, tgt, irep);
+#endif
+}
+
+unsigned int R__unzip_dict_id(int srcsize, unsigned char *src)
+{
+  if (srcsize < HDRSIZE || !is_valid_header_zstd_dict(src)) {
+     return 0;
+  }
+#ifdef R__HAS_ZSTD
+  return R__getZSTDFrameDictID(srcsize, src);
+#else
+  return 0;
+#endif
+}
+
+void R__unzipWithDict(int *srcsize, unsigned char *src, int *tgtsize, unsigned char *tgt, int *irep,
+                      const char *dict, int dictsize)
+{
+  *irep = 0;
+
+  if (*srcsize < HDRSIZE) {
+    fprintf(stderr,"R__unzipWithDict: too small source\n");
+    return;
+  }
+
+  if (!is_valid_header_zstd_dict(src)) {
+     R__unzip(srcsize, src, tgtsize, tgt, irep);
+     return;
+  }
+
+#ifdef R__HAS_ZSTD
+  R__unzipZSTDDict(srcsize, src, tgtsize, tgt, irep, dict, dictsize);
+#else
+  (void)dict; (void)dictsize;
+  fprintf(stderr, "R__unzipWithDict: buffer is ZSTD compressed but ROOT was built without ZSTD support\n");
+#endif
+}
+
 void R__unzipZLIB(int *srcsize, unsigned char *src, int *tgtsize, unsigned char *tgt, int *irep)
 {
      z_stream stream; /* decompression stream */
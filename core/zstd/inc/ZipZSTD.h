@@ -0,0 +1,29 @@
+/*************************************************************************
+ * Copyright (C) 1995-2018, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#include <stddef.h>
+
+// NOTE: the ROOT compression libraries aren't consistently written in C++; hence the
+// #ifdef's to avoid problems with C code.
+#ifdef __cplusplus
+extern "C" {
+#endif
+void R__zipZSTD(int cxlevel, int *srcsize, char *src, int *tgtsize, char *tgt, int *irep);
+void R__unzipZSTD(int *srcsize, unsigned char *src, int *tgtsize, unsigned char *tgt, int *irep);
+
+// Compression against an externally stored dictionary, see R__zipWithDict in RZip.h.
+int R__trainZSTDDict(char *dict, int dictcapacity, const char *samples, const size_t *samplesizes, unsigned nsamples);
+unsigned R__getZSTDDictID(const char *dict, int dictsize);
+unsigned R__getZSTDFrameDictID(int srcsize, unsigned char *src);
+void R__zipZSTDDict(int cxlevel, int *srcsize, char *src, int *tgtsize, char *tgt, int *irep, const char *dict,
+                    int dictsize);
+void R__unzipZSTDDict(int *srcsize, unsigned char *src, int *tgtsize, unsigned char *tgt, int *irep,
+                      const char *dict, int dictsize);
+#ifdef __cplusplus
+}
+#endif
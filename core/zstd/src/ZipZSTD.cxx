@@ -0,0 +1,287 @@
+/*************************************************************************
+ * Copyright (C) 1995-2018, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#include "ZipZSTD.h"
+
+#include "ROOT/RConfig.h"
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include <zdict.h>
+#include <zstd.h>
+
+// Header consists of:
+// - 2 byte identifier "ZS"
+// - 1 byte format version: 1 for plain zstd frames, 2 for frames compressed against
+//   an external dictionary (the dictionary ID is stored in the zstd frame header)
+// - 3 bytes of compressed size
+// - 3 bytes of uncompressed size
+static const int kHeaderSize = 9;
+static const char kFormatVersion = 1;
+static const char kFormatVersionDict = 2;
+
+namespace {
+
+struct CCtxDeleter {
+   void operator()(ZSTD_CCtx *ctx) const { ZSTD_freeCCtx(ctx); }
+};
+
+struct DCtxDeleter {
+   void operator()(ZSTD_DCtx *ctx) const { ZSTD_freeDCtx(ctx); }
+};
+
+struct CDictDeleter {
+   void operator()(ZSTD_CDict *dict) const { ZSTD_freeCDict(dict); }
+};
+
+struct DDictDeleter {
+   void operator()(ZSTD_DDict *dict) const { ZSTD_freeDDict(dict); }
+};
+
+// The contexts are expensive to set up compared to a typical basket; keep one per thread.
+ZSTD_CCtx *GetCompressionContext()
+{
+   static thread_local std::unique_ptr<ZSTD_CCtx, CCtxDeleter> ctx(ZSTD_createCCtx());
+   return ctx.get();
+}
+
+ZSTD_DCtx *GetDecompressionContext()
+{
+   static thread_local std::unique_ptr<ZSTD_DCtx, DCtxDeleter> ctx(ZSTD_createDCtx());
+   return ctx.get();
+}
+
+/// Map the ROOT compression level (1-9) onto the zstd range (1-22). Level 9 stops
+/// at 18 because the zstd "ultra" levels need large windows that do not pay off
+/// for baskets of at most 16MB.
+int ZSTDLevel(int cxlevel)
+{
+   if (cxlevel < 1)
+      cxlevel = 1;
+   if (cxlevel > 9)
+      cxlevel = 9;
+   return 2 * cxlevel;
+}
+
+/// Digesting a dictionary costs about as much as compressing a small basket, so the last
+/// digested dictionary is kept per thread. Baskets of one branch are written and read in
+/// sequence, hence a single entry cache is enough to reuse it across baskets.
+///
+/// The dictionary ID alone does not identify a dictionary: it is a 32 bit hash of the
+/// content, or set by the user, so two files can hold different dictionaries with the same
+/// ID. The cache keeps a copy of the dictionary it digested and reuses it only if the
+/// content matches; comparing a few kB is cheap next to digesting them again.
+class DictKey {
+   unsigned fID = 0;
+   std::vector<char> fContent;
+
+public:
+   bool Matches(const char *dict, int dictsize, unsigned id) const
+   {
+      return id == fID && static_cast<size_t>(dictsize) == fContent.size() &&
+             (dictsize == 0 || memcmp(dict, fContent.data(), fContent.size()) == 0);
+   }
+   void Set(const char *dict, int dictsize, unsigned id)
+   {
+      fID = id;
+      fContent.assign(dict, dict + dictsize);
+   }
+};
+
+ZSTD_CDict *GetCompressionDict(const char *dict, int dictsize, int level)
+{
+   static thread_local std::unique_ptr<ZSTD_CDict, CDictDeleter> cached;
+   static thread_local DictKey cachedKey;
+   static thread_local int cachedLevel = 0;
+
+   unsigned id = ZDICT_getDictID(dict, static_cast<size_t>(dictsize));
+   if (!cached || !cachedKey.Matches(dict, dictsize, id) || level != cachedLevel) {
+      cached.reset(ZSTD_createCDict(dict, static_cast<size_t>(dictsize), level));
+      cachedKey.Set(dict, dictsize, id);
+      cachedLevel = level;
+   }
+   return cached.get();
+}
+
+ZSTD_DDict *GetDecompressionDict(const char *dict, int dictsize)
+{
+   static thread_local std::unique_ptr<ZSTD_DDict, DDictDeleter> cached;
+   static thread_local DictKey cachedKey;
+
+   unsigned id = ZDICT_getDictID(dict, static_cast<size_t>(dictsize));
+   if (!cached || !cachedKey.Matches(dict, dictsize, id)) {
+      cached.reset(ZSTD_createDDict(dict, static_cast<size_t>(dictsize)));
+      cachedKey.Set(dict, dictsize, id);
+   }
+   return cached.get();
+}
+
+void WriteHeader(char *tgt, char version, size_t out_size, size_t in_size)
+{
+   tgt[0] = 'Z';
+   tgt[1] = 'S';
+   tgt[2] = version;
+
+   // NOTE: these next 6 bytes are required from the ROOT compressed buffer format;
+   // upper layers will assume they are laid out in a specific manner.
+   tgt[3] = (char)(out_size & 0xff);
+   tgt[4] = (char)((out_size >> 8) & 0xff);
+   tgt[5] = (char)((out_size >> 16) & 0xff);
+
+   tgt[6] = (char)(in_size & 0xff); /* decompressed size */
+   tgt[7] = (char)((in_size >> 8) & 0xff);
+   tgt[8] = (char)((in_size >> 16) & 0xff);
+}
+
+} // anonymous namespace
+
+void R__zipZSTD(int cxlevel, int *srcsize, char *src, int *tgtsize, char *tgt, int *irep)
+{
+   *irep = 0;
+
+   if (R__unlikely(*tgtsize <= kHeaderSize)) {
+      return;
+   }
+
+   // Refuse to compress more than 16MB at a time -- we are only allowed 3 bytes for size info.
+   if (R__unlikely(*srcsize > 0xffffff || *srcsize < 0)) {
+      return;
+   }
+
+   ZSTD_CCtx *ctx = GetCompressionContext();
+   if (R__unlikely(!ctx)) {
+      return;
+   }
+
+   size_t returnStatus = ZSTD_compressCCtx(ctx, &tgt[kHeaderSize], static_cast<size_t>(*tgtsize - kHeaderSize), src,
+                                           static_cast<size_t>(*srcsize), ZSTDLevel(cxlevel));
+   // An error here is usually just an incompressible buffer (target too small);
+   // the caller then stores the buffer uncompressed.
+   if (R__unlikely(ZSTD_isError(returnStatus))) {
+      return;
+   }
+
+   WriteHeader(tgt, kFormatVersion, returnStatus, static_cast<size_t>(*srcsize));
+   *irep = static_cast<int>(returnStatus) + kHeaderSize;
+}
+
+void R__unzipZSTD(int *srcsize, unsigned char *src, int *tgtsize, unsigned char *tgt, int *irep)
+{
+   // NOTE: We don't check that srcsize / tgtsize is reasonable or within the ROOT-imposed limits.
+   // This is assumed to be handled by the upper layers.
+
+   *irep = 0;
+   if (R__unlikely(src[0] != 'Z' || src[1] != 'S')) {
+      fprintf(stderr, "R__unzipZSTD: algorithm run against buffer with incorrect header (got %d%d; expected %d%d).\n",
+              src[0], src[1], 'Z', 'S');
+      return;
+   }
+   if (R__unlikely(src[2] != kFormatVersion)) {
+      fprintf(stderr, "R__unzipZSTD: unsupported on-disk format version (got %d; expected %d).\n", src[2],
+              kFormatVersion);
+      return;
+   }
+
+   ZSTD_DCtx *ctx = GetDecompressionContext();
+   if (R__unlikely(!ctx)) {
+      fprintf(stderr, "R__unzipZSTD: cannot allocate the decompression context.\n");
+      return;
+   }
+
+   size_t returnStatus = ZSTD_decompressDCtx(ctx, tgt, static_cast<size_t>(*tgtsize), &src[kHeaderSize],
+                                             static_cast<size_t>(*srcsize - kHeaderSize));
+   if (R__unlikely(ZSTD_isError(returnStatus))) {
+      fprintf(stderr, "R__unzipZSTD: error in decompression (%s).\n", ZSTD_getErrorName(returnStatus));
+      return;
+   }
+
+   *irep = static_cast<int>(returnStatus);
+}
+
+int R__trainZSTDDict(char *dict, int dictcapacity, const char *samples, const size_t *samplesizes, unsigned nsamples)
+{
+   if (dictcapacity <= 0 || nsamples == 0) {
+      return 0;
+   }
+   size_t returnStatus =
+      ZDICT_trainFromBuffer(dict, static_cast<size_t>(dictcapacity), samples, samplesizes, nsamples);
+   // Training fails if the samples are too few or too uniform to extract anything useful.
+   if (ZDICT_isError(returnStatus)) {
+      return 0;
+   }
+   return static_cast<int>(returnStatus);
+}
+
+unsigned R__getZSTDDictID(const char *dict, int dictsize)
+{
+   return ZDICT_getDictID(dict, static_cast<size_t>(dictsize));
+}
+
+unsigned R__getZSTDFrameDictID(int srcsize, unsigned char *src)
+{
+   if (srcsize <= kHeaderSize || src[0] != 'Z' || src[1] != 'S' || src[2] != kFormatVersionDict) {
+      return 0;
+   }
+   return ZSTD_getDictID_fromFrame(&src[kHeaderSize], static_cast<size_t>(srcsize - kHeaderSize));
+}
+
+void R__zipZSTDDict(int cxlevel, int *srcsize, char *src, int *tgtsize, char *tgt, int *irep, const char *dict,
+                    int dictsize)
+{
+   *irep = 0;
+
+   if (R__unlikely(*tgtsize <= kHeaderSize)) {
+      return;
+   }
+   if (R__unlikely(*srcsize > 0xffffff || *srcsize < 0)) {
+      return;
+   }
+
+   ZSTD_CCtx *ctx = GetCompressionContext();
+   ZSTD_CDict *cdict = GetCompressionDict(dict, dictsize, ZSTDLevel(cxlevel));
+   if (R__unlikely(!ctx || !cdict)) {
+      return;
+   }
+
+   size_t returnStatus = ZSTD_compress_usingCDict(ctx, &tgt[kHeaderSize], static_cast<size_t>(*tgtsize - kHeaderSize),
+                                                  src, static_cast<size_t>(*srcsize), cdict);
+   if (R__unlikely(ZSTD_isError(returnStatus))) {
+      return;
+   }
+
+   WriteHeader(tgt, kFormatVersionDict, returnStatus, static_cast<size_t>(*srcsize));
+   *irep = static_cast<int>(returnStatus) + kHeaderSize;
+}
+
+void R__unzipZSTDDict(int *srcsize, unsigned char *src, int *tgtsize, unsigned char *tgt, int *irep,
+                      const char *dict, int dictsize)
+{
+   *irep = 0;
+   if (R__unlikely(src[0] != 'Z' || src[1] != 'S' || src[2] != kFormatVersionDict)) {
+      fprintf(stderr, "R__unzipZSTDDict: buffer was not compressed against a dictionary.\n");
+      return;
+   }
+
+   ZSTD_DCtx *ctx = GetDecompressionContext();
+   ZSTD_DDict *ddict = GetDecompressionDict(dict, dictsize);
+   if (R__unlikely(!ctx || !ddict)) {
+      fprintf(stderr, "R__unzipZSTDDict: cannot set up the decompression context.\n");
+      return;
+   }
+
+   size_t returnStatus = ZSTD_decompress_usingDDict(ctx, tgt, static_cast<size_t>(*tgtsize), &src[kHeaderSize],
+                                                    static_cast<size_t>(*srcsize - kHeaderSize), ddict);
+   if (R__unlikely(ZSTD_isError(returnStatus))) {
+      fprintf(stderr, "R__unzipZSTDDict: error in decompression (%s).\n", ZSTD_getErrorName(returnStatus));
+      return;
+   }
+
+   *irep = static_cast<int>(returnStatus);
+}
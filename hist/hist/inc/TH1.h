@@ -52,6 +52,9 @@ class TCollection;
 class TVirtualFFT;
 class TVirtualHistPainter;
 
+namespace ROOT {
+class TH1ConcurrentFillManager;
+}
 
 class TH1 : public TNamed, public TAttLine, public TAttFill, public TAttMarker {
 
@@ -81,6 +84,7 @@ public:
    };
 
    friend class TH1Merger;
+   friend class ROOT::TH1ConcurrentFillManager;
 
 protected:
     Int_t         fNcells;          ///< number of bins(1D), cells (2D) +U/Overflows
@@ -145,6 +149,7 @@ protected:
                                Option_t * opt, Bool_t doerr = kFALSE) const;
 
    virtual void     DoFillN(Int_t ntimes, const Double_t *x, const Double_t *w, Int_t stride=1);
+   void             DoFillBins(Int_t n, const Int_t *bins, const Double_t *w);
    Bool_t    GetStatOverflowsBehaviour() const { return EStatOverflows::kNeutral == fStatOverflows ? fgStatOverflows : EStatOverflows::kConsider == fStatOverflows; }
 
    static bool CheckAxisLimits(const TAxis* a1, const TAxis* a2);
@@ -0,0 +1,98 @@
+// @(#)root/hist:$Id$
+
+/*************************************************************************
+ * Copyright (C) 1995-2018, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef ROOT_TH1ConcurrentFill
+#define ROOT_TH1ConcurrentFill
+
+#include "RtypesCore.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class TH1;
+
+namespace ROOT {
+
+class TH1ConcurrentFiller;
+
+class TH1ConcurrentFillManager {
+   friend class TH1ConcurrentFiller;
+
+   TH1 &fHist;
+   Int_t fNCoords;                  ///< Dimension of the histogram
+   Int_t fCellsPerShard;            ///< Number of consecutive cells protected by each shard mutex, 0 if not sharded
+   std::vector<std::unique_ptr<std::mutex>> fShardMutexes;
+   std::mutex fStatsMutex;          ///< Protects the statistics and the number of entries of the histogram
+   std::atomic<bool> fHasSumw2;     ///< Whether the histogram stores the sum of squares of weights
+
+   void Flush(TH1ConcurrentFiller &filler);
+   void FlushSharded(TH1ConcurrentFiller &filler);
+   void EnableSumw2();
+
+public:
+   explicit TH1ConcurrentFillManager(TH1 &hist, Int_t nshards = 0);
+   TH1ConcurrentFillManager(const TH1ConcurrentFillManager &) = delete;
+   TH1ConcurrentFillManager &operator=(const TH1ConcurrentFillManager &) = delete;
+
+   TH1ConcurrentFiller MakeFiller();
+
+   TH1 &GetHist() const { return fHist; }
+   Int_t GetNShards() const { return fShardMutexes.size(); }
+
+   void lock();
+   void unlock();
+};
+
+class TH1ConcurrentFiller {
+   friend class TH1ConcurrentFillManager;
+
+   TH1ConcurrentFillManager *fManager;
+   std::vector<Double_t> fValues;   ///< Coordinates and weight of the buffered entries, interleaved
+   Int_t fNEntries = 0;             ///< Number of buffered entries
+
+   void Add(const Double_t *values, Int_t n);
+
+public:
+   static constexpr Int_t kBufferSize = 1024; ///< Number of entries buffered before being added to the histogram
+
+   explicit TH1ConcurrentFiller(TH1ConcurrentFillManager &manager);
+   TH1ConcurrentFiller(TH1ConcurrentFiller &&other);
+   TH1ConcurrentFiller(const TH1ConcurrentFiller &) = delete;
+   TH1ConcurrentFiller &operator=(const TH1ConcurrentFiller &) = delete;
+   ~TH1ConcurrentFiller() { Flush(); }
+
+   /// Buffer the filling of the histogram with the same arguments, e.g. (x, w) for a 1-D and (x, y) for a 2-D histogram.
+   void Fill(Double_t x0) { Add(&x0, 1); }
+   void Fill(Double_t x0, Double_t x1)
+   {
+      const Double_t values[] = {x0, x1};
+      Add(values, 2);
+   }
+   void Fill(Double_t x0, Double_t x1, Double_t x2)
+   {
+      const Double_t values[] = {x0, x1, x2};
+      Add(values, 3);
+   }
+   void Fill(Double_t x0, Double_t x1, Double_t x2, Double_t x3)
+   {
+      const Double_t values[] = {x0, x1, x2, x3};
+      Add(values, 4);
+   }
+
+   void Flush();
+
+   TH1 &GetHist() const { return fManager->GetHist(); }
+};
+
+} // namespace ROOT
+
+#endif
@@ -30,6 +30,8 @@ class TProfile2D;
 
 class TH3 : public TH1, public TAtt3D {
 
+   friend class ROOT::TH1ConcurrentFillManager;
+
 protected:
    Double_t     fTsumwy;          //Total Sum of weight*Y
    Double_t     fTsumwy2;         //Total Sum of weight*Y*Y
@@ -73,6 +75,9 @@ public:
    virtual void     Copy(TObject &hnew) const;
    virtual Int_t    Fill(Double_t x, Double_t y, Double_t z);
    virtual Int_t    Fill(Double_t x, Double_t y, Double_t z, Double_t w);
+   virtual void     FillN(Int_t, const Double_t *, const Double_t *, Int_t) {;} //MayNotUse
+   virtual void     FillN(Int_t, const Double_t *, const Double_t *, const Double_t *, Int_t) {;} //MayNotUse
+   virtual void     FillN(Int_t ntimes, const Double_t *x, const Double_t *y, const Double_t *z, const Double_t *w, Int_t stride=1);
 
    virtual Int_t    Fill(const char *namex, const char *namey, const char *namez, Double_t w);
    virtual Int_t    Fill(const char *namex, Double_t y, const char *namez, Double_t w);
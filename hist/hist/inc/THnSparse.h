@@ -21,7 +21,6 @@
 
 
 #include "THnBase.h"
-#include "TExMap.h"
 #include "THnSparse_Internal.h"
 
 // needed only for template instantiations of THnSparseT:
@@ -32,14 +31,14 @@
 #include "TArrayC.h"
 
 class THnSparseCompactBinCoord;
+class THnSparseBinIndex;
 
 class THnSparse: public THnBase {
  private:
    Int_t      fChunkSize;    // number of entries for each chunk
    Long64_t   fFilledBins;   // number of filled bins
    TObjArray  fBinContent;   // array of THnSparseArrayChunk
-   TExMap     fBins;         //! filled bins
-   TExMap     fBinsContinued;//! filled bins for non-unique hashes, containing pairs of (bin index 0, bin index 1)
+   THnSparseBinIndex *fBinIndex; //! hash table of the filled bins
    THnSparseCompactBinCoord *fCompactCoord; //! compact coordinate
 
    THnSparse(const THnSparse&); // Not implemented
@@ -57,9 +56,11 @@ class THnSparse: public THnBase {
 
    THnSparseArrayChunk* AddChunk();
    void Reserve(Long64_t nbins);
-   void FillExMap();
+   void FillBinIndex();
    virtual TArray* GenerateArray() const = 0;
    Long64_t GetBinIndexForCurrentBin(Bool_t allocate);
+   Long64_t GetBinIndexForBuffer(ULong64_t hash, const Char_t* buf, Bool_t allocate);
+   Bool_t AddSameBinning(const THnBase* h, Double_t c);
 
    /// Increment the bin content of "bin" by "w",
    /// return the bin index.
@@ -126,6 +127,7 @@ class THnSparse: public THnBase {
 
    Double_t GetSparseFractionBins() const;
    Double_t GetSparseFractionMem() const;
+   Long64_t GetMemoryUsage() const;
 
    /// Forwards to THnBase::Projection().
    /// Non-virtual, as a CINT-compatible replacement of a using
@@ -73,6 +73,8 @@ private:
    Double_t *GetB2() {return (fBinSumw2.fN ? &fBinSumw2.fArray[0] : 0 ); }
    Double_t *GetW()  {return &fArray[0];}
    Double_t *GetW2() {return &fSumw2.fArray[0];}
+   void FillN(Int_t, const Double_t *, const Double_t *, const Double_t *, const Double_t *, Int_t)
+      { MayNotUse("FillN(Int_t, Double_t*, Double_t*, Double_t*, Double_t*, Int_t"); }
    void  SetBins(Int_t, Double_t, Double_t)
       { MayNotUse("SetBins(Int_t, Double_t, Double_t"); }
    void  SetBins(Int_t, const Double_t*)
@@ -15,6 +15,7 @@
 #include <ctype.h>
 #include <sstream>
 #include <cmath>
+#include <algorithm>
 
 #include "Riostream.h"
 #include "TROOT.h"
@@ -3386,6 +3387,35 @@ void TH1::DoFillN(Int_t ntimes, const Double_t *x, const Double_t *w, Int_t stri
    fEntries += ntimes;
    Double_t ww = 1;
    Int_t nbins   = fXaxis.GetNbins();
+
+   // Fast path: if the axis cannot be extended, the entries are processed in blocks,
+   // finding all their bins at once and then adding them to the bins and to the statistics.
+   if (!fXaxis.CanExtend()) {
+      const Int_t kBlockSize = 256;
+      Double_t xs[kBlockSize], ws[kBlockSize];
+      Int_t bins[kBlockSize];
+      const Bool_t statOverflows = GetStatOverflowsBehaviour();
+      for (Int_t first = 0; first < ntimes; first += kBlockSize) {
+         const Int_t n = std::min(kBlockSize, ntimes - first);
+         for (i = 0; i < n; ++i) {
+            xs[i] = x[(first + i) * stride];
+            ws[i] = w ? w[(first + i) * stride] : 1.;
+         }
+         fXaxis.FindFixBins(n, xs, bins);
+         DoFillBins(n, bins, ws);
+         // The statistics are summed in the order of the entries, as by Fill
+         for (i = 0; i < n; ++i) {
+            if (!statOverflows && (bins[i] == 0 || bins[i] > nbins)) continue;
+            const Double_t z = ws[i];
+            fTsumw   += z;
+            fTsumw2  += z*z;
+            fTsumwx  += z*xs[i];
+            fTsumwx2 += z*xs[i]*xs[i];
+         }
+      }
+      return;
+   }
+
    ntimes *= stride;
    for (i=0;i<ntimes;i+=stride) {
       bin =fXaxis.FindBin(x[i]);
@@ -3405,6 +3435,49 @@ void TH1::DoFillN(Int_t ntimes, const Double_t *x, const Double_t *w, Int_t stri
    }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Internal method adding the weights `w` of `n` entries to their global bins `bins`,
+/// as many calls to AddBinContent would, used by the FillN methods.
+///
+/// The sum of squares of weights is triggered by the first weight not equal to 1,
+/// as in Fill. The contents of TH1F, TH1D, TH2F, TH2D, TH3F and TH3D are
+/// updated directly in their arrays.
+
+void TH1::DoFillBins(Int_t n, const Int_t *bins, const Double_t *w)
+{
+   Int_t i = 0;
+   if (!fSumw2.fN && !TestBit(TH1::kIsNotW)) {
+      while (i < n && w[i] == 1.) ++i;
+      if (i < n) {
+         // the entries before the first weighted one are in the contents used by Sumw2
+         DoFillBins(i, bins, w);
+         Sumw2();
+         bins += i;
+         w += i;
+         n -= i;
+      }
+   }
+   if (fSumw2.fN) {
+      Double_t *sumw2 = fSumw2.fArray;
+      for (i = 0; i < n; ++i)
+         sumw2[bins[i]] += w[i] * w[i];
+   }
+
+   const TClass *cl = IsA();
+   if (cl == TH1D::Class() || cl == TH2D::Class() || cl == TH3D::Class()) {
+      Double_t *array = dynamic_cast<TArrayD *>(this)->fArray;
+      for (i = 0; i < n; ++i)
+         array[bins[i]] += w[i];
+   } else if (cl == TH1F::Class() || cl == TH2F::Class() || cl == TH3F::Class()) {
+      Float_t *array = dynamic_cast<TArrayF *>(this)->fArray;
+      for (i = 0; i < n; ++i)
+         array[bins[i]] += Float_t(w[i]);
+   } else {
+      for (i = 0; i < n; ++i)
+         AddBinContent(bins[i], w[i]);
+   }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Fill histogram following distribution in function fname.
 ///
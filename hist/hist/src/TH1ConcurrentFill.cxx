@@ -0,0 +1,312 @@
+// @(#)root/hist:$Id$
+
+/*************************************************************************
+ * Copyright (C) 1995-2018, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#include "TH1ConcurrentFill.h"
+#include "TH1.h"
+#include "TH2.h"
+#include "TH3.h"
+#include "TError.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+/** \class ROOT::TH1ConcurrentFillManager
+\ingroup Hist
+Allows several threads to fill the same TH1, TH2 or TH3 without a copy of the
+histogram per thread.
+
+Each thread fills the histogram through its own ROOT::TH1ConcurrentFiller,
+which buffers the entries and periodically adds them to the histogram:
+~~~ {.cpp}
+TH2D h("h", "h", 1000, 0, 1, 1000, 0, 1);
+ROOT::TH1ConcurrentFillManager manager(h);
+// in each thread:
+auto filler = manager.MakeFiller();
+filler.Fill(x, y);
+~~~
+The entries buffered by a filler are added to the histogram when its buffer is
+full, when ROOT::TH1ConcurrentFiller::Flush is called and when it is destroyed.
+The histogram can be read once all the fillers are flushed, or concurrently
+while the manager is locked.
+
+If no axis of the histogram can be extended, the fillers compute the bins of
+their entries without holding any lock, and the cells of the histogram are
+split in shards of consecutive cells, each with its own mutex, so that threads
+filling different regions of the histogram do not wait for each other. Otherwise
+the buffered entries are passed to FillN under a single mutex.
+
+Profiles are not supported: the constructor throws std::invalid_argument if
+`hist` is a TProfile, TProfile2D or TProfile3D.
+*/
+
+namespace ROOT {
+
+constexpr Int_t TH1ConcurrentFiller::kBufferSize;
+
+////////////////////////////////////////////////////////////////////////////////
+/// Manage the concurrent filling of `hist`, with its cells split in `nshards`
+/// shards if its axes cannot be extended. If `nshards` is 0, about one shard
+/// per 4096 cells, at most 64, is used. Throws std::invalid_argument if `hist`
+/// is a profile.
+
+TH1ConcurrentFillManager::TH1ConcurrentFillManager(TH1 &hist, Int_t nshards)
+   : fHist(hist), fNCoords(hist.GetDimension()), fCellsPerShard(0), fHasSumw2(hist.GetSumw2N() > 0)
+{
+   if (hist.InheritsFrom("TProfile") || hist.InheritsFrom("TProfile2D") || hist.InheritsFrom("TProfile3D"))
+      throw std::invalid_argument(std::string("TH1ConcurrentFillManager: ") + hist.GetName() +
+                                  " is a profile: profiles cannot be filled concurrently");
+
+   const Bool_t canShard = fNCoords >= 1 && fNCoords <= 3 && !hist.GetBuffer() && !hist.InheritsFrom("TH2Poly") &&
+                           !hist.GetXaxis()->CanExtend() && !hist.GetYaxis()->CanExtend() &&
+                           !hist.GetZaxis()->CanExtend();
+   if (canShard) {
+      const Int_t ncells = hist.GetNcells();
+      if (nshards <= 0)
+         nshards = std::min(64, std::max(1, ncells / 4096));
+      nshards = std::min(nshards, ncells);
+      fCellsPerShard = (ncells + nshards - 1) / nshards;
+      nshards = (ncells + fCellsPerShard - 1) / fCellsPerShard;
+   } else {
+      nshards = 1;
+   }
+   for (Int_t i = 0; i < nshards; ++i)
+      fShardMutexes.emplace_back(new std::mutex);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return a new filler, to be used by one thread at a time.
+
+TH1ConcurrentFiller TH1ConcurrentFillManager::MakeFiller()
+{
+   return TH1ConcurrentFiller(*this);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Wait until no filler is adding entries to the histogram and prevent them
+/// from doing so until unlock() is called. With these two methods the manager
+/// can be used with std::lock_guard.
+
+void TH1ConcurrentFillManager::lock()
+{
+   for (auto &mutex : fShardMutexes)
+      mutex->lock();
+   fStatsMutex.lock();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Let the fillers add entries to the histogram again.
+
+void TH1ConcurrentFillManager::unlock()
+{
+   fStatsMutex.unlock();
+   for (auto iter = fShardMutexes.rbegin(); iter != fShardMutexes.rend(); ++iter)
+      (*iter)->unlock();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Start storing the sum of squares of weights, as Fill does for the first
+/// weight not equal to 1.
+
+void TH1ConcurrentFillManager::EnableSumw2()
+{
+   std::lock_guard<TH1ConcurrentFillManager> lock(*this);
+   if (!fHist.GetSumw2N())
+      fHist.Sumw2();
+   fHasSumw2 = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Add the entries buffered by `filler` to the histogram and empty its buffer.
+
+void TH1ConcurrentFillManager::Flush(TH1ConcurrentFiller &filler)
+{
+   if (fCellsPerShard > 0) {
+      FlushSharded(filler);
+   } else {
+      const Int_t n = filler.fNEntries;
+      const Double_t *v = filler.fValues.data();
+      const Int_t stride = fNCoords + 1;
+      std::lock_guard<std::mutex> lock(*fShardMutexes[0]);
+      if (fNCoords == 1)
+         fHist.FillN(n, v, v + 1, stride);
+      else if (fNCoords == 2)
+         fHist.FillN(n, v, v + 1, v + 2, stride);
+      else if (fNCoords == 3)
+         static_cast<TH3 &>(fHist).FillN(n, v, v + 1, v + 2, v + 3, stride);
+   }
+   filler.fValues.clear();
+   filler.fNEntries = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Add the entries buffered by `filler` to the histogram: their bins and their
+/// contribution to the statistics are computed without lock, then the weights
+/// are added shard by shard.
+
+void TH1ConcurrentFillManager::FlushSharded(TH1ConcurrentFiller &filler)
+{
+   const Int_t n = filler.fNEntries;
+   const Int_t ncoords = fNCoords;
+   const Int_t stride = ncoords + 1;
+   const Double_t *v = filler.fValues.data();
+   const TAxis *axes[3] = {fHist.GetXaxis(), fHist.GetYaxis(), fHist.GetZaxis()};
+
+   std::vector<Double_t> coords(ncoords * n), weights(n);
+   std::vector<Int_t> axisBins(ncoords * n), bins(n, 0);
+   Bool_t weighted = kFALSE;
+   for (Int_t i = 0; i < n; ++i) {
+      weights[i] = v[i * stride + ncoords];
+      weighted |= (weights[i] != 1.);
+   }
+   for (Int_t d = ncoords - 1; d >= 0; --d) {
+      Double_t *x = &coords[d * n];
+      Int_t *b = &axisBins[d * n];
+      for (Int_t i = 0; i < n; ++i)
+         x[i] = v[i * stride + d];
+      axes[d]->FindFixBins(n, x, b);
+      const Int_t ncells = axes[d]->GetNbins() + 2;
+      for (Int_t i = 0; i < n; ++i)
+         bins[i] = bins[i] * ncells + b[i];
+   }
+
+   // Statistics, summed in the order of the entries
+   const Bool_t statOverflows = fHist.GetStatOverflowsBehaviour();
+   Double_t stats[11] = {0};
+   for (Int_t i = 0; i < n; ++i) {
+      Bool_t inRange = kTRUE;
+      for (Int_t d = 0; d < ncoords; ++d) {
+         const Int_t b = axisBins[d * n + i];
+         inRange &= (b > 0 && b <= axes[d]->GetNbins());
+      }
+      if (!inRange && !statOverflows)
+         continue;
+      const Double_t w = weights[i];
+      const Double_t x = coords[i];
+      stats[0] += w;
+      stats[1] += w * w;
+      stats[2] += w * x;
+      stats[3] += w * x * x;
+      if (ncoords > 1) {
+         const Double_t y = coords[n + i];
+         stats[4] += w * y;
+         stats[5] += w * y * y;
+         stats[6] += w * x * y;
+         if (ncoords > 2) {
+            const Double_t z = coords[2 * n + i];
+            stats[7] += w * z;
+            stats[8] += w * z * z;
+            stats[9] += w * x * z;
+            stats[10] += w * y * z;
+         }
+      }
+   }
+   {
+      std::lock_guard<std::mutex> lock(fStatsMutex);
+      fHist.fEntries += n;
+      fHist.fTsumw += stats[0];
+      fHist.fTsumw2 += stats[1];
+      fHist.fTsumwx += stats[2];
+      fHist.fTsumwx2 += stats[3];
+      if (ncoords == 2) {
+         TH2 &h2 = static_cast<TH2 &>(fHist);
+         h2.fTsumwy += stats[4];
+         h2.fTsumwy2 += stats[5];
+         h2.fTsumwxy += stats[6];
+      } else if (ncoords == 3) {
+         TH3 &h3 = static_cast<TH3 &>(fHist);
+         h3.fTsumwy += stats[4];
+         h3.fTsumwy2 += stats[5];
+         h3.fTsumwxy += stats[6];
+         h3.fTsumwz += stats[7];
+         h3.fTsumwz2 += stats[8];
+         h3.fTsumwxz += stats[9];
+         h3.fTsumwyz += stats[10];
+      }
+   }
+
+   // The sum of squares of weights must exist before any weighted entry is added
+   if (weighted && !fHasSumw2 && !fHist.TestBit(TH1::kIsNotW))
+      EnableSumw2();
+
+   // Sort the entries by shard
+   const Int_t nshards = fShardMutexes.size();
+   std::vector<Int_t> offsets(nshards + 1, 0);
+   for (Int_t i = 0; i < n; ++i)
+      ++offsets[bins[i] / fCellsPerShard + 1];
+   for (Int_t s = 0; s < nshards; ++s)
+      offsets[s + 1] += offsets[s];
+   std::vector<Int_t> sortedBins(n);
+   std::vector<Double_t> sortedWeights(n);
+   {
+      std::vector<Int_t> next(offsets.begin(), offsets.end() - 1);
+      for (Int_t i = 0; i < n; ++i) {
+         const Int_t j = next[bins[i] / fCellsPerShard]++;
+         sortedBins[j] = bins[i];
+         sortedWeights[j] = weights[i];
+      }
+   }
+
+   for (Int_t s = 0; s < nshards; ++s) {
+      const Int_t first = offsets[s];
+      if (first == offsets[s + 1])
+         continue;
+      std::lock_guard<std::mutex> lock(*fShardMutexes[s]);
+      fHist.DoFillBins(offsets[s + 1] - first, &sortedBins[first], &sortedWeights[first]);
+   }
+}
+
+/** \class ROOT::TH1ConcurrentFiller
+\ingroup Hist
+Buffers the Fill calls of one thread and adds them to the histogram of a
+ROOT::TH1ConcurrentFillManager.
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+/// Create a filler of the histogram managed by `manager`.
+
+TH1ConcurrentFiller::TH1ConcurrentFiller(TH1ConcurrentFillManager &manager) : fManager(&manager)
+{
+   fValues.reserve(kBufferSize * (manager.fNCoords + 1));
+}
+
+TH1ConcurrentFiller::TH1ConcurrentFiller(TH1ConcurrentFiller &&other)
+   : fManager(other.fManager), fValues(std::move(other.fValues)), fNEntries(other.fNEntries)
+{
+   other.fValues.clear();
+   other.fNEntries = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Buffer an entry of `n` values: its coordinates, possibly followed by its weight.
+
+void TH1ConcurrentFiller::Add(const Double_t *values, Int_t n)
+{
+   const Int_t ncoords = fManager->fNCoords;
+   if (n != ncoords && n != ncoords + 1) {
+      ::Error("TH1ConcurrentFiller::Fill", "Cannot fill a %d-dimensional histogram with %d values", ncoords, n);
+      return;
+   }
+   fValues.insert(fValues.end(), values, values + ncoords);
+   fValues.push_back(n > ncoords ? values[ncoords] : 1.);
+   if (++fNEntries == kBufferSize)
+      Flush();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Add the buffered entries to the histogram.
+
+void TH1ConcurrentFiller::Flush()
+{
+   if (fNEntries)
+      fManager->Flush(*this);
+}
+
+} // namespace ROOT
@@ -25,6 +25,8 @@
 #include "TObjString.h"
 #include "TVirtualHistPainter.h"
 
+#include <algorithm>
+
 
 ClassImp(TH2);
 
@@ -551,6 +553,47 @@ void TH2::FillN(Int_t ntimes, const Double_t *x, const Double_t *y, const Double
          return;
    }
 
+   // Fast path: if no axis can be extended, the entries are processed in blocks,
+   // finding all their bins at once and then adding them to the bins and to the statistics.
+   if (!fXaxis.CanExtend() && !fYaxis.CanExtend()) {
+      const Int_t kBlockSize = 256;
+      Double_t xs[kBlockSize], ys[kBlockSize], ws[kBlockSize];
+      Int_t binsx[kBlockSize], binsy[kBlockSize], bins[kBlockSize];
+      const Int_t nbinsx = fXaxis.GetNbins();
+      const Int_t nbinsy = fYaxis.GetNbins();
+      const Bool_t statOverflows = GetStatOverflowsBehaviour();
+      const Int_t nentries = (ntimes - ifirst) / stride;
+      for (Int_t first = 0; first < nentries; first += kBlockSize) {
+         const Int_t n = std::min(kBlockSize, nentries - first);
+         for (i = 0; i < n; ++i) {
+            const Int_t j = ifirst + (first + i) * stride;
+            xs[i] = x[j];
+            ys[i] = y[j];
+            ws[i] = w ? w[j] : 1.;
+         }
+         fEntries += n;
+         fXaxis.FindFixBins(n, xs, binsx);
+         fYaxis.FindFixBins(n, ys, binsy);
+         for (i = 0; i < n; ++i)
+            bins[i] = binsy[i] * (nbinsx + 2) + binsx[i];
+         DoFillBins(n, bins, ws);
+         // The statistics are summed in the order of the entries, as by Fill
+         for (i = 0; i < n; ++i) {
+            if (!statOverflows && (binsx[i] == 0 || binsx[i] > nbinsx || binsy[i] == 0 || binsy[i] > nbinsy))
+               continue;
+            const Double_t z = ws[i];
+            fTsumw   += z;
+            fTsumw2  += z*z;
+            fTsumwx  += z*xs[i];
+            fTsumwx2 += z*xs[i]*xs[i];
+            fTsumwy  += z*ys[i];
+            fTsumwy2 += z*ys[i]*ys[i];
+            fTsumwxy += z*xs[i]*ys[i];
+         }
+      }
+      return;
+   }
+
    Double_t ww = 1;
    for (i=ifirst;i<ntimes;i+=stride) {
       fEntries++;
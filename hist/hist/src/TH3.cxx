@@ -24,6 +24,8 @@
 #include "TMath.h"
 #include "TObjString.h"
 
+#include <algorithm>
+
 ClassImp(TH3);
 
 /** \addtogroup Hist
@@ -382,6 +384,97 @@ Int_t TH3::Fill(Double_t x, Double_t y, Double_t z, Double_t w)
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// Fill a 3-D histogram with an array of values and weights.
+///
+///  - ntimes:  number of entries in arrays x, y, z and w (array size must be ntimes*stride)
+///  - x:       array of x values to be histogrammed
+///  - y:       array of y values to be histogrammed
+///  - z:       array of z values to be histogrammed
+///  - w:       array of weights
+///  - stride:  step size through arrays x, y, z and w
+///
+///   - If the weight is not equal to 1, the storage of the sum of squares of
+///     weights is automatically triggered and the sum of the squares of weights is incremented
+///     by w[i]^2 in the bin corresponding to x[i],y[i],z[i].
+///   - If w is NULL each entry is assumed a weight=1
+///
+/// NB: function only valid for a TH3x object
+
+void TH3::FillN(Int_t ntimes, const Double_t *x, const Double_t *y, const Double_t *z, const Double_t *w, Int_t stride)
+{
+   Int_t i;
+   ntimes *= stride;
+   Int_t ifirst = 0;
+
+   //If a buffer is activated, fill buffer
+   if (fBuffer) {
+      for (i=0;i<ntimes;i+=stride) {
+         if (!fBuffer) break; // buffer can be deleted in BufferFill when is empty
+         if (w) BufferFill(x[i],y[i],z[i],w[i]);
+         else BufferFill(x[i], y[i], z[i], 1.);
+      }
+      // fill the remaining entries if the buffer has been deleted
+      if (i < ntimes && fBuffer==0)
+         ifirst = i;
+      else
+         return;
+   }
+
+   if (fXaxis.CanExtend() || fYaxis.CanExtend() || fZaxis.CanExtend()) {
+      for (i=ifirst;i<ntimes;i+=stride)
+         Fill(x[i], y[i], z[i], w ? w[i] : 1.);
+      return;
+   }
+
+   // No axis can be extended: the entries are processed in blocks, finding all
+   // their bins at once and then adding them to the bins and to the statistics.
+   const Int_t kBlockSize = 256;
+   Double_t xs[kBlockSize], ys[kBlockSize], zs[kBlockSize], ws[kBlockSize];
+   Int_t binsx[kBlockSize], binsy[kBlockSize], binsz[kBlockSize], bins[kBlockSize];
+   const Int_t nbinsx = fXaxis.GetNbins();
+   const Int_t nbinsy = fYaxis.GetNbins();
+   const Int_t nbinsz = fZaxis.GetNbins();
+   const Bool_t statOverflows = GetStatOverflowsBehaviour();
+   const Int_t nentries = (ntimes - ifirst) / stride;
+   for (Int_t first = 0; first < nentries; first += kBlockSize) {
+      const Int_t n = std::min(kBlockSize, nentries - first);
+      for (i = 0; i < n; ++i) {
+         const Int_t j = ifirst + (first + i) * stride;
+         xs[i] = x[j];
+         ys[i] = y[j];
+         zs[i] = z[j];
+         ws[i] = w ? w[j] : 1.;
+      }
+      fEntries += n;
+      fXaxis.FindFixBins(n, xs, binsx);
+      fYaxis.FindFixBins(n, ys, binsy);
+      fZaxis.FindFixBins(n, zs, binsz);
+      for (i = 0; i < n; ++i)
+         bins[i] = binsx[i] + (nbinsx + 2) * (binsy[i] + (nbinsy + 2) * binsz[i]);
+      DoFillBins(n, bins, ws);
+      // The statistics are summed in the order of the entries, as by Fill
+      for (i = 0; i < n; ++i) {
+         if (!statOverflows && (binsx[i] == 0 || binsx[i] > nbinsx || binsy[i] == 0 || binsy[i] > nbinsy ||
+                                binsz[i] == 0 || binsz[i] > nbinsz))
+            continue;
+         const Double_t v = ws[i];
+         fTsumw   += v;
+         fTsumw2  += v*v;
+         fTsumwx  += v*xs[i];
+         fTsumwx2 += v*xs[i]*xs[i];
+         fTsumwy  += v*ys[i];
+         fTsumwy2 += v*ys[i]*ys[i];
+         fTsumwxy += v*xs[i]*ys[i];
+         fTsumwz  += v*zs[i];
+         fTsumwz2 += v*zs[i]*zs[i];
+         fTsumwxz += v*xs[i]*zs[i];
+         fTsumwyz += v*ys[i]*zs[i];
+      }
+   }
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Increment cell defined by namex,namey,namez by a weight w
 ///
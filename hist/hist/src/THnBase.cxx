@@ -644,6 +644,12 @@ void THnBase::AddInternal(const THnBase* h, Double_t c, Bool_t rebinned)
       Sumw2();
    Bool_t haveErrors = GetCalculateErrors();
 
+   Double_t nEntries = GetEntries() + c * h->GetEntries();
+   if (!rebinned && AddSameBinning(h, c)) {
+      SetEntries(nEntries);
+      return;
+   }
+
    Double_t* x = 0;
    if (rebinned) {
       x = new Double_t[fNdimensions];
@@ -683,7 +689,6 @@ void THnBase::AddInternal(const THnBase* h, Double_t c, Bool_t rebinned)
    delete [] coord;
    delete [] x;
 
-   Double_t nEntries = GetEntries() + c * h->GetEntries();
    SetEntries(nEntries);
 }
 
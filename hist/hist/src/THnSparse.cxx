@@ -17,6 +17,8 @@
 #include "TDataMember.h"
 #include "TDataType.h"
 
+#include <vector>
+
 namespace {
 //______________________________________________________________________________
 //
@@ -319,9 +321,9 @@ ULong64_t THnSparseCoordCompression::GetHashFromBuffer(const Char_t* buf) const
 {
    // Bins are addressed in two different modes, depending
    // on whether the compact bin index fits into a Long64_t or not.
-   // If it does, we can use it as a "perfect hash" for the TExMap.
+   // If it does, we can use it as a "perfect hash" for the bin index.
    // If not we build a hash from the compact bin index, and use that
-   // as the TExMap's hash.
+   // as the bin index hash.
 
    if (fCoordBufferSize <= 8) {
       // fits into a Long64_t
@@ -410,6 +412,186 @@ THnSparseCompactBinCoord::~THnSparseCompactBinCoord()
    delete [] fCurrentBin;
 }
 
+/** \class THnSparseBinIndex
+THnSparseBinIndex is used internally by THnSparse to find the linear index of
+a filled bin given the hash of its compact coordinates.
+
+It is an open-addressing hash table: the hash and the linear index of each
+bin are stored in an array of slots, and a control byte per slot stores
+either kEmpty or 7 bits of the (mixed) hash. The slots are organized in groups
+of 8 whose control bytes are packed in a 64 bit word, so that a lookup
+compares the control bytes of a whole group at once and only reads the slots
+whose control byte matches. Groups are probed quadratically until one with an
+empty slot is found. Bins are never removed from the index, thus no tombstones
+are needed.
+
+Different coordinates can have the same hash if the compact coordinates do
+not fit in a ULong64_t: Find() then asks the caller whether the coordinates
+of a candidate bin match.
+*/
+
+class THnSparseBinIndex {
+public:
+   THnSparseBinIndex(): fSize(0) {}
+
+   Long64_t GetSize() const { return fSize; }
+   Long64_t GetCapacity() const { return fSlots.size(); }
+   Long64_t GetMemoryUsage() const {
+      return fSlots.capacity() * sizeof(Slot_t) + fCtrl.capacity() * sizeof(ULong64_t);
+   }
+
+   template <class MATCHES>
+   Long64_t Find(ULong64_t hash, MATCHES matches) const;
+   void Insert(ULong64_t hash, Long64_t idx);
+   void Reserve(Long64_t n);
+   void Clear();
+
+private:
+   struct Slot_t {
+      ULong64_t fHash;  // hash of the compact coordinates
+      Long64_t  fIndex; // linear index of the bin
+   };
+
+   static const Int_t kGroupSize = 8;
+   static const ULong64_t kEmpty = 0x80; // control byte of an empty slot
+   static const ULong64_t kLowBits = 0x7f7f7f7f7f7f7f7fULL;
+   static const ULong64_t kHighBits = 0x8080808080808080ULL;
+
+   /// Spread the bits of the hash: for small compact coordinates the hash
+   /// is the coordinate buffer itself, whose high bits are all zero.
+   static ULong64_t Mix(ULong64_t hash) {
+      hash ^= hash >> 33;
+      hash *= 0xff51afd7ed558ccdULL;
+      hash ^= hash >> 33;
+      hash *= 0xc4ceb9fe1a85ec53ULL;
+      hash ^= hash >> 33;
+      return hash;
+   }
+   /// Return a word with the high bit set in the control bytes equal to tag.
+   static ULong64_t MatchTag(ULong64_t group, ULong64_t tag) {
+      const ULong64_t x = group ^ (tag * 0x0101010101010101ULL);
+      return ~(((x & kLowBits) + kLowBits) | x | kLowBits);
+   }
+   /// Return a word with the high bit set in the control bytes of empty slots.
+   static ULong64_t MatchEmpty(ULong64_t group) { return group & kHighBits; }
+
+   void InsertNoGrow(ULong64_t hash, Long64_t idx);
+   void Rehash(Long64_t capacity);
+
+   std::vector<Slot_t>    fSlots; // slots, kGroupSize per group
+   std::vector<ULong64_t> fCtrl;  // control bytes, one word per group
+   Long64_t               fSize;  // number of bins in the index
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return the linear index of the bin with hash "hash" for which
+/// matches(linear index) returns true, or -1 if there is none.
+
+template <class MATCHES>
+Long64_t THnSparseBinIndex::Find(ULong64_t hash, MATCHES matches) const
+{
+   if (!fSize)
+      return -1;
+   const ULong64_t mixed = Mix(hash);
+   const ULong64_t mask = fCtrl.size() - 1;
+   ULong64_t igroup = (mixed >> 7) & mask;
+   for (ULong64_t step = 1; ; ++step) {
+      const ULong64_t group = fCtrl[igroup];
+      ULong64_t match = MatchTag(group, mixed & 0x7f);
+      for (Int_t i = 0; match; ++i, match >>= 8) {
+         if (match & kEmpty) {
+            const Slot_t &slot = fSlots[igroup * kGroupSize + i];
+            if (slot.fHash == hash && matches(slot.fIndex))
+               return slot.fIndex;
+         }
+      }
+      if (MatchEmpty(group))
+         return -1;
+      igroup = (igroup + step) & mask;
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Add the bin with linear index "idx" and hash "hash", which must not be in
+/// the index yet.
+
+void THnSparseBinIndex::Insert(ULong64_t hash, Long64_t idx)
+{
+   // Keep the load factor below 7/8
+   if (8 * (fSize + 1) > 7 * GetCapacity())
+      Reserve(2 * (fSize + 1));
+   InsertNoGrow(hash, idx);
+   ++fSize;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Store the bin in the first empty slot of its probe sequence.
+
+void THnSparseBinIndex::InsertNoGrow(ULong64_t hash, Long64_t idx)
+{
+   const ULong64_t mixed = Mix(hash);
+   const ULong64_t mask = fCtrl.size() - 1;
+   ULong64_t igroup = (mixed >> 7) & mask;
+   for (ULong64_t step = 1; ; ++step) {
+      ULong64_t empty = MatchEmpty(fCtrl[igroup]);
+      if (empty) {
+         Int_t i = 0;
+         for (; !(empty & kEmpty); ++i)
+            empty >>= 8;
+         fCtrl[igroup] &= ~(0xffULL << (8 * i));
+         fCtrl[igroup] |= (mixed & 0x7f) << (8 * i);
+         Slot_t &slot = fSlots[igroup * kGroupSize + i];
+         slot.fHash = hash;
+         slot.fIndex = idx;
+         return;
+      }
+      igroup = (igroup + step) & mask;
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Make room for n bins without rehashing.
+
+void THnSparseBinIndex::Reserve(Long64_t n)
+{
+   Long64_t capacity = 2 * kGroupSize;
+   while (8 * n > 7 * capacity)
+      capacity *= 2;
+   if (capacity > GetCapacity())
+      Rehash(capacity);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Move all bins into a table of "capacity" slots, a power of two.
+
+void THnSparseBinIndex::Rehash(Long64_t capacity)
+{
+   std::vector<Slot_t> slots(capacity);
+   std::vector<ULong64_t> ctrl(capacity / kGroupSize, kEmpty * 0x0101010101010101ULL);
+   slots.swap(fSlots);
+   ctrl.swap(fCtrl);
+   for (size_t igroup = 0; igroup < ctrl.size(); ++igroup) {
+      ULong64_t full = ~ctrl[igroup] & kHighBits;
+      for (Int_t i = 0; full; ++i, full >>= 8) {
+         if (full & kEmpty) {
+            const Slot_t &slot = slots[igroup * kGroupSize + i];
+            InsertNoGrow(slot.fHash, slot.fIndex);
+         }
+      }
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Remove all bins and release the memory.
+
+void THnSparseBinIndex::Clear()
+{
+   std::vector<Slot_t>().swap(fSlots);
+   std::vector<ULong64_t>().swap(fCtrl);
+   fSize = 0;
+}
+
 /** \class THnSparseArrayChunk
 THnSparseArrayChunk is used internally by THnSparse.
 THnSparse stores its (dynamic size) array of bin coordinates and their
@@ -571,14 +753,17 @@ Translation from an n-dimensional bin coordinate to the linear index within
 the chunks is done by GetBin(). It creates a hash from the compacted bin
 coordinates (the hash of a bin coordinate is the compacted coordinate itself
 if it takes less than 8 bytes, the size of a Long64_t.
-This hash is used to lookup the linear index in the TExMap member fBins;
-the coordinates of the entry fBins points to is compared to the coordinates
-passed to GetBin(). If they do not match, these two coordinates have the same
-hash - which is extremely unlikely but (for the case where the compact bin
-coordinates are larger than 4 bytes) possible. In this case, fBinsContinued
-contains a chain of linear indexes with the same hash. Iterating through this
-chain and comparing each bin coordinates with the one passed to GetBin() will
-retrieve the matching bin.
+This hash is used to lookup the linear index in fBinIndex, an open-addressing
+hash table (THnSparseBinIndex) storing the hash and the linear index of each
+filled bin. Different coordinates can have the same hash - which is extremely
+unlikely but (for the case where the compact bin coordinates are larger than
+8 bytes) possible. Only the bins with the same hash as the coordinates passed
+to GetBin() are considered, and their coordinates are compared to retrieve the
+matching bin.
+
+The index is not stored with the histogram: it is rebuilt from the compact
+coordinates of the chunks when the histogram is first accessed after being
+read. GetMemoryUsage() returns the memory used by the chunks and the index.
 */
 
 
@@ -588,7 +773,7 @@ ClassImp(THnSparse);
 /// Construct an empty THnSparse.
 
 THnSparse::THnSparse():
-   fChunkSize(1024), fFilledBins(0), fCompactCoord(0)
+   fChunkSize(1024), fFilledBins(0), fBinIndex(new THnSparseBinIndex), fCompactCoord(0)
 {
    fBinContent.SetOwner();
 }
@@ -605,7 +790,7 @@ THnSparse::THnSparse(const char* name, const char* title, Int_t dim,
                      const Int_t* nbins, const Double_t* xmin, const Double_t* xmax,
                      Int_t chunksize):
    THnBase(name, title, dim, nbins, xmin, xmax),
-   fChunkSize(chunksize), fFilledBins(0), fCompactCoord(0)
+   fChunkSize(chunksize), fFilledBins(0), fBinIndex(new THnSparseBinIndex), fCompactCoord(0)
 {
    fCompactCoord = new THnSparseCompactBinCoord(dim, nbins);
    fBinContent.SetOwner();
@@ -615,6 +800,7 @@ THnSparse::THnSparse(const char* name, const char* title, Int_t dim,
 /// Destruct a THnSparse
 
 THnSparse::~THnSparse() {
+   delete fBinIndex;
    delete fCompactCoord;
 }
 
@@ -651,36 +837,22 @@ void THnSparse::InitStorage(Int_t* nbins, Int_t chunkSize)
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-///We have been streamed; set up fBins
+///We have been streamed; set up fBinIndex
 
-void THnSparse::FillExMap()
+void THnSparse::FillBinIndex()
 {
    TIter iChunk(&fBinContent);
    THnSparseArrayChunk* chunk = 0;
    THnSparseCoordCompression compactCoord(*GetCompactCoord());
    Long64_t idx = 0;
-   if (2 * GetNbins() > fBins.Capacity())
-      fBins.Expand(3 * GetNbins());
+   fBinIndex->Reserve(GetNbins());
    while ((chunk = (THnSparseArrayChunk*) iChunk())) {
       const Int_t chunkSize = chunk->GetEntries();
       Char_t* buf = chunk->fCoordinates;
       const Int_t singleCoordSize = chunk->fSingleCoordinateSize;
       const Char_t* endbuf = buf + singleCoordSize * chunkSize;
-      for (; buf < endbuf; buf += singleCoordSize, ++idx) {
-         Long64_t hash = compactCoord.GetHashFromBuffer(buf);
-         Long64_t linidx = fBins.GetValue(hash);
-         if (linidx) {
-            Long64_t nextidx = linidx;
-            while (nextidx) {
-               // must be a collision, so go to fBinsContinued.
-               linidx = nextidx;
-               nextidx = fBinsContinued.GetValue(linidx);
-            }
-            fBinsContinued.Add(linidx, idx + 1);
-         } else {
-            fBins.Add(hash, idx + 1);
-         }
-      }
+      for (; buf < endbuf; buf += singleCoordSize, ++idx)
+         fBinIndex->Insert(compactCoord.GetHashFromBuffer(buf), idx);
    }
 }
 
@@ -688,12 +860,10 @@ void THnSparse::FillExMap()
 /// Initialize storage for nbins
 
 void THnSparse::Reserve(Long64_t nbins) {
-   if (!fBins.GetSize() && fBinContent.GetSize()) {
-      FillExMap();
-   }
-   if (2 * nbins > fBins.Capacity()) {
-      fBins.Expand(3 * nbins);
+   if (!fBinIndex->GetSize() && fBinContent.GetSize()) {
+      FillBinIndex();
    }
+   fBinIndex->Reserve(nbins);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -790,22 +960,23 @@ Double_t THnSparse::GetBinError2(Long64_t linidx) const {
 Long64_t THnSparse::GetBinIndexForCurrentBin(Bool_t allocate)
 {
    THnSparseCompactBinCoord* cc = GetCompactCoord();
-   ULong64_t hash = cc->GetHash();
-   if (fBinContent.GetSize() && !fBins.GetSize())
-      FillExMap();
-   Long64_t linidx = (Long64_t) fBins.GetValue(hash);
-   while (linidx) {
-      // fBins stores index + 1!
-      THnSparseArrayChunk* chunk = GetChunk((linidx - 1)/ fChunkSize);
-      if (chunk->Matches((linidx - 1) % fChunkSize, cc->GetBuffer()))
-         return linidx - 1; // we store idx+1, 0 is "TExMap: not found"
+   return GetBinIndexForBuffer(cc->GetHash(), cc->GetBuffer(), allocate);
+}
 
-      Long64_t nextlinidx = fBinsContinued.GetValue(linidx);
-      if (!nextlinidx) break;
+////////////////////////////////////////////////////////////////////////////////
+/// Return the index of the bin with compact coordinates buf and their hash.
+/// If it doesn't exist then return -1, or allocate a new bin if allocate is set
 
-      linidx = nextlinidx;
-   }
-   if (!allocate) return -1;
+Long64_t THnSparse::GetBinIndexForBuffer(ULong64_t hash, const Char_t* buf, Bool_t allocate)
+{
+   if (fBinContent.GetSize() && !fBinIndex->GetSize())
+      FillBinIndex();
+   const Int_t chunkSize = fChunkSize;
+   const Long64_t linidx = fBinIndex->Find(hash, [this, chunkSize, buf](Long64_t idx) {
+      return GetChunk(idx / chunkSize)->Matches(idx % chunkSize, buf);
+   });
+   if (linidx >= 0 || !allocate)
+      return linidx;
 
    ++fFilledBins;
 
@@ -816,23 +987,51 @@ Long64_t THnSparse::GetBinIndexForCurrentBin(Bool_t allocate)
       chunk = AddChunk();
       newidx = 0;
    }
-   chunk->AddBin(newidx, cc->GetBuffer());
+   chunk->AddBin(newidx, buf);
 
    // store translation between hash and bin
    newidx += (fBinContent.GetEntriesFast() - 1) * fChunkSize;
-   if (!linidx) {
-      // fBins didn't find it
-      if (2 * GetNbins() > fBins.Capacity())
-         fBins.Expand(3 * GetNbins());
-      fBins.Add(hash, newidx + 1);
-   } else {
-      // fBins contains one, but it's the wrong one;
-      // add entry to fBinsContinued.
-      fBinsContinued.Add(linidx, newidx + 1);
-   }
+   fBinIndex->Insert(hash, newidx);
    return newidx;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Add the bins of h, scaled by c, if h is a THnSparse with the same binning.
+/// The compact coordinates of the bins of h are then looked up directly in
+/// this histogram, without converting them to and from bin coordinates.
+/// Return kFALSE if h is not a THnSparse with the same binning.
+
+Bool_t THnSparse::AddSameBinning(const THnBase* h, Double_t c)
+{
+   const THnSparse* hs = dynamic_cast<const THnSparse*>(h);
+   if (!hs || hs->GetCompactCoord()->GetBufferSize() != GetCompactCoord()->GetBufferSize())
+      return kFALSE;
+
+   Reserve(GetNbins() + hs->GetNbins());
+   const Bool_t haveErrors = GetCalculateErrors();
+   const Bool_t hHasErrors = hs->GetCalculateErrors();
+   const THnSparseCoordCompression& compactCoord = *hs->GetCompactCoord();
+   const Int_t nchunks = hs->GetNChunks();
+   for (Int_t ichunk = 0; ichunk < nchunks; ++ichunk) {
+      const THnSparseArrayChunk* hchunk = hs->GetChunk(ichunk);
+      const Int_t nentries = hchunk->GetEntries();
+      const Int_t singleCoordSize = hchunk->fSingleCoordinateSize;
+      for (Int_t i = 0; i < nentries; ++i) {
+         const Char_t* buf = hchunk->fCoordinates + i * singleCoordSize;
+         const Long64_t bin = GetBinIndexForBuffer(compactCoord.GetHashFromBuffer(buf), buf, kTRUE);
+         THnSparseArrayChunk* chunk = GetChunk(bin / fChunkSize);
+         const Int_t idx = bin % fChunkSize;
+         const Double_t v = hchunk->fContent->GetAt(i);
+         if (haveErrors) {
+            const Double_t err2 = hHasErrors ? hchunk->fSumw2->GetAt(i) : v;
+            (*chunk->fSumw2)[idx] += c * c * err2;
+         }
+         chunk->fContent->SetAt(chunk->fContent->GetAt(idx) + c * v, idx);
+      }
+   }
+   return kTRUE;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Return THnSparseCompactBinCoord object.
 
@@ -859,29 +1058,30 @@ Double_t THnSparse::GetSparseFractionBins() const {
    return fFilledBins / nbinsTotal;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Return the size of the bin content type, or 0 if it cannot be determined.
+
+static Int_t GetArrayElementSize(const TArray* array)
+{
+   TClass* clArray = array->IsA();
+   TDataMember* dm = clArray ? clArray->GetDataMember("fArray") : 0;
+   return dm ? dm->GetDataType()->Size() : 0;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Return the amount of used memory over memory that would be used by a
 /// non-sparse n-dimensional histogram. The value is approximate.
 
 Double_t THnSparse::GetSparseFractionMem() const {
    Int_t arrayElementSize = 0;
-   if (fFilledBins) {
-      TClass* clArray = GetChunk(0)->fContent->IsA();
-      TDataMember* dm = clArray ? clArray->GetDataMember("fArray") : 0;
-      arrayElementSize = dm ? dm->GetDataType()->Size() : 0;
-   }
+   if (fFilledBins)
+      arrayElementSize = GetArrayElementSize(GetChunk(0)->fContent);
    if (!arrayElementSize) {
       Warning("GetSparseFractionMem", "Cannot determine type of elements!");
       return -1.;
    }
 
-   Double_t sizePerChunkElement = arrayElementSize + GetCompactCoord()->GetBufferSize();
-   if (fFilledBins && GetChunk(0)->fSumw2)
-      sizePerChunkElement += sizeof(Double_t); /* fSumw2 */
-
-   Double_t size = 0.;
-   size += fBinContent.GetEntries() * (GetChunkSize() * sizePerChunkElement + sizeof(THnSparseArrayChunk));
-   size += + 3 * sizeof(Long64_t) * fBins.GetSize() /* TExMap */;
+   Double_t size = GetMemoryUsage();
 
    Double_t nbinsTotal = 1.;
    for (Int_t d = 0; d < fNdimensions; ++d)
@@ -890,6 +1090,22 @@ Double_t THnSparse::GetSparseFractionMem() const {
    return size / nbinsTotal / arrayElementSize;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Return the approximate number of bytes allocated for the bins: their
+/// content, errors and compact coordinates, and the index to find them.
+
+Long64_t THnSparse::GetMemoryUsage() const {
+   Long64_t size = fBinIndex->GetMemoryUsage();
+   if (!fFilledBins)
+      return size;
+
+   Long64_t sizePerChunkElement = GetArrayElementSize(GetChunk(0)->fContent) + GetCompactCoord()->GetBufferSize();
+   if (GetChunk(0)->fSumw2)
+      sizePerChunkElement += sizeof(Double_t); /* fSumw2 */
+   size += fBinContent.GetEntries() * (GetChunkSize() * sizePerChunkElement + sizeof(THnSparseArrayChunk));
+   return size;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Create an iterator over all filled bins of a THnSparse.
 /// Use THnIter instead.
@@ -963,8 +1179,7 @@ void THnSparse::Sumw2()
 void THnSparse::Reset(Option_t *option /*= ""*/)
 {
    fFilledBins = 0;
-   fBins.Delete();
-   fBinsContinued.Clear();
+   fBinIndex->Clear();
    fBinContent.Delete();
    ResetBase(option);
 }
@@ -1,9 +1,13 @@
 #include "gtest/gtest.h"
 
 #include "THn.h"
+#include "THnSparse.h"
 #include "TH1.h"
 #include "TH2.h"
 
+#include <memory>
+#include <vector>
+
 // Filling THn
 TEST(THn, Fill) {
    Int_t bins[2] = {2, 3};
@@ -108,3 +112,53 @@ TEST(THn, Projection) {
 
 
 }
+
+// Finding and merging the bins of THnSparse
+TEST(THnSparse, BinIndex) {
+   // 9 dimensions with 1000 bins: the compact coordinates do not fit in 8 bytes
+   for (Int_t ndim : {3, 9}) {
+      std::vector<Int_t> bins(ndim, 1000);
+      std::vector<Double_t> xmin(ndim, 0.), xmax(ndim, 1.);
+      THnSparseD h1("h1", "h1", ndim, bins.data(), xmin.data(), xmax.data(), 128);
+      THnSparseD h2("h2", "h2", ndim, bins.data(), xmin.data(), xmax.data(), 128);
+      h2.Sumw2();
+
+      std::vector<Int_t> coord(ndim);
+      auto setCoord = [&coord, ndim](Int_t i) {
+         coord[0] = 1 + i % 1000;
+         coord[1] = 1 + i / 1000;
+         for (Int_t d = 2; d < ndim; ++d)
+            coord[d] = 1 + (i * (d + 7) + d) % 1000;
+      };
+      for (Int_t i = 0; i < 5000; ++i) {
+         setCoord(i);
+         Long64_t bin = h1.GetBin(coord.data());
+         EXPECT_EQ(i, bin);
+         EXPECT_EQ(bin, h1.GetBin(coord.data()));
+         h1.AddBinContent(bin, i);
+         if (i % 2)
+            h2.AddBinContent(h2.GetBin(coord.data()), 1.);
+      }
+      EXPECT_EQ(5000, h1.GetNbins());
+      EXPECT_EQ(2500, h2.GetNbins());
+      EXPECT_GT(h1.GetMemoryUsage(), 5000 * 8);
+
+      for (Int_t d = 0; d < ndim; ++d)
+         coord[d] = 999;
+      EXPECT_EQ(-1, ((const THnSparseD&)h1).GetBin(coord.data()));
+
+      // Add uses the compact coordinates of h2; RebinnedAdd the bin centers
+      std::unique_ptr<THnSparseD> hAdd((THnSparseD*)h1.Clone("hAdd"));
+      std::unique_ptr<THnSparseD> hRebinnedAdd((THnSparseD*)h1.Clone("hRebinnedAdd"));
+      hAdd->Add(&h2, 2.);
+      hRebinnedAdd->RebinnedAdd(&h2, 2.);
+      ASSERT_EQ(hRebinnedAdd->GetNbins(), hAdd->GetNbins());
+      for (Long64_t bin = 0; bin < hAdd->GetNbins(); ++bin) {
+         EXPECT_DOUBLE_EQ(hRebinnedAdd->GetBinContent(bin), hAdd->GetBinContent(bin));
+         EXPECT_DOUBLE_EQ(hRebinnedAdd->GetBinError2(bin), hAdd->GetBinError2(bin));
+      }
+      EXPECT_DOUBLE_EQ(hRebinnedAdd->GetEntries(), hAdd->GetEntries());
+      setCoord(1);
+      EXPECT_DOUBLE_EQ(1. + 2., hAdd->GetBinContent(coord.data()));
+   }
+}
@@ -2,6 +2,14 @@
 
 #include "TH1.h"
 #include "TH1F.h"
+#include "TH2.h"
+#include "TH3.h"
+#include "TProfile3D.h"
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
 
 // StatOverflows TH1
 TEST(TH1, StatOverflows)
@@ -30,3 +38,95 @@ TEST(TH1, StatOverflows)
    EXPECT_EQ(TH1::EStatOverflows::kConsider, h1.GetStatOverflows());
    EXPECT_EQ(TH1::EStatOverflows::kNeutral,  h2.GetStatOverflows());
 }
+
+// The statistics and the contents of two histograms are identical
+static void ExpectSameContents(const TH1 &h1, const TH1 &h2)
+{
+   EXPECT_EQ(h1.GetEntries(), h2.GetEntries());
+   Double_t stats1[TH1::kNstat], stats2[TH1::kNstat];
+   h1.GetStats(stats1);
+   h2.GetStats(stats2);
+   for (int i = 0; i < TH1::kNstat; ++i)
+      EXPECT_EQ(stats1[i], stats2[i]);
+   ASSERT_EQ(h1.GetSumw2N(), h2.GetSumw2N());
+   for (int bin = 0; bin < h1.GetNcells(); ++bin) {
+      EXPECT_EQ(h1.GetBinContent(bin), h2.GetBinContent(bin));
+      EXPECT_EQ(h1.GetBinError(bin), h2.GetBinError(bin));
+   }
+}
+
+// FillN of 1-D histograms
+TEST(TH1, FillN)
+{
+   std::mt19937 gen(1);
+   std::normal_distribution<double> dist(0., 2.);
+   const int n = 1000;
+   std::vector<double> x(2 * n), w(2 * n);
+   for (int i = 0; i < 2 * n; ++i) {
+      x[i] = dist(gen);
+      w[i] = i < n / 2 ? 1. : 0.5 + std::abs(dist(gen)); // the sum of squares of weights starts on the way
+   }
+   x[0] = std::numeric_limits<double>::quiet_NaN();
+   x[2] = std::numeric_limits<double>::infinity();
+   x[4] = -5.;
+   x[6] = 5.;
+
+   const double edges[] = {-5., -2., -1., -0.5, 0., 0.1, 0.5, 1., 3., 5.};
+   TH1D fix("fix", "fix", 37, -5, 5), fixN("fixN", "fixN", 37, -5, 5);
+   TH1F var("var", "var", 9, edges), varN("varN", "varN", 9, edges);
+   TH1D ignore("ignore", "ignore", 10, -1, 1), ignoreN("ignoreN", "ignoreN", 10, -1, 1);
+   ignore.SetStatOverflows(TH1::EStatOverflows::kIgnore);
+   ignoreN.SetStatOverflows(TH1::EStatOverflows::kIgnore);
+   for (int i = 0; i < n; ++i) {
+      fix.Fill(x[2 * i], w[2 * i]);
+      var.Fill(x[2 * i], w[2 * i]);
+      ignore.Fill(x[2 * i]);
+   }
+   fixN.FillN(n, x.data(), w.data(), 2);
+   varN.FillN(n, x.data(), w.data(), 2);
+   ignoreN.FillN(n, x.data(), nullptr, 2);
+
+   ExpectSameContents(fix, fixN);
+   ExpectSameContents(var, varN);
+   ExpectSameContents(ignore, ignoreN);
+   EXPECT_EQ(0, ignoreN.GetSumw2N());
+}
+
+// FillN of 2-D and 3-D histograms
+TEST(TH1, FillNMultiDim)
+{
+   std::mt19937 gen(2);
+   std::normal_distribution<double> dist(0., 2.);
+   const int n = 700;
+   std::vector<double> x(n), y(n), z(n), w(n);
+   for (int i = 0; i < n; ++i) {
+      x[i] = dist(gen);
+      y[i] = dist(gen);
+      z[i] = dist(gen);
+      w[i] = i < n / 3 ? 1. : std::abs(dist(gen));
+   }
+
+   const double edges[] = {-4., -1., 0., 0.5, 2., 4.};
+   TH2F h2("h2", "h2", 13, -4, 4, 5, edges), h2N("h2N", "h2N", 13, -4, 4, 5, edges);
+   TH3D h3("h3", "h3", 7, -4, 4, 5, -3, 3, 9, -4, 4), h3N("h3N", "h3N", 7, -4, 4, 5, -3, 3, 9, -4, 4);
+   for (int i = 0; i < n; ++i) {
+      h2.Fill(x[i], y[i], w[i]);
+      h3.Fill(x[i], y[i], z[i], w[i]);
+   }
+   h2N.FillN(n, x.data(), y.data(), w.data());
+   h3N.FillN(n, x.data(), y.data(), z.data(), w.data());
+
+   ExpectSameContents(h2, h2N);
+   ExpectSameContents(h3, h3N);
+}
+
+TEST(TH1, FillNProfile3D)
+{
+   // TH3::FillN has histogram semantics: a TProfile3D must not be filled by it
+   TProfile3D p("p", "p", 4, 0, 1, 4, 0, 1, 4, 0, 1);
+   const double x[] = {0.1, 0.6}, y[] = {0.2, 0.7}, z[] = {0.3, 0.8}, w[] = {2., 3.};
+   TH3 &h = p;
+   h.FillN(2, x, y, z, w);
+   EXPECT_EQ(0., p.GetEntries());
+   EXPECT_EQ(0., p.GetSumOfWeights());
+}
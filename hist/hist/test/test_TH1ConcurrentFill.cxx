@@ -0,0 +1,126 @@
+#include "gtest/gtest.h"
+
+#include "TH1.h"
+#include "TH1ConcurrentFill.h"
+#include "TH2.h"
+#include "TH3.h"
+#include "TProfile.h"
+#include "TProfile2D.h"
+#include "TProfile3D.h"
+
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// The threads fill the entries with index i % nThreads == thread index
+template <typename FILL>
+static void FillConcurrently(ROOT::TH1ConcurrentFillManager &manager, int nThreads, int nEntries, FILL fill)
+{
+   std::vector<std::thread> threads;
+   for (int t = 0; t < nThreads; ++t) {
+      threads.emplace_back([&manager, t, nThreads, nEntries, fill]() {
+         auto filler = manager.MakeFiller();
+         for (int i = t; i < nEntries; i += nThreads)
+            fill(filler, i);
+      });
+   }
+   for (auto &thread : threads)
+      thread.join();
+}
+
+// Weights are multiples of 1/4 so that the bin contents do not depend on the order of the entries
+static void ExpectSameHist(const TH1 &h1, const TH1 &h2)
+{
+   EXPECT_EQ(h1.GetEntries(), h2.GetEntries());
+   Double_t stats1[TH1::kNstat], stats2[TH1::kNstat];
+   h1.GetStats(stats1);
+   h2.GetStats(stats2);
+   for (int i = 0; i < TH1::kNstat; ++i)
+      EXPECT_NEAR(stats1[i], stats2[i], 1e-9 * std::abs(stats1[i]));
+   ASSERT_EQ(h1.GetSumw2N(), h2.GetSumw2N());
+   for (int bin = 0; bin < h1.GetNcells(); ++bin) {
+      EXPECT_EQ(h1.GetBinContent(bin), h2.GetBinContent(bin));
+      EXPECT_EQ(h1.GetBinError(bin), h2.GetBinError(bin));
+   }
+}
+
+TEST(TH1ConcurrentFill, TH1D)
+{
+   const int n = 100000;
+   std::mt19937 gen(1);
+   std::normal_distribution<double> dist(0., 1.);
+   std::vector<double> x(n), w(n);
+   for (int i = 0; i < n; ++i) {
+      x[i] = dist(gen);
+      w[i] = i < n / 2 ? 1. : 0.25 * (1 + i % 8);
+   }
+
+   TH1D h("h", "h", 10000, -3, 3), hc("hc", "hc", 10000, -3, 3);
+   for (int i = 0; i < n; ++i)
+      h.Fill(x[i], w[i]);
+
+   ROOT::TH1ConcurrentFillManager manager(hc, 3);
+   EXPECT_EQ(3, manager.GetNShards());
+   FillConcurrently(manager, 4, n, [&x, &w](ROOT::TH1ConcurrentFiller &f, int i) { f.Fill(x[i], w[i]); });
+   ExpectSameHist(h, hc);
+}
+
+TEST(TH1ConcurrentFill, TH2FAndTH3D)
+{
+   const int n = 50000;
+   std::mt19937 gen(2);
+   std::normal_distribution<double> dist(0., 1.);
+   std::vector<double> x(n), y(n), z(n);
+   for (int i = 0; i < n; ++i) {
+      x[i] = dist(gen);
+      y[i] = dist(gen);
+      z[i] = dist(gen);
+   }
+
+   TH2F h2("h2", "h2", 200, -3, 3, 300, -3, 3), h2c("h2c", "h2c", 200, -3, 3, 300, -3, 3);
+   TH3D h3("h3", "h3", 40, -3, 3, 30, -3, 3, 20, -3, 3), h3c("h3c", "h3c", 40, -3, 3, 30, -3, 3, 20, -3, 3);
+   for (int i = 0; i < n; ++i) {
+      h2.Fill(x[i], y[i]);
+      h3.Fill(x[i], y[i], z[i], 0.5);
+   }
+
+   ROOT::TH1ConcurrentFillManager manager2(h2c);
+   EXPECT_LT(1, manager2.GetNShards());
+   FillConcurrently(manager2, 4, n, [&x, &y](ROOT::TH1ConcurrentFiller &f, int i) { f.Fill(x[i], y[i]); });
+   ExpectSameHist(h2, h2c);
+
+   ROOT::TH1ConcurrentFillManager manager3(h3c);
+   FillConcurrently(manager3, 4, n,
+                    [&x, &y, &z](ROOT::TH1ConcurrentFiller &f, int i) { f.Fill(x[i], y[i], z[i], 0.5); });
+   ExpectSameHist(h3, h3c);
+}
+
+TEST(TH1ConcurrentFill, CanExtend)
+{
+   TH1D h("h", "h", 10, 0, 1), hc("hc", "hc", 10, 0, 1);
+   h.SetCanExtend(TH1::kAllAxes);
+   hc.SetCanExtend(TH1::kAllAxes);
+   for (int i = 0; i < 1000; ++i)
+      h.Fill(i * 0.01);
+
+   ROOT::TH1ConcurrentFillManager manager(hc);
+   EXPECT_EQ(1, manager.GetNShards());
+   {
+      auto filler = manager.MakeFiller();
+      for (int i = 0; i < 1000; ++i)
+         filler.Fill(i * 0.01);
+   }
+   ExpectSameHist(h, hc);
+}
+
+TEST(TH1ConcurrentFill, RejectsProfiles)
+{
+   TProfile p("p", "p", 10, 0, 1);
+   TProfile2D p2("p2", "p2", 10, 0, 1, 10, 0, 1);
+   TProfile3D p3("p3", "p3", 10, 0, 1, 10, 0, 1, 10, 0, 1);
+   EXPECT_THROW(ROOT::TH1ConcurrentFillManager manager(p), std::invalid_argument);
+   EXPECT_THROW(ROOT::TH1ConcurrentFillManager manager(p2), std::invalid_argument);
+   EXPECT_THROW(ROOT::TH1ConcurrentFillManager manager(p3), std::invalid_argument);
+}
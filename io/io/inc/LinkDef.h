@@ -48,6 +48,7 @@
 #pragma link C++ options=version(0) class TVirtualArray-;
 #pragma link C++ class TFPBlock+;
 #pragma link C++ class TFilePrefetch+;
+#pragma link C++ class TFileBlockCache+;
 #pragma link C++ namespace TStreamerInfoActions;
 #pragma link C++ class TStreamerInfoActions::TConfiguredAction+;
 #pragma link C++ class TStreamerInfoActions::TActionSequence+;
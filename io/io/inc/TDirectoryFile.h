@@ -118,6 +118,7 @@ public:
    virtual Int_t       Write(const char *name=0, Int_t opt=0, Int_t bufsize=0);
    virtual Int_t       Write(const char *name=0, Int_t opt=0, Int_t bufsize=0) const ;
    virtual Int_t       WriteTObject(const TObject *obj, const char *name=0, Option_t *option="", Int_t bufsize=0);
+   virtual Int_t       WriteParallel(UInt_t nthreads=0, Int_t opt=0, Int_t bufsize=0);
    virtual Int_t       WriteObjectAny(const void *obj, const char *classname, const char *name, Option_t *option="", Int_t bufsize=0);
    virtual Int_t       WriteObjectAny(const void *obj, const TClass *cl, const char *name, Option_t *option="", Int_t bufsize=0);
    virtual void        WriteDirHeader();
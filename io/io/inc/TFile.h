@@ -30,6 +30,7 @@
 
 #ifdef R__USE_IMT
 #include "ROOT/TRWSpinLock.hxx"
+#include <memory>
 #include <mutex>
 #endif
 
@@ -43,6 +44,7 @@ class TFileCacheWrite;
 class TProcessID;
 class TStopwatch;
 class TFilePrefetch;
+class TFileBlockCache;
 
 class TFile : public TDirectoryFile {
   friend class TDirectoryFile;
@@ -106,6 +108,11 @@ protected:
    TList           *fInfoCache;      ///<!Cached list of the streamer infos in this file
    TList           *fOpenPhases;     ///<!Time info about open phases
 
+   const char      *fMappedBuffer{nullptr}; ///<!Read-only memory mapping of the file (`mmap` option)
+   std::shared_ptr<const char> fMapping;    ///<!Owns the memory mapping, shared with the baskets that use it as buffer
+   Long64_t         fMappedSize{0};         ///<!Size of the memory mapping
+   TFileBlockCache *fBlockCache{nullptr};   ///<!Local block cache of a remote file (see SetBlockCacheDir)
+
 #ifdef R__USE_IMT
    static ROOT::TRWSpinLock                   fgRwLock;     ///<!Read-write lock to protect global PID list
    std::mutex                                 fWriteMutex;  ///<!Lock for writing baskets / keys into the file.
@@ -117,6 +124,9 @@ protected:
    static TString   fgCacheFileDir;          ///<Directory where to locally stage files
    static Bool_t    fgCacheFileDisconnected; ///<Indicates, we trust in the files in the cache dir without stat on the cached file
    static Bool_t    fgCacheFileForce;        ///<Indicates, to force all READ to CACHEREAD
+   static TString   fgBlockCacheDir;         ///<Directory of the local block cache of remote files
+   static Long64_t  fgBlockCacheSize;        ///<Maximum size of the block cache directory
+   static Int_t     fgBlockCacheBlockSize;   ///<Size of the blocks of the block cache
    static UInt_t    fgOpenTimeout;           ///<Timeout for open operations in ms  - 0 corresponds to blocking i/o
    static Bool_t    fgOnlyStaged ;           ///<Before the file is opened, it is checked, that the file is staged, if not, the open fails
 
@@ -130,6 +140,9 @@ protected:
    virtual void  Init(Bool_t create);
    Bool_t                    FlushWriteCache();
    Int_t                     ReadBufferViaCache(char *buf, Int_t len);
+   Bool_t                    ReadBufferFromMap(char *buf, Int_t len);
+   void                      MapFile();
+   void                      UnmapFile();
    Int_t                     WriteBufferViaCache(const char *buf, Int_t len);
 
    ////////////////////////////////////////////////////////////////////////////////
@@ -221,6 +234,7 @@ public:
    virtual Int_t       GetNfree() const { return fFree->GetSize(); }
    virtual Int_t       GetNProcessIDs() const { return fNProcessIDs; }
    Option_t           *GetOption() const { return fOption.Data(); }
+   TFileBlockCache    *GetBlockCache() const { return fBlockCache; }
    virtual Long64_t    GetBytesRead() const { return fBytesRead; }
    virtual Long64_t    GetBytesReadExtra() const { return fBytesReadExtra; }
    virtual Long64_t    GetBytesWritten() const;
@@ -240,6 +254,7 @@ public:
    virtual void        IncrementProcessIDs() { fNProcessIDs++; }
    virtual Bool_t      IsArchive() const { return fIsArchive; }
            Bool_t      IsBinary() const { return TestBit(kBinaryFile); }
+           Bool_t      IsMemoryMapped() const { return fMappedBuffer != nullptr; }
            Bool_t      IsRaw() const { return !fIsRootFile; }
    virtual Bool_t      IsOpen() const;
    virtual void        ls(Option_t *option="") const;
@@ -256,6 +271,9 @@ public:
    virtual Bool_t      ReadBuffer(char *buf, Int_t len);
    virtual Bool_t      ReadBuffer(char *buf, Long64_t pos, Int_t len);
    virtual Bool_t      ReadBuffers(char *buf, Long64_t *pos, Int_t *len, Int_t nbuf);
+           Bool_t      ReadBuffersViaBlockCache(char *buf, Long64_t *pos, Int_t *len, Int_t nbuf);
+   const char         *ReadMappedBuffer(Long64_t pos, Int_t len);
+   std::shared_ptr<const char> GetMappedRegion() const { return fMapping; }
    virtual void        ReadFree();
    virtual TProcessID *ReadProcessID(UShort_t pidf);
    virtual void        ReadStreamerInfo();
@@ -277,6 +295,7 @@ public:
    virtual Bool_t      WriteBuffer(const char *buf, Int_t len);
    virtual Int_t       Write(const char *name=0, Int_t opt=0, Int_t bufsiz=0);
    virtual Int_t       Write(const char *name=0, Int_t opt=0, Int_t bufsiz=0) const;
+   virtual Int_t       WriteParallel(UInt_t nthreads=0, Int_t opt=0, Int_t bufsiz=0);
    virtual void        WriteFree();
    virtual void        WriteHeader();
    virtual UShort_t    WriteProcessID(TProcessID *pid);
@@ -319,6 +338,9 @@ public:
                                        Bool_t forceCacheread = kFALSE);
    static const char  *GetCacheFileDir();
    static Bool_t       ShrinkCacheFileDir(Long64_t shrinkSize, Long_t cleanupInteval = 0);
+   static Bool_t       SetBlockCacheDir(const char *cacheDir, Long64_t maxSize = 10000000000LL,
+                                        Int_t blockSize = 262144);
+   static const char  *GetBlockCacheDir();
    static Bool_t       Cp(const char *src, const char *dst, Bool_t progressbar = kTRUE,
                           UInt_t buffersize = 1000000);
 
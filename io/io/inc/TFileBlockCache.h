@@ -0,0 +1,63 @@
+// @(#)root/io:$Id$
+
+/*************************************************************************
+ * Copyright (C) 1995-2018, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef ROOT_TFileBlockCache
+#define ROOT_TFileBlockCache
+
+#include "TObject.h"
+#include "TString.h"
+
+#include <atomic>
+#include <vector>
+
+class TFile;
+
+class TFileBlockCache : public TObject {
+
+private:
+   TFile      *fFile;           ///<! File whose content is cached
+   TString     fTopDir;         ///<! Cache directory, shared by all the cached files
+   TString     fDir;            ///<! Directory holding the blocks of this file
+   Int_t       fBlockSize;      ///<! Size of a block in bytes
+   Long64_t    fMaxSize;        ///<! Budget of the whole cache directory in bytes
+   Long64_t    fFileSize;       ///<! Size of the cached file, -1 if unknown
+   Long64_t    fNHits;          ///<! Number of blocks found in the cache
+   Long64_t    fNMisses;        ///<! Number of blocks fetched from the file
+   Long64_t    fBytesFromCache; ///<! Number of requested bytes served by the cache
+
+   static std::atomic<Long64_t> fgBytesSinceShrink; ///<! Bytes added to the cache since the last eviction scan
+
+   TFileBlockCache(const TFileBlockCache &) = delete;
+   TFileBlockCache &operator=(const TFileBlockCache &) = delete;
+
+   Int_t    GetBlockLength(Long64_t idx) const;
+   TString  GetBlockPath(Long64_t idx) const;
+   Bool_t   LoadBlock(Long64_t idx, char *dest);
+   void     StoreBlock(Long64_t idx, const char *src);
+
+public:
+   TFileBlockCache(TFile *file, const char *cachedir, Long64_t maxsize, Int_t blocksize);
+   virtual ~TFileBlockCache() {}
+
+   Int_t       GetBlockSize() const { return fBlockSize; }
+   Long64_t    GetBytesFromCache() const { return fBytesFromCache; }
+   const char *GetDirectory() const { return fDir; }
+   Long64_t    GetNHits() const { return fNHits; }
+   Long64_t    GetNMisses() const { return fNMisses; }
+   Bool_t      IsValid() const { return fFileSize > 0; }
+   virtual void Print(Option_t *option = "") const;
+   Bool_t      ReadBuffers(char *buf, Long64_t *pos, Int_t *len, Int_t nbuf);
+
+   static Long64_t Shrink(const char *cachedir, Long64_t maxsize);
+
+   ClassDef(TFileBlockCache, 0); // Local block cache for remote files
+};
+
+#endif
@@ -22,6 +22,8 @@
 class TList;
 class TFile;
 class TDirectory;
+class TClass;
+class TFileMergeInfo;
 
 namespace ROOT {
 class TIOFeatures;
@@ -54,8 +56,11 @@ protected:
    TString        fObjectNames;               ///< List of object names to be either merged exclusively or skipped
    TList          fMergeList;                 ///< list of TObjString containing the name of the files need to be merged
    TList          fExcessFiles;               ///<! List of TObjString containing the name of the files not yet added to fFileList due to user or system limitiation on the max number of files opened.
+   UInt_t         fNThreads{0};               ///< Number of threads used to open the input files and merge the objects (0 or 1 for sequential merging)
 
    Bool_t         OpenExcessFiles();
+   void           MergeObjectInParallel(TObject *obj, TClass *cl, const char *name, const char *path,
+                                        TFile *firstsource, TList *sourcelist, TFileMergeInfo &info);
    virtual Bool_t AddFile(TFile *source, Bool_t own, Bool_t cpProgress);
    virtual Bool_t MergeRecursive(TDirectory *target, TList *sourcelist, Int_t type = kRegular | kAll);
 
@@ -86,6 +91,8 @@ public:
    TFile      *GetOutputFile() const { return fOutputFile; }
    Int_t       GetMaxOpenedFiles() const { return fMaxOpenedFiles; }
    void        SetMaxOpenedFiles(Int_t newmax);
+   UInt_t      GetNThreads() const { return fNThreads; }
+   void        SetNThreads(UInt_t nthreads);
    const char *GetMsgPrefix() const { return fMsgPrefix; }
    void        SetMsgPrefix(const char *prefix);
    const char *GetMergeOptions() { return fMergeOptions; }
@@ -117,7 +124,7 @@ public:
    virtual void   SetNotrees(Bool_t notrees=kFALSE) {fNoTrees = notrees;}
    virtual void        RecursiveRemove(TObject *obj);
 
-   ClassDef(TFileMerger, 6)  // File copying and merging services
+   ClassDef(TFileMerger, 7)  // File copying and merging services
 };
 
 #endif
@@ -32,6 +32,9 @@ protected:
    typedef void (TGenCollectionStreamer::*ReadBuffer_t)(TBuffer &b, void *obj, const TClass *onFileClass);
    ReadBuffer_t fReadBufferFunc;
 
+   Int_t fNestedVectorKind; ///< Type of the inner values if this is a compiled vector of vectors of fundamental types, kNoType_t if not, -1 if not yet known.
+   Int_t GetNestedVectorKind();
+
    template <typename From, typename To> void ConvertBufferVectorPrimitives(TBuffer &b, void *obj, Int_t nElements);
    template <typename To> void ConvertBufferVectorPrimitivesFloat16(TBuffer &b, void *obj, Int_t nElements);
    template <typename To> void ConvertBufferVectorPrimitivesDouble32(TBuffer &b, void *obj, Int_t nElements);
@@ -39,6 +42,8 @@ protected:
    template <typename basictype> void ReadBufferVectorPrimitives(TBuffer &b, void *obj, const TClass *onFileClass);
    void ReadBufferVectorPrimitivesFloat16(TBuffer &b, void *obj, const TClass *onFileClass);
    void ReadBufferVectorPrimitivesDouble32(TBuffer &b, void *obj, const TClass *onFileClass);
+   template <typename basictype> void ReadBufferVectorOfVectorPrimitives(TBuffer &b, void *obj, const TClass *onFileClass);
+   template <typename basictype> void WriteVectorOfVectorPrimitives(TBuffer &b);
    void ReadBufferDefault(TBuffer &b, void *obj, const TClass *onFileClass);
    void ReadBufferGeneric(TBuffer &b, void *obj, const TClass *onFileClass);
 
@@ -51,20 +51,26 @@ protected:
            void     Build(TDirectory* motherDir, const char* classname, Long64_t filepos);
    virtual void     Reset(); // Currently only for the use of TBasket.
    virtual Int_t    WriteFileKeepBuffer(TFile *f = 0);
+           Int_t    CompressBufferRef();
 
 
  public:
+   /// Tag selecting the constructors that do not reserve space in the file, see Commit().
+   enum EDeferred { kDeferred };
+
    TKey();
    TKey(TDirectory* motherDir);
    TKey(TDirectory* motherDir, const TKey &orig, UShort_t pidOffset);
    TKey(const char *name, const char *title, const TClass *cl, Int_t nbytes, TDirectory* motherDir);
    TKey(const TString &name, const TString &title, const TClass *cl, Int_t nbytes, TDirectory* motherDir);
    TKey(const TObject *obj, const char *name, Int_t bufsize, TDirectory* motherDir);
+   TKey(const TObject *obj, const char *name, Int_t bufsize, TDirectory* motherDir, Long64_t filepos, EDeferred);
    TKey(const void *obj, const TClass *cl, const char *name, Int_t bufsize, TDirectory* motherDir);
    TKey(Long64_t pointer, Int_t nbytes, TDirectory* motherDir = 0);
    virtual ~TKey();
 
    virtual void        Browse(TBrowser *b);
+           Int_t       Commit();
    virtual void        Delete(Option_t *option="");
    virtual void        DeleteBuffer();
    virtual void        FillBuffer(char *&buffer);
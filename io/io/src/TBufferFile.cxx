@@ -3297,7 +3297,8 @@ Int_t TBufferFile::ReadClassBuffer(const TClass *cl, void *pointer, Int_t versio
    /////////////////////////////////////////////////////////////////////////////
    /// The StreamerInfo should exist at this point.
 
-   else {
+   // In the steady state the StreamerInfo is already compiled and found without lock.
+   else if (version == 0 || !(sinfo = (TStreamerInfo *)cl->FindCompiledStreamerInfo(version))) {
       R__LOCKGUARD(gInterpreterMutex);
       auto infos = cl->GetStreamerInfos();
       auto ninfos = infos->GetSize();
@@ -3401,6 +3402,9 @@ Int_t TBufferFile::ReadClassBuffer(const TClass *cl, void *pointer, const TClass
       TStreamerInfo *guess = (TStreamerInfo*)cl->GetLastReadInfo();
       if (guess && guess->GetClassVersion() == version) {
          sinfo = guess;
+      } else if (version != 0 && (guess = (TStreamerInfo *)cl->FindCompiledStreamerInfo(version))) {
+         // Another version already compiled, found without lock.
+         sinfo = guess;
       } else {
          // The last one is not the one we are looking for.
          {
@@ -41,6 +41,7 @@ End_Macro
 #include "TError.h"
 #include "Bytes.h"
 #include "TClass.h"
+#include "TClassRef.h"
 #include "TRegexp.h"
 #include "TSystem.h"
 #include "TStreamerElement.h"
@@ -48,6 +49,11 @@ End_Macro
 #include "TVirtualMutex.h"
 #include "TEmulatedCollectionProxy.h"
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
 const UInt_t kIsBigFile = BIT(16);
 const Int_t  kMaxLen = 2048;
 
@@ -1780,6 +1786,134 @@ Int_t TDirectoryFile::Write(const char *, Int_t opt, Int_t bufsize)
    return nbytes;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Write all objects in memory to this directory, like Write(), but stream
+/// and compress them in parallel.
+///
+/// The objects are serialized and compressed into memory by up to `nthreads`
+/// threads (by default the size of the implicit multi-threading pool if it
+/// is enabled, else the number of cores), see the kDeferred constructor of
+/// TKey. The keys are then committed to the file in a single ordered pass,
+/// which reserves their space in the file and registers them in this
+/// directory; the directory itself is saved once at the end. The file holds
+/// the same keys, in the same order, as after Write().
+///
+/// Subdirectories are written the same way. Collections and TTrees, as well
+/// as all objects of non-binary files, are written by their own Write()
+/// method at their place in the sequence. The other objects are written as
+/// by TObject::Write(): objects of classes with a custom Write() method
+/// should not be written with this function.
+///
+/// Objects are only streamed in parallel in builds with implicit
+/// multi-threading support; ROOT::EnableThreadSafety() is then called.
+/// Nothing else must be written to the file while this function runs.
+///
+/// `opt` and `bufsize` have the same meaning as for TObject::Write().
+/// The function returns the total number of bytes written.
+
+Int_t TDirectoryFile::WriteParallel(UInt_t nthreads, Int_t opt, Int_t bufsize)
+{
+   if (!IsWritable()) return 0;
+   TDirectory::TContext ctxt(this);
+
+#ifdef R__USE_IMT
+   if (nthreads == 0)
+      nthreads = ROOT::IsImplicitMTEnabled() ? ROOT::GetImplicitMTPoolSize() : std::thread::hardware_concurrency();
+#else
+   nthreads = 1;
+#endif
+   if (nthreads > 1) ROOT::EnableThreadSafety();
+
+   // Plain objects get a deferred key, the others are written in place.
+   static TClassRef treeClass("TTree");
+   std::vector<TObject*> objects;
+   std::vector<Bool_t> deferred;
+   TIter next(fList);
+   while (TObject *obj = next()) {
+      objects.push_back(obj);
+      deferred.push_back(fFile->IsBinary() && !obj->InheritsFrom(TDirectory::Class())
+                         && !obj->InheritsFrom(TCollection::Class())
+                         && !(treeClass && obj->InheritsFrom(treeClass)));
+   }
+
+   // Bound the memory held by the streamed objects waiting to be committed.
+   const size_t batchSize = 256 * std::max(nthreads, 1U);
+   std::vector<TKey*> keys;
+   Int_t nbytes = 0;
+   for (size_t first = 0; first < objects.size(); first += batchSize) {
+      const size_t n = std::min(batchSize, objects.size() - first);
+      const Int_t bsize = bufsize > 0 ? bufsize : GetBufferSize();
+      const Long64_t filepos = fFile->GetEND();
+      keys.assign(n, nullptr);
+
+      auto prepare = [&](size_t i) {
+         if (!deferred[first + i]) return;
+         TObject *obj = objects[first + i];
+         TString name(obj->GetName());
+         name.Remove(TString::kTrailing, ' ');
+         keys[i] = new TKey(obj, name, bsize, this, filepos, TKey::kDeferred);
+      };
+      std::atomic<size_t> nextIdx(0);
+      auto worker = [&]() {
+         for (size_t i = nextIdx++; i < n; i = nextIdx++)
+            prepare(i);
+      };
+      std::vector<std::thread> threads;
+      for (UInt_t t = 1; t < std::min<size_t>(nthreads, n); ++t)
+         threads.emplace_back(worker);
+      worker();
+      for (auto &thread : threads)
+         thread.join();
+
+      for (size_t i = 0; i < n; ++i) {
+         TObject *obj = objects[first + i];
+         TKey *key = keys[i];
+         // A key prepared with a small header can not be placed beyond 2GB.
+         if (key && key->GetVersion() <= 1000 && fFile->GetEND() > TFile::kStartBigFile) {
+            delete key;
+            key = nullptr;
+         }
+         if (!key) {
+            if (obj->InheritsFrom(TDirectoryFile::Class()))
+               nbytes += ((TDirectoryFile*)obj)->WriteParallel(nthreads, opt, bufsize);
+            else
+               nbytes += obj->Write(0, opt, bufsize);
+            continue;
+         }
+
+         TKey *oldkey = 0;
+         if (opt & TObject::kOverwrite) {
+            oldkey = GetKey(key->GetName());
+            if (oldkey) {
+               oldkey->Delete();
+               delete oldkey;
+               oldkey = 0;
+            }
+         }
+         if (opt & TObject::kWriteDelete) {
+            oldkey = GetKey(key->GetName());
+         }
+         fFile->SumBuffer(key->GetObjlen());
+         Int_t nkey = key->Commit();
+         if (nkey == 0) {
+            fKeys->Remove(key);
+            delete key;
+            continue;
+         }
+         if (fFile->TestBit(TFile::kWriteError)) continue;
+         if (oldkey) {
+            oldkey->Delete();
+            delete oldkey;
+         }
+         nbytes += nkey;
+      }
+   }
+   if (bufsize) fFile->SetBufferSize(bufsize);
+   SaveSelf(kTRUE);   // force save itself
+
+   return nbytes;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// One can not save a const TDirectory object.
 
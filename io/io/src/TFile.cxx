@@ -84,6 +84,7 @@ The structure of a directory is shown in TDirectoryFile::TDirectoryFile
 #include <sys/stat.h>
 #ifndef WIN32
 #   include <unistd.h>
+#   include <sys/mman.h>
 #else
 #   define ssize_t int
 #   include <io.h>
@@ -102,6 +103,7 @@ The structure of a directory is shown in TDirectoryFile::TDirectoryFile
 #include "TDatime.h"
 #include "TError.h"
 #include "TFile.h"
+#include "TFileBlockCache.h"
 #include "TFileCacheRead.h"
 #include "TFileCacheWrite.h"
 #include "TFree.h"
@@ -147,6 +149,9 @@ TList   *TFile::fgAsyncOpenRequests = 0;
 TString  TFile::fgCacheFileDir;
 Bool_t   TFile::fgCacheFileForce = kFALSE;
 Bool_t   TFile::fgCacheFileDisconnected = kTRUE;
+TString  TFile::fgBlockCacheDir;
+Long64_t TFile::fgBlockCacheSize = 10000000000LL;
+Int_t    TFile::fgBlockCacheBlockSize = 262144;
 UInt_t   TFile::fgOpenTimeout = TFile::kEternalTimeout;
 Bool_t   TFile::fgOnlyStaged = 0;
 #ifdef R__USE_IMT
@@ -265,6 +270,17 @@ TFile::TFile() : TDirectoryFile(), fInfoCache(0)
 ///
 /// This is convenient because the many remote file access plugins allow
 /// easy access to/from the many different mass storage systems.
+/// Local files opened for reading can be memory mapped using:
+///
+///     file.root?mmap
+///
+/// In this mode reads are served from the mapping instead of system calls:
+/// compressed baskets are decompressed directly from the mapping, uncompressed
+/// baskets are used in place and no TTreeCache is created automatically, as it
+/// would only add a copy. The mapping is read-only; the baskets that point
+/// into it keep it alive, so that they remain valid after the file is closed,
+/// e.g. in a tree detached from the file. If the file cannot be mapped, a warning
+/// is printed and it is read normally.
 /// The title of the file (ftitle) will be shown by the ROOT browsers.
 /// A ROOT file (like a Unix file system) may contain objects and
 /// directories. There are no restrictions for the number of levels
@@ -353,6 +369,9 @@ TFile::TFile(const char *fname1, Option_t *option, const char *ftitle, Int_t com
    if (strstr(fUrl.GetOptions(), "filetype=pcm"))
       fIsPcmFile = kTRUE;
 
+   // if option contains mmap then serve reads from a memory mapping of the file
+   Bool_t mmapRequested = strstr(fUrl.GetOptions(), "mmap") != nullptr;
+
    // Init initialization control flag
    fInitDone   = kFALSE;
    fMustFlush  = kTRUE;
@@ -517,6 +536,8 @@ TFile::TFile(const char *fname1, Option_t *option, const char *ftitle, Int_t com
          goto zombie;
       }
       fWritable = kFALSE;
+      if (mmapRequested)
+         MapFile();
    }
 
    Init(create);
@@ -559,7 +580,10 @@ TFile::~TFile()
    if (fList)
       fList->Delete("slow");
 
+   UnmapFile();
+
    SafeDelete(fAsyncHandle);
+   SafeDelete(fBlockCache);
    SafeDelete(fCacheRead);
    SafeDelete(fCacheReadMap);
    SafeDelete(fCacheWrite);
@@ -924,6 +948,7 @@ void TFile::Close(Option_t *option)
 
    if (fIsArchive || !fIsRootFile) {
       FlushWriteCache();
+      UnmapFile();
       SysClose(fD);
       fD = -1;
 
@@ -947,6 +972,7 @@ void TFile::Close(Option_t *option)
          cache->Close();
       }
    }
+   SafeDelete(fBlockCache);
 
    // Delete all supported directories structures from memory
    // If gDirectory points to this object or any of the nested
@@ -979,6 +1005,7 @@ void TFile::Close(Option_t *option)
    }
 
    if (IsOpen()) {
+      UnmapFile();
       SysClose(fD);
       fD = -1;
    }
@@ -1634,6 +1661,9 @@ Bool_t TFile::ReadBuffer(char *buf, Long64_t pos, Int_t len)
       }
 
       Seek(pos);
+      if (fMappedBuffer)
+         return ReadBufferFromMap(buf, len);
+
       ssize_t siz;
 
       while ((siz = SysRead(fD, buf, len)) < 0 && GetErrno() == EINTR)
@@ -1682,6 +1712,8 @@ Bool_t TFile::ReadBuffer(char *buf, Int_t len)
       Double_t start = 0;
 
       if (gPerfStats != 0) start = TTimeStamp();
+      if (fMappedBuffer)
+         return ReadBufferFromMap(buf, len);
 
       while ((siz = SysRead(fD, buf, len)) < 0 && GetErrno() == EINTR)
          ResetErrno();
@@ -1730,6 +1762,19 @@ Bool_t TFile::ReadBuffers(char *buf, Long64_t *pos, Int_t *len, Int_t nbuf)
       return kFALSE;
    }
 
+   // With a memory mapped file there is nothing to gain from read-ahead
+   if (fMappedBuffer) {
+      Int_t k = 0;
+      for (Int_t j = 0; j < nbuf; j++) {
+         const char *src = ReadMappedBuffer(pos[j], len[j]);
+         if (!src)
+            return kTRUE;
+         memcpy(&buf[k], src, len[j]);
+         k += len[j];
+      }
+      return kFALSE;
+   }
+
    Int_t k = 0;
    Bool_t result = kTRUE;
    TFileCacheRead *old = fCacheRead;
@@ -1780,6 +1825,131 @@ Bool_t TFile::ReadBuffers(char *buf, Long64_t *pos, Int_t *len, Int_t nbuf)
    return result;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Read the nbuf blocks described in arrays pos and len, like ReadBuffers(),
+/// going through the local block cache if one is configured with
+/// SetBlockCacheDir() (or the rootrc variable `TFile.BlockCacheDir`).
+///
+/// The block cache is used for remote files opened for reading only; it is
+/// created on the first call. This is the entry point used by the read
+/// caches (TFileCacheRead, TTreeCache) to fetch their buffers.
+/// Returns kTRUE in case of failure.
+
+Bool_t TFile::ReadBuffersViaBlockCache(char *buf, Long64_t *pos, Int_t *len, Int_t nbuf)
+{
+   static const Bool_t envChecked = [] {
+      const char *dir = gEnv->GetValue("TFile.BlockCacheDir", "");
+      if (dir && *dir && fgBlockCacheDir.IsNull())
+         SetBlockCacheDir(dir, 1000000LL * gEnv->GetValue("TFile.BlockCacheSize", 10000));
+      return kTRUE;
+   }();
+   (void)envChecked;
+
+   if (buf && !fBlockCache && !fgBlockCacheDir.IsNull() && fIsRootFile && !IsWritable() && !fMappedBuffer &&
+       strcmp(GetEndpointUrl()->GetProtocol(), "file")) {
+      fBlockCache = new TFileBlockCache(this, fgBlockCacheDir, fgBlockCacheSize, fgBlockCacheBlockSize);
+   }
+   if (buf && fBlockCache)
+      return fBlockCache->ReadBuffers(buf, pos, len, nbuf);
+   return ReadBuffers(buf, pos, len, nbuf);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Read a buffer from the memory mapping at the current offset.
+/// Returns kTRUE in case of failure.
+
+Bool_t TFile::ReadBufferFromMap(char *buf, Int_t len)
+{
+   const char *src = ReadMappedBuffer(GetRelOffset(), len);
+   if (!src) {
+      Error("ReadBuffer", "error reading %d bytes at offset %lld from file %s, beyond the end of the mapping",
+            len, GetRelOffset(), GetName());
+      return kTRUE;
+   }
+   memcpy(buf, src, len);
+   return kFALSE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return a pointer to the len bytes at offset pos of a memory mapped file.
+///
+/// The bytes are accounted as read from the file and the file offset is
+/// moved past them, like for ReadBuffer(char*, Long64_t, Int_t), but no copy
+/// is made. Returns nullptr if the file is not memory mapped (see the `mmap`
+/// option of the TFile constructor) or if the range is outside the file.
+/// The returned memory is mapped read-only. It is only valid until the file
+/// is closed, unless a reference to the mapping, see GetMappedRegion(), is
+/// kept: the memory is unmapped when the file and all these references are gone.
+
+const char *TFile::ReadMappedBuffer(Long64_t pos, Int_t len)
+{
+   Long64_t offset = pos + fArchiveOffset;
+   if (!fMappedBuffer || pos < 0 || len < 0 || offset + len > fMappedSize)
+      return nullptr;
+
+   Double_t start = 0;
+   if (gPerfStats != 0) start = TTimeStamp();
+
+   fOffset = offset + len;
+   fBytesRead  += len;
+   fgBytesRead += len;
+   fReadCalls++;
+   fgReadCalls++;
+
+   if (gMonitoringWriter)
+      gMonitoringWriter->SendFileReadProgress(this);
+   if (gPerfStats != 0) {
+      gPerfStats->FileReadEvent(this, len, start);
+   }
+   return fMappedBuffer + offset;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Memory map the whole file for reading.
+///
+/// On failure a warning is issued and the file is read through regular
+/// system calls.
+
+void TFile::MapFile()
+{
+#ifndef WIN32
+   Long_t id, flags, modtime;
+   Long64_t size = 0;
+   if (SysStat(fD, &id, &size, &flags, &modtime) || size <= 0) {
+      Warning("MapFile", "cannot determine the size of file %s, not using a memory mapping", GetName());
+      return;
+   }
+   void *addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fD, 0);
+   if (addr == MAP_FAILED) {
+      Warning("MapFile", "cannot memory map file %s (%s), using regular reads", GetName(),
+              gSystem->GetError());
+      return;
+   }
+   fMappedBuffer = static_cast<const char *>(addr);
+   fMappedSize = size;
+   // Baskets using the mapping as buffer keep a reference to it: they remain
+   // readable after the file is closed, e.g. in a tree detached from the file.
+   fMapping = std::shared_ptr<const char>(fMappedBuffer, [size](const char *p) {
+      munmap(const_cast<char *>(p), size);
+   });
+#else
+   Warning("MapFile", "memory mapped files are not supported on this platform");
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Release the file's reference to its memory mapping, if any.
+
+void TFile::UnmapFile()
+{
+   if (!fMappedBuffer)
+      return;
+   // The memory is unmapped once the baskets referencing it are gone too.
+   fMapping.reset();
+   fMappedBuffer = nullptr;
+   fMappedSize = 0;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Read buffer via cache.
 ///
@@ -2055,6 +2225,8 @@ Int_t TFile::Recover()
 /// did not change (was already as requested or wrong input arguments)
 /// and -1 in case of failure, in which case the file cannot be used
 /// anymore. The current directory (gFile) is changed to this file.
+/// Memory mapped files (see the `mmap` option of the constructor) cannot
+/// be switched to UPDATE mode.
 
 Int_t TFile::ReOpen(Option_t *mode)
 {
@@ -2117,6 +2289,12 @@ Int_t TFile::ReOpen(Option_t *mode)
    } else {
       // switch to UPDATE mode
 
+      // objects read from the file might still point into the mapping
+      if (fMappedBuffer) {
+         Error("ReOpen", "file %s is memory mapped and cannot be reopened in update mode", GetName());
+         return -1;
+      }
+
       // close readonly file
       if (IsOpen()) {
          SysClose(fD);
@@ -2189,6 +2367,16 @@ void TFile::Seek(Long64_t offset, ERelativeTo pos)
          break;
    }
    Long64_t retpos;
+   if (fMappedBuffer) {
+      // Reads are served from the mapping, only the cursor has to move.
+      retpos = offset;
+      if (whence == SEEK_CUR)
+         retpos += fOffset;
+      else if (whence == SEEK_END)
+         retpos += fMappedSize;
+      fOffset = retpos;
+      return;
+   }
    if ((retpos = SysSeek(fD, offset, whence)) < 0)
       SysError("Seek", "cannot seek to position %lld in file %s, retpos=%lld",
                offset, GetName(), retpos);
@@ -2360,6 +2548,32 @@ Int_t TFile::Write(const char *, Int_t opt, Int_t bufsiz)
    return nbytes;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Write memory objects to this file, streaming and compressing them in
+/// parallel; see TDirectoryFile::WriteParallel.
+/// As Write(), this also writes the StreamerInfo record, the list of free
+/// segments and the file header.
+
+Int_t TFile::WriteParallel(UInt_t nthreads, Int_t opt, Int_t bufsiz)
+{
+   if (!IsWritable()) {
+      if (!TestBit(kWriteError)) {
+         // Do not print the warning if we already had a SysError.
+         Warning("WriteParallel", "file %s not opened in write mode", GetName());
+      }
+      return 0;
+   }
+
+   fMustFlush = kFALSE;
+   Int_t nbytes = TDirectoryFile::WriteParallel(nthreads, opt, bufsiz); // Write directory tree
+   WriteStreamerInfo();
+   WriteFree();                       // Write free segments linked list
+   WriteHeader();                     // Now write file header
+   fMustFlush = kTRUE;
+
+   return nbytes;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// One can not save a const TDirectory object.
 
@@ -3654,6 +3868,10 @@ void TFile::ShowStreamerInfo()
 
 UShort_t TFile::WriteProcessID(TProcessID *pidd)
 {
+#ifdef R__USE_IMT
+   // Objects may be streamed concurrently, see TDirectoryFile::WriteParallel.
+   std::lock_guard<std::mutex> sentry(fWriteMutex);
+#endif
    TProcessID *pid = pidd;
    if (!pid) pid = TProcessID::GetPID();
    TObjArray *pids = GetListOfProcessIDs();
@@ -4526,6 +4744,62 @@ const char *TFile::GetCacheFileDir()
    return fgCacheFileDir;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Sets the directory of the local block cache of remote files.
+///
+/// Once set, the content read from remote files opened for reading is
+/// stored in `cachedir` in blocks of `blocksize` bytes, keyed by the file UUID,
+/// and the blocks are taken from local disk the next time they are needed,
+/// by this or any other process using the same directory. The least recently
+/// used blocks are evicted when the directory exceeds `maxsize` bytes.
+/// See TFileBlockCache for the details. An empty `cachedir` disables the
+/// block cache for the files opened afterwards.
+/// If the directory is not writable by us return kFALSE.
+
+Bool_t TFile::SetBlockCacheDir(const char *cachedir, Long64_t maxsize, Int_t blocksize)
+{
+   if (!cachedir || !*cachedir) {
+      fgBlockCacheDir = "";
+      return kTRUE;
+   }
+   if (maxsize <= 0 || blocksize <= 0) {
+      ::Error("TFile::SetBlockCacheDir", "invalid cache size %lld or block size %d", maxsize, blocksize);
+      return kFALSE;
+   }
+
+   TString cached = cachedir;
+   if (!cached.EndsWith("/"))
+      cached += "/";
+
+   if (gSystem->AccessPathName(cached, kFileExists)) {
+      // try to create it
+      gSystem->mkdir(cached, kTRUE);
+      if (gSystem->AccessPathName(cached, kFileExists)) {
+         ::Error("TFile::SetBlockCacheDir", "no sufficient permissions on cache directory %s or cannot create it", cachedir);
+         fgBlockCacheDir = "";
+         return kFALSE;
+      }
+      gSystem->Chmod(cached, 0700);
+   }
+   if (gSystem->AccessPathName(cached, kWritePermission)) {
+      ::Error("TFile::SetBlockCacheDir", "cache directory %s is not writable", cachedir);
+      fgBlockCacheDir = "";
+      return kFALSE;
+   }
+   fgBlockCacheDir       = cached;
+   fgBlockCacheSize      = maxsize;
+   fgBlockCacheBlockSize = blocksize;
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Get the directory of the local block cache of remote files.
+
+const char *TFile::GetBlockCacheDir()
+{
+   return fgBlockCacheDir;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Try to shrink the cache to the desired size.
 ///
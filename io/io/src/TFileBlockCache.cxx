@@ -0,0 +1,339 @@
+// @(#)root/io:$Id$
+
+/*************************************************************************
+ * Copyright (C) 1995-2018, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+/**
+\class TFileBlockCache
+\ingroup IO
+
+A persistent, node-local cache of the content of remote files.
+
+The file is divided in blocks of fixed size (256 kB by default). Each block
+is stored as a separate file
+`<cachedir>/<file UUID>_<end of file>_<modification date>/<block number>`,
+so the cache content is addressed by the identity and the state of the ROOT
+file rather than by its URL: replicas of the same file on different servers
+share the blocks, while a file rewritten under the same name, or updated in
+place (which keeps its UUID), gets a new set of blocks instead of stale data.
+
+TFileBlockCache sits below TFile::ReadBuffers(): the vectored reads issued by
+TFileCacheRead and TTreeCache are translated into block requests, the blocks
+found in the cache directory are read from local disk and only the missing
+ones are fetched from the remote file, in a single vectored request.
+Repeated analyses over the same dataset thus only transfer the baskets of the
+branches that were not read before.
+
+The cache directory can be shared by several processes running on the same
+node:
+ - blocks are written to a temporary file and renamed into place, so a block
+   is either complete or absent;
+ - a block whose size does not match the expected one is discarded;
+ - every process can evict blocks; failures to remove a file that was
+   already evicted by another process are ignored.
+
+The eviction is LRU: the modification time of a block is updated every time
+it is read, and whenever 10% of the cache budget has been written by the
+current process the directory is scanned and the least recently used blocks
+are removed until the cache occupies at most 90% of its budget.
+
+The cache is normally not created directly but enabled for all the remote
+files opened for reading with TFile::SetBlockCacheDir() or with the
+`TFile.BlockCacheDir` rootrc variable.
+*/
+
+#include "TFileBlockCache.h"
+#include "TError.h"
+#include "TFile.h"
+#include "TSystem.h"
+#include "TUUID.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+std::atomic<Long64_t> TFileBlockCache::fgBytesSinceShrink{0};
+
+ClassImp(TFileBlockCache);
+
+////////////////////////////////////////////////////////////////////////////////
+/// Create a block cache for `file` in the directory `cachedir`, which is
+/// shared by all the cached files and must not exceed `maxsize` bytes.
+/// If the cache cannot be used (unknown file size, directory not writable),
+/// IsValid() returns false and ReadBuffers() forwards to the file.
+
+TFileBlockCache::TFileBlockCache(TFile *file, const char *cachedir, Long64_t maxsize, Int_t blocksize)
+   : fFile(file), fTopDir(cachedir), fBlockSize(blocksize), fMaxSize(maxsize), fFileSize(-1), fNHits(0),
+     fNMisses(0), fBytesFromCache(0)
+{
+   if (!fTopDir.EndsWith("/"))
+      fTopDir += "/";
+   // Files updated in place keep their UUID: their end and modification date
+   // tell the versions apart.
+   fDir = fTopDir;
+   fDir += TString::Format("%s_%lld_%u/", file->GetUUID().AsString(), file->GetEND(), file->GetModificationDate().Get());
+
+   if (fBlockSize <= 0) {
+      Error("TFileBlockCache", "invalid block size %d", fBlockSize);
+      return;
+   }
+   if (gSystem->AccessPathName(fDir, kWritePermission)) {
+      gSystem->mkdir(fDir, kTRUE);
+      if (gSystem->AccessPathName(fDir, kWritePermission)) {
+         Error("TFileBlockCache", "cannot create the cache directory %s", fDir.Data());
+         return;
+      }
+   }
+   fFileSize = file->GetSize();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return the size of block `idx`: only the last block of the file is
+/// shorter than the block size.
+
+Int_t TFileBlockCache::GetBlockLength(Long64_t idx) const
+{
+   return (Int_t)std::min<Long64_t>(fBlockSize, fFileSize - idx * fBlockSize);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return the path of the file holding block `idx`.
+
+TString TFileBlockCache::GetBlockPath(Long64_t idx) const
+{
+   TString path = fDir;
+   path += idx;
+   return path;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Read block `idx` from the cache directory into `dest`.
+/// Returns kFALSE if the block is not cached. Truncated or oversized blocks,
+/// e.g. left by a process killed while writing without atomic rename
+/// support, are removed.
+
+Bool_t TFileBlockCache::LoadBlock(Long64_t idx, char *dest)
+{
+   const TString path = GetBlockPath(idx);
+   FILE *fp = fopen(path, "rb");
+   if (!fp)
+      return kFALSE;
+
+   const Int_t len = GetBlockLength(idx);
+   const Bool_t ok = fread(dest, 1, len, fp) == (size_t)len && fgetc(fp) == EOF;
+   fclose(fp);
+   if (!ok) {
+      gSystem->Unlink(path);
+      return kFALSE;
+   }
+   // Mark the block as recently used for the LRU eviction.
+   gSystem->Utime(path, (Long_t)time(0), 0);
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Add block `idx` to the cache. The block is written to a file private to
+/// this process and renamed into place, so concurrent readers never see a
+/// partial block. Failures are silent: the block simply stays uncached.
+
+void TFileBlockCache::StoreBlock(Long64_t idx, const char *src)
+{
+   static std::atomic<Int_t> counter{0};
+
+   const TString path = GetBlockPath(idx);
+   const TString tmp = TString::Format("%s.%d.%d.tmp", path.Data(), gSystem->GetPid(), counter++);
+   FILE *fp = fopen(tmp, "wb");
+   if (!fp) {
+      // The directory might have been removed by the eviction of another process.
+      gSystem->mkdir(fDir, kTRUE);
+      fp = fopen(tmp, "wb");
+      if (!fp)
+         return;
+   }
+   const Int_t len = GetBlockLength(idx);
+   Bool_t ok = fwrite(src, 1, len, fp) == (size_t)len;
+   ok = (fclose(fp) == 0) && ok;
+   if (!ok || gSystem->Rename(tmp, path)) {
+      gSystem->Unlink(tmp);
+      return;
+   }
+
+   if ((fgBytesSinceShrink += len) > fMaxSize / 10) {
+      fgBytesSinceShrink = 0;
+      Shrink(fTopDir, fMaxSize);
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Print the cache statistics.
+
+void TFileBlockCache::Print(Option_t *) const
+{
+   printf("******TFileBlockCache statistics for file: %s ******\n", fFile ? fFile->GetName() : "");
+   printf("Cache directory ...............: %s\n", fDir.Data());
+   printf("Block size ....................: %d\n", fBlockSize);
+   printf("Number of blocks from cache ...: %lld\n", fNHits);
+   printf("Number of blocks fetched ......: %lld\n", fNMisses);
+   printf("Bytes served from cache .......: %lld\n", fBytesFromCache);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Read the nbuf blocks described in arrays pos and len, with the same
+/// semantics as TFile::ReadBuffers(). The blocks of the file covering the
+/// requested ranges are taken from the cache directory when present; the
+/// missing ones are fetched with a single vectored read of the file and added
+/// to the cache.
+/// Returns kTRUE in case of failure.
+
+Bool_t TFileBlockCache::ReadBuffers(char *buf, Long64_t *pos, Int_t *len, Int_t nbuf)
+{
+   if (!buf || !IsValid())
+      return fFile->ReadBuffers(buf, pos, len, nbuf);
+
+   std::vector<Long64_t> blocks;
+   for (Int_t i = 0; i < nbuf; ++i) {
+      if (len[i] <= 0)
+         continue;
+      if (pos[i] < 0 || pos[i] + len[i] > fFileSize)
+         return fFile->ReadBuffers(buf, pos, len, nbuf);
+      const Long64_t last = (pos[i] + len[i] - 1) / fBlockSize;
+      for (Long64_t idx = pos[i] / fBlockSize; idx <= last; ++idx)
+         blocks.push_back(idx);
+   }
+   std::sort(blocks.begin(), blocks.end());
+   blocks.erase(std::unique(blocks.begin(), blocks.end()), blocks.end());
+
+   // One slot of fBlockSize bytes per block.
+   std::vector<char> data(blocks.size() * fBlockSize);
+   std::vector<Bool_t> cached(blocks.size(), kFALSE);
+   std::vector<Long64_t> missPos;
+   std::vector<Int_t> missLen;
+   std::vector<size_t> missSlot;
+   Long64_t missBytes = 0;
+   for (size_t i = 0; i < blocks.size(); ++i) {
+      if (LoadBlock(blocks[i], &data[i * fBlockSize])) {
+         cached[i] = kTRUE;
+         ++fNHits;
+      } else {
+         missPos.push_back(blocks[i] * fBlockSize);
+         missLen.push_back(GetBlockLength(blocks[i]));
+         missSlot.push_back(i);
+         missBytes += missLen.back();
+         ++fNMisses;
+      }
+   }
+
+   if (!missPos.empty()) {
+      std::vector<char> fetched(missBytes);
+      if (fFile->ReadBuffers(fetched.data(), missPos.data(), missLen.data(), (Int_t)missPos.size()))
+         return kTRUE;
+      Long64_t k = 0;
+      for (size_t m = 0; m < missSlot.size(); ++m) {
+         char *slot = &data[missSlot[m] * fBlockSize];
+         memcpy(slot, &fetched[k], missLen[m]);
+         StoreBlock(blocks[missSlot[m]], slot);
+         k += missLen[m];
+      }
+   }
+
+   Long64_t k = 0;
+   for (Int_t i = 0; i < nbuf; ++i) {
+      Long64_t cur = pos[i];
+      Int_t remaining = len[i];
+      while (remaining > 0) {
+         const Long64_t idx = cur / fBlockSize;
+         const size_t slot = std::lower_bound(blocks.begin(), blocks.end(), idx) - blocks.begin();
+         const Int_t offset = (Int_t)(cur - idx * fBlockSize);
+         const Int_t n = std::min(remaining, fBlockSize - offset);
+         memcpy(&buf[k], &data[slot * fBlockSize + offset], n);
+         if (cached[slot])
+            fBytesFromCache += n;
+         k += n;
+         cur += n;
+         remaining -= n;
+      }
+   }
+   return kFALSE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Remove the least recently used blocks from the cache directory `cachedir`
+/// until it occupies at most 90% of `maxsize` bytes. Stale temporary files
+/// older than one hour are removed as well.
+/// Returns the number of bytes freed.
+
+Long64_t TFileBlockCache::Shrink(const char *cachedir, Long64_t maxsize)
+{
+   struct BlockFile {
+      TString fPath;
+      Long64_t fSize;
+      Long_t fMtime;
+   };
+
+   TString top = cachedir;
+   if (!top.EndsWith("/"))
+      top += "/";
+
+   void *topdir = gSystem->OpenDirectory(top);
+   if (!topdir)
+      return 0;
+
+   const Long_t now = (Long_t)time(0);
+   std::vector<BlockFile> files;
+   std::vector<TString> subdirs;
+   Long64_t total = 0;
+   while (const char *entry = gSystem->GetDirEntry(topdir)) {
+      if (entry[0] == '.')
+         continue;
+      TString subdir = top + entry + "/";
+      void *dirp = gSystem->OpenDirectory(subdir);
+      if (!dirp)
+         continue;
+      subdirs.push_back(subdir);
+      while (const char *name = gSystem->GetDirEntry(dirp)) {
+         if (name[0] == '.')
+            continue;
+         BlockFile file{subdir + name, 0, 0};
+         FileStat_t st;
+         if (gSystem->GetPathInfo(file.fPath, st) || R_ISDIR(st.fMode))
+            continue;
+         if (file.fPath.EndsWith(".tmp")) {
+            if (now - st.fMtime > 3600)
+               gSystem->Unlink(file.fPath);
+            continue;
+         }
+         file.fSize = st.fSize;
+         file.fMtime = st.fMtime;
+         total += file.fSize;
+         files.push_back(file);
+      }
+      gSystem->FreeDirectory(dirp);
+   }
+   gSystem->FreeDirectory(topdir);
+
+   if (total <= maxsize)
+      return 0;
+
+   std::sort(files.begin(), files.end(),
+             [](const BlockFile &a, const BlockFile &b) { return a.fMtime < b.fMtime; });
+   const Long64_t target = maxsize / 10 * 9;
+   Long64_t freed = 0;
+   for (const auto &file : files) {
+      if (total - freed <= target)
+         break;
+      // Another process may have evicted the block already.
+      if (!gSystem->Unlink(file.fPath))
+         freed += file.fSize;
+   }
+   // Remove the directories of files whose blocks are all gone; this fails
+   // harmlessly for the non-empty ones.
+   for (const auto &subdir : subdirs)
+      gSystem->Unlink(subdir);
+   return freed;
+}
@@ -459,7 +459,7 @@ Int_t TFileCacheRead::ReadBufferExtNormal(char *buf, Long64_t pos, Int_t len, In
       // If ReadBufferAsync is not supported by this implementation...
       if (!fAsyncReading) {
          // Then we use the vectored read to read everything now
-         if (fFile->ReadBuffers(fBuffer,fPos,fLen,fNb)) {
+         if (fFile->ReadBuffersViaBlockCache(fBuffer,fPos,fLen,fNb)) {
             return -1;
          }
          fIsTransferred = kTRUE;
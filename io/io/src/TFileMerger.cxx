@@ -21,6 +21,24 @@ a Grid environment where the files might be accessible via Castor,
 rfio, dcap, etc.
 The merging interface allows files containing histograms and trees
 to be merged, like the standalone hadd program.
+
+With SetNThreads(n), the merge uses up to n threads: the input files are
+opened (and copied locally, if requested) concurrently, by batches of at
+most GetMaxOpenedFiles(), and the objects that are merged in memory
+(histograms and any other class without a ResetAfterMerge function) are
+read from the input files and merged by the threads in parallel, each
+thread reducing a contiguous range of input files before the partial
+results are merged, in order, into the output object. The output file is
+still written by the calling thread only.
+
+TTrees are merged one input tree after the other. In their fast merging,
+the compressed baskets of each input tree are read by a separate task, one
+file cache worth of baskets ahead of the calling thread, which copies them
+to the output file in order (option "ParallelRead" of TTree::CopyEntries).
+The slow merging, needed for instance when the compression settings change,
+unzips and streams the entries in the calling thread; the baskets are
+recompressed in parallel if implicit multi-threading is enabled (see
+ROOT::EnableImplicitMT).
 */
 
 #include "TFileMerger.h"
@@ -41,6 +59,11 @@ to be merged, like the standalone hadd program.
 #include "TMemFile.h"
 #include "TVirtualMutex.h"
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
 #ifdef WIN32
 // For _getmaxstdio
 #include <stdio.h>
@@ -57,6 +80,27 @@ TClassRef R__TTree_Class("TTree");
 
 static const Int_t kCpProgress = BIT(14);
 static const Int_t kCintFileNumber = 100;
+
+////////////////////////////////////////////////////////////////////////////////
+/// Call func(i) for all i in [0, n), using up to nthreads threads (including
+/// the calling one).
+
+template <typename F>
+static void R__ParallelFor(UInt_t nthreads, Int_t n, F func)
+{
+   std::atomic<Int_t> next(0);
+   auto worker = [&]() {
+      for (Int_t i = next++; i < n; i = next++)
+         func(i);
+   };
+   std::vector<std::thread> threads;
+   for (Int_t t = 1; t < std::min<Int_t>(nthreads, n); ++t)
+      threads.emplace_back(worker);
+   worker();
+   for (auto &thread : threads)
+      thread.join();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Return the maximum number of allowed opened files minus some wiggle room
 /// for CINT or at least of the standard library (stdio).
@@ -133,7 +177,16 @@ Bool_t TFileMerger::AddFile(const char *url, Bool_t cpProgress)
    TFile *newfile = 0;
    TString localcopy;
 
-   if (fFileList.GetEntries() >= (fMaxOpenedFiles-1)) {
+   // When merging in parallel, all the files are opened concurrently by OpenExcessFiles.
+   if (fNThreads > 1) {
+      // Report the local files that do not exist now rather than when they are opened
+      TUrl u(url, kTRUE);
+      if (!strcmp(u.GetProtocol(), "file") && gSystem->AccessPathName(u.GetFile(), kReadPermission)) {
+         Error("AddFile", "cannot open file %s", url);
+         return kFALSE;
+      }
+   }
+   if (fNThreads > 1 || fFileList.GetEntries() >= (fMaxOpenedFiles-1)) {
 
       TObjString *urlObj = new TObjString(url);
       fMergeList.Add(urlObj);
@@ -408,6 +461,9 @@ Bool_t TFileMerger::MergeRecursive(TDirectory *target, TList *sourcelist, Int_t
    info.fOptions = fMergeOptions;
    if (fFastMethod && ((type&kKeepCompression) || !fCompressionChange) ) {
       info.fOptions.Append(" fast");
+      if (fNThreads > 1) {
+         info.fOptions.Append(" parallelread");
+      }
    }
 
    TFile      *current_file;
@@ -555,6 +611,8 @@ Bool_t TFileMerger::MergeRecursive(TDirectory *target, TList *sourcelist, Int_t
                   ROOT::MergeFunc_t func = cl->GetMerge();
                   func(obj, &inputs, &info);
                   info.fIsFirst = kFALSE;
+               } else if (fNThreads > 1 && !cl->GetResetAfterMerge()) {
+                  MergeObjectInParallel(obj, cl, key->GetName(), path, nextsource, sourcelist, info);
                } else {
                   do {
                      // make sure we are at the correct directory level by cd'ing to path
@@ -785,6 +843,87 @@ Bool_t TFileMerger::MergeRecursive(TDirectory *target, TList *sourcelist, Int_t
    return status;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Merge into obj the objects called 'name' in the directory 'path' of
+/// firstsource and of all the files following it in sourcelist.
+///
+/// The input files are split in contiguous ranges, one per thread.  Each
+/// thread reads the objects from its files and reduces them into the first
+/// one it read; the partial results are then merged into obj in the order of
+/// the files.
+
+void TFileMerger::MergeObjectInParallel(TObject *obj, TClass *cl, const char *name, const char *path,
+                                        TFile *firstsource, TList *sourcelist, TFileMergeInfo &info)
+{
+   std::vector<TFile*> sources;
+   for (TFile *source = firstsource; source; source = (TFile*)sourcelist->After(source))
+      sources.push_back(source);
+
+   const Int_t nsources = sources.size();
+   const Int_t nranges = std::min<Int_t>(fNThreads, nsources);
+   std::vector<TObject*> partials(nranges, nullptr);
+   const Bool_t oneGo = fHistoOneGo && cl->InheritsFrom(R__TH1_Class);
+   ROOT::MergeFunc_t func = cl->GetMerge();
+
+   R__ParallelFor(fNThreads, nranges, [&](Int_t range) {
+      TDirectory::TContext ctxt;
+      TFileMergeInfo rangeinfo(info.fOutputDirectory);
+      rangeinfo.fOptions = info.fOptions;
+      rangeinfo.fIOFeatures = info.fIOFeatures;
+      TList inputs;
+      TObject *&partial = partials[range];
+      const Int_t end = (Long64_t)nsources * (range + 1) / nranges;
+      for (Int_t i = (Long64_t)nsources * range / nranges; i < end; ++i) {
+         TDirectory *ndir = sources[i]->GetDirectory(path);
+         if (!ndir) continue;
+         ndir->cd();
+         TKey *key = (TKey*)ndir->GetListOfKeys()->FindObject(name);
+         if (!key) continue;
+         TObject *hobj = key->ReadObj();
+         if (!hobj) {
+            Info("MergeRecursive", "could not read object for key {%s, %s}; skipping file %s",
+                 key->GetName(), key->GetTitle(), sources[i]->GetName());
+            continue;
+         }
+         // Set ownership for collections
+         if (hobj->InheritsFrom(TCollection::Class())) {
+            ((TCollection*)hobj)->SetOwner();
+         }
+         hobj->ResetBit(kMustCleanup);
+         if (!partial) {
+            partial = hobj;
+            continue;
+         }
+         inputs.Add(hobj);
+         if (!oneGo) {
+            if (func(partial, &inputs, &rangeinfo) < 0) {
+               Error("MergeRecursive", "calling Merge() on '%s' with the corresponding object in '%s'",
+                     partial->GetName(), sources[i]->GetName());
+            }
+            rangeinfo.fIsFirst = kFALSE;
+            inputs.Delete();
+         }
+      }
+      if (oneGo && partial && inputs.GetEntries()) {
+         func(partial, &inputs, &rangeinfo);
+         inputs.Delete();
+      }
+   });
+
+   TList inputs;
+   for (TObject *partial : partials) {
+      if (partial) inputs.Add(partial);
+   }
+   if (inputs.GetEntries() || info.fIsFirst) {
+      if (func(obj, &inputs, &info) < 0) {
+         Error("MergeRecursive", "calling Merge() on '%s' with the corresponding objects in the input files",
+               obj->GetName());
+      }
+      info.fIsFirst = kFALSE;
+      inputs.Delete();
+   }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Merge the files. If no output file was specified it will write into
 /// the file "FileMerger.root" in the working directory. Returns true
@@ -814,6 +953,11 @@ Bool_t TFileMerger::PartialMerge(Int_t in_type)
       }
    }
 
+   // When merging in parallel, AddFile only records the input files.
+   if (fFileList.GetEntries() == 0 && fExcessFiles.GetEntries() > 0 && !OpenExcessFiles()) {
+      return kFALSE;
+   }
+
    // Special treament for the single file case ...
    if ((fFileList.GetEntries() == 1) && !fExcessFiles.GetEntries() &&
       !(in_type & kIncremental) && !fCompressionChange && !fExplicitCompLevel) {
@@ -911,6 +1055,52 @@ Bool_t TFileMerger::OpenExcessFiles()
    TString localcopy;
    // We want gDirectory untouched by anything going on here
    TDirectory::TContext ctxt;
+   if (fNThreads > 1) {
+      // Open (and copy) the files concurrently, then add them in order.
+      std::vector<TObjString*> urls;
+      while (nfiles < (fMaxOpenedFiles-1) && ( url = (TObjString*)next() )) {
+         urls.push_back(url);
+         ++nfiles;
+      }
+      std::vector<TFile*> newfiles(urls.size(), nullptr);
+      std::vector<TString> localcopies(urls.size());
+      R__ParallelFor(fNThreads, urls.size(), [&](Int_t i) {
+         TDirectory::TContext threadctxt;
+         const char *name = urls[i]->GetName();
+         if (fLocal) {
+            TUUID uuid;
+            localcopies[i].Form("file:%s/ROOTMERGE-%s.root", gSystem->TempDirectory(), uuid.AsString());
+            // The progress bars of concurrent copies would be mixed up.
+            if (!TFile::Cp(name, localcopies[i], kFALSE)) {
+               Error("OpenExcessFiles", "cannot get a local copy of file %s", name);
+               return;
+            }
+            name = localcopies[i].Data();
+         }
+         newfiles[i] = TFile::Open(name, "READ");
+         if (!newfiles[i]) {
+            if (fLocal)
+               Error("OpenExcessFiles", "cannot open local copy %s of URL %s",
+                     localcopies[i].Data(), urls[i]->GetName());
+            else
+               Error("OpenExcessFiles", "cannot open file %s", urls[i]->GetName());
+         }
+      });
+      Bool_t result = kTRUE;
+      for (size_t i = 0; i < urls.size(); ++i) {
+         if (!newfiles[i]) {
+            result = kFALSE;
+            continue;
+         }
+         if (fOutputFile && fOutputFile->GetCompressionLevel() != newfiles[i]->GetCompressionLevel()) fCompressionChange = kTRUE;
+
+         newfiles[i]->SetBit(kCanDelete);
+         fFileList.Add(newfiles[i]);
+         fExcessFiles.Remove(urls[i]);
+         delete urls[i];
+      }
+      return result;
+   }
    while( nfiles < (fMaxOpenedFiles-1) && ( url = (TObjString*)next() ) ) {
       TFile *newfile = 0;
       if (fLocal) {
@@ -974,6 +1164,25 @@ void TFileMerger::SetMaxOpenedFiles(Int_t newmax)
    }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Set the number of threads used to open the input files, to merge the
+/// objects merged in memory and to read ahead the baskets of the TTrees in
+/// their fast merging (see the class documentation).  0 or 1 request the
+/// sequential merging.
+///
+/// Using more than one thread enables ROOT's thread safety (see
+/// ROOT::EnableThreadSafety).  The input files added with AddFile(const char*)
+/// from then on are opened by Merge or PartialMerge rather than by AddFile,
+/// which still reports the local files that do not exist.
+
+void TFileMerger::SetNThreads(UInt_t nthreads)
+{
+   fNThreads = nthreads;
+   if (fNThreads > 1) {
+      ROOT::EnableThreadSafety();
+   }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Set the prefix to be used when printing informational message.
 
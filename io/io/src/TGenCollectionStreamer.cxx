@@ -31,20 +31,26 @@ size(), clear(), resize(). resize() may be a void operation.
 #include "Riostream.h"
 #include "TVirtualCollectionIterators.h"
 
+#include <typeinfo>
+#include <vector>
+
 TGenCollectionStreamer::TGenCollectionStreamer(const TGenCollectionStreamer& copy)
-      : TGenCollectionProxy(copy), fReadBufferFunc(&TGenCollectionStreamer::ReadBufferDefault)
+      : TGenCollectionProxy(copy), fReadBufferFunc(&TGenCollectionStreamer::ReadBufferDefault),
+        fNestedVectorKind(-1)
 {
    // Build a Streamer for an emulated vector whose type is 'name'.
 }
 
 TGenCollectionStreamer::TGenCollectionStreamer(Info_t info, size_t iter_size)
-      : TGenCollectionProxy(info, iter_size), fReadBufferFunc(&TGenCollectionStreamer::ReadBufferDefault)
+      : TGenCollectionProxy(info, iter_size), fReadBufferFunc(&TGenCollectionStreamer::ReadBufferDefault),
+        fNestedVectorKind(-1)
 {
    // Build a Streamer for a collection whose type is described by 'collectionClass'.
 }
 
 TGenCollectionStreamer::TGenCollectionStreamer(const ::ROOT::TCollectionProxyInfo &info, TClass *cl)
-      : TGenCollectionProxy(info, cl), fReadBufferFunc(&TGenCollectionStreamer::ReadBufferDefault)
+      : TGenCollectionProxy(info, cl), fReadBufferFunc(&TGenCollectionStreamer::ReadBufferDefault),
+        fNestedVectorKind(-1)
 {
    // Build a Streamer for a collection whose type is described by 'collectionClass'.
 }
@@ -972,6 +978,21 @@ void TGenCollectionStreamer::WriteObjects(int nElements, TBuffer &b)
          // Simple case: contiguous memory. get address of first, then jump.
       case ROOT::kSTLvector:
 #define DOLOOP(x) {int idx=0; while(idx<nElements) {StreamHelper* i=(StreamHelper*)(((char*)itm) + fValDiff*idx); { x ;} ++idx;} break;}
+         switch (fVal->fCase == kIsClass ? GetNestedVectorKind() : kNoType_t) {
+            case kChar_t:    WriteVectorOfVectorPrimitives<Char_t>(b);    return;
+            case kShort_t:   WriteVectorOfVectorPrimitives<Short_t>(b);   return;
+            case kInt_t:     WriteVectorOfVectorPrimitives<Int_t>(b);     return;
+            case kLong_t:    WriteVectorOfVectorPrimitives<Long_t>(b);    return;
+            case kLong64_t:  WriteVectorOfVectorPrimitives<Long64_t>(b);  return;
+            case kFloat_t:   WriteVectorOfVectorPrimitives<Float_t>(b);   return;
+            case kDouble_t:  WriteVectorOfVectorPrimitives<Double_t>(b);  return;
+            case kUChar_t:   WriteVectorOfVectorPrimitives<UChar_t>(b);   return;
+            case kUShort_t:  WriteVectorOfVectorPrimitives<UShort_t>(b);  return;
+            case kUInt_t:    WriteVectorOfVectorPrimitives<UInt_t>(b);    return;
+            case kULong_t:   WriteVectorOfVectorPrimitives<ULong_t>(b);   return;
+            case kULong64_t: WriteVectorOfVectorPrimitives<ULong64_t>(b); return;
+            default: break;
+         }
          itm = (StreamHelper*)fFirst.invoke(fEnv);
          switch (fVal->fCase) {
             case kIsClass:
@@ -1217,6 +1238,97 @@ void TGenCollectionStreamer::ReadBufferVectorPrimitivesDouble32(TBuffer &b, void
 
 
 
+template <typename basictype>
+static Bool_t IsVectorOfVector(const std::type_info &info)
+{
+   return info == typeid(std::vector<std::vector<basictype>>);
+}
+
+Int_t TGenCollectionStreamer::GetNestedVectorKind()
+{
+   // Return the type of the inner values if this collection is a compiled
+   // std::vector<std::vector<T> > with T a fundamental type, kNoType_t
+   // otherwise.  Such collections are streamed by the specialized
+   // ReadBufferVectorOfVectorPrimitives and WriteVectorOfVectorPrimitives
+   // rather than element by element through the inner collection proxy.
+   // The layout on file is the same in both cases.
+
+   if (fNestedVectorKind != -1) return fNestedVectorKind;
+
+   Int_t kind = kNoType_t;
+   if (fSTL_type == ROOT::kSTLvector && fVal && fVal->fCase == kIsClass && !(fProperties & kIsEmulated)) {
+      TVirtualCollectionProxy *inner = fVal->fType ? fVal->fType->GetCollectionProxy() : nullptr;
+      if (inner && inner->GetCollectionType() == ROOT::kSTLvector && !inner->GetValueClass()
+          && !inner->HasPointers() && !(inner->GetProperties() & kIsEmulated)) {
+         Bool_t match = kFALSE;
+         // Float16_t and Double32_t share the type_info of float and double
+         // but not their representation on file, hence the check of the
+         // type recorded by the inner proxy.
+         switch (int(inner->GetType())) {
+            case kChar_t:    match = IsVectorOfVector<Char_t>(fTypeinfo);    break;
+            case kShort_t:   match = IsVectorOfVector<Short_t>(fTypeinfo);   break;
+            case kInt_t:     match = IsVectorOfVector<Int_t>(fTypeinfo);     break;
+            case kLong_t:    match = IsVectorOfVector<Long_t>(fTypeinfo);    break;
+            case kLong64_t:  match = IsVectorOfVector<Long64_t>(fTypeinfo);  break;
+            case kFloat_t:   match = IsVectorOfVector<Float_t>(fTypeinfo);   break;
+            case kDouble_t:  match = IsVectorOfVector<Double_t>(fTypeinfo);  break;
+            case kUChar_t:   match = IsVectorOfVector<UChar_t>(fTypeinfo);   break;
+            case kUShort_t:  match = IsVectorOfVector<UShort_t>(fTypeinfo);  break;
+            case kUInt_t:    match = IsVectorOfVector<UInt_t>(fTypeinfo);    break;
+            case kULong_t:   match = IsVectorOfVector<ULong_t>(fTypeinfo);   break;
+            case kULong64_t: match = IsVectorOfVector<ULong64_t>(fTypeinfo); break;
+            default: break;
+         }
+         if (match) kind = inner->GetType();
+      }
+   }
+   fNestedVectorKind = kind;
+   return kind;
+}
+
+template <typename basictype>
+void TGenCollectionStreamer::ReadBufferVectorOfVectorPrimitives(TBuffer &b, void *obj, const TClass *onFileClass)
+{
+   // Read a std::vector<std::vector<basictype> >: each inner vector is
+   // resized once and its content is byte-swapped directly into its storage.
+
+   if (onFileClass && onFileClass != GetCollectionClass()) {
+      TVirtualCollectionProxy *onFileProxy = onFileClass->GetCollectionProxy();
+      if (!onFileProxy || onFileProxy->GetValueClass() != fVal->fType.GetClass()) {
+         ReadBufferGeneric(b, obj, onFileClass);
+         return;
+      }
+   }
+
+   int nElements = 0;
+   b >> nElements;
+   if (nElements < 0) return;
+
+   auto &outer = *(std::vector<std::vector<basictype>> *)obj;
+   outer.resize(nElements);
+   for (auto &inner : outer) {
+      int nValues = 0;
+      b >> nValues;
+      inner.resize(nValues);
+      b.ReadFastArray(inner.data(), nValues);
+   }
+}
+
+template <typename basictype>
+void TGenCollectionStreamer::WriteVectorOfVectorPrimitives(TBuffer &b)
+{
+   // Write the inner vectors of a std::vector<std::vector<basictype> >, the
+   // number of elements of the outer vector being already written.
+
+   const auto &outer = *(const std::vector<std::vector<basictype>> *)fEnv->fObject;
+   for (const auto &inner : outer) {
+      int nValues = inner.size();
+      b << nValues;
+      b.WriteFastArray(inner.data(), nValues);
+   }
+}
+
+
 void TGenCollectionStreamer::ReadBuffer(TBuffer &b, void *obj, const TClass *onFileClass)
 {
    // Call the specialized function.  The first time this call ReadBufferDefault which
@@ -1299,6 +1411,26 @@ void TGenCollectionStreamer::ReadBufferDefault(TBuffer &b, void *obj, const TCla
             break;
       }
    }
+   else if (fSTL_type == ROOT::kSTLvector && fVal->fCase == kIsClass)
+   {
+      switch (GetNestedVectorKind()) {
+         case kChar_t:    fReadBufferFunc = &TGenCollectionStreamer::ReadBufferVectorOfVectorPrimitives<Char_t>;    break;
+         case kShort_t:   fReadBufferFunc = &TGenCollectionStreamer::ReadBufferVectorOfVectorPrimitives<Short_t>;   break;
+         case kInt_t:     fReadBufferFunc = &TGenCollectionStreamer::ReadBufferVectorOfVectorPrimitives<Int_t>;     break;
+         case kLong_t:    fReadBufferFunc = &TGenCollectionStreamer::ReadBufferVectorOfVectorPrimitives<Long_t>;    break;
+         case kLong64_t:  fReadBufferFunc = &TGenCollectionStreamer::ReadBufferVectorOfVectorPrimitives<Long64_t>;  break;
+         case kFloat_t:   fReadBufferFunc = &TGenCollectionStreamer::ReadBufferVectorOfVectorPrimitives<Float_t>;   break;
+         case kDouble_t:  fReadBufferFunc = &TGenCollectionStreamer::ReadBufferVectorOfVectorPrimitives<Double_t>;  break;
+         case kUChar_t:   fReadBufferFunc = &TGenCollectionStreamer::ReadBufferVectorOfVectorPrimitives<UChar_t>;   break;
+         case kUShort_t:  fReadBufferFunc = &TGenCollectionStreamer::ReadBufferVectorOfVectorPrimitives<UShort_t>;  break;
+         case kUInt_t:    fReadBufferFunc = &TGenCollectionStreamer::ReadBufferVectorOfVectorPrimitives<UInt_t>;    break;
+         case kULong_t:   fReadBufferFunc = &TGenCollectionStreamer::ReadBufferVectorOfVectorPrimitives<ULong_t>;   break;
+         case kULong64_t: fReadBufferFunc = &TGenCollectionStreamer::ReadBufferVectorOfVectorPrimitives<ULong64_t>; break;
+         default:
+            // Use the generic one.
+            break;
+      }
+   }
    (this->*fReadBufferFunc)(b,obj,onFileClass);
 }
 
@@ -291,6 +291,47 @@ TKey::TKey(const TObject *obj, const char *name, Int_t bufsize, TDirectory* moth
    }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Create a TKey object for a TObject* and fill output buffer, but neither
+/// register the key in motherDir nor reserve its space in the file: this is
+/// done by Commit(), which must be called before the key can be used.
+///
+/// The construction only reads the state of the file, so that several keys
+/// can be built concurrently, e.g. by TDirectoryFile::WriteParallel, as long
+/// as nothing else is written to the file in the meantime. filepos is the
+/// end of the file at the time the construction started, it selects the
+/// format of the key header.
+///
+///  WARNING: in name avoid special characters like '^','$','.' that are used
+///  by the regular expression parser (see TRegexp).
+
+TKey::TKey(const TObject *obj, const char *name, Int_t bufsize, TDirectory* motherDir, Long64_t filepos, EDeferred)
+     : TNamed(name, obj->GetTitle())
+{
+   R__ASSERT(obj);
+
+   if (!obj->IsA()->HasDefaultConstructor()) {
+      Warning("TKey", "since %s has no public constructor\n"
+              "\twhich can be called without argument, objects of this class\n"
+              "\tcan not be read with the current library. You will need to\n"
+              "\tadd a default constructor before attempting to read it.",
+              obj->ClassName());
+   }
+
+   Build(motherDir, obj->ClassName(), filepos);
+
+   fBufferRef = new TBufferFile(TBuffer::kWrite, bufsize);
+   fBufferRef->SetParent(GetFile());
+
+   Streamer(*fBufferRef);         //reserve the key header, written by Commit
+   fKeylen    = fBufferRef->Length();
+   fBufferRef->MapObject(obj);    //register obj in map in case of self reference
+   ((TObject*)obj)->Streamer(*fBufferRef);    //write object
+   fObjlen    = fBufferRef->Length() - fKeylen;
+
+   fNbytes    = fKeylen + CompressBufferRef();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Create a TKey object for any object obj of class cl d and fill
 /// output buffer.
@@ -382,6 +423,47 @@ TKey::TKey(const void *obj, const TClass *cl, const char *name, Int_t bufsize, T
    }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Compress the object data held by fBufferRef, following the compression
+/// settings of the file, into fBuffer after room for the key header.
+/// If the data are not worth compressing, fBuffer is the buffer of
+/// fBufferRef. Returns the number of bytes of object data in fBuffer.
+
+Int_t TKey::CompressBufferRef()
+{
+   Int_t cxlevel = GetFile() ? GetFile()->GetCompressionLevel() : 0;
+   ROOT::ECompressionAlgorithm cxAlgorithm = static_cast<ROOT::ECompressionAlgorithm>(GetFile() ? GetFile()->GetCompressionAlgorithm() : 0);
+   if (cxlevel > 0 && fObjlen > 256) {
+      Int_t nbuffers = 1 + (fObjlen - 1)/kMAXZIPBUF;
+      Int_t buflen = TMath::Max(512,fKeylen + fObjlen + 9*nbuffers + 28); //add 28 bytes in case object is placed in a deleted gap
+      char *zipbuf = new char[buflen];
+      char *objbuf = fBufferRef->Buffer() + fKeylen;
+      char *bufcur = &zipbuf[fKeylen];
+      Int_t nout, bufmax;
+      Int_t noutot = 0;
+      Int_t nzip   = 0;
+      for (Int_t i = 0; i < nbuffers; ++i) {
+         if (i == nbuffers - 1) bufmax = fObjlen - nzip;
+         else               bufmax = kMAXZIPBUF;
+         R__zipMultipleAlgorithm(cxlevel, &bufmax, objbuf, &bufmax, bufcur, &nout, cxAlgorithm);
+         if (nout == 0 || nout >= fObjlen) { //this happens when the buffer cannot be compressed
+            delete [] zipbuf;
+            fBuffer = fBufferRef->Buffer();
+            return fObjlen;
+         }
+         bufcur += nout;
+         noutot += nout;
+         objbuf += kMAXZIPBUF;
+         nzip   += kMAXZIPBUF;
+      }
+      fBuffer = zipbuf;
+      delete fBufferRef; fBufferRef = 0;
+      return noutot;
+   }
+   fBuffer = fBufferRef->Buffer();
+   return fObjlen;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Method used in all TKey constructor to initialize basic data fields.
 ///
@@ -449,6 +531,27 @@ void TKey::Browse(TBrowser *b)
    }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Register a key built with the kDeferred constructor in its directory,
+/// reserve its space in the file and write it.
+///
+/// Returns the number of bytes written, 0 if no space could be reserved
+/// (the key is then still in the list of keys of its directory), -1 in
+/// case of write error.
+
+Int_t TKey::Commit()
+{
+   if (!fMotherDir || !GetFile()) {
+      Error("Commit","Cannot commit key without file");
+      return 0;
+   }
+
+   fCycle = fMotherDir->AppendKey(this);
+   Create(fNbytes - fKeylen);
+   if (!fSeekKey) return 0;
+   return WriteFile(fCycle);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Create a TKey object of specified size.
 ///
@@ -0,0 +1,90 @@
+#include "TFile.h"
+#include "TH1F.h"
+#include "TKey.h"
+#include "TNamed.h"
+#include "TSystem.h"
+
+#include <memory>
+
+#include "gtest/gtest.h"
+
+static void Fill(TDirectory *dir, Int_t nhistos)
+{
+   for (Int_t i = 0; i < nhistos; ++i) {
+      auto h = new TH1F(TString::Format("h%d", i), "histo", 100, 0, 100);
+      for (Int_t j = 0; j < i % 50; ++j)
+         h->Fill(j * 1.5, i);
+      h->SetDirectory(dir);
+   }
+   dir->Append(new TNamed("note ", "trailing blank"));
+}
+
+TEST(TDirectoryFile, WriteParallel)
+{
+   const char *fname = "tdirectoryfile_writeparallel.root";
+   const char *refname = "tdirectoryfile_writeparallel_ref.root";
+   for (auto name : {fname, refname}) {
+      TFile f(name, "RECREATE");
+      Fill(&f, 1000);
+      Fill(f.mkdir("sub"), 100);
+      if (name == fname)
+         EXPECT_GT(f.WriteParallel(4), 0);
+      else
+         EXPECT_GT(f.Write(), 0);
+   }
+
+   std::unique_ptr<TFile> f(TFile::Open(fname));
+   std::unique_ptr<TFile> ref(TFile::Open(refname));
+   ASSERT_TRUE(f && !f->IsZombie() && ref && !ref->IsZombie());
+   for (auto dirname : {"", "sub"}) {
+      TDirectory *dir = f->GetDirectory(dirname);
+      TDirectory *refdir = ref->GetDirectory(dirname);
+      ASSERT_NE(nullptr, dir);
+      ASSERT_NE(nullptr, refdir);
+      ASSERT_EQ(refdir->GetListOfKeys()->GetSize(), dir->GetListOfKeys()->GetSize());
+      TIter next(dir->GetListOfKeys());
+      TIter nextref(refdir->GetListOfKeys());
+      while (TKey *refkey = (TKey *)nextref()) {
+         TKey *key = (TKey *)next();
+         EXPECT_STREQ(refkey->GetName(), key->GetName());
+         EXPECT_STREQ(refkey->GetClassName(), key->GetClassName());
+         EXPECT_EQ(refkey->GetCycle(), key->GetCycle());
+         EXPECT_EQ(refkey->GetObjlen(), key->GetObjlen());
+      }
+   }
+   for (Int_t i = 0; i < 1000; i += 37) {
+      TString hname = TString::Format("h%d", i);
+      TH1F *h = nullptr;
+      TH1F *hr = nullptr;
+      f->GetObject(hname, h);
+      ref->GetObject(hname, hr);
+      ASSERT_TRUE(h && hr);
+      EXPECT_EQ(hr->GetEntries(), h->GetEntries());
+      for (Int_t b = 0; b <= 101; ++b)
+         EXPECT_EQ(hr->GetBinContent(b), h->GetBinContent(b));
+   }
+   EXPECT_NE(nullptr, f->GetKey("note"));
+   EXPECT_NE(nullptr, f->Get("sub/h99"));
+
+   f.reset();
+   ref.reset();
+   gSystem->Unlink(fname);
+   gSystem->Unlink(refname);
+}
+
+TEST(TDirectoryFile, WriteParallelOverwrite)
+{
+   const char *fname = "tdirectoryfile_writeparallel_overwrite.root";
+   TFile f(fname, "RECREATE");
+   Fill(&f, 10);
+   f.WriteParallel(2);
+   f.WriteParallel(2);
+   EXPECT_EQ(2, f.GetKey("h3")->GetCycle());
+   // Overwriting replaces the highest cycle only.
+   f.WriteParallel(2, TObject::kOverwrite);
+   EXPECT_EQ(2, f.GetKey("h3")->GetCycle());
+   EXPECT_NE(nullptr, f.GetKey("h3", 1));
+   EXPECT_EQ(22, f.GetListOfKeys()->GetSize());
+   f.Close();
+   gSystem->Unlink(fname);
+}
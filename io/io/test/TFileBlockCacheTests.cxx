@@ -0,0 +1,175 @@
+#include "TFile.h"
+#include "TFileBlockCache.h"
+#include "TNamed.h"
+#include "TSystem.h"
+#include "TTree.h"
+
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+static void WriteFile(const char *fname)
+{
+   TFile f(fname, "RECREATE", "", 0);
+   TTree t("t", "t");
+   double x = 0;
+   t.Branch("x", &x);
+   for (int i = 0; i < 20000; ++i) {
+      x = 0.5 * i;
+      t.Fill();
+   }
+   t.Write();
+}
+
+static Long64_t DirSize(const char *dirname)
+{
+   Long64_t total = 0;
+   void *topdir = gSystem->OpenDirectory(dirname);
+   while (const char *entry = gSystem->GetDirEntry(topdir)) {
+      if (entry[0] == '.')
+         continue;
+      TString subdir = TString(dirname) + "/" + entry;
+      void *dirp = gSystem->OpenDirectory(subdir);
+      while (const char *name = gSystem->GetDirEntry(dirp)) {
+         FileStat_t st;
+         if (name[0] != '.' && !gSystem->GetPathInfo(subdir + "/" + name, st))
+            total += st.fSize;
+      }
+      gSystem->FreeDirectory(dirp);
+   }
+   gSystem->FreeDirectory(topdir);
+   return total;
+}
+
+TEST(TFileBlockCache, ReadBuffers)
+{
+   const char *fname = "tfile_blockcache.root";
+   const char *cachedir = "tfile_blockcache_dir";
+   WriteFile(fname);
+   gSystem->Exec(TString::Format("rm -rf %s", cachedir));
+
+   std::unique_ptr<TFile> f(TFile::Open(fname));
+   ASSERT_TRUE(f && !f->IsZombie());
+   const Long64_t size = f->GetSize();
+
+   // Ranges spanning several blocks, sharing blocks, and reaching the end of the file.
+   std::vector<Long64_t> pos{0, 100, 5000, 9000, size - 300};
+   std::vector<Int_t> len{50, 4000, 3000, 10000, 300};
+   Int_t total = 0;
+   for (auto l : len)
+      total += l;
+   std::vector<char> expected(total), buf(total);
+   ASSERT_FALSE(f->ReadBuffers(expected.data(), pos.data(), len.data(), pos.size()));
+
+   TFileBlockCache cache(f.get(), cachedir, 100000000, 4096);
+   ASSERT_TRUE(cache.IsValid());
+   ASSERT_FALSE(cache.ReadBuffers(buf.data(), pos.data(), len.data(), pos.size()));
+   EXPECT_EQ(expected, buf);
+   EXPECT_EQ(0, cache.GetNHits());
+   const Long64_t nblocks = cache.GetNMisses();
+   EXPECT_GT(nblocks, 5);
+
+   // A second cache on the same directory, as another process would do.
+   TFileBlockCache cache2(f.get(), cachedir, 100000000, 4096);
+   std::fill(buf.begin(), buf.end(), 0);
+   ASSERT_FALSE(cache2.ReadBuffers(buf.data(), pos.data(), len.data(), pos.size()));
+   EXPECT_EQ(expected, buf);
+   EXPECT_EQ(nblocks, cache2.GetNHits());
+   EXPECT_EQ(0, cache2.GetNMisses());
+   EXPECT_EQ(total, cache2.GetBytesFromCache());
+
+   // A damaged block is fetched again.
+   FILE *fp = fopen(TString(cache2.GetDirectory()) + "0", "wb");
+   ASSERT_NE(nullptr, fp);
+   fputs("bad", fp);
+   fclose(fp);
+   std::fill(buf.begin(), buf.end(), 0);
+   ASSERT_FALSE(cache2.ReadBuffers(buf.data(), pos.data(), len.data(), pos.size()));
+   EXPECT_EQ(expected, buf);
+   EXPECT_EQ(1, cache2.GetNMisses());
+
+   // Eviction keeps the directory within 90% of the budget.
+   const Long64_t used = DirSize(cachedir);
+   EXPECT_EQ(0, TFileBlockCache::Shrink(cachedir, used));
+   EXPECT_GT(TFileBlockCache::Shrink(cachedir, used / 2), 0);
+   EXPECT_LE(DirSize(cachedir), used / 2 / 10 * 9);
+
+   f.reset();
+   gSystem->Exec(TString::Format("rm -rf %s", cachedir));
+   gSystem->Unlink(fname);
+}
+
+TEST(TFileBlockCache, UpdatedFile)
+{
+   const char *fname = "tfile_blockcache_update.root";
+   const char *cachedir = "tfile_blockcache_update_dir";
+   WriteFile(fname);
+   gSystem->Exec(TString::Format("rm -rf %s", cachedir));
+
+   std::vector<Long64_t> pos{0, 1000};
+   std::vector<Int_t> len{500, 8000};
+   std::vector<char> buf(8500), expected(8500);
+   TString dir;
+   {
+      std::unique_ptr<TFile> f(TFile::Open(fname));
+      ASSERT_TRUE(f && !f->IsZombie());
+      TFileBlockCache cache(f.get(), cachedir, 100000000, 4096);
+      ASSERT_TRUE(cache.IsValid());
+      ASSERT_FALSE(cache.ReadBuffers(buf.data(), pos.data(), len.data(), pos.size()));
+      EXPECT_GT(cache.GetNMisses(), 0);
+      dir = cache.GetDirectory();
+   }
+
+   // Updating the file keeps its UUID but changes its content.
+   {
+      std::unique_ptr<TFile> f(TFile::Open(fname, "UPDATE"));
+      ASSERT_TRUE(f && !f->IsZombie());
+      TNamed n("n", "a new object written at the end of the updated file");
+      n.Write();
+   }
+
+   std::unique_ptr<TFile> f(TFile::Open(fname));
+   ASSERT_TRUE(f && !f->IsZombie());
+   ASSERT_FALSE(f->ReadBuffers(expected.data(), pos.data(), len.data(), pos.size()));
+   TFileBlockCache cache(f.get(), cachedir, 100000000, 4096);
+   ASSERT_TRUE(cache.IsValid());
+   EXPECT_NE(dir, cache.GetDirectory());
+   ASSERT_FALSE(cache.ReadBuffers(buf.data(), pos.data(), len.data(), pos.size()));
+   EXPECT_EQ(expected, buf);
+   EXPECT_EQ(0, cache.GetNHits());
+   TNamed *n = nullptr;
+   f->GetObject("n", n);
+   EXPECT_NE(nullptr, n);
+   delete n;
+
+   f.reset();
+   gSystem->Exec(TString::Format("rm -rf %s", cachedir));
+   gSystem->Unlink(fname);
+}
+
+TEST(TFileBlockCache, LocalFilesBypass)
+{
+   const char *fname = "tfile_blockcache_local.root";
+   const char *cachedir = "tfile_blockcache_local_dir";
+   WriteFile(fname);
+   ASSERT_TRUE(TFile::SetBlockCacheDir(cachedir));
+
+   std::unique_ptr<TFile> f(TFile::Open(fname));
+   ASSERT_TRUE(f && !f->IsZombie());
+   TTree *t = nullptr;
+   f->GetObject("t", t);
+   ASSERT_NE(nullptr, t);
+   double x = -1;
+   t->SetBranchAddress("x", &x);
+   for (Long64_t e = 0; e < t->GetEntries(); ++e) {
+      t->GetEntry(e);
+      EXPECT_DOUBLE_EQ(0.5 * e, x);
+   }
+   EXPECT_EQ(nullptr, f->GetBlockCache());
+
+   TFile::SetBlockCacheDir("");
+   f.reset();
+   gSystem->Exec(TString::Format("rm -rf %s", cachedir));
+   gSystem->Unlink(fname);
+}
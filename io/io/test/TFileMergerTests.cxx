@@ -1,8 +1,15 @@
 #include "TFileMerger.h"
 
+#include "TFile.h"
+#include "TH1D.h"
 #include "TMemFile.h"
+#include "TSystem.h"
 #include "TTree.h"
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "gtest/gtest.h"
 
 namespace {
@@ -96,3 +103,134 @@ TEST(TFileMerger, CreateWithUnwritableTFilePointer)
    output->SetWritable(false);
    EXPECT_ROOT_ERROR(merger.OutputFile(std::move(output)), "Error in .* output file output.root is not writable\n");
 }
+
+TEST(TFileMerger, ParallelMerge)
+{
+   const int nfiles = 7;
+   std::vector<std::string> inputs;
+   for (int i = 0; i < nfiles; ++i) {
+      inputs.push_back("tfilemerger_parallel_input" + std::to_string(i) + ".root");
+      TFile f(inputs.back().c_str(), "RECREATE");
+      TH1D h("h", "h", 10, 0, 10);
+      h.Fill(i, i + 1.);
+      h.Write();
+      TTree t("t", "t");
+      t.SetImplicitMT(false);
+      int value = i;
+      t.Branch("value", &value);
+      t.Fill();
+      t.Write();
+   }
+
+   auto merge = [&](const char *output, UInt_t nthreads) {
+      TFileMerger merger(kFALSE);
+      merger.SetNThreads(nthreads);
+      // Force several batches of input files.
+      merger.SetMaxOpenedFiles(4);
+      merger.SetPrintLevel(0);
+      EXPECT_TRUE(merger.OutputFile(output, "RECREATE"));
+      for (auto &input : inputs)
+         EXPECT_TRUE(merger.AddFile(input.c_str(), kFALSE));
+      EXPECT_TRUE(merger.Merge());
+   };
+   merge("tfilemerger_parallel_seq.root", 0);
+   merge("tfilemerger_parallel_mt.root", 3);
+
+   TFile seq("tfilemerger_parallel_seq.root");
+   TFile mt("tfilemerger_parallel_mt.root");
+   TH1D *hseq = nullptr, *hmt = nullptr;
+   seq.GetObject("h", hseq);
+   mt.GetObject("h", hmt);
+   ASSERT_TRUE(hseq && hmt);
+   EXPECT_EQ(hseq->GetEntries(), hmt->GetEntries());
+   for (int bin = 0; bin <= hseq->GetNbinsX() + 1; ++bin)
+      EXPECT_DOUBLE_EQ(hseq->GetBinContent(bin), hmt->GetBinContent(bin));
+
+   TTree *tmt = nullptr;
+   mt.GetObject("t", tmt);
+   ASSERT_TRUE(tmt != nullptr);
+   ASSERT_EQ(nfiles, tmt->GetEntries());
+   int value = -1;
+   tmt->SetBranchAddress("value", &value);
+   for (int i = 0; i < nfiles; ++i) {
+      tmt->GetEntry(i);
+      EXPECT_EQ(i, value); // The input files are merged in order.
+   }
+   tmt->ResetBranchAddresses();
+
+   for (auto &input : inputs)
+      gSystem->Unlink(input.c_str());
+   gSystem->Unlink("tfilemerger_parallel_seq.root");
+   gSystem->Unlink("tfilemerger_parallel_mt.root");
+}
+
+TEST(TFileMerger, ParallelMergeMissingFile)
+{
+   TFileMerger merger(kFALSE);
+   merger.SetNThreads(2);
+   merger.SetPrintLevel(0);
+   EXPECT_ROOT_ERROR(EXPECT_FALSE(merger.AddFile("tfilemerger_does_not_exist.root", kFALSE)),
+                     "Error in <TFileMerger::AddFile>: cannot open file tfilemerger_does_not_exist.root\n");
+}
+
+TEST(TFileMerger, ParallelMergeTreeBaskets)
+{
+   // Trees with many baskets, read ahead in chunks of a small cache by the fast merge
+   const int nfiles = 3;
+   const int nentries = 5000;
+   std::vector<std::string> inputs;
+   for (int i = 0; i < nfiles; ++i) {
+      inputs.push_back("tfilemerger_baskets_input" + std::to_string(i) + ".root");
+      TFile f(inputs.back().c_str(), "RECREATE");
+      TTree t("t", "t");
+      t.SetImplicitMT(false);
+      int value = 0;
+      double x = 0.;
+      t.Branch("value", &value, 1000);
+      t.Branch("x", &x, 2000);
+      for (int e = 0; e < nentries; ++e) {
+         value = i * nentries + e;
+         x = 0.5 * value;
+         t.Fill();
+      }
+      t.Write();
+   }
+
+   auto merge = [&](const char *output, UInt_t nthreads) {
+      TFileMerger merger(kFALSE);
+      merger.SetNThreads(nthreads);
+      merger.SetPrintLevel(0);
+      merger.SetMergeOptions(TString("cachesize=8000"));
+      EXPECT_TRUE(merger.OutputFile(output, "RECREATE"));
+      for (auto &input : inputs)
+         EXPECT_TRUE(merger.AddFile(input.c_str(), kFALSE));
+      EXPECT_TRUE(merger.Merge());
+   };
+   merge("tfilemerger_baskets_seq.root", 0);
+   merge("tfilemerger_baskets_mt.root", 4);
+
+   TFile seq("tfilemerger_baskets_seq.root");
+   TFile mt("tfilemerger_baskets_mt.root");
+   TTree *tseq = nullptr, *tmt = nullptr;
+   seq.GetObject("t", tseq);
+   mt.GetObject("t", tmt);
+   ASSERT_TRUE(tseq && tmt);
+   ASSERT_EQ(nfiles * nentries, tmt->GetEntries());
+   EXPECT_EQ(tseq->GetZipBytes(), tmt->GetZipBytes());
+   EXPECT_LT(3 * nfiles, tmt->GetBranch("x")->GetWriteBasket());
+   int value = -1;
+   double x = -1.;
+   tmt->SetBranchAddress("value", &value);
+   tmt->SetBranchAddress("x", &x);
+   for (int e = 0; e < nfiles * nentries; ++e) {
+      tmt->GetEntry(e);
+      ASSERT_EQ(e, value);
+      ASSERT_EQ(0.5 * e, x);
+   }
+   tmt->ResetBranchAddresses();
+
+   for (auto &input : inputs)
+      gSystem->Unlink(input.c_str());
+   gSystem->Unlink("tfilemerger_baskets_seq.root");
+   gSystem->Unlink("tfilemerger_baskets_mt.root");
+}
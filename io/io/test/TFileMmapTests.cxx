@@ -0,0 +1,123 @@
+#include "TError.h"
+#include "TFile.h"
+#include "TNamed.h"
+#include "TSystem.h"
+#include "TTree.h"
+
+#include <memory>
+
+#include "gtest/gtest.h"
+
+static void WriteFile(const char *fname, int compress)
+{
+   TFile f(fname, "RECREATE", "", compress);
+   TTree t("t", "t");
+   int i = 0;
+   double x = 0;
+   t.Branch("i", &i);
+   t.Branch("x", &x);
+   t.SetAutoFlush(1000);
+   for (i = 0; i < 10000; ++i) {
+      x = 0.5 * i;
+      t.Fill();
+   }
+   TNamed n("name", "title");
+   n.Write();
+   t.Write();
+}
+
+static void CheckFile(const char *fname)
+{
+   std::unique_ptr<TFile> f(TFile::Open(TString(fname) + "?mmap"));
+   ASSERT_TRUE(f && !f->IsZombie());
+#ifndef R__WIN32
+   EXPECT_TRUE(f->IsMemoryMapped());
+#endif
+
+   TNamed *n = nullptr;
+   f->GetObject("name", n);
+   ASSERT_NE(nullptr, n);
+   EXPECT_STREQ("title", n->GetTitle());
+
+   TTree *t = nullptr;
+   f->GetObject("t", t);
+   ASSERT_NE(nullptr, t);
+   int i = -1;
+   double x = -1;
+   t->SetBranchAddress("i", &i);
+   t->SetBranchAddress("x", &x);
+   const auto nEntries = t->GetEntries();
+   ASSERT_EQ(10000, nEntries);
+   for (Long64_t e = 0; e < nEntries; ++e) {
+      t->GetEntry(e);
+      EXPECT_EQ(e, i);
+      EXPECT_DOUBLE_EQ(0.5 * e, x);
+   }
+   if (f->IsMemoryMapped()) {
+      EXPECT_EQ(nullptr, f->GetCacheRead(t));
+   }
+   EXPECT_GT(f->GetBytesRead(), 0);
+}
+
+TEST(TFileMmap, Compressed)
+{
+   const char *fname = "tfile_mmap_compressed.root";
+   WriteFile(fname, 101);
+   CheckFile(fname);
+   gSystem->Unlink(fname);
+}
+
+TEST(TFileMmap, Uncompressed)
+{
+   const char *fname = "tfile_mmap_uncompressed.root";
+   WriteFile(fname, 0);
+   CheckFile(fname);
+   gSystem->Unlink(fname);
+}
+
+TEST(TFileMmap, NoUpdate)
+{
+   const char *fname = "tfile_mmap_noupdate.root";
+   WriteFile(fname, 0);
+   std::unique_ptr<TFile> f(TFile::Open(TString(fname) + "?mmap"));
+   ASSERT_TRUE(f && !f->IsZombie());
+   if (f->IsMemoryMapped()) {
+      auto oldIgnoreLevel = gErrorIgnoreLevel;
+      gErrorIgnoreLevel = kBreak;
+      EXPECT_EQ(-1, f->ReOpen("UPDATE"));
+      gErrorIgnoreLevel = oldIgnoreLevel;
+   }
+   f.reset();
+   gSystem->Unlink(fname);
+}
+
+// The baskets of an uncompressed file use the mapping as buffer: they must stay readable in a tree detached from the
+// file after the file is closed.
+TEST(TFileMmap, DetachedTreeAfterClose)
+{
+   const char *fname = "tfile_mmap_detached.root";
+   WriteFile(fname, 0);
+   std::unique_ptr<TFile> f(TFile::Open(TString(fname) + "?mmap"));
+   ASSERT_TRUE(f && !f->IsZombie());
+   TTree *t = nullptr;
+   f->GetObject("t", t);
+   ASSERT_NE(nullptr, t);
+   EXPECT_LT(0, t->LoadBaskets());
+   t->SetDirectory(nullptr);
+   std::unique_ptr<TTree> tree(t);
+   f.reset();
+
+   int i = -1;
+   double x = -1;
+   tree->SetBranchAddress("i", &i);
+   tree->SetBranchAddress("x", &x);
+   const auto nEntries = tree->GetEntries();
+   ASSERT_EQ(10000, nEntries);
+   for (Long64_t e = 0; e < nEntries; ++e) {
+      EXPECT_LT(0, tree->GetEntry(e));
+      EXPECT_EQ(e, i);
+      EXPECT_DOUBLE_EQ(0.5 * e, x);
+   }
+   tree.reset();
+   gSystem->Unlink(fname);
+}
@@ -0,0 +1,85 @@
+#include "TBufferFile.h"
+#include "TClass.h"
+#include "TFile.h"
+#include "TSystem.h"
+#include "TTree.h"
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+TEST(TGenCollectionStreamer, NestedVectorLayout)
+{
+   TClass *cl = TClass::GetClass("vector<vector<float> >");
+   ASSERT_NE(nullptr, cl);
+   std::vector<std::vector<float>> in{{1.5f, 2.5f}, {}, {-3.f}};
+
+   TBufferFile b(TBuffer::kWrite);
+   cl->Streamer(&in, b);
+
+   // The layout of the element by element streaming: the number of inner
+   // vectors, then the size and the values of each of them.
+   TBufferFile ref(TBuffer::kWrite);
+   ref << 3;
+   ref << 2;
+   ref.WriteFastArray(in[0].data(), 2);
+   ref << 0;
+   ref << 1;
+   ref.WriteFastArray(in[2].data(), 1);
+   ASSERT_EQ(ref.Length(), b.Length());
+   EXPECT_EQ(0, memcmp(ref.Buffer(), b.Buffer(), b.Length()));
+
+   TBufferFile r(TBuffer::kRead, ref.Length(), ref.Buffer(), kFALSE);
+   std::vector<std::vector<float>> out{{9.f}, {9.f, 9.f, 9.f, 9.f}, {9.f}, {9.f}};
+   cl->Streamer(&out, r);
+   EXPECT_EQ(in, out);
+   EXPECT_EQ(ref.Length(), r.Length());
+}
+
+TEST(TGenCollectionStreamer, NestedVectorTree)
+{
+   const char *fname = "tgencollectionstreamer_nested.root";
+   {
+      TFile f(fname, "RECREATE");
+      TTree t("t", "t");
+      std::vector<std::vector<float>> vvf;
+      std::vector<std::vector<int>> vvi;
+      std::vector<float> vf;
+      t.Branch("vvf", &vvf);
+      t.Branch("vvi", &vvi);
+      t.Branch("vf", &vf);
+      for (int e = 0; e < 100; ++e) {
+         vvf.assign(e % 7, std::vector<float>(e % 5, 0.5f * e));
+         vvi.assign(e % 3, std::vector<int>(e % 11, -e));
+         vf.assign(e % 13, 0.25f * e);
+         t.Fill();
+      }
+      t.Write();
+   }
+
+   std::unique_ptr<TFile> f(TFile::Open(fname));
+   ASSERT_TRUE(f && !f->IsZombie());
+   TTree *t = nullptr;
+   f->GetObject("t", t);
+   ASSERT_NE(nullptr, t);
+   std::vector<std::vector<float>> *vvf = nullptr;
+   std::vector<std::vector<int>> *vvi = nullptr;
+   std::vector<float> *vf = nullptr;
+   t->SetBranchAddress("vvf", &vvf);
+   t->SetBranchAddress("vvi", &vvi);
+   t->SetBranchAddress("vf", &vf);
+   for (int e = 0; e < 100; ++e) {
+      ASSERT_GT(t->GetEntry(e), 0);
+      EXPECT_EQ(std::vector<std::vector<float>>(e % 7, std::vector<float>(e % 5, 0.5f * e)), *vvf);
+      EXPECT_EQ(std::vector<std::vector<int>>(e % 3, std::vector<int>(e % 11, -e)), *vvi);
+      EXPECT_EQ(std::vector<float>(e % 13, 0.25f * e), *vf);
+   }
+   t->ResetBranchAddresses();
+   delete vvf;
+   delete vvi;
+   delete vf;
+   f.reset();
+   gSystem->Unlink(fname);
+}
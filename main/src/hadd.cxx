@@ -98,6 +98,7 @@ int main( int argc, char **argv )
    if ( argc < 3 || "-h" == std::string(argv[1]) || "--help" == std::string(argv[1]) ) {
       std::cout << "Usage: " << argv[0] << " [-f[fk][0-9]] [-k] [-T] [-O] [-a] \n"
       "            [-n maxopenedfiles] [-cachesize size] [-j ncpus] [-v [verbosity]] \n"
+      "            [-sortbycluster] [-clustersize size] \n"
       "            targetfile source1 [source2 source3 ...]\n" << std::endl;
       std::cout << "This program will add histograms from a list of root files and write them" << std::endl;
       std::cout << "   to a target root file. The target file is newly created and must not" << std::endl;
@@ -121,6 +122,10 @@ int main( int argc, char **argv )
                    "   to request to use the system maximum." << std::endl;
       std::cout << "If the option -cachesize is used, hadd will resize (or disable if 0) the\n"
                    "   prefetching cache use to speed up I/O operations." << std::endl;
+      std::cout << "If the option -sortbycluster is used, the baskets of the output trees are grouped by\n"
+                   "   cluster (and by branch within a cluster), so that each cluster is contiguous in the file." << std::endl;
+      std::cout << "If the option -clustersize is used, the baskets of the output trees are rewritten\n"
+                   "   (like with -O) and sized to produce clusters of about 'size' compressed bytes." << std::endl;
       std::cout << "If the option -experimental-io-features is used (and an argument provided), then\n"
                    "   the corresponding experimental feature will be enabled for output trees." << std::endl;
       std::cout << "When -the -f option is specified, one can also specify the compression level of\n"
@@ -161,6 +166,7 @@ int main( int argc, char **argv )
    Int_t maxopenedfiles = 0;
    Int_t verbosity = 99;
    TString cacheSize;
+   TString layoutOptions;
    SysInfo_t s;
    gSystem->GetSysInfo(&s);
    auto nProcesses = s.fCpus;
@@ -276,6 +282,25 @@ int main( int argc, char **argv )
             }
          }
          ++ffirst;
+      } else if (strcmp(argv[a], "-sortbycluster") == 0) {
+         layoutOptions += " SortBasketsByCluster";
+         ++ffirst;
+      } else if (strcmp(argv[a], "-clustersize") == 0) {
+         if (a+1 >= argc) {
+            std::cerr << "Error: no cluster size was provided after -clustersize.\n";
+         } else {
+            int size;
+            if (ROOT::FromHumanReadableSize(argv[a+1],size) != ROOT::EFromHumanReadableSize::kSuccess || size <= 0) {
+               std::cerr << "Error: could not parse the cluster size passed after -clustersize: "
+                         << argv[a + 1] << ". The clusters will not be resized.\n";
+            } else {
+               layoutOptions += " ClusterSize=";
+               layoutOptions += argv[a+1];
+            }
+            ++a;
+            ++ffirst;
+         }
+         ++ffirst;
       } else if (!strcmp(argv[a], "-experimental-io-features")) {
          if (a+1 >= argc) {
             std::cerr << "Error: no IO feature was specified after -experimental-io-features; ignoring\n";
@@ -474,7 +499,7 @@ int main( int argc, char **argv )
          }
       }
       merger.SetNotrees(noTrees);
-      merger.SetMergeOptions(cacheSize);
+      merger.SetMergeOptions(cacheSize + layoutOptions);
       merger.SetIOFeatures(features);
       Bool_t status;
       if (append)
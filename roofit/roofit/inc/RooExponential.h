@@ -39,6 +39,7 @@ protected:
   RooRealProxy c;
 
   Double_t evaluate() const;
+  virtual Bool_t evaluateBatch(Double_t* output, Int_t first, Int_t n, const RooAbsData& data, const RooArgSet* nset) const;
 
 private:
   ClassDef(RooExponential,1) // Exponential PDF
@@ -46,6 +46,7 @@ protected:
   RooRealProxy sigma ;
 
   Double_t evaluate() const ;
+  virtual Bool_t evaluateBatch(Double_t* output, Int_t first, Int_t n, const RooAbsData& data, const RooArgSet* nset) const ;
 
 private:
 
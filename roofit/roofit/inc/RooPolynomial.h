@@ -49,6 +49,7 @@ protected:
   mutable std::vector<Double_t> _wksp; //! do not persist
 
   Double_t evaluate() const;
+  virtual Bool_t evaluateBatch(Double_t* output, Int_t first, Int_t n, const RooAbsData& data, const RooArgSet* nset) const;
 
   ClassDef(RooPolynomial,1) // Polynomial PDF
 };
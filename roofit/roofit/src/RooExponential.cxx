@@ -25,6 +25,7 @@ Exponential p.d.f
 #include "Riostream.h"
 #include "Riostream.h"
 #include <math.h>
+#include <vector>
 
 #include "RooExponential.h"
 #include "RooRealVar.h"
@@ -57,6 +58,21 @@ Double_t RooExponential::evaluate() const{
   return exp(c*x);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Compute the exponential for a range of events of 'data', see RooAbsReal::evaluateBatch()
+
+Bool_t RooExponential::evaluateBatch(Double_t* output, Int_t first, Int_t n, const RooAbsData& data, const RooArgSet* /*nset*/) const
+{
+  vector<Double_t> xVals(n), cVals(n) ;
+  x.arg().getValBatch(&xVals[0], first, n, data, x.nset()) ;
+  c.arg().getValBatch(&cVals[0], first, n, data, c.nset()) ;
+
+  for (Int_t i=0 ; i<n ; i++) {
+    output[i] = exp(cVals[i]*xVals[i]) ;
+  }
+  return kTRUE ;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 Int_t RooExponential::getAnalyticalIntegral(RooArgSet& allVars, RooArgSet& analVars, const char* /*rangeName*/) const
@@ -25,6 +25,7 @@ Plain Gaussian p.d.f
 #include "Riostream.h"
 #include "Riostream.h"
 #include <math.h>
+#include <vector>
 
 #include "RooGaussian.h"
 #include "RooAbsReal.h"
@@ -69,6 +70,24 @@ Double_t RooGaussian::evaluate() const
   return ret ;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Compute the Gaussian for a range of events of 'data', see RooAbsReal::evaluateBatch()
+
+Bool_t RooGaussian::evaluateBatch(Double_t* output, Int_t first, Int_t n, const RooAbsData& data, const RooArgSet* /*nset*/) const
+{
+  vector<Double_t> xVals(n), meanVals(n), sigmaVals(n) ;
+  x.arg().getValBatch(&xVals[0], first, n, data, x.nset()) ;
+  mean.arg().getValBatch(&meanVals[0], first, n, data, mean.nset()) ;
+  sigma.arg().getValBatch(&sigmaVals[0], first, n, data, sigma.nset()) ;
+
+  for (Int_t i=0 ; i<n ; i++) {
+    const Double_t arg = xVals[i] - meanVals[i] ;
+    const Double_t sig = sigmaVals[i] ;
+    output[i] = exp(-0.5*arg*arg/(sig*sig)) ;
+  }
+  return kTRUE ;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// calculate and return the negative log-likelihood of the Poisson
 
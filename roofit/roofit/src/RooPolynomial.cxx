@@ -24,6 +24,7 @@ probability density functions have one degree of freedom
 less than polynomial functions due to the normalization condition
 **/
 
+#include <algorithm>
 #include <cmath>
 #include <cassert>
 
@@ -123,6 +124,38 @@ Double_t RooPolynomial::evaluate() const
   return retVal * std::pow(x, lowestOrder) + (lowestOrder ? 1.0 : 0.0);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Compute the polynomial for a range of events of 'data', see RooAbsReal::evaluateBatch()
+
+Bool_t RooPolynomial::evaluateBatch(Double_t* output, Int_t first, Int_t n, const RooAbsData& data, const RooArgSet* /*nset*/) const
+{
+  const unsigned sz = _coefList.getSize();
+  const int lowestOrder = _lowestOrder;
+  if (!sz) {
+    std::fill(output, output + n, lowestOrder ? 1. : 0.);
+    return kTRUE;
+  }
+
+  // Values of the coefficients, one block of n values per coefficient
+  std::vector<Double_t> coefVals(sz * n);
+  {
+    const RooArgSet* nset = _coefList.nset();
+    RooFIter it = _coefList.fwdIterator();
+    RooAbsReal* c;
+    for (unsigned k = 0; (c = (RooAbsReal*) it.next()); ++k) c->getValBatch(&coefVals[k * n], first, n, data, nset);
+  }
+  std::vector<Double_t> xVals(n);
+  _x.arg().getValBatch(&xVals[0], first, n, data, _x.nset());
+
+  for (Int_t i = 0; i < n; ++i) output[i] = coefVals[(sz - 1) * n + i];
+  for (unsigned k = sz - 1; k--; ) {
+    const Double_t* coef = &coefVals[k * n];
+    for (Int_t i = 0; i < n; ++i) output[i] = coef[i] + xVals[i] * output[i];
+  }
+  for (Int_t i = 0; i < n; ++i) output[i] = output[i] * std::pow(xVals[i], lowestOrder) + (lowestOrder ? 1.0 : 0.0);
+  return kTRUE;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 Int_t RooPolynomial::getAnalyticalIntegral(RooArgSet& allVars, RooArgSet& analVars, const char* /*rangeName*/) const
@@ -87,6 +87,7 @@ public:
   virtual Double_t weightError(ErrorType etype=Poisson) const ;
   virtual void weightError(Double_t& lo, Double_t& hi, ErrorType etype=Poisson) const ; 
   virtual const RooArgSet* get(Int_t index) const ;
+  const Double_t* getBatch(const RooAbsReal& real, Int_t first, Int_t n) const ;
 
   virtual Int_t numEntries() const ;
   virtual Double_t sumEntries() const = 0 ;
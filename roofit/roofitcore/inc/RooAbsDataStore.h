@@ -24,6 +24,7 @@
 
 
 class RooAbsArg ;
+class RooAbsReal ;
 class RooArgList ;
 class TIterator ;
 class TTree ;
@@ -52,6 +53,9 @@ public:
 
   virtual Double_t weight(Int_t index) const = 0 ;
 
+  // Retrieve the values of a column for a range of rows, if stored contiguously
+  virtual const Double_t* getBatch(const RooAbsReal& /*real*/, Int_t /*first*/, Int_t /*n*/) const { return 0 ; }
+
   virtual Bool_t isWeighted() const = 0 ;
 
   // Change observable name
@@ -24,6 +24,7 @@
 #include "RooGlobalFunc.h"
 
 class RooArgList ;
+class RooAbsData ;
 class RooDataSet ;
 class RooPlot;
 class RooRealVar;
@@ -73,6 +74,9 @@ public:
 
   virtual Double_t getValV(const RooArgSet* set=0) const ;
 
+  // Evaluation for a range of events of a dataset
+  virtual void getValBatch(Double_t* output, Int_t first, Int_t n, const RooAbsData& data, const RooArgSet* set=0) const ;
+
   Double_t getPropagatedError(const RooFitResult &fr, const RooArgSet &nset = RooArgSet());
 
   Bool_t operator==(Double_t value) const ;
@@ -371,6 +375,9 @@ protected:
     return kFALSE ;
   }
   virtual Double_t evaluate() const = 0 ;
+  virtual Bool_t evaluateBatch(Double_t* output, Int_t first, Int_t n, const RooAbsData& data, const RooArgSet* set) const ;
+  Bool_t getValBatchFromData(Double_t* output, Int_t first, Int_t n, const RooAbsData& data, const RooArgSet* set) const ;
+  void getValBatchByEvent(Double_t* output, Int_t first, Int_t n, const RooAbsData& data, const RooArgSet* set) const ;
 
   // Hooks for RooDataSet interface
   friend class RooRealIntegral ;
@@ -95,9 +95,9 @@ protected:
   
   RooSetProxy _paramSet ;          // Parameters of the test statistic (=parameters of the input function)
 
-  enum GOFOpMode { SimMaster,MPMaster,Slave } ;
+  enum GOFOpMode { SimMaster,MPMaster,Slave,MTMaster } ;
   GOFOpMode operMode() const { 
-    // Return test statistic operation mode of this instance (SimMaster, MPMaster or Slave)
+    // Return test statistic operation mode of this instance (SimMaster, MPMaster, MTMaster or Slave)
     return _gofOpMode ; 
   }
 
@@ -118,9 +118,17 @@ protected:
 
   virtual Bool_t processEmptyDataSets() const { return kTRUE ; }
 
+  // Data slices of the partitions in multi-threaded mode
+  virtual Bool_t supportsDataSlices(const RooAbsReal& /*real*/, const RooAbsData& /*data*/) const { return kFALSE ; }
+  virtual void combineDataSlices() {}
+  // Can the partitions of multi-threaded mode be evaluated concurrently with the current configuration?
+  virtual Bool_t concurrentPartitionsSafe() const { return kTRUE ; }
+  RooAbsData* createDataSlice(const RooAbsData& data, Int_t inSetNum, Int_t inNumSets) const ;
+
   Bool_t initialize() ;
   void initSimMode(RooSimultaneous* pdf, RooAbsData* data, const RooArgSet* projDeps, const char* rangeName, const char* addCoefRangeName) ;    
   void initMPMode(RooAbsReal* real, RooAbsData* data, const RooArgSet* projDeps, const char* rangeName, const char* addCoefRangeName) ;
+  void initMTMode(RooAbsReal* real, RooAbsData* data, const RooArgSet* projDeps, const char* rangeName, const char* addCoefRangeName) ;
 
   mutable Bool_t _init ;          //! Is object initialized  
   GOFOpMode   _gofOpMode ;        // Operation mode of test statistic instance 
@@ -132,12 +140,15 @@ protected:
 
   // Simultaneous mode data
   Int_t          _nGof        ; // Number of sub-contexts 
-  pRooAbsTestStatistic* _gofArray ; //! Array of sub-contexts representing part of the combined test statistic
+  pRooAbsTestStatistic* _gofArray ; //! Array of sub-contexts representing part of the combined test statistic, or of partitions in MTMaster mode
   std::vector<RooFit::MPSplit> _gofSplitMode ; //! GOF MP Split mode specified by component (when Auto is active)
   
   // Parallel mode data
   Int_t          _nCPU ;      //  Number of processors to use in parallel calculation mode
   pRooRealMPFE*  _mpfeArray ; //! Array of parallel execution frond ends
+  mutable Bool_t _mtSerialEval ; //! Evaluate the partitions of MTMaster mode in the calling thread at next evaluation
+  Bool_t         _mtParallel ; //! Partitions of MTMaster mode may be evaluated concurrently
+  Bool_t         _dataSlice ; //! Data only contains the events of this partition, all of which are evaluated
 
   RooFit::MPSplit        _mpinterl ; // Use interleaving strategy rather than N-wise split for partioning of dataset for multiprocessor-split
   Bool_t         _doOffset ; // Apply interval value offset to control numeric precision?
@@ -41,6 +41,7 @@ public:
   virtual ~RooAddPdf() ;
 
   Double_t evaluate() const ;
+  virtual Bool_t evaluateBatch(Double_t* output, Int_t first, Int_t n, const RooAbsData& data, const RooArgSet* nset) const ;
   virtual Bool_t checkObservables(const RooArgSet* nset) const ;	
 
   virtual Bool_t forceAnalyticalInt(const RooAbsArg& /*dep*/) const { 
@@ -27,7 +27,7 @@ class RooNLLVar : public RooAbsOptTestStatistic {
 public:
 
   // Constructors, assignment etc
-  RooNLLVar() { _first = kTRUE ; }
+  RooNLLVar() { _first = kTRUE ; _batchMode = kFALSE ; _sumEntriesAll = 0 ; _sumW2All = 0 ; }
   RooNLLVar(const char *name, const char* title, RooAbsPdf& pdf, RooAbsData& data,
 	    const RooCmdArg& arg1=RooCmdArg::none(), const RooCmdArg& arg2=RooCmdArg::none(),const RooCmdArg& arg3=RooCmdArg::none(),
 	    const RooCmdArg& arg4=RooCmdArg::none(), const RooCmdArg& arg5=RooCmdArg::none(),const RooCmdArg& arg6=RooCmdArg::none(),
@@ -49,24 +49,33 @@ public:
   virtual RooAbsTestStatistic* create(const char *name, const char *title, RooAbsReal& pdf, RooAbsData& adata,
 				      const RooArgSet& projDeps, const char* rangeName, const char* addCoefRangeName=0, 
 				      Int_t nCPU=1, RooFit::MPSplit interleave=RooFit::BulkPartition, Bool_t verbose=kTRUE, Bool_t splitRange=kFALSE, Bool_t binnedL=kFALSE) {
-    return new RooNLLVar(name,title,(RooAbsPdf&)pdf,adata,projDeps,_extended,rangeName, addCoefRangeName, nCPU, interleave,verbose,splitRange,kFALSE,binnedL) ;
+    RooNLLVar* nll = new RooNLLVar(name,title,(RooAbsPdf&)pdf,adata,projDeps,_extended,rangeName, addCoefRangeName, nCPU, interleave,verbose,splitRange,kFALSE,binnedL) ;
+    nll->_batchMode = _batchMode ;
+    return nll ;
   }
   
   virtual ~RooNLLVar();
 
   void applyWeightSquared(Bool_t flag) ; 
+  void batchMode(Bool_t flag) ;
 
   virtual Double_t defaultErrorLevel() const { return 0.5 ; }
 
 protected:
 
   virtual Bool_t processEmptyDataSets() const { return _extended ; }
+  virtual Bool_t supportsDataSlices(const RooAbsReal& real, const RooAbsData& data) const ;
+  virtual void combineDataSlices() ;
+  virtual Bool_t concurrentPartitionsSafe() const { return !_batchMode ; }
 
   static RooArgSet _emptySet ; // Supports named argument constructor
 
   Bool_t _extended ;
   virtual Double_t evaluatePartition(Int_t firstEvent, Int_t lastEvent, Int_t stepSize) const ;
   Bool_t _weightSq ; // Apply weights squared?
+  Bool_t _batchMode ; //! Evaluate the p.d.f with getLogValBatch()?
+  Double_t _sumEntriesAll ; //! Sum of weights of all partitions, if the data only holds the events of this one
+  Double_t _sumW2All ; //! Sum of squared weights of all partitions, if the data only holds the events of this one
   mutable Bool_t _first ; //!
   Double_t _offsetSaveW2; //!
   Double_t _offsetCarrySaveW2; //!
@@ -73,6 +73,7 @@ public:
   virtual Double_t weightError(RooAbsData::ErrorType etype=RooAbsData::Poisson) const ;
   virtual void weightError(Double_t& lo, Double_t& hi, RooAbsData::ErrorType etype=RooAbsData::Poisson) const ; 
   virtual Double_t weight(Int_t index) const ;
+  virtual const Double_t* getBatch(const RooAbsReal& real, Int_t first, Int_t n) const ;
   virtual Bool_t isWeighted() const { return (_wgtVar!=0||_extWgtArray!=0) ; }
 
   // Change observable name
@@ -302,6 +302,18 @@ const RooArgSet* RooAbsData::get(Int_t index) const
   return _dstore->get(index) ;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Return a pointer to the values that get(i) loads into 'real' for the
+/// events first <= i < first+n, or zero if they are not stored contiguously.
+/// Besides observables, this includes the functions cached by the constant
+/// term optimizer of the likelihood.
+
+const Double_t* RooAbsData::getBatch(const RooAbsReal& real, Int_t first, Int_t n) const
+{
+  checkInit() ;
+  return _dstore->getBatch(real, first, n) ;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Internal method -- Cache given set of functions with data
 
@@ -756,6 +756,13 @@ Bool_t RooAbsOptTestStatistic::setDataSlave(RooAbsData& indata, Bool_t cloneData
     //cout << "ROATS::setDataSlave() ERROR this is SimMaster _funcClone = " << _funcClone << endl ;    
     return kFALSE ;
   }
+
+  if (operMode()==MTMaster) {
+    // Component of a RooSimultaneous calculated in threads: the partitions take their own copy of the data
+    Bool_t ret = setData(indata,kTRUE) ;
+    if (ownNewData) delete &indata ;
+    return ret ;
+  }
   
   //cout << "ROATS::setDataSlave() new dataset size = " << indata.numEntries() << endl ;
   //indata.Print("v") ;
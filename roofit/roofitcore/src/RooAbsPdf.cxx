@@ -158,6 +158,7 @@ the proxy holds a function, and will trigger an assert
 #include "RooRealIntegral.h"
 #include "RooWorkspace.h"
 #include "Math/CholeskyDecomp.h"
+#include <algorithm>
 #include <string>
 
 using namespace std;
@@ -312,6 +313,99 @@ Double_t RooAbsPdf::getValV(const RooArgSet* nset) const
 
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// Compute the values of the p.d.f, normalized over the observables 'nset',
+/// for the events first <= i < first+n of the dataset 'data', see
+/// RooAbsReal::getValBatch(). The unnormalized values computed by
+/// evaluateBatch() are divided by the normalization integral, which is
+/// computed once if all the observables of the dataset the p.d.f depends on
+/// are in 'nset'. Otherwise, e.g. with conditional observables, the values
+/// are computed event by event.
+
+void RooAbsPdf::getValBatch(Double_t* output, Int_t first, Int_t n, const RooAbsData& data, const RooArgSet* nset) const
+{
+  if (n<=0 || getValBatchFromData(output, first, n, data, nset)) return ;
+
+  // The normalization is the same for all events unless the p.d.f depends on
+  // observables of the dataset that are not normalized over
+  Double_t normVal(1) ;
+  if (nset) {
+    Bool_t constNorm(kTRUE) ;
+    RooArgSet* obs = getObservables(data) ;
+    RooFIter iter = obs->fwdIterator() ;
+    RooAbsArg* arg ;
+    while((arg=iter.next())) {
+      if (!nset->find(arg->GetName())) {
+        constNorm = kFALSE ;
+        break ;
+      }
+    }
+    delete obs ;
+    if (!constNorm) {
+      getValBatchByEvent(output, first, n, data, nset) ;
+      return ;
+    }
+    normVal = getNorm(nset) ;
+  }
+
+  if (!evaluateBatch(output, first, n, data, nset)) {
+    getValBatchByEvent(output, first, n, data, nset) ;
+    return ;
+  }
+
+  if (normVal<=0.) {
+    logEvalError("p.d.f normalization integral is zero or negative") ;
+    std::fill(output, output+n, 0.) ;
+    return ;
+  }
+
+  for (Int_t i=0 ; i<n ; i++) {
+    const Double_t rawVal = output[i] ;
+    if ((rawVal<0 || TMath::IsNaN(rawVal)) && traceEvalPdf(rawVal)) {
+      output[i] = 0 ;
+    } else if (nset) {
+      output[i] = rawVal / normVal ;
+    }
+  }
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Compute the logarithm of the p.d.f for the events first <= i < first+n of
+/// the dataset 'data', reporting the same evaluation errors as getLogVal()
+
+void RooAbsPdf::getLogValBatch(Double_t* output, Int_t first, Int_t n, const RooAbsData& data, const RooArgSet* nset) const
+{
+  getValBatch(output, first, n, data, nset) ;
+
+  for (Int_t i=0 ; i<n ; i++) {
+    const Double_t prob = output[i] ;
+    if (prob>0 && prob<=1e6) {
+      output[i] = log(prob) ;
+      continue ;
+    }
+
+    if (fabs(prob)>1e6) {
+      coutW(Eval) << "RooAbsPdf::getLogVal(" << GetName() << ") WARNING: large likelihood value: " << prob << endl ;
+    }
+    if (prob<0) {
+      logEvalError("getLogVal() top-level p.d.f evaluates to a negative number") ;
+      output[i] = 0 ;
+    } else if (prob==0) {
+      logEvalError("getLogVal() top-level p.d.f evaluates to zero") ;
+      output[i] = log((double)0) ;
+    } else if (TMath::IsNaN(prob)) {
+      logEvalError("getLogVal() top-level p.d.f evaluates to NaN") ;
+      output[i] = log((double)0) ;
+    } else {
+      output[i] = log(prob) ;
+    }
+  }
+}
+
+
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Analytical integral with normalization (see RooAbsReal::analyticalIntegralWN() for further information)
 ///
@@ -749,6 +843,8 @@ Double_t RooAbsPdf::extendedTerm(Double_t observed, const RooArgSet* nset) const
 /// CloneData(Bool flag)           -- Use clone of dataset in NLL (default is true)
 /// Offset(Bool_t)                  -- Offset likelihood by initial value (so that starting value of FCN in minuit is zero). This
 ///                                    can improve numeric stability in simultaneously fits with components with large likelihood values
+/// BatchMode(Bool_t)               -- Evaluate the p.d.f for blocks of events of an unbinned dataset with RooAbsPdf::getLogValBatch()
+///                                    instead of event by event. This is faster for p.d.f.s implementing RooAbsReal::evaluateBatch()
 /// 
 /// 
 
@@ -798,6 +894,7 @@ RooAbsReal* RooAbsPdf::createNLL(RooAbsData& data, const RooLinkedList& cmdList)
   pc.defineSet("glObs","GlobalObservables",0,0) ;
   pc.defineInt("constrAll","Constrained",0,0) ;
   pc.defineInt("doOffset","OffsetLikelihood",0,0) ;
+  pc.defineInt("batchMode","BatchMode",0,0) ;
   pc.defineSet("extCons","ExternalConstraints",0,0) ;
   pc.defineMutex("Range","RangeWithName") ;
   pc.defineMutex("Constrain","Constrained") ;
@@ -822,6 +919,7 @@ RooAbsReal* RooAbsPdf::createNLL(RooAbsData& data, const RooLinkedList& cmdList)
   Int_t optConst = pc.getInt("optConst") ;
   Int_t cloneData = pc.getInt("cloneData") ;
   Int_t doOffset = pc.getInt("doOffset") ;
+  Bool_t batchMode = pc.getInt("batchMode") ;
   
   // If no explicit cloneData command is specified, cloneData is set to true if optimization is activated
   if (cloneData==2) {
@@ -900,7 +998,9 @@ RooAbsReal* RooAbsPdf::createNLL(RooAbsData& data, const RooLinkedList& cmdList)
     // Simple case: default range, or single restricted range
     //cout<<"FK: Data test 1: "<<data.sumEntries()<<endl;
 
-    nll = new RooNLLVar(baseName.c_str(),"-log(likelihood)",*this,data,projDeps,ext,rangeName,addCoefRangeName,numcpu,interl,verbose,splitr,cloneData) ;
+    RooNLLVar* nllVar = new RooNLLVar(baseName.c_str(),"-log(likelihood)",*this,data,projDeps,ext,rangeName,addCoefRangeName,numcpu,interl,verbose,splitr,cloneData) ;
+    nllVar->batchMode(batchMode) ;
+    nll = nllVar ;
 
   } else {
     // Composite case: multiple ranges
@@ -910,7 +1010,8 @@ RooAbsReal* RooAbsPdf::createNLL(RooAbsData& data, const RooLinkedList& cmdList)
     strlcpy(buf,rangeName,bufSize) ;
     char* token = strtok(buf,",") ;
     while(token) {
-      RooAbsReal* nllComp = new RooNLLVar(Form("%s_%s",baseName.c_str(),token),"-log(likelihood)",*this,data,projDeps,ext,token,addCoefRangeName,numcpu,interl,verbose,splitr,cloneData) ;
+      RooNLLVar* nllComp = new RooNLLVar(Form("%s_%s",baseName.c_str(),token),"-log(likelihood)",*this,data,projDeps,ext,token,addCoefRangeName,numcpu,interl,verbose,splitr,cloneData) ;
+      nllComp->batchMode(batchMode) ;
       nllList.add(*nllComp) ;
       token = strtok(0,",") ;
     }
@@ -1030,6 +1131,8 @@ RooAbsReal* RooAbsPdf::createNLL(RooAbsData& data, const RooLinkedList& cmdList)
 /// ExternalConstraints(const RooArgSet& ) -- Include given external constraints to likelihood
 /// Offset(Bool_t)                  -- Offset likelihood by initial value (so that starting value of FCN in minuit is zero). This
 ///                                    can improve numeric stability in simultaneously fits with components with large likelihood values
+/// BatchMode(Bool_t)               -- Evaluate the p.d.f for blocks of events of an unbinned dataset with RooAbsPdf::getLogValBatch()
+///                                    instead of event by event. This is faster for p.d.f.s implementing RooAbsReal::evaluateBatch()
 ///
 /// Options to control flow of fit procedure
 /// ----------------------------------------
@@ -1106,7 +1209,7 @@ RooFitResult* RooAbsPdf::fitTo(RooAbsData& data, const RooLinkedList& cmdList)
   RooCmdConfig pc(Form("RooAbsPdf::fitTo(%s)",GetName())) ;
 
   RooLinkedList fitCmdList(cmdList) ;
-  RooLinkedList nllCmdList = pc.filterCmdList(fitCmdList,"ProjectedObservables,Extended,Range,RangeWithName,SumCoefRange,NumCPU,SplitRange,Constrained,Constrain,ExternalConstraints,CloneData,GlobalObservables,GlobalObservablesTag,OffsetLikelihood") ;
+  RooLinkedList nllCmdList = pc.filterCmdList(fitCmdList,"ProjectedObservables,Extended,Range,RangeWithName,SumCoefRange,NumCPU,SplitRange,Constrained,Constrain,ExternalConstraints,CloneData,GlobalObservables,GlobalObservablesTag,OffsetLikelihood,BatchMode") ;
 
   pc.defineString("fitOpt","FitOptions",0,"") ;
   pc.defineInt("optConst","Optimize",0,2) ;
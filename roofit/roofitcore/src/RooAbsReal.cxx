@@ -101,7 +101,10 @@
 #include "TF3.h"
 #include "TMatrixD.h"
 #include "TVector.h"
+#include "ThreadLocalStorage.h"
 
+#include <algorithm>
+#include <mutex>
 #include <sstream>
 
 using namespace std ;
@@ -120,6 +123,13 @@ RooAbsReal::ErrorLoggingMode RooAbsReal::_evalErrorMode = RooAbsReal::PrintError
 Int_t RooAbsReal::_evalErrorCount = 0 ;
 map<const RooAbsArg*,pair<string,list<RooAbsReal::EvalError> > > RooAbsReal::_evalErrorList ;
 
+// Protects the evaluation error log, which is filled by test statistics evaluated in threads
+static std::mutex& evalErrorMutex()
+{
+  static std::mutex mutex ;
+  return mutex ;
+}
+
 
 ////////////////////////////////////////////////////////////////////////////////
 /// coverity[UNINIT_CTOR]
@@ -264,6 +274,78 @@ Double_t RooAbsReal::getValV(const RooArgSet* nset) const
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// Compute the values of this object for the events first <= i < first+n
+/// of the dataset 'data' and store them in output[0..n-1]. The result is the
+/// same as calling data.get(i) followed by getVal(nset) for each event, but
+/// classes implementing evaluateBatch() compute it with loops over the
+/// columns of the dataset, without walking through the expression tree for
+/// each event. The dataset must be the one the observables of this object
+/// are attached to, e.g. with attachDataSet().
+
+void RooAbsReal::getValBatch(Double_t* output, Int_t first, Int_t n, const RooAbsData& data, const RooArgSet* nset) const
+{
+  if (n<=0 || getValBatchFromData(output, first, n, data, nset)) return ;
+
+  if (!evaluateBatch(output, first, n, data, nset)) {
+    getValBatchByEvent(output, first, n, data, nset) ;
+  }
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Batch counterpart of evaluate(): compute the unnormalized values of this
+/// object for the events first <= i < first+n of 'data', with the
+/// normalization set 'nset' used for its components, and return true.
+/// Servers are evaluated with getValBatch(). The default implementation
+/// returns false, in which case the values are computed event by event.
+
+Bool_t RooAbsReal::evaluateBatch(Double_t* /*output*/, Int_t /*first*/, Int_t /*n*/, const RooAbsData& /*data*/, const RooArgSet* /*nset*/) const
+{
+  return kFALSE ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Fill output with the values of this object for a range of events if they
+/// do not need to be computed: if this object is a column of the dataset (an
+/// observable or a function cached by the likelihood optimizer) or if it does
+/// not depend on the observables of the dataset. Return false otherwise.
+
+Bool_t RooAbsReal::getValBatchFromData(Double_t* output, Int_t first, Int_t n, const RooAbsData& data, const RooArgSet* nset) const
+{
+  const Double_t* column = data.getBatch(*this, first, n) ;
+  if (column) {
+    std::copy(column, column+n, output) ;
+    return kTRUE ;
+  }
+
+  if (!dependsOn(*data.get())) {
+    std::fill(output, output+n, getVal(nset)) ;
+    return kTRUE ;
+  }
+
+  return kFALSE ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Compute the values of this object for a range of events by loading each
+/// event of the dataset and calling getVal()
+
+void RooAbsReal::getValBatchByEvent(Double_t* output, Int_t first, Int_t n, const RooAbsData& data, const RooArgSet* nset) const
+{
+  for (Int_t i=0 ; i<n ; i++) {
+    data.get(first+i) ;
+    output[i] = getVal(nset) ;
+  }
+}
+
+
+
 ////////////////////////////////////////////////////////////////////////////////
 
 Int_t RooAbsReal::numEvalErrorItems()
@@ -3606,11 +3688,12 @@ void RooAbsReal::logEvalError(const RooAbsReal* originator, const char* origName
   }
 
   if (_evalErrorMode==CountErrors) {
+    std::lock_guard<std::mutex> lock(evalErrorMutex()) ;
     _evalErrorCount++ ;
     return ;
   }
 
-  static Bool_t inLogEvalError = kFALSE ;
+  TTHREAD_TLS(Bool_t) inLogEvalError = kFALSE ;
 
   if (inLogEvalError) {
     return ;
@@ -3624,6 +3707,7 @@ void RooAbsReal::logEvalError(const RooAbsReal* originator, const char* origName
     ee.setServerValues(serverValueString) ;
   }
 
+  std::lock_guard<std::mutex> lock(evalErrorMutex()) ;
   if (_evalErrorMode==PrintErrors) {
    oocoutE((TObject*)0,Eval) << "RooAbsReal::logEvalError(" << "<STATIC>" << ") evaluation error, " << endl
 		   << " origin       : " << origName << endl
@@ -3661,11 +3745,12 @@ void RooAbsReal::logEvalError(const char* message, const char* serverValueString
   }
 
   if (_evalErrorMode==CountErrors) {
+    std::lock_guard<std::mutex> lock(evalErrorMutex()) ;
     _evalErrorCount++ ;
     return ;
   }
 
-  static Bool_t inLogEvalError = kFALSE ;
+  TTHREAD_TLS(Bool_t) inLogEvalError = kFALSE ;
 
   if (inLogEvalError) {
     return ;
@@ -3698,6 +3783,7 @@ void RooAbsReal::logEvalError(const char* message, const char* serverValueString
   ostringstream oss2 ;
   printStream(oss2,kName|kClassName|kArgs,kInline)  ;
 
+  std::lock_guard<std::mutex> lock(evalErrorMutex()) ;
   if (_evalErrorMode==PrintErrors) {
    coutE(Eval) << "RooAbsReal::logEvalError(" << GetName() << ") evaluation error, " << endl
 	       << " origin       : " << oss2.str() << endl
@@ -31,7 +31,14 @@ statistic values for the PDF components of the simultaneous PDF and
 organizes multi-processor parallel calculation of test statistic
 values. For the latter, the test statistic value is calculated in
 partitions in parallel executing processes and a posteriori
-combined in the main thread.
+combined in the main thread. If implicit multi-threading is enabled
+with ROOT::EnableImplicitMT(), the partitions are instead calculated
+by clones of the test statistic in the threads of the ROOT thread pool,
+and combined in a fixed order so that the result does not depend on the
+scheduling of the threads. Test statistics that support it give each
+of these clones only the events of its partition. The components of a
+RooSimultaneous are then calculated one after the other, each of them
+in parallel partitions.
 **/
 
 
@@ -51,20 +58,67 @@ combined in the main thread.
 #include "TTimeStamp.h"
 #include "RooProdPdf.h"
 #include "RooRealSumPdf.h"
+#include "RooAbsCachedPdf.h"
+#include "RooAbsCachedReal.h"
+#include "TROOT.h"
+#ifdef R__USE_IMT
+#include "ROOT/TThreadExecutor.hxx"
+#endif
 #include <string>
+#include <vector>
 
 using namespace std;
 
 ClassImp(RooAbsTestStatistic);
 
+namespace {
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return true if the partitions of a parallelized test statistic are to be
+/// calculated in threads, i.e. if implicit multi-threading is enabled, and
+/// false if they are to be calculated in separate processes
+
+Bool_t parallelInThreads()
+{
+#ifdef R__USE_IMT
+  return ROOT::IsImplicitMTEnabled() ;
+#else
+  return kFALSE ;
+#endif
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return true if evaluating the given function may rebuild caches, which
+/// allocates RooArgSets from their shared memory pool and registers names:
+/// this is the case for cached p.d.f.s and functions, whose caches are
+/// refilled when their parameters change
+
+Bool_t rebuildsCachesInEvaluation(const RooAbsReal& real)
+{
+  RooArgSet branches ;
+  real.branchNodeServerList(&branches) ;
+  RooFIter iter = branches.fwdIterator() ;
+  RooAbsArg* arg ;
+  while ((arg = iter.next())) {
+    if (arg->InheritsFrom(RooAbsCachedPdf::Class()) || arg->InheritsFrom(RooAbsCachedReal::Class())) {
+      return kTRUE ;
+    }
+  }
+  return kFALSE ;
+}
+
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Default constructor
 
 RooAbsTestStatistic::RooAbsTestStatistic() :
   _func(0), _data(0), _projDeps(0), _splitRange(0), _simCount(0),
   _verbose(kFALSE), _init(kFALSE), _gofOpMode(Slave), _nEvents(0), _setNum(0),
-  _numSets(0), _extSet(0), _nGof(0), _gofArray(0), _nCPU(1), _mpfeArray(0),
-  _mpinterl(RooFit::BulkPartition), _doOffset(kFALSE), _offset(0),
+  _numSets(0), _extSet(0), _nGof(0), _gofArray(0), _nCPU(1), _mpfeArray(0), _mtSerialEval(kTRUE),
+  _mtParallel(kFALSE), _dataSlice(kFALSE), _mpinterl(RooFit::BulkPartition), _doOffset(kFALSE), _offset(0),
   _offsetCarry(0), _evalCarry(0)
 {
 }
@@ -76,7 +130,8 @@ RooAbsTestStatistic::RooAbsTestStatistic() :
 /// rangeName is not null, only events in the dataset inside the range will be used in the test
 /// statistic calculation. If addCoefRangeName is not null, all RooAddPdf component of 'real' will be
 /// instructed to fix their fraction definitions to the given named range. If nCPU is greater than
-/// 1 the test statistic calculation will be paralellized over multiple processes. By default the data
+/// 1 the test statistic calculation will be paralellized over multiple processes, or over multiple
+/// threads if implicit multi-threading is enabled with ROOT::EnableImplicitMT(). By default the data
 /// is split with 'bulk' partitioning (each process calculates a contigious block of fraction 1/nCPU
 /// of the data). For binned data this approach may be suboptimal as the number of bins with >0 entries
 /// in each processing block many vary greatly thereby distributing the workload rather unevenly.
@@ -102,6 +157,9 @@ RooAbsTestStatistic::RooAbsTestStatistic(const char *name, const char *title, Ro
   _gofArray(0),
   _nCPU(nCPU),
   _mpfeArray(0),
+  _mtSerialEval(kTRUE),
+  _mtParallel(kFALSE),
+  _dataSlice(kFALSE),
   _mpinterl(interleave),
   _doOffset(kFALSE),
   _offset(0),
@@ -113,19 +171,24 @@ RooAbsTestStatistic::RooAbsTestStatistic(const char *name, const char *title, Ro
   _paramSet.add(*params) ;
   delete params ;
 
+  // Determine if RooAbsReal is a RooSimultaneous
+  Bool_t simMode = dynamic_cast<RooSimultaneous*>(&real)?kTRUE:kFALSE ;
+
   if (_nCPU>1 || _nCPU==-1) {
 
     if (_nCPU==-1) {
       _nCPU=1 ;
     }
 
-    _gofOpMode = MPMaster ;
+    if (!parallelInThreads()) {
+      _gofOpMode = MPMaster ;
+    } else {
+      // In threads, the components of a RooSimultaneous are split in partitions
+      _gofOpMode = simMode ? SimMaster : MTMaster ;
+    }
 
   } else {
 
-    // Determine if RooAbsReal is a RooSimultaneous
-    Bool_t simMode = dynamic_cast<RooSimultaneous*>(&real)?kTRUE:kFALSE ;
-
     if (simMode) {
       _gofOpMode = SimMaster ;
     } else {
@@ -161,6 +224,9 @@ RooAbsTestStatistic::RooAbsTestStatistic(const RooAbsTestStatistic& other, const
   _gofSplitMode(other._gofSplitMode),
   _nCPU(other._nCPU),
   _mpfeArray(0),
+  _mtSerialEval(kTRUE),
+  _mtParallel(kFALSE),
+  _dataSlice(kFALSE),
   _mpinterl(other._mpinterl),
   _doOffset(other._doOffset),
   _offset(other._offset),
@@ -170,19 +236,24 @@ RooAbsTestStatistic::RooAbsTestStatistic(const RooAbsTestStatistic& other, const
   // Our parameters are those of original
   _paramSet.add(other._paramSet) ;
 
+  // Determine if RooAbsReal is a RooSimultaneous
+  Bool_t simMode = dynamic_cast<RooSimultaneous*>(_func)?kTRUE:kFALSE ;
+
   if (_nCPU>1 || _nCPU==-1) {
 
     if (_nCPU==-1) {
       _nCPU=1 ;
     }
       
-    _gofOpMode = MPMaster ;
+    if (!parallelInThreads()) {
+      _gofOpMode = MPMaster ;
+    } else {
+      // In threads, the components of a RooSimultaneous are split in partitions
+      _gofOpMode = simMode ? SimMaster : MTMaster ;
+    }
 
   } else {
 
-    // Determine if RooAbsReal is a RooSimultaneous
-    Bool_t simMode = dynamic_cast<RooSimultaneous*>(_func)?kTRUE:kFALSE ;
-
     if (simMode) {
       _gofOpMode = SimMaster ;
     } else {
@@ -211,7 +282,7 @@ RooAbsTestStatistic::~RooAbsTestStatistic()
     delete[] _mpfeArray ;
   }
 
-  if (SimMaster == _gofOpMode && _init) {
+  if ((SimMaster == _gofOpMode || MTMaster == _gofOpMode) && _init) {
     for (Int_t i = 0; i < _nGof; ++i) delete _gofArray[i];
     delete[] _gofArray ;
   }
@@ -287,12 +358,57 @@ Double_t RooAbsTestStatistic::evaluate() const
     _evalCarry = carry;
     return ret ;
 
+  } else if (MTMaster == _gofOpMode) {
+
+    // Calculate the partitions in parallel threads, each with its own clone of the test statistic
+    vector<Double_t> values(_nGof), carries(_nGof) ;
+    auto evalPartition = [&](Int_t i) {
+      values[i] = _gofArray[i]->getValV() ;
+      carries[i] = _gofArray[i]->getCarry() ;
+    } ;
+#ifdef R__USE_IMT
+    if (_mtParallel && !_mtSerialEval && concurrentPartitionsSafe()) {
+      ROOT::TThreadExecutor pool ;
+      pool.Foreach(evalPartition, ROOT::TSeq<Int_t>(0, _nGof)) ;
+    } else
+#endif
+    {
+      // The first evaluation after a change of the configuration (re)creates the
+      // normalization integrals and caches of the clones, which registers them with
+      // the shared parameters and allocates RooArgSets: do it serially
+      for (Int_t i = 0; i < _nGof; ++i) evalPartition(i) ;
+      _mtSerialEval = kFALSE ;
+    }
+
+    // Combine the partitions in a fixed order
+    Double_t sum(0), carry = 0.;
+    for (Int_t i = 0; i < _nGof; ++i) {
+      Double_t y = values[i];
+      carry += carries[i];
+      y -= carry;
+      const Double_t t = sum + y;
+      carry = (t - sum) - y;
+      sum = t;
+    }
+
+    Double_t ret = sum ;
+    _evalCarry = carry;
+
+    if (numSets()==1) {
+      const Double_t norm = globalNormalization();
+      ret /= norm;
+      _evalCarry /= norm;
+    }
+
+    return ret ;
+
   } else {
 
     // Evaluate as straight FUNC
     Int_t nFirst(0), nLast(_nEvents), nStep(1) ;
     
-    switch (_mpinterl) {
+    // The data of a partition in multi-threaded mode only contains its own events
+    switch (_dataSlice ? RooFit::SimComponents : _mpinterl) {
     case RooFit::BulkPartition:
       nFirst = _nEvents * _setNum / _numSets ;
       nLast  = _nEvents * (_setNum+1) / _numSets ;
@@ -342,6 +458,8 @@ Bool_t RooAbsTestStatistic::initialize()
   
   if (MPMaster == _gofOpMode) {
     initMPMode(_func,_data,_projDeps,_rangeName.size()?_rangeName.c_str():0,_addCoefRangeName.size()?_addCoefRangeName.c_str():0) ;
+  } else if (MTMaster == _gofOpMode) {
+    initMTMode(_func,_data,_projDeps,_rangeName.size()?_rangeName.c_str():0,_addCoefRangeName.size()?_addCoefRangeName.c_str():0) ;
   } else if (SimMaster == _gofOpMode) {
     initSimMode((RooSimultaneous*)_func,_data,_projDeps,_rangeName.size()?_rangeName.c_str():0,_addCoefRangeName.size()?_addCoefRangeName.c_str():0) ;
   }
@@ -356,13 +474,14 @@ Bool_t RooAbsTestStatistic::initialize()
 
 Bool_t RooAbsTestStatistic::redirectServersHook(const RooAbsCollection& newServerList, Bool_t mustReplaceAll, Bool_t nameChange, Bool_t)
 {
-  if (SimMaster == _gofOpMode && _gofArray) {
+  if ((SimMaster == _gofOpMode || MTMaster == _gofOpMode) && _gofArray) {
     // Forward to slaves
     for (Int_t i = 0; i < _nGof; ++i) {
       if (_gofArray[i]) {
 	_gofArray[i]->recursiveRedirectServers(newServerList,mustReplaceAll,nameChange);
       }
     }
+    _mtSerialEval = kTRUE ;
   } else if (MPMaster == _gofOpMode&& _mpfeArray) {
     // Forward to slaves
     for (Int_t i = 0; i < _nCPU; ++i) {
@@ -383,7 +502,7 @@ Bool_t RooAbsTestStatistic::redirectServersHook(const RooAbsCollection& newServe
 
 void RooAbsTestStatistic::printCompactTreeHook(ostream& os, const char* indent)
 {
-  if (SimMaster == _gofOpMode) {
+  if (SimMaster == _gofOpMode || MTMaster == _gofOpMode) {
     // Forward to slaves
     os << indent << "RooAbsTestStatistic begin GOF contents" << endl ;
     for (Int_t i = 0; i < _nGof; ++i) {
@@ -421,6 +540,12 @@ void RooAbsTestStatistic::constOptimizeTestStatistic(ConstOpCode opcode, Bool_t
     for (Int_t i = 0; i < _nCPU; ++i) {
       _mpfeArray[i]->constOptimizeTestStatistic(opcode,doAlsoTrackingOpt);
     }
+  } else if (MTMaster == _gofOpMode) {
+    for (Int_t i = 0; i < _nGof; ++i) {
+      _gofArray[i]->constOptimizeTestStatistic(opcode,doAlsoTrackingOpt);
+    }
+    // Caches of the clones may be rebuilt at the next evaluation
+    _mtSerialEval = kTRUE ;
   }
 }
 
@@ -478,6 +603,69 @@ void RooAbsTestStatistic::initMPMode(RooAbsReal* real, RooAbsData* data, const R
 
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// Initialize multi-threaded calculation mode. Create one component test statistic
+/// per partition, each with its own clone of the function and of the dataset so that
+/// the partitions can be calculated concurrently in the threads of the ROOT thread pool.
+/// If the test statistic supports it, the dataset of each partition only contains
+/// the events of the partition. The clones share the parameters of this test statistic,
+/// which must not be modified during an evaluation.
+///
+/// Partitions are calculated one after the other if the evaluation is not thread safe,
+/// i.e. if there are projected observables, whose cache is recalculated at each
+/// evaluation, or cached p.d.f.s, whose caches are rebuilt when parameters change.
+
+void RooAbsTestStatistic::initMTMode(RooAbsReal* real, RooAbsData* data, const RooArgSet* projDeps, const char* rangeName, const char* addCoefRangeName)
+{
+  _nGof = _nCPU ;
+  _gofArray = new pRooAbsTestStatistic[_nGof] ;
+
+  const Bool_t slices = supportsDataSlices(*real,*data) ;
+  for (Int_t i = 0; i < _nGof; ++i) {
+    ccoutD(Eval) << "RooAbsTestStatistic::initMTMode: creating partition #" << i << endl;
+    // The partition clones its data, the slice is not needed afterwards
+    RooAbsData* slice = slices ? createDataSlice(*data,i,_nGof) : 0 ;
+    _gofArray[i] = create(Form("%s_GOF%d",GetName(),i),Form("%s_GOF%d",GetTitle(),i),*real,slice?*slice:*data,*projDeps,rangeName,addCoefRangeName,1,_mpinterl,_verbose,_splitRange);
+    delete slice ;
+    _gofArray[i]->recursiveRedirectServers(_paramSet);
+    _gofArray[i]->setMPSet(i,_nCPU);
+    _gofArray[i]->setSimCount(_simCount);
+    _gofArray[i]->_dataSlice = slices ;
+  }
+  if (slices) combineDataSlices() ;
+
+  _mtParallel = (projDeps->getSize()==0 && !rebuildsCachesInEvaluation(*real)) ;
+  _mtSerialEval = kTRUE ;
+  if (_mtParallel) {
+    coutI(Eval) << "RooAbsTestStatistic::initMTMode: created " << _nGof << " partitions calculated in parallel threads." << endl;
+  } else {
+    coutI(Eval) << "RooAbsTestStatistic::initMTMode: created " << _nGof << " partitions, calculated serially because "
+		<< "the evaluation of " << real->GetName() << " is not thread safe (projected observables or cached p.d.f.s)." << endl;
+  }
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return a new dataset with the events of partition inSetNum out of inNumSets
+/// of the given data, for the split strategies BulkPartition and Interleave.
+
+RooAbsData* RooAbsTestStatistic::createDataSlice(const RooAbsData& data, Int_t inSetNum, Int_t inNumSets) const
+{
+  const Int_t nEvents = data.numEntries() ;
+  if (_mpinterl==RooFit::Interleave) {
+    RooAbsData* slice = data.emptyClone() ;
+    for (Int_t i = inSetNum; i < nEvents; i += inNumSets) {
+      const RooArgSet* row = data.get(i) ;
+      slice->add(*row,data.weight()) ;
+    }
+    return slice ;
+  }
+  return const_cast<RooAbsData&>(data).reduce(RooFit::EventRange(nEvents*inSetNum/inNumSets,nEvents*(inSetNum+1)/inNumSets)) ;
+}
+
+
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Initialize simultaneous p.d.f processing mode. Strip simultaneous
 /// p.d.f into individual components, split dataset in subset
@@ -555,12 +743,17 @@ void RooAbsTestStatistic::initSimMode(RooSimultaneous* simpdf, RooAbsData* data,
       // WVE END HACK
       // Below here directly pass binnedPdf instead of PROD(binnedPdf,constraints) as constraints are evaluated elsewhere anyway
       // and omitting them reduces model complexity and associated handling/cloning times
+      // In multi-threaded mode, components that are not split in events are calculated in the calling thread
+      Int_t compCPU = _nCPU ;
+      if (_nCPU>1 && (_mpinterl==RooFit::SimComponents || (_mpinterl==RooFit::Hybrid && dset->numEntries()<10))) {
+	compCPU = 1 ;
+      }
       if (_splitRange && rangeName) {
 	_gofArray[n] = create(type->GetName(),type->GetName(),(binnedPdf?*binnedPdf:*pdf),*dset,*projDeps,
-			      Form("%s_%s",rangeName,type->GetName()),addCoefRangeName,_nCPU*(_mpinterl?-1:1),_mpinterl,_verbose,_splitRange,binnedL);
+			      Form("%s_%s",rangeName,type->GetName()),addCoefRangeName,compCPU*(_mpinterl?-1:1),_mpinterl,_verbose,_splitRange,binnedL);
       } else {
 	_gofArray[n] = create(type->GetName(),type->GetName(),(binnedPdf?*binnedPdf:*pdf),*dset,*projDeps,
-			      rangeName,addCoefRangeName,_nCPU,_mpinterl,_verbose,_splitRange,binnedL);
+			      rangeName,addCoefRangeName,compCPU,_mpinterl,_verbose,_splitRange,binnedL);
       }
       _gofArray[n]->setSimCount(_nGof);
       // *** END HERE
@@ -588,6 +781,11 @@ void RooAbsTestStatistic::initSimMode(RooSimultaneous* simpdf, RooAbsData* data,
       delete selTargetParams;
       delete actualParams;
 
+      // Components calculated in threads create their partitions now, while their data exists
+      if (MTMaster == _gofArray[n]->operMode()) {
+	_gofArray[n]->initialize() ;
+      }
+
       ++n;
 
     } else {
@@ -653,6 +851,22 @@ Bool_t RooAbsTestStatistic::setData(RooAbsData& indata, Bool_t cloneData)
       }
     }
     break;
+  case MTMaster:
+    // Forward to partitions, each of which must have its own copy of the data or of its slice
+    initialize();
+    {
+      const Bool_t slices = supportsDataSlices(*_func, indata);
+      for (Int_t i = 0; i < _nGof; ++i) {
+	RooAbsData* slice = slices ? createDataSlice(indata, i, _nGof) : 0;
+	_gofArray[i]->setData(slice ? *slice : indata, kTRUE);
+	_gofArray[i]->_dataSlice = slices;
+	delete slice;
+      }
+      if (slices) combineDataSlices();
+    }
+    setEventCount(indata.numEntries());
+    _mtSerialEval = kTRUE;
+    break;
   case MPMaster:
     // Not supported
     coutF(DataHandling) << "RooAbsTestStatistic::setData(" << GetName() << ") FATAL: setData() is not supported in multi-processor mode" << endl;
@@ -694,6 +908,13 @@ void RooAbsTestStatistic::enableOffsetting(Bool_t flag)
       _mpfeArray[i]->enableOffsetting(flag);
     }
     break;
+  case MTMaster:
+    _doOffset = flag;
+    for (Int_t i = 0; i < _nGof; ++i) {
+      _gofArray[i]->enableOffsetting(flag);
+    }
+    _mtSerialEval = kTRUE;
+    break;
   }
 }
 
@@ -860,6 +860,53 @@ Double_t RooAddPdf::evaluate() const
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// Calculate the values for a range of events of 'data': the coefficients are
+/// updated once, then the values of each component p.d.f are computed for
+/// all the events and accumulated
+
+Bool_t RooAddPdf::evaluateBatch(Double_t* output, Int_t first, Int_t n, const RooAbsData& data, const RooArgSet* nset) const
+{
+  if (nset==0 || nset->getSize()==0) {
+    if (_refCoefNorm.getSize()!=0) {
+      nset = &_refCoefNorm ;
+    }
+  }
+
+  CacheElem* cache = getProjCache(nset) ;
+  updateCoefficients(*cache,nset) ;
+
+  std::fill(output, output+n, 0.) ;
+  std::vector<Double_t> pdfVals(n), snormVals ;
+  if (cache->_needSupNorm) {
+    snormVals.resize(n) ;
+  }
+
+  RooAbsPdf* pdf ;
+  Int_t i(0) ;
+  RooFIter pi = _pdfList.fwdIterator() ;
+  while((pdf = (RooAbsPdf*)pi.next())) {
+    if (pdf->isSelectedComp()) {
+      pdf->getValBatch(&pdfVals[0], first, n, data, nset) ;
+      const Double_t coef = _coefCache[i] ;
+      if (cache->_needSupNorm) {
+        ((RooAbsReal*)cache->_suppNormList.at(i))->getValBatch(&snormVals[0], first, n, data) ;
+        for (Int_t j=0 ; j<n ; j++) {
+          output[j] += pdfVals[j]*coef/snormVals[j] ;
+        }
+      } else {
+        for (Int_t j=0 ; j<n ; j++) {
+          output[j] += pdfVals[j]*coef ;
+        }
+      }
+    }
+    i++ ;
+  }
+
+  return kTRUE ;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Reset error counter to given value, limiting the number
 /// of future error messages for this pdf to 'resetValue'
@@ -206,6 +206,7 @@ namespace RooFit {
   RooCmdArg Integrate(Bool_t flag)                       { return RooCmdArg("Integrate",flag,0,0,0,0,0,0,0) ; }
   RooCmdArg Minimizer(const char* type, const char* alg) { return RooCmdArg("Minimizer",0,0,0,0,type,alg,0,0) ; }
   RooCmdArg Offset(Bool_t flag)                          { return RooCmdArg("OffsetLikelihood",flag,0,0,0,0,0,0,0) ; }
+  RooCmdArg BatchMode(Bool_t flag)                       { return RooCmdArg("BatchMode",flag,0,0,0,0,0,0,0) ; }
 
   
   // RooAbsPdf::paramOn arguments
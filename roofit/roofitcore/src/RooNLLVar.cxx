@@ -43,8 +43,29 @@ In extended mode, a (Nexpect - Nobserved*log(NExpected) term is added
 #include "RooRealSumPdf.h"
 #include "RooRealVar.h"
 #include "RooProdPdf.h"
+#include "RooDataSet.h"
 
 ClassImp(RooNLLVar);
+
+namespace {
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return the sum of the squared weights of the events of the given dataset
+
+Double_t sumOfWeightsSquared(RooAbsData& data)
+{
+  Double_t sumW2(0), sumW2carry(0);
+  for (Int_t i=0 ; i<data.numEntries() ; i++) {
+    data.get(i);
+    Double_t y = data.weightSquared() - sumW2carry;
+    Double_t t = sumW2 + y;
+    sumW2carry = (t - sumW2) - y;
+    sumW2 = t;
+  }
+  return sumW2 ;
+}
+
+}
 ;
 
 RooArgSet RooNLLVar::_emptySet ;
@@ -89,6 +110,9 @@ RooNLLVar::RooNLLVar(const char *name, const char* title, RooAbsPdf& pdf, RooAbs
 
   _extended = pc.getInt("extended") ;
   _weightSq = kFALSE ;
+  _batchMode = kFALSE ;
+  _sumEntriesAll = 0 ;
+  _sumW2All = 0 ;
   _first = kTRUE ;
   _offset = 0.;
   _offsetCarry = 0.;
@@ -110,6 +134,8 @@ RooNLLVar::RooNLLVar(const char *name, const char *title, RooAbsPdf& pdf, RooAbs
   RooAbsOptTestStatistic(name,title,pdf,indata,RooArgSet(),rangeName,addCoefRangeName,nCPU,interleave,verbose,splitRange,cloneData),
   _extended(extended),
   _weightSq(kFALSE),
+  _batchMode(kFALSE),
+  _sumEntriesAll(0), _sumW2All(0),
   _first(kTRUE), _offsetSaveW2(0.), _offsetCarrySaveW2(0.)
 {
   // If binned likelihood flag is set, pdf is a RooRealSumPdf representing a yield vector
@@ -155,6 +181,8 @@ RooNLLVar::RooNLLVar(const char *name, const char *title, RooAbsPdf& pdf, RooAbs
   RooAbsOptTestStatistic(name,title,pdf,indata,projDeps,rangeName,addCoefRangeName,nCPU,interleave,verbose,splitRange,cloneData),
   _extended(extended),
   _weightSq(kFALSE),
+  _batchMode(kFALSE),
+  _sumEntriesAll(0), _sumW2All(0),
   _first(kTRUE), _offsetSaveW2(0.), _offsetCarrySaveW2(0.)
 {
   // If binned likelihood flag is set, pdf is a RooRealSumPdf representing a yield vector
@@ -194,6 +222,8 @@ RooNLLVar::RooNLLVar(const RooNLLVar& other, const char* name) :
   RooAbsOptTestStatistic(other,name),
   _extended(other._extended),
   _weightSq(other._weightSq),
+  _batchMode(other._batchMode),
+  _sumEntriesAll(other._sumEntriesAll), _sumW2All(other._sumW2All),
   _first(kTRUE), _offsetSaveW2(other._offsetSaveW2),
   _offsetCarrySaveW2(other._offsetCarrySaveW2),
   _binw(other._binw) {
@@ -227,9 +257,70 @@ void RooNLLVar::applyWeightSquared(Bool_t flag)
   } else if ( _gofOpMode==MPMaster) {
     for (Int_t i=0 ; i<_nCPU ; i++)
       _mpfeArray[i]->applyNLLWeightSquared(flag);
-  } else if ( _gofOpMode==SimMaster) {
+  } else if ( _gofOpMode==SimMaster || _gofOpMode==MTMaster) {
     for (Int_t i=0 ; i<_nGof ; i++)
       ((RooNLLVar*)_gofArray[i])->applyWeightSquared(flag);
+    _mtSerialEval = kTRUE ;
+  }
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// If flag is true, evaluate the p.d.f for blocks of events with
+/// RooAbsPdf::getLogValBatch() instead of event by event. The likelihood is
+/// the same, but p.d.f.s implementing RooAbsReal::evaluateBatch() are computed
+/// with loops over the columns of the dataset. Batch evaluation is only used
+/// for unbinned datasets processed in contiguous partitions.
+/// In multi-process mode, the flag must be set before the first evaluation.
+/// In multi-threaded mode, the partitions are evaluated one after the other
+/// while batch mode is on: RooAbsPdf::getValBatch() allocates RooArgSets,
+/// whose memory pool is not thread safe.
+
+void RooNLLVar::batchMode(Bool_t flag)
+{
+  _batchMode = flag ;
+  if (_gofOpMode==MPMaster && _init) {
+    coutW(Eval) << "RooNLLVar::batchMode(" << GetName() << ") WARNING: the likelihood is already evaluated by "
+		<< _nCPU << " processes, batch mode will not be changed in these processes" << std::endl ;
+  } else if ((_gofOpMode==SimMaster || _gofOpMode==MTMaster) && _init) {
+    for (Int_t i=0 ; i<_nGof ; i++)
+      ((RooNLLVar*)_gofArray[i])->batchMode(flag);
+    _mtSerialEval = kTRUE ;
+  }
+  setValueDirty() ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// In multi-threaded mode, the partitions of an unbinned likelihood only
+/// hold the events they evaluate if the data is split in blocks or
+/// interleaved.
+
+Bool_t RooNLLVar::supportsDataSlices(const RooAbsReal& real, const RooAbsData& indata) const
+{
+  return !real.getAttribute("BinnedLikelihood") && dynamic_cast<const RooDataSet*>(&indata) &&
+    (_mpinterl==RooFit::BulkPartition || _mpinterl==RooFit::Interleave) ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Pass the sums of weights over the data slices of all partitions to the
+/// partitions, for the calculation of the extended term.
+
+void RooNLLVar::combineDataSlices()
+{
+  Double_t sumEntries(0), sumW2(0) ;
+  for (Int_t i=0 ; i<_nGof ; i++) {
+    RooAbsData& sliceData = *((RooNLLVar*)_gofArray[i])->_dataClone ;
+    sumEntries += sliceData.sumEntries() ;
+    sumW2 += sumOfWeightsSquared(sliceData) ;
+  }
+  for (Int_t i=0 ; i<_nGof ; i++) {
+    ((RooNLLVar*)_gofArray[i])->_sumEntriesAll = sumEntries ;
+    ((RooNLLVar*)_gofArray[i])->_sumW2All = sumW2 ;
   }
 }
 
@@ -304,6 +395,42 @@ Double_t RooNLLVar::evaluatePartition(Int_t firstEvent, Int_t lastEvent, Int_t s
     }
 
 
+  } else if (_batchMode && stepSize==1 && dynamic_cast<RooDataSet*>(_dataClone)) {
+
+    // Evaluate the p.d.f for blocks of events, the summation is the same as below
+    const Int_t blockSize = 1024 ;
+    const Bool_t weighted = _dataClone->isWeighted() ;
+    std::vector<Double_t> logVals(std::min(blockSize,std::max(lastEvent-firstEvent,0))) ;
+
+    for (Int_t first=firstEvent ; first<lastEvent ; first+=blockSize) {
+
+      const Int_t n = std::min(blockSize,lastEvent-first) ;
+      pdfClone->getLogValBatch(&logVals[0],first,n,*_dataClone,_normSet) ;
+
+      for (Int_t j=0 ; j<n ; j++) {
+
+	Double_t eventWeight(1) ;
+	if (weighted) {
+	  _dataClone->get(first+j) ;
+	  eventWeight = _dataClone->weight();
+	  if (0. == eventWeight * eventWeight) continue ;
+	  if (_weightSq) eventWeight = _dataClone->weightSquared() ;
+	}
+
+	Double_t term = -eventWeight * logVals[j];
+
+	Double_t y = eventWeight - sumWeightCarry;
+	Double_t t = sumWeight + y;
+	sumWeightCarry = (t - sumWeight) - y;
+	sumWeight = t;
+
+	y = term - carry;
+	t = result + y;
+	carry = (t - result) - y;
+	result = t;
+      }
+    }
+
   } else {
 
     for (i=firstEvent ; i<lastEvent ; i+=stepSize) {
@@ -329,20 +456,20 @@ Double_t RooNLLVar::evaluatePartition(Int_t firstEvent, Int_t lastEvent, Int_t s
       carry = (t - result) - y;
       result = t;
     }
+  }
+
+  if (!_binnedPdf) {
 
     // include the extended maximum likelihood term, if requested
     if(_extended && _setNum==_extSet) {
+
+      // The data of a partition in multi-threaded mode only contains its own events
+      const Double_t sumEntries = _dataSlice ? _sumEntriesAll : _dataClone->sumEntries() ;
+
       if (_weightSq) {
 
 	// Calculate sum of weights-squared here for extended term
-	Double_t sumW2(0), sumW2carry(0);
-	for (i=0 ; i<_dataClone->numEntries() ; i++) {
-	  _dataClone->get(i);
-	  Double_t y = _dataClone->weightSquared() - sumW2carry;
-	  Double_t t = sumW2 + y;
-	  sumW2carry = (t - sumW2) - y;
-	  sumW2 = t;
-	}
+	Double_t sumW2 = _dataSlice ? _sumW2All : sumOfWeightsSquared(*_dataClone) ;
 
 	Double_t expected= pdfClone->expectedEvents(_dataClone->get());
 
@@ -362,7 +489,7 @@ Double_t RooNLLVar::evaluatePartition(Int_t firstEvent, Int_t lastEvent, Int_t s
         //  sum[w^2] / sum[w] * expected - sum[w^2] * log (expectedW)
         //  and since the weights are constants in the likelihood we can use log(expected) instead of log(expectedW)
 
-	Double_t expectedW2 = expected * sumW2 / _dataClone->sumEntries() ;
+	Double_t expectedW2 = expected * sumW2 / sumEntries ;
 	Double_t extra= expectedW2 - sumW2*log(expected );
 
 	// Double_t y = pdfClone->extendedTerm(sumW2, _dataClone->get()) - carry;
@@ -373,7 +500,7 @@ Double_t RooNLLVar::evaluatePartition(Int_t firstEvent, Int_t lastEvent, Int_t s
 	carry = (t - result) - y;
 	result = t;
       } else {
-	Double_t y = pdfClone->extendedTerm(_dataClone->sumEntries(), _dataClone->get()) - carry;
+	Double_t y = pdfClone->extendedTerm(sumEntries, _dataClone->get()) - carry;
 	Double_t t = result + y;
 	carry = (t - result) - y;
 	result = t;
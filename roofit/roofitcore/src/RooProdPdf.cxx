@@ -495,6 +495,61 @@ Double_t RooProdPdf::evaluate() const
 
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// Calculate the values for a range of events of 'data' as the running
+/// product of the values of the terms, each computed for all the events
+
+Bool_t RooProdPdf::evaluateBatch(Double_t* output, Int_t first, Int_t n, const RooAbsData& data, const RooArgSet* nset) const
+{
+  _curNormSet = (RooArgSet*)nset ;
+
+  Int_t code ;
+  CacheElem* cache = (CacheElem*) _cacheMgr.getObj(_curNormSet,0,&code) ;
+  if (!cache) {
+    RooArgList *plist(0) ;
+    RooLinkedList *nlist(0) ;
+    getPartIntList(_curNormSet,0,plist,nlist,code) ;
+    cache = (CacheElem*) _cacheMgr.getObj(_curNormSet,0,&code) ;
+  }
+
+  std::vector<Double_t> piVals(n) ;
+
+  if (cache->_isRearranged) {
+    cache->_rearrangedNum->getValBatch(output, first, n, data) ;
+    cache->_rearrangedDen->getValBatch(&piVals[0], first, n, data) ;
+    for (Int_t i=0 ; i<n ; i++) {
+      output[i] /= piVals[i] ;
+    }
+    return kTRUE ;
+  }
+
+  std::fill(output, output+n, 1.) ;
+  Bool_t firstTerm(kTRUE) ;
+  RooAbsReal* partInt;
+  RooArgSet* normSet;
+  RooFIter plIter = cache->_partList.fwdIterator();
+  RooFIter nlIter = cache->_normList.fwdIterator();
+  for (partInt = (RooAbsReal*) plIter.next(),
+      normSet = (RooArgSet*) nlIter.next(); partInt && normSet;
+      partInt = (RooAbsReal*) plIter.next(),
+      normSet = (RooArgSet*) nlIter.next()) {
+    partInt->getValBatch(&piVals[0], first, n, data, normSet->getSize() > 0 ? normSet : 0) ;
+    if (firstTerm) {
+      std::copy(piVals.begin(), piVals.end(), output) ;
+      firstTerm = kFALSE ;
+      continue ;
+    }
+    // Events whose running product fell below the cutoff keep their value, as in calculate()
+    for (Int_t i=0 ; i<n ; i++) {
+      if (output[i] > _cutOff) output[i] *= piVals[i] ;
+    }
+  }
+
+  return kTRUE ;
+}
+
+
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Calculate running product of pdfs terms, using the supplied
 /// normalization set in 'normSetList' for each component
@@ -631,6 +631,29 @@ Double_t RooVectorDataStore::weight(Int_t index) const
 
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// Return a pointer to the values that get(i) loads into 'real' for the
+/// events first <= i < first+n, looking also in the cache of the constant
+/// term optimizer. Return zero if 'real' is not attached to this store.
+
+const Double_t* RooVectorDataStore::getBatch(const RooAbsReal& real, Int_t first, Int_t n) const
+{
+  if (first<0 || n<=0 || first+n>_nEntries) return 0 ;
+
+  for (Int_t i=0 ; i<_nReal ; i++) {
+    const RealVector* rv = *(_firstReal+i) ;
+    if (rv->_real==&real) return rv->_vec0 + first ;
+  }
+  for (Int_t i=0 ; i<_nRealF ; i++) {
+    const RealFullVector* rv = *(_firstRealF+i) ;
+    if (rv->_real==&real) return rv->_vec0 + first ;
+  }
+
+  return _cache ? _cache->getBatch(real, first, n) : 0 ;
+}
+
+
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Return the weight of the n-th data point (n='index') in memory
 
@@ -0,0 +1,53 @@
+#include <RooRealVar.h>
+#include <RooGaussian.h>
+#include <RooExponential.h>
+#include <RooPolynomial.h>
+#include <RooAddPdf.h>
+#include <RooProdPdf.h>
+#include <RooDataSet.h>
+#include <RooGlobalFunc.h>
+
+#include <cmath>
+#include <memory>
+
+#include "gtest/gtest.h"
+
+using namespace RooFit;
+
+// The likelihood computed with batches of events must be the one computed event by event
+TEST(RooNLLVar, BatchMode)
+{
+   RooRealVar x("x", "x", -10, 10);
+   RooRealVar y("y", "y", 0, 5);
+   RooRealVar mean("mean", "mean", 1, -10, 10);
+   RooRealVar sigma("sigma", "sigma", 2, 0.1, 10);
+   RooRealVar a1("a1", "a1", 0.1, -1, 1);
+   RooRealVar c("c", "c", -0.5, -2., 0.);
+   RooRealVar frac("frac", "frac", 0.7, 0, 1);
+
+   RooGaussian gauss("gauss", "gauss", x, mean, sigma);
+   RooPolynomial poly("poly", "poly", x, RooArgList(a1));
+   RooAddPdf sum("sum", "sum", gauss, poly, frac);
+   RooExponential expo("expo", "expo", y, c);
+   RooProdPdf model("model", "model", sum, expo);
+
+   std::unique_ptr<RooDataSet> data(model.generate(RooArgSet(x, y), 3000));
+
+   for (Int_t optConst = 0; optConst < 2; ++optConst) {
+      std::unique_ptr<RooAbsReal> nll(model.createNLL(*data, Optimize(optConst)));
+      std::unique_ptr<RooAbsReal> nllBatch(model.createNLL(*data, Optimize(optConst), BatchMode()));
+
+      EXPECT_NEAR(nll->getVal(), nllBatch->getVal(), 1.E-9 * std::abs(nll->getVal()));
+
+      mean.setVal(0.5);
+      sigma.setVal(1.5);
+      frac.setVal(0.4);
+      c.setVal(-0.3);
+      EXPECT_NEAR(nll->getVal(), nllBatch->getVal(), 1.E-9 * std::abs(nll->getVal()));
+
+      mean.setVal(1);
+      sigma.setVal(2);
+      frac.setVal(0.7);
+      c.setVal(-0.5);
+   }
+}
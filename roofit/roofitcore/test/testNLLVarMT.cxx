@@ -0,0 +1,220 @@
+#include <RooRealVar.h>
+#include <RooGaussian.h>
+#include <RooExponential.h>
+#include <RooAddPdf.h>
+#include <RooExtendPdf.h>
+#include <RooFormulaVar.h>
+#include <RooSimultaneous.h>
+#include <RooCategory.h>
+#include <RooDataSet.h>
+#include <RooGlobalFunc.h>
+#include <TROOT.h>
+#include <TRandom3.h>
+
+#include <cmath>
+#include <memory>
+
+#include "gtest/gtest.h"
+
+using namespace RooFit;
+
+#ifdef R__USE_IMT
+// With implicit multi-threading enabled, NumCPU() calculates the partitions of the likelihood in threads
+TEST(RooNLLVar, NumCPUThreads)
+{
+   RooRealVar x("x", "x", 0, 10);
+   RooRealVar mean("mean", "mean", 5, 0, 10);
+   RooRealVar sigma("sigma", "sigma", 1, 0.1, 10);
+   RooRealVar c("c", "c", -0.3, -2., 0.);
+   RooRealVar nsig("nsig", "nsig", 500, 0, 5000);
+   RooRealVar nbkg("nbkg", "nbkg", 1500, 0, 5000);
+
+   RooGaussian gauss("gauss", "gauss", x, mean, sigma);
+   RooExponential expo("expo", "expo", x, c);
+   RooAddPdf model("model", "model", RooArgList(gauss, expo), RooArgList(nsig, nbkg));
+
+   std::unique_ptr<RooDataSet> data(model.generate(x, 2000));
+   std::unique_ptr<RooAbsReal> nll(model.createNLL(*data));
+   const Double_t ref1 = nll->getVal();
+   mean.setVal(4.5);
+   nsig.setVal(600);
+   const Double_t ref2 = nll->getVal();
+   mean.setVal(5);
+   nsig.setVal(500);
+
+   ROOT::EnableImplicitMT(4);
+   for (Int_t strat = 0; strat < 2; ++strat) {
+      std::unique_ptr<RooAbsReal> nllMT(model.createNLL(*data, NumCPU(4, strat)));
+      // The first evaluation is serial, the next ones are parallel
+      EXPECT_NEAR(ref1, nllMT->getVal(), 1.E-9 * std::abs(ref1));
+      mean.setVal(4.5);
+      nsig.setVal(600);
+      EXPECT_NEAR(ref2, nllMT->getVal(), 1.E-9 * std::abs(ref2));
+      mean.setVal(5);
+      nsig.setVal(500);
+      EXPECT_NEAR(ref1, nllMT->getVal(), 1.E-9 * std::abs(ref1));
+   }
+   ROOT::DisableImplicitMT();
+}
+
+// The components of a RooSimultaneous are calculated one after the other, each in parallel partitions. With the
+// Hybrid strategy, components with few events are not split.
+TEST(RooNLLVar, NumCPUThreadsSimultaneous)
+{
+   RooRealVar x("x", "x", 0, 10);
+   RooRealVar mean("mean", "mean", 5, 0, 10);
+   RooRealVar sigma("sigma", "sigma", 1, 0.1, 10);
+   RooRealVar c("c", "c", -0.3, -2., 0.);
+   RooRealVar nsig("nsig", "nsig", 500, 0, 5000);
+   RooRealVar nbkg("nbkg", "nbkg", 1500, 0, 5000);
+   RooRealVar nctl("nctl", "nctl", 5, 0, 100);
+
+   RooGaussian gauss("gauss", "gauss", x, mean, sigma);
+   RooExponential expo("expo", "expo", x, c);
+   RooAddPdf model("model", "model", RooArgList(gauss, expo), RooArgList(nsig, nbkg));
+   RooExtendPdf control("control", "control", expo, nctl);
+
+   RooCategory cat("cat", "cat");
+   cat.defineType("signal");
+   cat.defineType("control");
+   RooSimultaneous simPdf("simPdf", "simPdf", cat);
+   simPdf.addPdf(model, "signal");
+   simPdf.addPdf(control, "control");
+
+   std::unique_ptr<RooDataSet> dataSig(model.generate(x, 2000));
+   std::unique_ptr<RooDataSet> dataCtl(expo.generate(x, 5));
+   RooDataSet data("data", "data", x, Index(cat), Import("signal", *dataSig), Import("control", *dataCtl));
+
+   std::unique_ptr<RooAbsReal> nll(simPdf.createNLL(data, Extended()));
+   const Double_t ref1 = nll->getVal();
+   mean.setVal(4.5);
+   c.setVal(-0.4);
+   const Double_t ref2 = nll->getVal();
+   mean.setVal(5);
+   c.setVal(-0.3);
+
+   ROOT::EnableImplicitMT(4);
+   for (Int_t strat : {0, 1, 3}) {
+      std::unique_ptr<RooAbsReal> nllMT(simPdf.createNLL(data, Extended(), NumCPU(4, strat)));
+      EXPECT_NEAR(ref1, nllMT->getVal(), 1.E-9 * std::abs(ref1));
+      mean.setVal(4.5);
+      c.setVal(-0.4);
+      EXPECT_NEAR(ref2, nllMT->getVal(), 1.E-9 * std::abs(ref2));
+      mean.setVal(5);
+      c.setVal(-0.3);
+      EXPECT_NEAR(ref1, nllMT->getVal(), 1.E-9 * std::abs(ref1));
+   }
+   ROOT::DisableImplicitMT();
+}
+
+// With conditional observables the partitions are calculated serially, the result must not change
+TEST(RooNLLVar, NumCPUThreadsConditional)
+{
+   RooRealVar x("x", "x", -10, 10);
+   RooRealVar y("y", "y", 0, 1);
+   RooRealVar a("a", "a", 2, -5, 5);
+   RooRealVar sigma("sigma", "sigma", 1, 0.1, 10);
+   RooFormulaVar mu("mu", "a*y", RooArgList(a, y));
+   RooGaussian gauss("gauss", "gauss", x, mu, sigma);
+
+   TRandom3 rng(1234);
+   RooDataSet data("data", "data", RooArgSet(x, y));
+   for (Int_t i = 0; i < 1000; ++i) {
+      y.setVal(rng.Uniform(0., 1.));
+      x.setVal(rng.Gaus(2. * y.getVal(), 1.));
+      data.add(RooArgSet(x, y));
+   }
+
+   std::unique_ptr<RooAbsReal> nll(gauss.createNLL(data, ConditionalObservables(y)));
+   const Double_t ref1 = nll->getVal();
+   a.setVal(1.5);
+   const Double_t ref2 = nll->getVal();
+   a.setVal(2);
+
+   ROOT::EnableImplicitMT(4);
+   for (Int_t strat = 0; strat < 2; ++strat) {
+      std::unique_ptr<RooAbsReal> nllMT(gauss.createNLL(data, ConditionalObservables(y), NumCPU(4, strat)));
+      EXPECT_NEAR(ref1, nllMT->getVal(), 1.E-9 * std::abs(ref1));
+      a.setVal(1.5);
+      EXPECT_NEAR(ref2, nllMT->getVal(), 1.E-9 * std::abs(ref2));
+      a.setVal(2);
+      EXPECT_NEAR(ref1, nllMT->getVal(), 1.E-9 * std::abs(ref1));
+   }
+   ROOT::DisableImplicitMT();
+}
+
+// Each partition offsets its own value, the sum must equal the offset serial likelihood
+TEST(RooNLLVar, NumCPUThreadsOffset)
+{
+   RooRealVar x("x", "x", 0, 10);
+   RooRealVar mean("mean", "mean", 5, 0, 10);
+   RooRealVar sigma("sigma", "sigma", 1, 0.1, 10);
+   RooRealVar c("c", "c", -0.3, -2., 0.);
+   RooRealVar nsig("nsig", "nsig", 500, 0, 5000);
+   RooRealVar nbkg("nbkg", "nbkg", 1500, 0, 5000);
+
+   RooGaussian gauss("gauss", "gauss", x, mean, sigma);
+   RooExponential expo("expo", "expo", x, c);
+   RooAddPdf model("model", "model", RooArgList(gauss, expo), RooArgList(nsig, nbkg));
+
+   std::unique_ptr<RooDataSet> data(model.generate(x, 2000));
+   std::unique_ptr<RooAbsReal> nll(model.createNLL(*data, Offset()));
+   const Double_t ref1 = nll->getVal();
+   mean.setVal(4.5);
+   nsig.setVal(600);
+   const Double_t ref2 = nll->getVal();
+   mean.setVal(5);
+   nsig.setVal(500);
+
+   ROOT::EnableImplicitMT(4);
+   for (Int_t strat = 0; strat < 2; ++strat) {
+      std::unique_ptr<RooAbsReal> nllMT(model.createNLL(*data, Offset(), NumCPU(4, strat)));
+      EXPECT_NEAR(ref1, nllMT->getVal(), 1.E-7);
+      mean.setVal(4.5);
+      nsig.setVal(600);
+      EXPECT_NEAR(ref2, nllMT->getVal(), 1.E-7);
+      mean.setVal(5);
+      nsig.setVal(500);
+      EXPECT_NEAR(ref1, nllMT->getVal(), 1.E-7);
+   }
+   ROOT::DisableImplicitMT();
+}
+
+// In batch mode the partitions are evaluated serially, the result must be the same as in the default mode
+TEST(RooNLLVar, NumCPUThreadsBatchMode)
+{
+   RooRealVar x("x", "x", 0, 10);
+   RooRealVar mean("mean", "mean", 5, 0, 10);
+   RooRealVar sigma("sigma", "sigma", 1, 0.1, 10);
+   RooRealVar c("c", "c", -0.3, -2., 0.);
+   RooRealVar nsig("nsig", "nsig", 500, 0, 5000);
+   RooRealVar nbkg("nbkg", "nbkg", 1500, 0, 5000);
+
+   RooGaussian gauss("gauss", "gauss", x, mean, sigma);
+   RooExponential expo("expo", "expo", x, c);
+   RooAddPdf model("model", "model", RooArgList(gauss, expo), RooArgList(nsig, nbkg));
+
+   std::unique_ptr<RooDataSet> data(model.generate(x, 2000));
+   std::unique_ptr<RooAbsReal> nll(model.createNLL(*data));
+   const Double_t ref1 = nll->getVal();
+   mean.setVal(4.5);
+   nsig.setVal(600);
+   const Double_t ref2 = nll->getVal();
+   mean.setVal(5);
+   nsig.setVal(500);
+
+   ROOT::EnableImplicitMT(4);
+   for (Int_t strat = 0; strat < 2; ++strat) {
+      std::unique_ptr<RooAbsReal> nllMT(model.createNLL(*data, NumCPU(4, strat), BatchMode()));
+      for (Int_t i = 0; i < 3; ++i) {
+         EXPECT_NEAR(ref1, nllMT->getVal(), 1.E-9 * std::abs(ref1));
+         mean.setVal(4.5);
+         nsig.setVal(600);
+         EXPECT_NEAR(ref2, nllMT->getVal(), 1.E-9 * std::abs(ref2));
+         mean.setVal(5);
+         nsig.setVal(500);
+      }
+   }
+   ROOT::DisableImplicitMT();
+}
+#endif
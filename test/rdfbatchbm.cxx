@@ -0,0 +1,108 @@
+// @(#)root/test:$Id$
+
+#include <stdlib.h>
+
+#include "Riostream.h"
+#include "ROOT/RDataFrame.hxx"
+#include "TH1D.h"
+#include "TRandom3.h"
+#include "TStopwatch.h"
+#include "TTree.h"
+//
+// This program benchmarks the RDataFrame event loop in its default mode, which runs the
+// actions entry by entry, against its batch mode (RDataFrame::SetBatchSize), in which
+// Count, Sum and Histo1D receive the filter mask and contiguous column buffers of a
+// whole batch of entries.
+//
+// Usage: rdfbatchbm -h                          - to print a usage info
+//        rdfbatchbm [nentries] [batchsize]      - to run the benchmark
+//
+// parameters:
+//       nentries      - number of entries of the in-memory tree
+//       batchsize     - number of entries per batch in batch mode
+//
+
+using std::cout;
+using std::endl;
+
+int nentries  = 2000000;  // Number of entries of the tree.
+int batchsize = 1024;     // Number of entries per batch.
+
+//______________________________________________________________________________
+struct Results {
+   ULong64_t fCount;
+   double fSum;
+   double fMean;
+   double fWeightedIntegral;
+};
+
+//______________________________________________________________________________
+Results Run(TTree &tree, unsigned int batchSize)
+{
+   ROOT::RDataFrame d(tree);
+   if (batchSize)
+      d.SetBatchSize(batchSize);
+   auto f = d.Filter([](int n) { return n > 1; }, {"n"});
+   auto count = f.Count();
+   auto sum = f.Sum<double>("x");
+   auto h = f.Histo1D<double>("x");
+   auto hm = f.Histo1D<double>({"hm", "hm", 100, -5., 5.}, "x");
+   auto hw = f.Histo1D<double, float>({"hw", "hw", 100, -5., 5.}, "x", "w");
+   Results r;
+   r.fCount = *count;
+   r.fSum = *sum;
+   r.fMean = h->GetMean();
+   r.fWeightedIntegral = hw->Integral() + hm->Integral();
+   return r;
+}
+
+//______________________________________________________________________________
+int main(int argc, char **argv)
+{
+   if (argc > 1 && argv[1][0] == '-') {
+      cout << "Usage: rdfbatchbm [nentries] [batchsize]" << endl;
+      return 0;
+   }
+   if (argc > 1)
+      nentries = atoi(argv[1]);
+   if (argc > 2)
+      batchsize = atoi(argv[2]);
+
+   TTree tree("t", "t");
+   tree.SetDirectory(nullptr);
+   double x;
+   float w;
+   int n;
+   tree.Branch("x", &x);
+   tree.Branch("w", &w);
+   tree.Branch("n", &n);
+   TRandom3 rnd(1);
+   for (int i = 0; i < nentries; ++i) {
+      x = rnd.Gaus();
+      w = 0.25 * (i % 4);
+      n = i % 10;
+      tree.Fill();
+   }
+
+   TStopwatch timer;
+   timer.Start();
+   const auto ref = Run(tree, 0);
+   timer.Stop();
+   const auto tDefault = timer.RealTime();
+   timer.Start();
+   const auto res = Run(tree, batchsize);
+   timer.Stop();
+   const auto tBatch = timer.RealTime();
+
+   cout << "rdfbatchbm: " << nentries << " entries, batch size " << batchsize << endl;
+   cout << "  default mode: " << tDefault << " s" << endl;
+   cout << "  batch mode:   " << tBatch << " s" << endl;
+
+   // both modes add the values in the same order: the results must be identical
+   if (ref.fCount != res.fCount || ref.fSum != res.fSum || ref.fMean != res.fMean ||
+       ref.fWeightedIntegral != res.fWeightedIntegral) {
+      cout << "rdfbatchbm: the results of the two modes differ" << endl;
+      return 1;
+   }
+   return 0;
+}
@@ -0,0 +1,109 @@
+// @(#)root/test:$Id$
+
+#include <stdlib.h>
+#include <cmath>
+
+#include "Riostream.h"
+#include "TRandom3.h"
+#include "TStopwatch.h"
+#include "TTree.h"
+#include "TTreeFormula.h"
+//
+// This program benchmarks the evaluation of TTreeFormula expressions by the
+// interpreter against their compiled version (TTreeFormula::SetJitExpressions).
+// The compiled expressions read the scalar leaves directly from their buffers,
+// the branches are loaded by TTreeFormula in both cases.
+//
+// Usage: treeformulajitbm -h                  - to print a usage info
+//        treeformulajitbm [nentries] [nloop]  - to run the benchmark
+//
+// parameters:
+//       nentries      - number of entries of the in-memory tree
+//       nloop         - number of passes over the entries for each expression
+//
+
+using std::cout;
+using std::endl;
+
+int nentries = 200000; // Number of entries of the tree.
+int nloop    = 10;     // Number of passes over the entries.
+
+const char *gExpressions[] = {
+   "x + y",
+   "x*y + z*w - 3*n",
+   "sqrt(x*x + y*y + z*z) * (n > 2 && w < 0.5)",
+   "sin(x)*cos(y) + exp(-abs(z)) + log(1 + w*w) + atan2(y, x)",
+   "((n & 3) == 1) * pow(x, 2) + min(y, z) - max(w, x) + fmod(z, 0.3)"
+};
+
+//______________________________________________________________________________
+double Run(TTree &tree, const char *expr, bool jit, double &sum)
+{
+   TTreeFormula::SetJitExpressions(jit);
+   TTreeFormula form("form", expr, &tree);
+   if (jit && !form.IsJitted())
+      cout << "treeformulajitbm: " << expr << " is not compiled" << endl;
+
+   TStopwatch timer;
+   timer.Start();
+   sum = 0;
+   const Long64_t entries = tree.GetEntries();
+   for (int l = 0; l < nloop; ++l) {
+      for (Long64_t e = 0; e < entries; ++e) {
+         tree.LoadTree(e);
+         sum += form.EvalInstance();
+      }
+   }
+   timer.Stop();
+   return timer.RealTime();
+}
+
+//______________________________________________________________________________
+int main(int argc, char **argv)
+{
+   if (argc > 1 && argv[1][0] == '-') {
+      cout << "Usage: treeformulajitbm [nentries] [nloop]" << endl;
+      return 0;
+   }
+   if (argc > 1)
+      nentries = atoi(argv[1]);
+   if (argc > 2)
+      nloop = atoi(argv[2]);
+
+   TTree tree("t", "t");
+   tree.SetDirectory(nullptr);
+   double x, y;
+   float z, w;
+   int n;
+   tree.Branch("x", &x);
+   tree.Branch("y", &y);
+   tree.Branch("z", &z);
+   tree.Branch("w", &w);
+   tree.Branch("n", &n);
+   TRandom3 rnd(1);
+   for (int i = 0; i < nentries; ++i) {
+      x = rnd.Gaus();
+      y = rnd.Gaus();
+      z = rnd.Uniform(-1, 1);
+      w = rnd.Rndm();
+      n = i % 10;
+      tree.Fill();
+   }
+
+   cout << "treeformulajitbm: " << nentries << " entries, " << nloop << " passes" << endl;
+   int status = 0;
+   for (auto expr : gExpressions) {
+      double sumInterpreted, sumJitted;
+      const double tInterpreted = Run(tree, expr, false, sumInterpreted);
+      const double tJitted = Run(tree, expr, true, sumJitted);
+      cout << "  " << expr << endl;
+      cout << "     interpreted: " << tInterpreted << " s, compiled: " << tJitted << " s" << endl;
+      // the compiled code calls the same functions in the same order
+      if (std::abs(sumInterpreted - sumJitted) > 1e-12 * std::abs(sumInterpreted)) {
+         cout << "treeformulajitbm: the results differ (" << sumInterpreted << " vs " << sumJitted << ")" << endl;
+         status = 1;
+      }
+   }
+   TTreeFormula::SetJitExpressions(false);
+   return status;
+}
@@ -0,0 +1,41 @@
+/*************************************************************************
+ * Copyright (C) 1995-2018, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef ROOT_RCACHEOPTIONS
+#define ROOT_RCACHEOPTIONS
+
+#include <Compression.h>
+#include <RtypesCore.h>
+#include <string>
+
+namespace ROOT {
+
+namespace RDF {
+/// A collection of options to steer the storage of the columns cached in memory
+struct RCacheOptions {
+   using ECAlgo = ::ROOT::ECompressionAlgorithm;
+   RCacheOptions() = default;
+   RCacheOptions(const RCacheOptions &) = default;
+   RCacheOptions(RCacheOptions &&) = default;
+   RCacheOptions(ULong64_t memoryBudget, ECAlgo comprAlgo, int comprLevel, unsigned int chunkSize)
+      : fMemoryBudget(memoryBudget), fCompressionAlgorithm(comprAlgo), fCompressionLevel(comprLevel),
+        fChunkSize(chunkSize)
+   {
+   }
+   /// Maximum number of bytes of cached data kept in memory, 0 means no limit. Chunks which do not fit in the budget
+   /// are spilled to a temporary file, which is removed when the cached dataset is deleted
+   ULong64_t fMemoryBudget = 0;
+   ECAlgo fCompressionAlgorithm = ROOT::kLZ4; ///< Compression algorithm of the cached chunks
+   int fCompressionLevel = 0;                 ///< Compression level of the cached chunks, 0 to store them uncompressed
+   unsigned int fChunkSize = 10000;           ///< Number of entries per chunk, the unit of compression and of work
+   std::string fSpillDirectory;               ///< Directory of the spill file, the system temporary directory if empty
+};
+} // ns RDF
+} // ns ROOT
+
+#endif
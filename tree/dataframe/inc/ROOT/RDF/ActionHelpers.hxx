@@ -14,6 +14,7 @@
 #include <algorithm>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <stack>
 #include <stdexcept>
 #include <string>
@@ -38,12 +39,18 @@
 #include "TDirectory.h"
 #include "TFile.h" // for SnapshotHelper
 #include "TH1.h"
+#include "TH1ConcurrentFill.h"
+#include "TH2.h"
+#include "TH3.h"
 #include "TGraph.h"
 #include "TLeaf.h"
+#include "TMemFile.h" // for SnapshotHelperMT
 #include "TObjArray.h"
 #include "TObject.h"
+#include "TROOT.h" // for SnapshotHelperMT
 #include "TTree.h"
 #include "TTreeReader.h" // for SnapshotHelper
+#include "TVirtualMutex.h" // for SnapshotHelperMT
 
 /// \cond HIDDEN_SYMBOLS
 
@@ -122,6 +129,7 @@ public:
    CountHelper(const CountHelper &) = delete;
    void InitTask(TTreeReader *, unsigned int) {}
    void Exec(unsigned int slot);
+   void BatchExec(unsigned int slot, unsigned int n, const char *mask);
    void Initialize() { /* noop */}
    void Finalize();
    ULong64_t &PartialUpdate(unsigned int slot);
@@ -184,6 +192,38 @@ public:
    void Exec(unsigned int slot, double v);
    void Exec(unsigned int slot, double v, double w);
 
+   /// Batch mode: buffer the values of the entries selected by `mask`
+   template <typename T, typename std::enable_if<std::is_arithmetic<T>::value, int>::type = 0>
+   void BatchExec(unsigned int slot, unsigned int n, const char *mask, const T *vs)
+   {
+      auto &thisBuf = fBuffers[slot];
+      auto thisMin = fMin[slot];
+      auto thisMax = fMax[slot];
+      for (auto i = 0u; i < n; ++i) {
+         if (mask[i]) {
+            const BufEl_t v = vs[i];
+            thisMin = std::min(thisMin, v);
+            thisMax = std::max(thisMax, v);
+            thisBuf.emplace_back(v);
+         }
+      }
+      fMin[slot] = thisMin;
+      fMax[slot] = thisMax;
+   }
+
+   /// Batch mode: buffer the values and weights of the entries selected by `mask`
+   template <typename T, typename W,
+             typename std::enable_if<std::is_arithmetic<T>::value && std::is_arithmetic<W>::value, int>::type = 0>
+   void BatchExec(unsigned int slot, unsigned int n, const char *mask, const T *vs, const W *ws)
+   {
+      BatchExec(slot, n, mask, vs);
+      auto &thisWBuf = fWBuffers[slot];
+      for (auto i = 0u; i < n; ++i) {
+         if (mask[i])
+            thisWBuf.emplace_back(ws[i]);
+      }
+   }
+
    template <typename T, typename std::enable_if<IsContainer<T>::value, int>::type = 0>
    void Exec(unsigned int slot, const T &vs)
    {
@@ -233,15 +273,102 @@ FillHelper::Exec(unsigned int, const std::vector<unsigned int> &, const std::vec
 
 template <typename HIST = Hist_t>
 class FillParHelper : public RActionImpl<FillParHelper<HIST>> {
+   /// TH1D, TH2D and TH3D are filled with their vectorized FillN: the values of the entries of each slot are buffered,
+   /// interleaved, and passed to FillN every fgBufSize entries. Other types, e.g. profiles, are filled entry by entry.
+   static constexpr bool fgIsBuffered =
+      std::is_same<HIST, ::TH1D>::value || std::is_same<HIST, ::TH2D>::value || std::is_same<HIST, ::TH3D>::value;
+   static constexpr unsigned int fgBufSize = 1024;
+   /// Above this number of cells in the per-slot copies, the slots fill the result concurrently instead
+   static constexpr ULong64_t fgMaxCopiedCells = 4 * 1024 * 1024;
+
+   struct RBuffer {
+      std::vector<double> fValues;
+      unsigned int fNColumns = 0;
+   };
+
    std::vector<HIST *> fObjects;
+   std::vector<RBuffer> fBuffers;
+   /// Non-null if the slots fill fObjects[0] concurrently, each with its filler, rather than a copy each
+   std::unique_ptr<ROOT::TH1ConcurrentFillManager> fManager;
+   std::vector<ROOT::TH1ConcurrentFiller> fFillers;
+   /// Copies of the concurrently filled result, passed to the callbacks of partial results
+   Results<std::unique_ptr<HIST>> fPartialHists;
+
+   // The buffered values are (x) or (x, w) for TH1D, (x, y) or (x, y, w) for TH2D and so on.
+   static void FillN(::TH1D &h, Int_t n, const double *v, unsigned int ncols)
+   {
+      h.FillN(n, v, ncols > 1 ? v + 1 : nullptr, ncols);
+   }
+   static void FillN(::TH2D &h, Int_t n, const double *v, unsigned int ncols)
+   {
+      h.FillN(n, v, v + 1, ncols > 2 ? v + 2 : nullptr, ncols);
+   }
+   static void FillN(::TH3D &h, Int_t n, const double *v, unsigned int ncols)
+   {
+      h.FillN(n, v, v + 1, v + 2, ncols > 3 ? v + 3 : nullptr, ncols);
+   }
+   template <typename H>
+   static void FillN(H &, Int_t, const double *, unsigned int)
+   {
+      // never called: only the types above are buffered
+   }
+
+   template <typename... Xs>
+   void Fill(std::true_type /*isBuffered*/, unsigned int slot, Xs... xs)
+   {
+      if (fManager) {
+         fFillers[slot].Fill(xs...);
+         return;
+      }
+      auto &buffer = fBuffers[slot];
+      const double values[] = {double(xs)...};
+      buffer.fNColumns = sizeof...(Xs);
+      buffer.fValues.insert(buffer.fValues.end(), values, values + sizeof...(Xs));
+      if (buffer.fValues.size() >= fgBufSize * sizeof...(Xs))
+         Flush(slot);
+   }
+
+   template <typename... Xs>
+   void Fill(std::false_type /*isBuffered*/, unsigned int slot, Xs... xs)
+   {
+      fObjects[slot]->Fill(xs...);
+   }
+
+   template <typename... Xs>
+   void Fill(unsigned int slot, Xs... xs)
+   {
+      Fill(std::integral_constant<bool, fgIsBuffered>(), slot, xs...);
+   }
+
+   /// Fill the histogram of the slot with the buffered entries
+   void Flush(unsigned int slot)
+   {
+      if (fManager) {
+         fFillers[slot].Flush();
+         return;
+      }
+      auto &buffer = fBuffers[slot];
+      if (buffer.fValues.empty())
+         return;
+      FillN(*fObjects[slot], buffer.fValues.size() / buffer.fNColumns, buffer.fValues.data(), buffer.fNColumns);
+      buffer.fValues.clear();
+   }
 
 public:
    FillParHelper(FillParHelper &&) = default;
    FillParHelper(const FillParHelper &) = delete;
 
-   FillParHelper(const std::shared_ptr<HIST> &h, const unsigned int nSlots) : fObjects(nSlots, nullptr)
+   FillParHelper(const std::shared_ptr<HIST> &h, const unsigned int nSlots)
+      : fObjects(nSlots, nullptr), fBuffers(fgIsBuffered ? nSlots : 0)
    {
       fObjects[0] = h.get();
+      if (fgIsBuffered && nSlots > 1 && ULong64_t(h->GetNcells()) * (nSlots - 1) > fgMaxCopiedCells) {
+         fManager.reset(new ROOT::TH1ConcurrentFillManager(*h));
+         for (unsigned int i = 0; i < nSlots; ++i)
+            fFillers.emplace_back(fManager->MakeFiller());
+         fPartialHists.resize(nSlots);
+         return;
+      }
       // Initialise all other slots
       for (unsigned int i = 1; i < nSlots; ++i) {
          fObjects[i] = new HIST(*fObjects[0]);
@@ -253,30 +380,65 @@ public:
 
    void Exec(unsigned int slot, double x0) // 1D histos
    {
-      fObjects[slot]->Fill(x0);
+      Fill(slot, x0);
    }
 
    void Exec(unsigned int slot, double x0, double x1) // 1D weighted and 2D histos
    {
-      fObjects[slot]->Fill(x0, x1);
+      Fill(slot, x0, x1);
    }
 
    void Exec(unsigned int slot, double x0, double x1, double x2) // 2D weighted and 3D histos
    {
-      fObjects[slot]->Fill(x0, x1, x2);
+      Fill(slot, x0, x1, x2);
    }
 
    void Exec(unsigned int slot, double x0, double x1, double x2, double x3) // 3D weighted histos
    {
-      fObjects[slot]->Fill(x0, x1, x2, x3);
+      Fill(slot, x0, x1, x2, x3);
+   }
+
+   template <bool...>
+   struct RBoolPack {};
+   // true if all Xs are arithmetic types, i.e. can be passed to BatchExec
+   template <typename... Xs>
+   using AreArithmetic_t = std::is_same<RBoolPack<std::is_arithmetic<Xs>::value..., true>,
+                                        RBoolPack<true, std::is_arithmetic<Xs>::value...>>;
+
+   /// Batch mode: fill the histogram with the entries selected by `mask`, with one array of values per column.
+   /// The values are buffered and passed to FillN as by Exec, without going through Exec for each entry.
+   template <typename... Xs,
+             typename std::enable_if<fgIsBuffered && (sizeof...(Xs) >= 1 && sizeof...(Xs) <= 4) &&
+                                        AreArithmetic_t<Xs...>::value,
+                                     int>::type = 0>
+   void BatchExec(unsigned int slot, unsigned int n, const char *mask, const Xs *... xs)
+   {
+      if (fManager) {
+         auto &filler = fFillers[slot];
+         for (auto i = 0u; i < n; ++i) {
+            if (mask[i])
+               filler.Fill(double(xs[i])...);
+         }
+         return;
+      }
+      constexpr unsigned int nColumns = sizeof...(Xs);
+      auto &buffer = fBuffers[slot];
+      buffer.fNColumns = nColumns;
+      for (auto i = 0u; i < n; ++i) {
+         if (mask[i]) {
+            const double values[] = {double(xs[i])...};
+            buffer.fValues.insert(buffer.fValues.end(), values, values + nColumns);
+         }
+      }
+      if (buffer.fValues.size() >= fgBufSize * nColumns)
+         Flush(slot);
    }
 
    template <typename X0, typename std::enable_if<IsContainer<X0>::value, int>::type = 0>
    void Exec(unsigned int slot, const X0 &x0s)
    {
-      auto thisSlotH = fObjects[slot];
       for (auto &x0 : x0s) {
-         thisSlotH->Fill(x0); // TODO: Can be optimised in case T == vector<double>
+         Fill(slot, x0);
       }
    }
 
@@ -284,7 +446,6 @@ public:
              typename std::enable_if<IsContainer<X0>::value && IsContainer<X1>::value, int>::type = 0>
    void Exec(unsigned int slot, const X0 &x0s, const X1 &x1s)
    {
-      auto thisSlotH = fObjects[slot];
       if (x0s.size() != x1s.size()) {
          throw std::runtime_error("Cannot fill histogram with values in containers of different sizes.");
       }
@@ -292,7 +453,7 @@ public:
       const auto x0sEnd = std::end(x0s);
       auto x1sIt = std::begin(x1s);
       for (; x0sIt != x0sEnd; x0sIt++, x1sIt++) {
-         thisSlotH->Fill(*x0sIt, *x1sIt); // TODO: Can be optimised in case T == vector<double>
+         Fill(slot, *x0sIt, *x1sIt);
       }
    }
 
@@ -301,7 +462,6 @@ public:
                                      int>::type = 0>
    void Exec(unsigned int slot, const X0 &x0s, const X1 &x1s, const X2 &x2s)
    {
-      auto thisSlotH = fObjects[slot];
       if (!(x0s.size() == x1s.size() && x1s.size() == x2s.size())) {
          throw std::runtime_error("Cannot fill histogram with values in containers of different sizes.");
       }
@@ -310,7 +470,7 @@ public:
       auto x1sIt = std::begin(x1s);
       auto x2sIt = std::begin(x2s);
       for (; x0sIt != x0sEnd; x0sIt++, x1sIt++, x2sIt++) {
-         thisSlotH->Fill(*x0sIt, *x1sIt, *x2sIt); // TODO: Can be optimised in case T == vector<double>
+         Fill(slot, *x0sIt, *x1sIt, *x2sIt);
       }
    }
    template <typename X0, typename X1, typename X2, typename X3,
@@ -319,7 +479,6 @@ public:
                                      int>::type = 0>
    void Exec(unsigned int slot, const X0 &x0s, const X1 &x1s, const X2 &x2s, const X3 &x3s)
    {
-      auto thisSlotH = fObjects[slot];
       if (!(x0s.size() == x1s.size() && x1s.size() == x2s.size() && x1s.size() == x3s.size())) {
          throw std::runtime_error("Cannot fill histogram with values in containers of different sizes.");
       }
@@ -329,14 +488,25 @@ public:
       auto x2sIt = std::begin(x2s);
       auto x3sIt = std::begin(x3s);
       for (; x0sIt != x0sEnd; x0sIt++, x1sIt++, x2sIt++, x3sIt++) {
-         thisSlotH->Fill(*x0sIt, *x1sIt, *x2sIt, *x3sIt); // TODO: Can be optimised in case T == vector<double>
+         Fill(slot, *x0sIt, *x1sIt, *x2sIt, *x3sIt);
       }
    }
 
    void Initialize() { /* noop */}
 
+   void FinalizeTask(unsigned int slot)
+   {
+      if (fgIsBuffered)
+         Flush(slot);
+   }
+
    void Finalize()
    {
+      for (unsigned int slot = 0; slot < fBuffers.size(); ++slot)
+         Flush(slot);
+      if (fManager)
+         return;
+
       auto resObj = fObjects[0];
       const auto nSlots = fObjects.size();
       TList l;
@@ -348,7 +518,18 @@ public:
       resObj->Merge(&l);
    }
 
-   HIST &PartialUpdate(unsigned int slot) { return *fObjects[slot]; }
+   HIST &PartialUpdate(unsigned int slot)
+   {
+      if (fgIsBuffered)
+         Flush(slot);
+      if (fManager) {
+         std::lock_guard<ROOT::TH1ConcurrentFillManager> lock(*fManager);
+         fPartialHists[slot].reset(new HIST(*fObjects[0]));
+         fPartialHists[slot]->SetDirectory(nullptr);
+         return *fPartialHists[slot];
+      }
+      return *fObjects[slot];
+   }
 
    std::string GetActionName() { return "FillPar"; }
 };
@@ -711,6 +892,19 @@ public:
    void InitTask(TTreeReader *, unsigned int) {}
    void Exec(unsigned int slot, ResultType v) { fSums[slot] += v; }
 
+   /// Batch mode: add the values of the entries selected by `mask`, in the same order as Exec
+   template <typename T, typename std::enable_if<std::is_arithmetic<T>::value && std::is_arithmetic<ResultType>::value,
+                                                 int>::type = 0>
+   void BatchExec(unsigned int slot, unsigned int n, const char *mask, const T *vs)
+   {
+      auto sum = fSums[slot];
+      for (auto i = 0u; i < n; ++i) {
+         if (mask[i])
+            sum += static_cast<ResultType>(vs[i]);
+      }
+      fSums[slot] = sum;
+   }
+
    template <typename T, typename std::enable_if<IsContainer<T>::value, int>::type = 0>
    void Exec(unsigned int slot, const T &vs)
    {
@@ -984,6 +1178,12 @@ class SnapshotHelperMT : public RActionImpl<SnapshotHelperMT<BranchTypes...>> {
    const ColumnNames_t fOutputBranchNames;
    std::vector<TTree *> fInputTrees; // Current input trees. Set at initialization time (`InitTask`)
 
+   // Used instead of fMerger and fOutputFiles if fOptions.fMTBasketMerge is set
+   std::vector<std::unique_ptr<TMemFile>> fWorkerFiles; // per-slot in-memory files in which baskets are compressed
+   std::unique_ptr<TFile> fOutputFile;                  // the output file, filled by all slots
+   TTree *fOutputTree = nullptr;                        // the output tree, owned by fOutputFile
+   std::unique_ptr<std::mutex> fOutputMutex;            // protects fOutputFile and fOutputTree (ptr to stay movable)
+
 public:
    using ColumnTypes_t = TypeList<BranchTypes...>;
    SnapshotHelperMT(const unsigned int nSlots, std::string_view filename, std::string_view dirname,
@@ -991,7 +1191,8 @@ public:
                     const RSnapshotOptions &options)
       : fNSlots(nSlots), fOutputFiles(fNSlots), fOutputTrees(fNSlots), fIsFirstEvent(fNSlots, 1), fFileName(filename),
         fDirName(dirname), fTreeName(treename), fOptions(options), fInputBranchNames(vbnames),
-        fOutputBranchNames(ReplaceDotWithUnderscore(bnames)), fInputTrees(fNSlots)
+        fOutputBranchNames(ReplaceDotWithUnderscore(bnames)), fInputTrees(fNSlots), fWorkerFiles(fNSlots),
+        fOutputMutex(new std::mutex())
    {
    }
    SnapshotHelperMT(const SnapshotHelperMT &) = delete;
@@ -1000,13 +1201,25 @@ public:
    void InitTask(TTreeReader *r, unsigned int slot)
    {
       ::TDirectory::TContext c; // do not let tasks change the thread-local gDirectory
-      if (!fOutputFiles[slot]) {
-         // first time this thread executes something, let's create a TBufferMerger output directory
-         fOutputFiles[slot] = fMerger->GetFile();
+      TDirectory *treeDirectory = nullptr;
+      if (fOptions.fMTBasketMerge) {
+         if (!fWorkerFiles[slot]) {
+            // first time this thread executes something, let's create its in-memory file
+            R__LOCKGUARD(gROOTMutex);
+            fWorkerFiles[slot].reset(new TMemFile(fFileName.c_str(), "RECREATE", "", fOutputFile->GetCompressionSettings()));
+            gROOT->GetListOfFiles()->Remove(fWorkerFiles[slot].get());
+         }
+         treeDirectory = fWorkerFiles[slot].get();
+      } else {
+         if (!fOutputFiles[slot]) {
+            // first time this thread executes something, let's create a TBufferMerger output directory
+            fOutputFiles[slot] = fMerger->GetFile();
+         }
+         treeDirectory = fOutputFiles[slot].get();
       }
-      TDirectory *treeDirectory = fOutputFiles[slot].get();
       if (!fDirName.empty()) {
-         treeDirectory = fOutputFiles[slot]->mkdir(fDirName.c_str());
+         auto subDir = treeDirectory->GetDirectory(fDirName.c_str());
+         treeDirectory = subDir ? subDir : treeDirectory->mkdir(fDirName.c_str());
       }
       // re-create output tree as we need to create its branches again, with new input variables
       // TODO we could instead create the output tree and its branches, change addresses of input variables in each task
@@ -1031,7 +1244,9 @@ public:
    void FinalizeTask(unsigned int slot)
    {
       if (fOutputTrees[slot].top()->GetEntries() > 0)
-         fOutputFiles[slot]->Write();
+         FlushSlot(slot);
+      else if (fOptions.fMTBasketMerge)
+         CreateOutputTree(*fOutputTrees[slot].top(), /*replace=*/false);
       // clear now to avoid concurrent destruction of output trees and input tree (which has them listed as fClones)
       fOutputTrees[slot].pop();
    }
@@ -1045,9 +1260,59 @@ public:
       }
       fOutputTrees[slot].top()->Fill();
       auto entries = fOutputTrees[slot].top()->GetEntries();
-      auto autoFlush = fOutputTrees[slot].top()->GetAutoFlush();
-      if ((autoFlush > 0) && (entries % autoFlush == 0))
+      auto flushEntries =
+         fOptions.fMTFlushEntries > 0 ? fOptions.fMTFlushEntries : fOutputTrees[slot].top()->GetAutoFlush();
+      if ((flushEntries > 0) && (entries % flushEntries == 0))
+         FlushSlot(slot);
+   }
+
+   /// Hand the entries filled by this slot over to the output file.
+   /// With fMTBasketMerge, the baskets are compressed here, in the worker thread, and their compressed content is
+   /// appended to the output tree by fast cloning, so that the only serialized step is the copy of the bytes.
+   /// Otherwise the in-memory file of the slot is queued for merging by the TBufferMerger.
+   void FlushSlot(unsigned int slot)
+   {
+      if (!fOptions.fMTBasketMerge) {
          fOutputFiles[slot]->Write();
+         return;
+      }
+
+      auto &tree = *fOutputTrees[slot].top();
+      if (tree.GetEntries() == 0)
+         return;
+      tree.FlushBaskets();
+      CreateOutputTree(tree, /*replace=*/true);
+      {
+         std::lock_guard<std::mutex> lock(*fOutputMutex);
+         if (fOutputTree->CopyEntries(&tree, -1, "fast") < 0)
+            throw std::runtime_error("Snapshot: could not append the baskets of a worker to the output tree");
+      }
+      fWorkerFiles[slot]->ResetAfterMerge(nullptr);
+   }
+
+   /// With fMTBasketMerge, create the output tree with the structure of the tree of a slot, if not done yet.
+   /// A slot whose tasks did not see any entry has a tree without branches: it only provides the output tree
+   /// if all the entries are filtered out, and is otherwise replaced (`replace`) by the first slot with entries.
+   void CreateOutputTree(TTree &tree, bool replace)
+   {
+      std::lock_guard<std::mutex> lock(*fOutputMutex);
+      if (fOutputTree) {
+         if (!replace || fOutputTree->GetNbranches() > 0)
+            return;
+         delete fOutputTree;
+         fOutputTree = nullptr;
+      }
+      TDirectory *outputDir = fOutputFile.get();
+      if (!fDirName.empty()) {
+         auto subDir = fOutputFile->GetDirectory(fDirName.c_str());
+         outputDir = subDir ? subDir : fOutputFile->mkdir(fDirName.c_str());
+      }
+      ::TDirectory::TContext c(outputDir);
+      fOutputTree = tree.CloneTree(0);
+      fOutputTree->SetDirectory(outputDir);
+      // the output tree must not share the addresses of this slot's values, nor be notified of their changes
+      tree.GetListOfClones()->Remove(fOutputTree);
+      fOutputTree->ResetBranchAddresses();
    }
 
    template <std::size_t... S>
@@ -1065,11 +1330,34 @@ public:
    void Initialize()
    {
       const auto cs = ROOT::CompressionSettings(fOptions.fCompressionAlgorithm, fOptions.fCompressionLevel);
+      if (fOptions.fMTBasketMerge) {
+         ::TDirectory::TContext c;
+         fOutputFile.reset(TFile::Open(fFileName.c_str(), fOptions.fMode.c_str(), /*ftitle=*/"", cs));
+         if (!fOutputFile || fOutputFile->IsZombie())
+            throw std::runtime_error("Snapshot: could not create output file " + fFileName);
+         return;
+      }
       fMerger = std::make_unique<ROOT::Experimental::TBufferMerger>(fFileName.c_str(), fOptions.fMode.c_str(), cs);
    }
 
    void Finalize()
    {
+      if (fOptions.fMTBasketMerge) {
+         const auto anyWorkerFile =
+            std::any_of(fWorkerFiles.begin(), fWorkerFiles.end(), [](const std::unique_ptr<TMemFile> &f) { return !!f; });
+         if (!anyWorkerFile)
+            Warning("Snapshot", "A lazy Snapshot action was booked but never triggered.");
+         fWorkerFiles.clear();
+         if (fOutputTree) {
+            ::TDirectory::TContext c(fOutputTree->GetDirectory());
+            fOutputTree->Write();
+         }
+         fOutputTree = nullptr; // deleted when the file is closed
+         fOutputFile->Close();
+         fOutputFile.reset();
+         return;
+      }
+
       auto fileWritten = false;
       for (auto &file : fOutputFiles) {
          if (file) {
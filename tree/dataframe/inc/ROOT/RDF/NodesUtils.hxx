@@ -16,6 +16,9 @@
 #include "ROOT/RVec.hxx"
 #include "ROOT/RDF/Utils.hxx" // ColumnNames_t
 
+#include <functional>
+#include <vector>
+
 template <typename T>
 class TTreeReaderValue;
 
@@ -74,6 +77,23 @@ void InitRDFValues(unsigned int slot, RDFValueTuple &valueTuple, TTreeReader *r,
    (void)r;        // avoid "unused variable" warnings for r on gcc5.2
 }
 
+/// Loaders that copy the values of the current entry into the batch buffers of the RColumnValues of a task.
+/// The arguments are the index of the entry in the batch and the entry number.
+using BatchLoaders_t = std::vector<std::function<void(unsigned int, Long64_t)>>;
+
+/// Switch a tuple of RColumnValues, already initialized with InitRDFValues, to batch mode.
+/// Does nothing if `loaders` is null, i.e. if batch mode is off.
+template <typename RDFValueTuple, std::size_t... S>
+void EnableBatchRDFValues(RDFValueTuple &valueTuple, BatchLoaders_t *loaders, unsigned int batchSize,
+                          std::index_sequence<S...>)
+{
+   if (!loaders)
+      return;
+   int expander[] = {(std::get<S>(valueTuple).EnableBatch(*loaders, batchSize), 0)..., 0};
+   (void)expander; // avoid "unused variable" warnings for expander on gcc4.9
+   (void)batchSize;
+}
+
 } // namespace RDF
 } // namespace Internal
 } // namespace ROOT
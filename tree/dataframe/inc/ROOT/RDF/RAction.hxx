@@ -13,6 +13,7 @@
 
 #include "ROOT/RDF/GraphNode.hxx"
 #include "ROOT/RDF/RActionBase.hxx"
+#include "ROOT/RDF/RLoopManager.hxx"
 #include "ROOT/RDF/NodesUtils.hxx" // InitRDFValues
 #include "ROOT/RDF/Utils.hxx"      // ColumnNames_t
 #include "ROOT/RDF/RColumnValue.hxx"
@@ -137,6 +138,23 @@ public:
          static_cast<Action_t *>(this)->Exec(slot, entry, TypeInd_t());
    }
 
+   void RunBatch(unsigned int slot, Long64_t firstEntry, unsigned int n) final
+   {
+      const auto &mask = fPrevData.CheckFiltersBatch(slot, firstEntry, n);
+      static_cast<Action_t *>(this)->ExecBatch(slot, firstEntry, n, mask.data());
+   }
+
+   /// Batch mode: run the helper on the entries of the batch selected by `mask`, one at a time.
+   /// Hidden by the RActions which can pass the whole batch to their helper.
+   void ExecBatch(unsigned int slot, Long64_t firstEntry, unsigned int n, const char *mask)
+   {
+      auto action = static_cast<Action_t *>(this);
+      for (auto i = 0u; i < n; ++i) {
+         if (mask[i])
+            action->Exec(slot, firstEntry + i, TypeInd_t());
+      }
+   }
+
    void TriggerChildrenCount() final { fPrevData.IncrChildrenCount(); }
 
    void FinalizeSlot(unsigned int slot) final
@@ -216,6 +234,9 @@ public:
    {
       InitRDFValues(slot, fValues[slot], r, RActionBase::GetColumnNames(), RActionBase::GetCustomColumns(),
                     typename ActionCRTP_t::TypeInd_t{});
+      auto lm = RActionBase::GetLoopManager();
+      EnableBatchRDFValues(fValues[slot], lm->GetBatchLoaders(slot), lm->GetBatchSize(),
+                           typename ActionCRTP_t::TypeInd_t{});
    }
 
    template <std::size_t... S>
@@ -225,11 +246,36 @@ public:
       ActionCRTP_t::GetHelper().Exec(slot, std::get<S>(fValues[slot]).Get(entry)...);
    }
 
+   /// Batch mode: if the helper implements `BatchExec` for the column types, pass it the selection mask and one
+   /// contiguous array of values per column for the whole batch. Otherwise run it on the selected entries one by one.
+   void ExecBatch(unsigned int slot, Long64_t firstEntry, unsigned int n, const char *mask)
+   {
+      ExecBatchImpl(slot, firstEntry, n, mask, typename ActionCRTP_t::TypeInd_t{}, ColumnTypes_t{}, 0);
+   }
+
    template <std::size_t... S>
    void ResetColumnValues(unsigned int slot, std::index_sequence<S...> s)
    {
       ResetRDFValueTuple(fValues[slot], s);
    }
+
+private:
+   // this overload is SFINAE'd out if Helper does not implement `BatchExec` for these column types
+   template <std::size_t... S, typename... ColTypes, typename H = Helper>
+   auto ExecBatchImpl(unsigned int slot, Long64_t firstEntry, unsigned int n, const char *mask,
+                      std::index_sequence<S...>, ROOT::TypeTraits::TypeList<ColTypes...>, int)
+      -> decltype(std::declval<H &>().BatchExec(slot, n, mask, std::declval<const ColTypes *>()...), void())
+   {
+      (void)firstEntry; // avoid bogus 'unused parameter' warning for actions without columns
+      ActionCRTP_t::GetHelper().BatchExec(slot, n, mask, std::get<S>(fValues[slot]).GetBatch(firstEntry, n, mask)...);
+   }
+
+   // this one is always available but has lower precedence thanks to the `long` argument
+   template <typename Seq, typename Types>
+   void ExecBatchImpl(unsigned int slot, Long64_t firstEntry, unsigned int n, const char *mask, Seq, Types, long)
+   {
+      ActionCRTP_t::ExecBatch(slot, firstEntry, n, mask);
+   }
 };
 
 // These specializations let RAction<SnapshotHelper[MT]> type-erase their column values, for (presumably) a small hit in
@@ -269,6 +315,9 @@ public:
                     typename ActionCRTP_t::TypeInd_t{}, ColumnTypes_t{});
    }
 
+   /// The output TTree branches point to the column values, which move around in batch mode
+   bool SupportsBatchMode() const final { return false; }
+
    template <std::size_t... S>
    void Exec(unsigned int slot, Long64_t entry, std::index_sequence<S...>)
    {
@@ -309,6 +358,9 @@ public:
                     typename ActionCRTP_t::TypeInd_t{}, ColumnTypes_t{});
    }
 
+   /// The output TTree branches point to the column values, which move around in batch mode
+   bool SupportsBatchMode() const final { return false; }
+
    template <std::size_t... S>
    void Exec(unsigned int slot, Long64_t entry, std::index_sequence<S...>)
    {
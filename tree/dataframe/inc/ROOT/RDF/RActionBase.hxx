@@ -64,6 +64,10 @@ public:
    RLoopManager *GetLoopManager() { return fLoopManager; }
    unsigned int GetNSlots() const { return fNSlots; }
    virtual void Run(unsigned int slot, Long64_t entry) = 0;
+   /// Batch mode: run the action on the selected entries among the `n` consecutive entries starting at `firstEntry`.
+   virtual void RunBatch(unsigned int slot, Long64_t firstEntry, unsigned int n) = 0;
+   /// Whether this action can consume batches of entries, see RLoopManager::SetBatchSize.
+   virtual bool SupportsBatchMode() const { return true; }
    virtual void Initialize() = 0;
    virtual void InitSlot(TTreeReader *r, unsigned int slot) = 0;
    virtual void TriggerChildrenCount() = 0;
@@ -0,0 +1,422 @@
+/*************************************************************************
+ * Copyright (C) 1995-2018, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef ROOT_RCACHEDS
+#define ROOT_RCACHEDS
+
+#include "ROOT/RDataSource.hxx"
+#include "ROOT/RDF/ActionHelpers.hxx"
+#include "ROOT/RDF/RCacheStore.hxx"
+#include "ROOT/RDF/Utils.hxx"
+#include "ROOT/RIntegerSequence.hxx"
+#include "ROOT/RResultPtr.hxx"
+#include "ROOT/TypeTraits.hxx"
+#include "TBufferFile.h"
+#include "TClass.h"
+#include "TError.h"
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
+
+namespace ROOT {
+namespace Internal {
+namespace RDF {
+
+/// The container of the values of a cached column in a chunk. Values must be addressable, hence no vector<bool>.
+template <typename T>
+struct RCacheColumn {
+   using Type_t = std::vector<T>;
+};
+
+template <>
+struct RCacheColumn<bool> {
+   using Type_t = std::deque<bool>;
+};
+
+template <typename T>
+using RCacheColumn_t = typename RCacheColumn<T>::Type_t;
+
+/// Serialization of a cached column. The buffers never leave the process, so that the values of fundamental types
+/// are copied as they are in memory, and the other values are streamed through their dictionary.
+template <typename T, typename = void>
+struct RCacheColumnIO {
+   static bool CanSerialize()
+   {
+      auto cl = TClass::GetClass(typeid(T));
+      return cl && (cl->HasDictionary() || cl->GetCollectionProxy());
+   }
+   static void Write(TBuffer &b, const RCacheColumn_t<T> &col)
+   {
+      const auto cl = TClass::GetClass(typeid(T));
+      for (auto &v : col)
+         b.StreamObject(const_cast<T *>(&v), cl);
+   }
+   static void Read(TBuffer &b, RCacheColumn_t<T> &col, ULong64_t n)
+   {
+      const auto cl = TClass::GetClass(typeid(T));
+      col.resize(n);
+      for (auto &v : col)
+         b.StreamObject(&v, cl);
+   }
+   static void Reserve(RCacheColumn_t<T> &col, unsigned int n) { col.reserve(n); }
+};
+
+template <typename T>
+struct RCacheColumnIO<T, typename std::enable_if<std::is_arithmetic<T>::value && !std::is_same<T, bool>::value>::type> {
+   static bool CanSerialize() { return true; }
+   static void Write(TBuffer &b, const RCacheColumn_t<T> &col)
+   {
+      b.WriteFastArray(reinterpret_cast<const char *>(col.data()), col.size() * sizeof(T));
+   }
+   static void Read(TBuffer &b, RCacheColumn_t<T> &col, ULong64_t n)
+   {
+      col.resize(n);
+      b.ReadFastArray(reinterpret_cast<char *>(col.data()), n * sizeof(T));
+   }
+   static void Reserve(RCacheColumn_t<T> &col, unsigned int n) { col.reserve(n); }
+};
+
+template <>
+struct RCacheColumnIO<bool> {
+   static bool CanSerialize() { return true; }
+   static void Write(TBuffer &b, const RCacheColumn_t<bool> &col)
+   {
+      for (bool v : col)
+         b << v;
+   }
+   static void Read(TBuffer &b, RCacheColumn_t<bool> &col, ULong64_t n)
+   {
+      col.resize(n);
+      for (auto &v : col)
+         b >> v;
+   }
+   static void Reserve(RCacheColumn_t<bool> &, unsigned int) {}
+};
+
+/// The action filling the chunks of a RCacheStore. Each slot fills its own chunk and hands it over to the store as
+/// soon as it is full: serialization and compression therefore run in the worker threads of the event loop.
+template <typename... ColumnTypes>
+class RCacheHelper : public ROOT::Detail::RDF::RActionImpl<RCacheHelper<ColumnTypes...>> {
+public:
+   using Result_t = ULong64_t;
+   using ColumnTypes_t = ROOT::TypeTraits::TypeList<ColumnTypes...>;
+   using Columns_t = std::tuple<RCacheColumn_t<ColumnTypes>...>;
+
+private:
+   std::shared_ptr<RCacheStore> fStore;
+   std::shared_ptr<ULong64_t> fNEntries;
+   unsigned int fChunkSize;
+   bool fSerialize;
+   std::vector<std::unique_ptr<Columns_t>> fColumns;
+   std::vector<unsigned int> fNInChunk;
+   std::vector<std::unique_ptr<TBufferFile>> fBuffers;
+
+   template <std::size_t... S>
+   void PushBack(unsigned int slot, std::index_sequence<S...>, const ColumnTypes &... values)
+   {
+      std::initializer_list<int> expander{(std::get<S>(*fColumns[slot]).push_back(values), 0)...};
+      (void)expander; // avoid unused variable warnings
+   }
+
+   template <std::size_t... S>
+   void Serialize(unsigned int slot, std::index_sequence<S...>)
+   {
+      auto &b = *fBuffers[slot];
+      b.Reset();
+      std::initializer_list<int> expander{(RCacheColumnIO<ColumnTypes>::Write(b, std::get<S>(*fColumns[slot])), 0)...};
+      (void)expander; // avoid unused variable warnings
+   }
+
+   template <std::size_t... S>
+   void Clear(unsigned int slot, std::index_sequence<S...>)
+   {
+      std::initializer_list<int> expander{(std::get<S>(*fColumns[slot]).clear(), 0)...};
+      (void)expander; // avoid unused variable warnings
+   }
+
+   template <std::size_t... S>
+   void Reserve(unsigned int slot, std::index_sequence<S...>)
+   {
+      std::initializer_list<int> expander{
+         (RCacheColumnIO<ColumnTypes>::Reserve(std::get<S>(*fColumns[slot]), fChunkSize), 0)...};
+      (void)expander; // avoid unused variable warnings
+   }
+
+   void Flush(unsigned int slot)
+   {
+      const auto n = fNInChunk[slot];
+      if (n == 0)
+         return;
+      const auto seq = std::index_sequence_for<ColumnTypes...>();
+      if (fSerialize) {
+         Serialize(slot, seq);
+         fStore->AddChunk(n, fBuffers[slot]->Buffer(), fBuffers[slot]->Length());
+         Clear(slot, seq);
+      } else {
+         const ULong64_t size = n * GetEntrySize();
+         fStore->AddChunk(n, std::shared_ptr<void>(std::move(fColumns[slot])), size);
+         fColumns[slot].reset(new Columns_t());
+         Reserve(slot, seq);
+      }
+      fNInChunk[slot] = 0;
+   }
+
+public:
+   RCacheHelper(const std::shared_ptr<RCacheStore> &store, const std::shared_ptr<ULong64_t> &nEntries,
+                unsigned int nSlots)
+      : fStore(store), fNEntries(nEntries), fChunkSize(std::max(1u, store->GetOptions().fChunkSize)),
+        fSerialize(false), fNInChunk(nSlots, 0)
+   {
+      const auto &options = store->GetOptions();
+      if (options.fCompressionLevel > 0 || options.fMemoryBudget > 0) {
+         fSerialize = CanSerialize();
+         if (!fSerialize)
+            Warning("Cache", "Some of the cached columns have a type without dictionary: the cache will be neither "
+                             "compressed nor spilled to disk.");
+      }
+      for (unsigned int slot = 0; slot < nSlots; ++slot) {
+         fColumns.emplace_back(new Columns_t());
+         Reserve(slot, std::index_sequence_for<ColumnTypes...>());
+         if (fSerialize)
+            fBuffers.emplace_back(new TBufferFile(TBuffer::kWrite));
+      }
+   }
+   RCacheHelper(RCacheHelper &&) = default;
+   RCacheHelper(const RCacheHelper &) = delete;
+
+   static bool CanSerialize()
+   {
+      const std::vector<bool> canSerialize{RCacheColumnIO<ColumnTypes>::CanSerialize()...};
+      return std::find(canSerialize.begin(), canSerialize.end(), false) == canSerialize.end();
+   }
+
+   /// Approximate size in memory of an entry, not accounting for the memory owned by the values
+   static std::size_t GetEntrySize()
+   {
+      const std::vector<std::size_t> sizes{sizeof(ColumnTypes)...};
+      return std::accumulate(sizes.begin(), sizes.end(), std::size_t(0));
+   }
+
+   void InitTask(TTreeReader *, unsigned int) {}
+
+   void Exec(unsigned int slot, const ColumnTypes &... values)
+   {
+      PushBack(slot, std::index_sequence_for<ColumnTypes...>(), values...);
+      if (++fNInChunk[slot] == fChunkSize)
+         Flush(slot);
+   }
+
+   void Initialize() { /* noop */}
+
+   void Finalize()
+   {
+      for (unsigned int slot = 0; slot < fColumns.size(); ++slot)
+         Flush(slot);
+      fColumns.clear();
+      fBuffers.clear();
+      *fNEntries = fStore->GetNEntries();
+   }
+
+   std::shared_ptr<Result_t> GetResultPtr() const { return fNEntries; }
+
+   std::string GetActionName() { return "Cache"; }
+};
+
+} // ns RDF
+} // ns Internal
+
+namespace RDF {
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+/// \brief A RDataSource implementation which reads the chunks of entries produced by RDataFrame::Cache
+///
+/// Each chunk is a range of entries of its own, so that the chunks are processed in parallel in multi-thread event
+/// loops. The chunks kept as columns are read in place; the serialized ones are read back from the spill file and
+/// uncompressed by the task processing them. The processing of the parent data frame starts only when the event loop
+/// is triggered in the data frame initialised with a RCacheDS.
+template <typename... ColumnTypes>
+class RCacheDS final : public ROOT::RDF::RDataSource {
+   using Columns_t = std::tuple<ROOT::Internal::RDF::RCacheColumn_t<ColumnTypes>...>;
+
+   struct RSlotData {
+      std::shared_ptr<Columns_t> fColumns; ///< The chunk currently processed
+      std::shared_ptr<Columns_t> fDecoded; ///< The columns of the last chunk deserialized in this slot
+      std::vector<char> fBuffer;           ///< The serialized columns of the last chunk deserialized in this slot
+      ULong64_t fBegin = 0;                ///< First entry of the chunk currently processed
+      ULong64_t fEnd = 0;                  ///< Entry after the last one of the chunk currently processed
+   };
+
+   const std::vector<std::string> fColNames;
+   const std::vector<std::string> fColTypeNames;
+   std::shared_ptr<ROOT::Internal::RDF::RCacheStore> fStore;
+   RResultPtr<ULong64_t> fNEntries;
+   unsigned int fNSlots{0};
+   std::vector<RSlotData> fSlots;
+   std::tuple<std::vector<ColumnTypes *>...> fValuePtrs; ///< The addresses of the current values, per slot
+   std::vector<ULong64_t> fChunkBegins;                  ///< First entry of each chunk, followed by the number of entries
+   std::vector<std::pair<ULong64_t, ULong64_t>> fEntryRanges{};
+
+   template <typename T>
+   static Record_t GetSlotReaders(std::vector<T *> &valuePtrs)
+   {
+      Record_t ret;
+      for (auto &ptr : valuePtrs)
+         ret.emplace_back(&ptr);
+      return ret;
+   }
+
+   template <std::size_t... S>
+   Record_t GetColumnReadersHelper(std::size_t index, std::index_sequence<S...>)
+   {
+      std::vector<Record_t> readers{GetSlotReaders(std::get<S>(fValuePtrs))...};
+      return readers[index];
+   }
+
+   Record_t GetColumnReadersImpl(std::string_view colName, const std::type_info &id)
+   {
+      const auto namesIt = std::find(fColNames.begin(), fColNames.end(), colName);
+      if (fColNames.end() == namesIt) {
+         std::string err = "The specified column name, \"" + std::string(colName) + "\" is not known to the data source.";
+         throw std::runtime_error(err);
+      }
+      const auto index = std::distance(fColNames.begin(), namesIt);
+
+      const auto idName = ROOT::Internal::RDF::TypeID2TypeName(id);
+      if (fColTypeNames[index] != idName) {
+         std::string err = "Column " + std::string(colName) + " has type " + fColTypeNames[index] +
+                           " while the id specified is associated to type " + idName;
+         throw std::runtime_error(err);
+      }
+
+      return GetColumnReadersHelper(index, std::index_sequence_for<ColumnTypes...>());
+   }
+
+   template <std::size_t... S>
+   void ReadColumns(TBuffer &b, Columns_t &columns, ULong64_t n, std::index_sequence<S...>)
+   {
+      std::initializer_list<int> expander{
+         (ROOT::Internal::RDF::RCacheColumnIO<ColumnTypes>::Read(b, std::get<S>(columns), n), 0)...};
+      (void)expander; // avoid unused variable warnings
+   }
+
+   template <std::size_t... S>
+   void SetValuePtrs(unsigned int slot, ULong64_t idx, std::index_sequence<S...>)
+   {
+      auto &columns = *fSlots[slot].fColumns;
+      std::initializer_list<int> expander{(std::get<S>(fValuePtrs)[slot] = &std::get<S>(columns)[idx], 0)...};
+      (void)expander; // avoid unused variable warnings
+   }
+
+   void LoadChunk(unsigned int slot, ULong64_t entry)
+   {
+      const auto chunk = std::upper_bound(fChunkBegins.begin(), fChunkBegins.end(), entry) - fChunkBegins.begin() - 1;
+      auto &slotData = fSlots[slot];
+      slotData.fBegin = fChunkBegins[chunk];
+      slotData.fEnd = fChunkBegins[chunk + 1];
+
+      const auto &columns = fStore->GetColumns(chunk);
+      if (columns) {
+         slotData.fColumns = std::static_pointer_cast<Columns_t>(columns);
+         return;
+      }
+
+      if (!fStore->LoadChunk(chunk, slotData.fBuffer))
+         throw std::runtime_error("Cannot load chunk " + std::to_string(chunk) + " of the cached dataset.");
+      if (!slotData.fDecoded)
+         slotData.fDecoded = std::make_shared<Columns_t>();
+      TBufferFile b(TBuffer::kRead, slotData.fBuffer.size(), slotData.fBuffer.data(), kFALSE);
+      ReadColumns(b, *slotData.fDecoded, slotData.fEnd - slotData.fBegin, std::index_sequence_for<ColumnTypes...>());
+      slotData.fColumns = slotData.fDecoded;
+   }
+
+protected:
+   std::string AsString() { return "cache data source"; };
+
+public:
+   RCacheDS(const std::vector<std::string> &colNames, const std::shared_ptr<ROOT::Internal::RDF::RCacheStore> &store,
+            const RResultPtr<ULong64_t> &nEntries)
+      : fColNames(colNames), fColTypeNames({ROOT::Internal::RDF::TypeID2TypeName(typeid(ColumnTypes))...}),
+        fStore(store), fNEntries(nEntries)
+   {
+   }
+
+   const std::vector<std::string> &GetColumnNames() const { return fColNames; }
+
+   std::vector<std::pair<ULong64_t, ULong64_t>> GetEntryRanges()
+   {
+      auto entryRanges(std::move(fEntryRanges)); // empty fEntryRanges
+      return entryRanges;
+   }
+
+   std::string GetTypeName(std::string_view colName) const
+   {
+      const auto namesIt = std::find(fColNames.begin(), fColNames.end(), colName);
+      if (fColNames.end() == namesIt)
+         throw std::runtime_error("The specified column name, \"" + std::string(colName) +
+                                  "\" is not known to the data source.");
+      return fColTypeNames[std::distance(fColNames.begin(), namesIt)];
+   }
+
+   bool HasColumn(std::string_view colName) const
+   {
+      return fColNames.end() != std::find(fColNames.begin(), fColNames.end(), colName);
+   }
+
+   bool SetEntry(unsigned int slot, ULong64_t entry)
+   {
+      auto &slotData = fSlots[slot];
+      if (entry < slotData.fBegin || entry >= slotData.fEnd)
+         LoadChunk(slot, entry);
+      SetValuePtrs(slot, entry - slotData.fBegin, std::index_sequence_for<ColumnTypes...>());
+      return true;
+   }
+
+   void SetNSlots(unsigned int nSlots)
+   {
+      fNSlots = nSlots;
+      fSlots.resize(fNSlots);
+      fValuePtrs = std::make_tuple(std::vector<ColumnTypes *>(fNSlots, nullptr)...);
+   }
+
+   void Initialise()
+   {
+      // Run the event loop of the parent data frame, if it did not run yet
+      *fNEntries;
+
+      fChunkBegins.assign(1, 0ull);
+      fEntryRanges.clear();
+      for (std::size_t i = 0; i < fStore->GetNChunks(); ++i) {
+         const auto begin = fChunkBegins.back();
+         const auto end = begin + fStore->GetNEntries(i);
+         fEntryRanges.emplace_back(begin, end);
+         fChunkBegins.emplace_back(end);
+      }
+   }
+
+   void Finalise()
+   {
+      // Release the chunks held by the slots
+      for (auto &slotData : fSlots)
+         slotData = RSlotData();
+   }
+
+   std::string GetDataSourceType() { return "Cache"; }
+};
+
+} // ns RDF
+} // ns ROOT
+
+#endif
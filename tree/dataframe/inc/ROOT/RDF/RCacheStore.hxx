@@ -0,0 +1,80 @@
+/*************************************************************************
+ * Copyright (C) 1995-2018, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef ROOT_RCACHESTORE
+#define ROOT_RCACHESTORE
+
+#include "ROOT/RCacheOptions.hxx"
+#include "RtypesCore.h"
+
+#include <cstddef>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ROOT {
+namespace Internal {
+namespace RDF {
+
+/// Storage of the chunks of entries produced by RDataFrame::Cache.
+///
+/// A chunk is either kept as the columns it was filled in, without any copy, or as a buffer of serialized columns.
+/// Serialized chunks are compressed according to the RCacheOptions and, once the memory budget is exhausted, written
+/// to a temporary spill file. Chunks can be added concurrently from several threads; they are read back, possibly
+/// concurrently, only after all of them have been added.
+class RCacheStore {
+   struct RChunk {
+      ULong64_t fNEntries = 0;        ///< Number of entries in the chunk
+      std::shared_ptr<void> fColumns; ///< The columns, if the chunk is not serialized
+      std::vector<char> fData;        ///< The serialized, possibly compressed, columns, if kept in memory
+      Int_t fObjLen = 0;              ///< Size of the serialized columns
+      Int_t fNbytes = 0;              ///< Size of the serialized columns after compression
+      Long64_t fSpillOffset = -1;     ///< Position of the chunk in the spill file, -1 if kept in memory
+   };
+
+   const ROOT::RDF::RCacheOptions fOptions;
+   std::vector<RChunk> fChunks;
+   ULong64_t fNEntries = 0;
+   ULong64_t fMemoryUsage = 0;
+   ULong64_t fSpilledBytes = 0;
+   std::string fSpillFileName;
+   mutable std::fstream fSpillFile; ///< Read under fMutex by LoadChunk
+   bool fBudgetWarningIssued = false;
+   mutable std::mutex fMutex;
+
+   bool OpenSpillFile();
+   void Spill(RChunk &chunk);
+
+public:
+   explicit RCacheStore(const ROOT::RDF::RCacheOptions &options);
+   RCacheStore(const RCacheStore &) = delete;
+   RCacheStore &operator=(const RCacheStore &) = delete;
+   ~RCacheStore();
+
+   const ROOT::RDF::RCacheOptions &GetOptions() const { return fOptions; }
+
+   void AddChunk(ULong64_t nEntries, const char *buffer, Int_t len);
+   void AddChunk(ULong64_t nEntries, std::shared_ptr<void> columns, ULong64_t size);
+
+   std::size_t GetNChunks() const { return fChunks.size(); }
+   ULong64_t GetNEntries() const;
+   ULong64_t GetNEntries(std::size_t i) const { return fChunks[i].fNEntries; }
+   const std::shared_ptr<void> &GetColumns(std::size_t i) const { return fChunks[i].fColumns; }
+   bool LoadChunk(std::size_t i, std::vector<char> &buffer) const;
+
+   ULong64_t GetMemoryUsage() const;
+   ULong64_t GetSpilledBytes() const;
+};
+
+} // ns RDF
+} // ns Internal
+} // ns ROOT
+
+#endif
@@ -23,6 +23,7 @@
 #include <TTreeReaderArray.h>
 
 #include <cstring> // strcmp
+#include <functional>
 #include <initializer_list>
 #include <limits>
 #include <memory>
@@ -58,6 +59,12 @@ TTree branch or from a temporary column respectively.
 
 RDataFrame nodes can store tuples of RColumnValues and retrieve an updated
 value for the column via the `Get` method.
+
+In batch mode (see RLoopManager::SetBatchSize) the values of TTree and data-source
+columns are copied into a per-column buffer while the event loop advances through
+a batch of consecutive entries, and `Get` then returns the buffered value of the
+requested entry. Custom columns are not buffered: they are recomputed from their
+(buffered) inputs on demand.
 **/
 template <typename T>
 class RColumnValue {
@@ -98,6 +105,72 @@ class RColumnValue {
    /// If MustUseRVec, i.e. we are reading an array, we return a reference to this RVec to clients
    RVec<ColumnValue_t> fRVec;
    bool fCopyWarningPrinted = false;
+   /// Buffered values of a batch of consecutive entries, only used in batch mode.
+   struct RBatch {
+      std::unique_ptr<T[]> fValues;
+      Long64_t fFirstEntry = 0;
+      bool fActive = false; ///< Whether `Get` should return the buffered values
+   };
+   /// One batch per task, like for the other stacks above.
+   std::stack<RBatch> fBatches;
+   /// The batch of the running task, i.e. the top of fBatches. Null if batch mode is off.
+   RBatch *fCurrentBatch = nullptr;
+   /// Values of the entries of a batch for columns which are not buffered, see GetBatch.
+   std::unique_ptr<T[]> fBatchScratch;
+   unsigned int fBatchScratchSize = 0;
+
+   template <typename U = T, typename std::enable_if<!RColumnValue<U>::MustUseRVec_t::value, int>::type = 0>
+   static void CopyToBatch(T &to, const T &from)
+   {
+      to = from;
+   }
+
+   /// RVecs read from a TTree adopt the memory of the TTreeReaderArray, which only lives until the next entry.
+   template <typename U = T, typename std::enable_if<RColumnValue<U>::MustUseRVec_t::value, int>::type = 0>
+   static void CopyToBatch(T &to, const T &from)
+   {
+      T copy(from.begin(), from.end());
+      swap(to, copy);
+   }
+
+   template <typename U = T,
+             typename std::enable_if<std::is_default_constructible<U>::value && std::is_copy_assignable<U>::value,
+                                     int>::type = 0>
+   void AllocateBatch(unsigned int batchSize)
+   {
+      fBatches.emplace();
+      fCurrentBatch = &fBatches.top();
+      fCurrentBatch->fValues.reset(new T[batchSize]);
+   }
+
+   template <typename U = T,
+             typename std::enable_if<!(std::is_default_constructible<U>::value && std::is_copy_assignable<U>::value),
+                                     int>::type = 0>
+   void AllocateBatch(unsigned int)
+   {
+      throw std::runtime_error("RColumnValue: batch mode cannot buffer values of type " + TypeID2TypeName(typeid(T)) +
+                               ", which is not default-constructible and copy-assignable");
+   }
+
+   template <typename U = T,
+             typename std::enable_if<std::is_default_constructible<U>::value && std::is_copy_assignable<U>::value,
+                                     int>::type = 0>
+   void LoadBatchEntryImpl(unsigned int idx, Long64_t entry)
+   {
+      auto &batch = *fCurrentBatch;
+      batch.fActive = false;
+      if (idx == 0)
+         batch.fFirstEntry = entry;
+      CopyToBatch(batch.fValues[idx], Get(entry));
+      batch.fActive = true;
+   }
+
+   template <typename U = T,
+             typename std::enable_if<!(std::is_default_constructible<U>::value && std::is_copy_assignable<U>::value),
+                                     int>::type = 0>
+   void LoadBatchEntryImpl(unsigned int, Long64_t)
+   {
+   }
 
 public:
    RColumnValue(){};
@@ -129,6 +202,35 @@ public:
       fTreeReaders.emplace(std::make_unique<TreeReader_t>(*r, bn.c_str()));
    }
 
+   /// Switch to batch mode if this column is read from a TTree or a data source.
+   /// The function that copies the value of an entry into the batch buffer is appended to `loaders`; the event loop
+   /// calls it with the index of the entry in the batch and the entry number.
+   void EnableBatch(std::vector<std::function<void(unsigned int, Long64_t)>> &loaders, unsigned int batchSize)
+   {
+      if (fColumnKind != EColumnKind::kTree && fColumnKind != EColumnKind::kDataSource)
+         return;
+      AllocateBatch(batchSize);
+      loaders.emplace_back([this](unsigned int idx, Long64_t entry) { LoadBatchEntryImpl(idx, entry); });
+   }
+
+   /// Batch mode: return the values of the `n` consecutive entries starting at `firstEntry` as a contiguous array.
+   /// Buffered columns return their batch buffer. The values of the other columns are evaluated, only for the entries
+   /// selected by `mask`, into a scratch array: the values of the entries not selected are unspecified.
+   const T *GetBatch(Long64_t firstEntry, unsigned int n, const char *mask)
+   {
+      if (fCurrentBatch && fCurrentBatch->fActive)
+         return &fCurrentBatch->fValues[firstEntry - fCurrentBatch->fFirstEntry];
+      if (fBatchScratchSize < n) {
+         fBatchScratch.reset(new T[n]);
+         fBatchScratchSize = n;
+      }
+      for (auto i = 0u; i < n; ++i) {
+         if (mask[i])
+            fBatchScratch[i] = Get(firstEntry + i);
+      }
+      return fBatchScratch.get();
+   }
+
    /// This overload is used to return scalar quantities (i.e. types that are not read into a RVec)
    // This method is executed inside the event-loop, many times per entry
    // If need be, the if statement can be avoided using thunks
@@ -136,6 +238,8 @@ public:
    template <typename U = T, typename std::enable_if<!RColumnValue<U>::MustUseRVec_t::value, int>::type = 0>
    T &Get(Long64_t entry)
    {
+      if (fCurrentBatch && fCurrentBatch->fActive)
+         return fCurrentBatch->fValues[entry - fCurrentBatch->fFirstEntry];
       if (fColumnKind == EColumnKind::kTree) {
          return *(fTreeReaders.top()->Get());
       } else {
@@ -149,6 +253,8 @@ public:
    template <typename U = T, typename std::enable_if<RColumnValue<U>::MustUseRVec_t::value, int>::type = 0>
    T &Get(Long64_t entry)
    {
+      if (fCurrentBatch && fCurrentBatch->fActive)
+         return fCurrentBatch->fValues[entry - fCurrentBatch->fFirstEntry];
       if (fColumnKind == EColumnKind::kTree) {
          auto &readerArray = *fTreeReaders.top();
          // We only use TTreeReaderArrays to read columns that users flagged as type `RVec`, so we need to check
@@ -209,6 +315,10 @@ public:
 
    void Reset()
    {
+      if (!fBatches.empty()) {
+         fBatches.pop();
+         fCurrentBatch = fBatches.empty() ? nullptr : &fBatches.top();
+      }
       switch (fColumnKind) {
       case EColumnKind::kTree: fTreeReaders.pop(); break;
       case EColumnKind::kCustomColumn:
@@ -14,13 +14,17 @@
 #include "ROOT/RDF/NodesUtils.hxx"
 #include "ROOT/RDF/RColumnValue.hxx"
 #include "ROOT/RDF/RCustomColumnBase.hxx"
+#include "ROOT/RDF/RLoopManager.hxx"
 #include "ROOT/RDF/Utils.hxx"
 #include "ROOT/RIntegerSequence.hxx"
 #include "ROOT/RStringView.hxx"
 #include "ROOT/TypeTraits.hxx"
 #include "RtypesCore.h"
 
+#include <algorithm>
 #include <deque>
+#include <limits>
+#include <stdexcept>
 #include <type_traits>
 #include <vector>
 
@@ -64,11 +68,63 @@ class RCustomColumn final : public RCustomColumnBase {
 
    std::vector<RDFInternal::RDFValueTuple_t<ColumnTypes_t>> fValues;
 
+   /// Batch mode: values computed for the entries of the running batch, per slot. Filters evaluate the whole batch
+   /// before actions run on the selected entries, so without them non-pure expressions would be called several
+   /// times per entry.
+   std::vector<ValuesPerSlot_t> fBatchResults;
+   std::vector<std::vector<char>> fBatchComputed; ///< Batch mode: whether fBatchResults holds the value of an entry
+   std::vector<ULong64_t> fBatchIds;              ///< Batch mode: identifier of the batch fBatchResults refers to
+
+   template <typename U = ret_type, typename std::enable_if<std::is_copy_assignable<U>::value, int>::type = 0>
+   void InitBatch(unsigned int slot, unsigned int batchSize)
+   {
+      if (fBatchComputed[slot].size() == batchSize)
+         return;
+      fBatchResults[slot].resize(batchSize);
+      fBatchComputed[slot].assign(batchSize, 0);
+      fBatchIds[slot] = std::numeric_limits<ULong64_t>::max();
+   }
+
+   template <typename U = ret_type, typename std::enable_if<!std::is_copy_assignable<U>::value, int>::type = 0>
+   void InitBatch(unsigned int, unsigned int batchSize)
+   {
+      if (batchSize > 0)
+         throw std::runtime_error("RCustomColumn: batch mode cannot buffer values of column " + fName + " of type " +
+                                  RDFInternal::TypeID2TypeName(typeid(ret_type)) + ", which is not copy-assignable");
+   }
+
+   template <typename U = ret_type, typename std::enable_if<std::is_copy_assignable<U>::value, int>::type = 0>
+   void UpdateInBatch(unsigned int slot, Long64_t entry)
+   {
+      const auto batchId = fLoopManager->GetBatchId(slot);
+      auto &computed = fBatchComputed[slot];
+      if (batchId != fBatchIds[slot]) {
+         std::fill(computed.begin(), computed.end(), 0);
+         fBatchIds[slot] = batchId;
+      }
+      const auto idx = entry - fLoopManager->GetBatchFirstEntry(slot);
+      R__ASSERT(idx >= 0 && idx < Long64_t(computed.size()));
+      if (computed[idx]) {
+         fLastResults[slot] = fBatchResults[slot][idx];
+      } else {
+         UpdateHelper(slot, entry, TypeInd_t(), ColumnTypes_t(), ExtraArgsTag{});
+         fBatchResults[slot][idx] = fLastResults[slot];
+         computed[idx] = 1;
+      }
+   }
+
+   template <typename U = ret_type, typename std::enable_if<!std::is_copy_assignable<U>::value, int>::type = 0>
+   void UpdateInBatch(unsigned int slot, Long64_t entry)
+   {
+      UpdateHelper(slot, entry, TypeInd_t(), ColumnTypes_t(), ExtraArgsTag{});
+   }
+
 public:
    RCustomColumn(RLoopManager *lm, std::string_view name, F &&expression, const ColumnNames_t &bl, unsigned int nSlots,
                  const RDFInternal::RBookedCustomColumns &customColumns, bool isDSColumn = false)
       : RCustomColumnBase(lm, name, nSlots, isDSColumn, customColumns), fExpression(std::forward<F>(expression)),
-        fBranches(bl), fLastResults(fNSlots), fValues(fNSlots)
+        fBranches(bl), fLastResults(fNSlots), fValues(fNSlots), fBatchResults(fNSlots), fBatchComputed(fNSlots),
+        fBatchIds(fNSlots)
    {
    }
 
@@ -80,6 +136,9 @@ public:
       // TODO: Each node calls this method for each column it uses. Multiple nodes may share the same columns, and this
       // would lead to this method being called multiple times.
       RDFInternal::InitRDFValues(slot, fValues[slot], r, fBranches, fCustomColumns, TypeInd_t());
+      RDFInternal::EnableBatchRDFValues(fValues[slot], fLoopManager->GetBatchLoaders(slot),
+                                        fLoopManager->GetBatchSize(), TypeInd_t());
+      InitBatch(slot, fLoopManager->GetBatchSize());
    }
 
    void *GetValuePtr(unsigned int slot) final { return static_cast<void *>(&fLastResults[slot]); }
@@ -88,7 +147,10 @@ public:
    {
       if (entry != fLastCheckedEntry[slot]) {
          // evaluate this filter, cache the result
-         UpdateHelper(slot, entry, TypeInd_t(), ColumnTypes_t(), ExtraArgsTag{});
+         if (fBatchComputed[slot].empty())
+            UpdateHelper(slot, entry, TypeInd_t(), ColumnTypes_t(), ExtraArgsTag{});
+         else
+            UpdateInBatch(slot, entry);
          fLastCheckedEntry[slot] = entry;
       }
    }
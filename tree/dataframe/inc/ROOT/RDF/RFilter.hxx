@@ -16,6 +16,7 @@
 #include "ROOT/RDF/NodesUtils.hxx"
 #include "ROOT/RDF/Utils.hxx"
 #include "ROOT/RDF/RFilterBase.hxx"
+#include "ROOT/RDF/RLoopManager.hxx"
 #include "ROOT/RIntegerSequence.hxx"
 #include "ROOT/TypeTraits.hxx"
 #include "RtypesCore.h"
@@ -87,6 +88,33 @@ public:
       return fLastResult[slot];
    }
 
+   /// Batch mode: evaluate the filter on the entries of the batch that pass the upstream filters.
+   const ROOT::VecOps::RVec<char> &CheckFiltersBatch(unsigned int slot, Long64_t firstEntry, unsigned int n) final
+   {
+      auto &mask = fBatchMasks[slot];
+      if (firstEntry != fLastCheckedBatch[slot]) {
+         const auto &prevMask = fPrevData.CheckFiltersBatch(slot, firstEntry, n);
+         if (mask.size() < n)
+            mask.resize(n);
+         ULong64_t nChecked = 0;
+         ULong64_t nAccepted = 0;
+         for (auto i = 0u; i < n; ++i) {
+            if (prevMask[i]) {
+               const bool passed = CheckFilterHelper(slot, firstEntry + i, TypeInd_t());
+               mask[i] = passed;
+               nAccepted += passed;
+               ++nChecked;
+            } else {
+               mask[i] = 0;
+            }
+         }
+         fAccepted[slot] += nAccepted;
+         fRejected[slot] += nChecked - nAccepted;
+         fLastCheckedBatch[slot] = firstEntry;
+      }
+      return mask;
+   }
+
    template <std::size_t... S>
    bool CheckFilterHelper(unsigned int slot, Long64_t entry, std::index_sequence<S...>)
    {
@@ -101,6 +129,9 @@ public:
       for (auto &bookedBranch : fCustomColumns.GetColumns())
          bookedBranch.second->InitSlot(r, slot);
       RDFInternal::InitRDFValues(slot, fValues[slot], r, fBranches, fCustomColumns, TypeInd_t());
+      RDFInternal::EnableBatchRDFValues(fValues[slot], fLoopManager->GetBatchLoaders(slot),
+                                        fLoopManager->GetBatchSize(), TypeInd_t());
+      fLastCheckedBatch[slot] = -1;
    }
 
    // recursive chain of `Report`s
@@ -39,6 +39,8 @@ protected:
    std::vector<int> fLastResult = {true}; // std::vector<bool> cannot be used in a MT context safely
    std::vector<ULong64_t> fAccepted = {0};
    std::vector<ULong64_t> fRejected = {0};
+   std::vector<Long64_t> fLastCheckedBatch;          ///< Batch mode: first entry of the last batch checked, per slot
+   std::vector<ROOT::VecOps::RVec<char>> fBatchMasks; ///< Batch mode: selection mask of the last batch, per slot
    const std::string fName;
    const unsigned int fNSlots; ///< Number of thread slots used by this node, inherited from parent node.
 
@@ -14,12 +14,14 @@
 #include "ROOT/RDataSource.hxx"
 #include "ROOT/RDF/ActionHelpers.hxx"
 #include "ROOT/RDF/RBookedCustomColumns.hxx"
+#include "ROOT/RDF/RCacheDS.hxx"
 #include "ROOT/RDF/HistoModels.hxx"
 #include "ROOT/RDF/InterfaceUtils.hxx"
 #include "ROOT/RDF/RRange.hxx"
 #include "ROOT/RDF/Utils.hxx"
 #include "ROOT/RIntegerSequence.hxx"
 #include "ROOT/RDF/RLazyDSImpl.hxx"
+#include "ROOT/RCacheOptions.hxx"
 #include "ROOT/RResultPtr.hxx"
 #include "ROOT/RSnapshotOptions.hxx"
 #include "ROOT/RStringView.hxx"
@@ -460,6 +462,18 @@ public:
    /// opts.fLazy = true;
    /// df.Snapshot("outputTree", "outputFile.root", {"x"}, opts);
    /// ~~~
+   ///
+   /// #### Multi-thread Snapshot
+   /// With implicit multi-threading, each worker fills its own tree in memory. By default, the in-memory files are
+   /// merged into the output file by a TBufferMerger. With `fMTBasketMerge`, workers instead compress their baskets
+   /// and append them to the output tree, which only copies the compressed bytes under a lock and scales better
+   /// with the number of threads. `fMTFlushEntries` sets how many entries a worker fills before each hand-over:
+   /// ~~~{.cpp}
+   /// RSnapshotOptions opts;
+   /// opts.fMTBasketMerge = true;
+   /// opts.fMTFlushEntries = 10000;
+   /// df.Snapshot("outputTree", "outputFile.root", {"x"}, opts);
+   /// ~~~
    template <typename... ColumnTypes>
    RResultPtr<RInterface<RLoopManager>>
    Snapshot(std::string_view treename, std::string_view filename, const ColumnNames_t &columnList,
@@ -595,53 +609,50 @@ public:
       return CacheImpl<ColumnTypes...>(columnList, staticSeq);
    }
 
+   ////////////////////////////////////////////////////////////////////////////
+   /// \brief Save selected columns in memory, within a memory budget
+   /// \tparam ColumnTypes variadic list of branch/column types.
+   /// \param[in] columns to be cached in memory.
+   /// \param[in] options RCacheOptions struct with extra options to steer the storage of the cached columns.
+   /// \return a `RDataFrame` that wraps the cached dataset.
+   ///
+   /// The entries are cached in chunks of `options.fChunkSize` entries, filled concurrently by the threads of the
+   /// event loop and processed in parallel by the event loops of the returned dataframe. If a compression level
+   /// or a memory budget is set, the chunks are serialized and compressed with `options.fCompressionAlgorithm`;
+   /// the chunks which do not fit in the budget are spilled to a temporary file in `options.fSpillDirectory`.
+   /// Chunks of columns whose type has no dictionary are neither compressed nor spilled.
+   ///
+   /// Example usage:
+   /// ~~~{.cpp}
+   /// RCacheOptions opts;
+   /// opts.fMemoryBudget = 4ull << 30; // 4 GB
+   /// opts.fCompressionLevel = 1;
+   /// auto cached = df.Filter("pt > 20").Cache<float, RVec<float>>({"pt", "jet_eta"}, opts);
+   /// ~~~
+   template <typename... ColumnTypes>
+   RInterface<RLoopManager> Cache(const ColumnNames_t &columnList, const RCacheOptions &options)
+   {
+      return CacheImpl<ColumnTypes...>(columnList, options);
+   }
+
    ////////////////////////////////////////////////////////////////////////////
    /// \brief Save selected columns in memory
    /// \param[in] columns to be cached in memory
    /// \return a `RDataFrame` that wraps the cached dataset.
    ///
    /// See the previous overloads for more information.
-   RInterface<RLoopManager> Cache(const ColumnNames_t &columnList)
-   {
-      // Early return: if the list of columns is empty, just return an empty RDF
-      // If we proceed, the jitted call will not compile!
-      if (columnList.empty()) {
-         auto nEntries = *this->Count();
-         RInterface<RLoopManager> emptyRDF(std::make_shared<RLoopManager>(nEntries));
-         return emptyRDF;
-      }
+   RInterface<RLoopManager> Cache(const ColumnNames_t &columnList) { return JitCache(columnList, nullptr); }
 
-      auto tree = fLoopManager->GetTree();
-      const auto nsID = fLoopManager->GetID();
-      std::stringstream cacheCall;
-      auto upcastNode = RDFInternal::UpcastNode(fProxiedPtr);
-      RInterface<TTraits::TakeFirstParameter_t<decltype(upcastNode)>> upcastInterface(
-         fProxiedPtr, *fLoopManager, fCustomColumns, fBranchNames, fDataSource);
-      // build a string equivalent to
-      // "(RInterface<nodetype*>*)(this)->Cache<Ts...>(*(ColumnNames_t*)(&columnList))"
-      RInterface<RLoopManager> resRDF(std::make_shared<ROOT::Detail::RDF::RLoopManager>(0));
-      cacheCall << "*reinterpret_cast<ROOT::RDF::RInterface<ROOT::Detail::RDF::RLoopManager>*>("
-                << RDFInternal::PrettyPrintAddr(&resRDF)
-                << ") = reinterpret_cast<ROOT::RDF::RInterface<ROOT::Detail::RDF::RNodeBase>*>("
-                << RDFInternal::PrettyPrintAddr(&upcastInterface) << ")->Cache<";
-
-      const auto &customCols = fCustomColumns.GetNames();
-      for (auto &c : columnList) {
-         const auto isCustom = std::find(customCols.begin(), customCols.end(), c) != customCols.end();
-         cacheCall << RDFInternal::ColumnName2ColumnTypeName(c, nsID, tree, fDataSource, isCustom) << ", ";
-      };
-      if (!columnList.empty())
-         cacheCall.seekp(-2, cacheCall.cur);                         // remove the last ",
-      cacheCall << ">(*reinterpret_cast<std::vector<std::string>*>(" // vector<string> should be ColumnNames_t
-                << RDFInternal::PrettyPrintAddr(&columnList) << "));";
-      // jit cacheCall, return result
-      TInterpreter::EErrorCode errorCode;
-      gInterpreter->Calc(cacheCall.str().c_str(), &errorCode);
-      if (TInterpreter::EErrorCode::kNoError != errorCode) {
-         std::string msg = "Cannot jit Cache call. Interpreter error code is " + std::to_string(errorCode) + ".";
-         throw std::runtime_error(msg);
-      }
-      return resRDF;
+   ////////////////////////////////////////////////////////////////////////////
+   /// \brief Save selected columns in memory, within a memory budget
+   /// \param[in] columns to be cached in memory
+   /// \param[in] options RCacheOptions struct with extra options to steer the storage of the cached columns.
+   /// \return a `RDataFrame` that wraps the cached dataset.
+   ///
+   /// See the previous overloads for more information.
+   RInterface<RLoopManager> Cache(const ColumnNames_t &columnList, const RCacheOptions &options)
+   {
+      return JitCache(columnList, &options);
    }
 
    ////////////////////////////////////////////////////////////////////////////
@@ -657,6 +668,19 @@ public:
       return Cache(selectedColumns);
    }
 
+   ////////////////////////////////////////////////////////////////////////////
+   /// \brief Save selected columns in memory, within a memory budget
+   /// \param[in] a regular expression to select the columns
+   /// \param[in] options RCacheOptions struct with extra options to steer the storage of the cached columns.
+   /// \return a `RDataFrame` that wraps the cached dataset.
+   ///
+   /// See the previous overloads for more information.
+   RInterface<RLoopManager> Cache(std::string_view columnNameRegexp, const RCacheOptions &options)
+   {
+      auto selectedColumns = ConvertRegexToColumns(columnNameRegexp, "Cache");
+      return Cache(selectedColumns, options);
+   }
+
    ////////////////////////////////////////////////////////////////////////////
    /// \brief Save selected columns in memory
    /// \param[in] columns to be cached in memory.
@@ -669,6 +693,19 @@ public:
       return Cache(selectedColumns);
    }
 
+   ////////////////////////////////////////////////////////////////////////////
+   /// \brief Save selected columns in memory, within a memory budget
+   /// \param[in] columns to be cached in memory.
+   /// \param[in] options RCacheOptions struct with extra options to steer the storage of the cached columns.
+   /// \return a `RDataFrame` that wraps the cached dataset.
+   ///
+   /// See the previous overloads for more information.
+   RInterface<RLoopManager> Cache(std::initializer_list<std::string> columnList, const RCacheOptions &options)
+   {
+      ColumnNames_t selectedColumns(columnList);
+      return Cache(selectedColumns, options);
+   }
+
    // clang-format off
    ////////////////////////////////////////////////////////////////////////////
    /// \brief Creates a node that filters entries based on range: [begin, end)
@@ -2070,6 +2107,55 @@ private:
       return snapshotRDFResPtr;
    }
 
+   ////////////////////////////////////////////////////////////////////////////
+   /// \brief Jit the call to the templated Cache, with the given options if not null
+   RInterface<RLoopManager> JitCache(const ColumnNames_t &columnList, const RCacheOptions *options)
+   {
+      // Early return: if the list of columns is empty, just return an empty RDF
+      // If we proceed, the jitted call will not compile!
+      if (columnList.empty()) {
+         auto nEntries = *this->Count();
+         RInterface<RLoopManager> emptyRDF(std::make_shared<RLoopManager>(nEntries));
+         return emptyRDF;
+      }
+
+      auto tree = fLoopManager->GetTree();
+      const auto nsID = fLoopManager->GetID();
+      std::stringstream cacheCall;
+      auto upcastNode = RDFInternal::UpcastNode(fProxiedPtr);
+      RInterface<TTraits::TakeFirstParameter_t<decltype(upcastNode)>> upcastInterface(
+         fProxiedPtr, *fLoopManager, fCustomColumns, fBranchNames, fDataSource);
+      // build a string equivalent to
+      // "(RInterface<nodetype*>*)(this)->Cache<Ts...>(*(ColumnNames_t*)(&columnList)[, *(RCacheOptions*)(options)])"
+      RInterface<RLoopManager> resRDF(std::make_shared<ROOT::Detail::RDF::RLoopManager>(0));
+      cacheCall << "*reinterpret_cast<ROOT::RDF::RInterface<ROOT::Detail::RDF::RLoopManager>*>("
+                << RDFInternal::PrettyPrintAddr(&resRDF)
+                << ") = reinterpret_cast<ROOT::RDF::RInterface<ROOT::Detail::RDF::RNodeBase>*>("
+                << RDFInternal::PrettyPrintAddr(&upcastInterface) << ")->Cache<";
+
+      const auto &customCols = fCustomColumns.GetNames();
+      for (auto &c : columnList) {
+         const auto isCustom = std::find(customCols.begin(), customCols.end(), c) != customCols.end();
+         cacheCall << RDFInternal::ColumnName2ColumnTypeName(c, nsID, tree, fDataSource, isCustom) << ", ";
+      };
+      if (!columnList.empty())
+         cacheCall.seekp(-2, cacheCall.cur);                         // remove the last ",
+      cacheCall << ">(*reinterpret_cast<std::vector<std::string>*>(" // vector<string> should be ColumnNames_t
+                << RDFInternal::PrettyPrintAddr(&columnList) << ")";
+      if (options)
+         cacheCall << ", *reinterpret_cast<const ROOT::RDF::RCacheOptions*>(" << RDFInternal::PrettyPrintAddr(options)
+                   << ")";
+      cacheCall << ");";
+      // jit cacheCall, return result
+      TInterpreter::EErrorCode errorCode;
+      gInterpreter->Calc(cacheCall.str().c_str(), &errorCode);
+      if (TInterpreter::EErrorCode::kNoError != errorCode) {
+         std::string msg = "Cannot jit Cache call. Interpreter error code is " + std::to_string(errorCode) + ".";
+         throw std::runtime_error(msg);
+      }
+      return resRDF;
+   }
+
    ////////////////////////////////////////////////////////////////////////////
    /// \brief Implementation of cache
    template <typename... BranchTypes, std::size_t... S>
@@ -2094,6 +2180,39 @@ private:
       return cachedRDF;
    }
 
+   ////////////////////////////////////////////////////////////////////////////
+   /// \brief Implementation of cache with options: the columns are stored in chunks by a RCacheHelper
+   template <typename... BranchTypes>
+   RInterface<RLoopManager> CacheImpl(const ColumnNames_t &columnList, const RCacheOptions &options)
+   {
+      // Check at compile time that the columns types are copy constructible
+      constexpr bool areCopyConstructible =
+         RDFInternal::TEvalAnd<std::is_copy_constructible<BranchTypes>::value...>::value;
+      static_assert(areCopyConstructible, "Columns of a type which is not copy constructible cannot be cached yet.");
+
+      RDFInternal::CheckTypesAndPars(sizeof...(BranchTypes), columnList.size());
+
+      const auto validCols = GetValidatedColumnNames(columnList.size(), columnList);
+
+      auto newColumns = CheckAndFillDSColumns(validCols, std::index_sequence_for<BranchTypes...>(),
+                                              TTraits::TypeList<BranchTypes...>());
+
+      auto store = std::make_shared<RDFInternal::RCacheStore>(options);
+      auto nEntries = std::make_shared<ULong64_t>(0);
+      using Helper_t = RDFInternal::RCacheHelper<BranchTypes...>;
+      using Action_t = RDFInternal::RAction<Helper_t, Proxied>;
+      auto action = std::make_unique<Action_t>(Helper_t(store, nEntries, fLoopManager->GetNSlots()), validCols,
+                                               fProxiedPtr, newColumns);
+      fLoopManager->Book(action.get());
+      auto nEntriesPtr = MakeResultPtr(nEntries, *fLoopManager, std::move(action));
+
+      auto ds = std::make_unique<RCacheDS<BranchTypes...>>(columnList, store, nEntriesPtr);
+
+      RInterface<RLoopManager> cachedRDF(std::make_shared<RLoopManager>(std::move(ds), columnList));
+
+      return cachedRDF;
+   }
+
 protected:
    RInterface(const std::shared_ptr<Proxied> &proxied, RLoopManager &lm, RDFInternal::RBookedCustomColumns columns,
               const std::shared_ptr<const ColumnNames_t> &datasetColumns, RDataSource *ds)
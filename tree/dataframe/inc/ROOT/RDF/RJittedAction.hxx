@@ -45,6 +45,8 @@ public:
    void SetAction(std::unique_ptr<RActionBase> a) { fConcreteAction = std::move(a); }
 
    void Run(unsigned int slot, Long64_t entry) final;
+   void RunBatch(unsigned int slot, Long64_t firstEntry, unsigned int n) final;
+   bool SupportsBatchMode() const final;
    void Initialize() final;
    void InitSlot(TTreeReader *r, unsigned int slot) final;
    void TriggerChildrenCount() final;
@@ -47,6 +47,7 @@ public:
 
    void InitSlot(TTreeReader *r, unsigned int slot) final;
    bool CheckFilters(unsigned int slot, Long64_t entry) final;
+   const ROOT::VecOps::RVec<char> &CheckFiltersBatch(unsigned int slot, Long64_t firstEntry, unsigned int n) final;
    void Report(ROOT::RDF::RCutFlowReport &) const final;
    void PartialReport(ROOT::RDF::RCutFlowReport &) const final;
    void FillReport(ROOT::RDF::RCutFlowReport &) const final;
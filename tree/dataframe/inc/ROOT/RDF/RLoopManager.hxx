@@ -17,6 +17,7 @@
 #include <functional>
 #include <map>
 #include <memory>
+#include <stack>
 #include <string>
 #include <vector>
 
@@ -94,6 +95,14 @@ class RLoopManager : public RNodeBase {
       }
    };
 
+   /// Entries collected by a task in batch mode, see SetBatchSize.
+   class TBatch {
+   public:
+      Long64_t fFirstEntry{0};              ///< Entry number of the first entry in the batch
+      unsigned int fSize{0};                ///< Number of entries collected so far
+      RDFInternal::BatchLoaders_t fLoaders; ///< Copy the column values of the current entry into the batch buffers
+   };
+
    std::vector<RDFInternal::RActionBase *> fBookedActions; ///< Non-owning pointers to actions to be run
    std::vector<RDFInternal::RActionBase *> fRunActions;    ///< Non-owning pointers to actions already run
    std::vector<RFilterBase *> fBookedFilters;
@@ -120,6 +129,17 @@ class RLoopManager : public RNodeBase {
    std::vector<RCustomColumnBase *>
       fCustomColumns; ///< The loopmanager tracks all columns created, without owning them.
 
+   unsigned int fBatchSize{0}; ///< Number of entries processed at once by the nodes, 0 if batch mode is off
+   /// Batches being collected, per slot. Tasks that run interleaved on the same slot each push their own batch.
+   std::vector<std::stack<TBatch>> fBatches;
+   std::vector<ROOT::VecOps::RVec<char>> fBatchAllPass; ///< Per-slot selection masks with all entries selected
+   std::vector<ULong64_t> fBatchIds; ///< Per-slot number of batches processed so far, identifies the running batch
+
+   /// The loop managers sharing their event loop with this one, this one included. Null if the event loop is not shared
+   std::shared_ptr<std::vector<RLoopManager *>> fSharedScan;
+   /// While this loop manager runs a shared event loop, the other loop managers taking part in it
+   std::vector<RLoopManager *> fSharedLoops;
+
    void RunEmptySourceMT();
    void RunEmptySource();
    void RunTreeProcessorMT();
@@ -127,11 +147,16 @@ class RLoopManager : public RNodeBase {
    void RunDataSourceMT();
    void RunDataSource();
    void RunAndCheckFilters(unsigned int slot, Long64_t entry);
+   void CollectBatchEntry(unsigned int slot, Long64_t entry);
+   void FlushBatch(unsigned int slot);
+   void FinishBatch(unsigned int slot);
+   bool CanRunInBatches() const;
    void InitNodeSlots(TTreeReader *r, unsigned int slot);
    void InitNodes();
    void CleanUpNodes();
    void CleanUpTask(unsigned int slot);
    void EvalChildrenCounts();
+   bool AllStopped() const;
    unsigned int GetNextID() const;
 
 public:
@@ -140,6 +165,7 @@ public:
    RLoopManager(std::unique_ptr<RDataSource> ds, const ColumnNames_t &defaultBranches);
    RLoopManager(const RLoopManager &) = delete;
    RLoopManager &operator=(const RLoopManager &) = delete;
+   ~RLoopManager();
 
    void BuildJittedNodes();
    RLoopManager *GetLoopManagerUnchecked() final { return this; }
@@ -156,6 +182,7 @@ public:
    void Book(RRangeBase *rangePtr);
    void Deregister(RRangeBase *rangePtr);
    bool CheckFilters(unsigned int, Long64_t) final;
+   const ROOT::VecOps::RVec<char> &CheckFiltersBatch(unsigned int slot, Long64_t, unsigned int n) final;
    unsigned int GetNSlots() const { return fNSlots; }
    bool MustRunNamedFilters() const { return fMustRunNamedFilters; }
    void Report(ROOT::RDF::RCutFlowReport &rep) const final;
@@ -169,6 +196,14 @@ public:
    const std::map<std::string, std::string> &GetAliasMap() const { return fAliasColumnNameMap; }
    void RegisterCallback(ULong64_t everyNEvents, std::function<void(unsigned int)> &&f);
    unsigned int GetID() const { return fID; }
+   void SetBatchSize(unsigned int batchSize);
+   unsigned int GetBatchSize() const { return fBatchSize; }
+   RDFInternal::BatchLoaders_t *GetBatchLoaders(unsigned int slot);
+   /// Batch mode: identifier of the batch being processed on `slot`, different for each batch of the slot.
+   ULong64_t GetBatchId(unsigned int slot) const { return fBatchIds[slot]; }
+   /// Batch mode: entry number of the first entry of the batch being processed on `slot`.
+   Long64_t GetBatchFirstEntry(unsigned int slot) const { return fBatches[slot].top().fFirstEntry; }
+   void ShareEventLoop(RLoopManager &other);
 
    /// End of recursive chain of calls, does nothing
    void AddFilterName(std::vector<std::string> &) {}
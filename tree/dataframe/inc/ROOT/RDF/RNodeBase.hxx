@@ -11,6 +11,7 @@
 #ifndef ROOT_RDFNODEBASE
 #define ROOT_RDFNODEBASE
 
+#include "ROOT/RVec.hxx"
 #include "RtypesCore.h"
 
 #include <memory>
@@ -48,6 +49,9 @@ public:
    RNodeBase(RLoopManager *lm = nullptr) : fLoopManager(lm) {}
    virtual ~RNodeBase() {}
    virtual bool CheckFilters(unsigned int, Long64_t) = 0;
+   /// Batch mode: return the selection mask of the `n` consecutive entries starting at `firstEntry`.
+   /// Only the first `n` elements of the returned mask are meaningful.
+   virtual const ROOT::VecOps::RVec<char> &CheckFiltersBatch(unsigned int slot, Long64_t firstEntry, unsigned int n) = 0;
    virtual void Report(ROOT::RDF::RCutFlowReport &) const = 0;
    virtual void PartialReport(ROOT::RDF::RCutFlowReport &) const = 0;
    virtual void IncrChildrenCount() = 0;
@@ -14,6 +14,7 @@
 #include "ROOT/RDF/RRangeBase.hxx"
 #include "RtypesCore.h"
 
+#include <algorithm>
 #include <memory>
 
 namespace ROOT {
@@ -71,6 +72,35 @@ public:
       return fLastResult;
    }
 
+   /// Batch mode: apply the range logic to the entries of the batch that pass the upstream filters.
+   const ROOT::VecOps::RVec<char> &CheckFiltersBatch(unsigned int slot, Long64_t firstEntry, unsigned int n) final
+   {
+      if (firstEntry != fLastCheckedBatch) {
+         if (fBatchMask.size() < n)
+            fBatchMask.resize(n);
+         if (fHasStopped) {
+            std::fill(fBatchMask.begin(), fBatchMask.begin() + n, 0);
+         } else {
+            const auto &prevMask = fPrevData.CheckFiltersBatch(slot, firstEntry, n);
+            for (auto i = 0u; i < n; ++i) {
+               if (!prevMask[i] || fHasStopped) {
+                  fBatchMask[i] = 0;
+                  continue;
+               }
+               ++fNProcessedEntries;
+               fBatchMask[i] = !(fNProcessedEntries <= fStart || (fStop > 0 && fNProcessedEntries > fStop) ||
+                                 (fStride != 1 && fNProcessedEntries % fStride != 0));
+               if (fNProcessedEntries == fStop) {
+                  fHasStopped = true;
+                  fPrevData.StopProcessing();
+               }
+            }
+         }
+         fLastCheckedBatch = firstEntry;
+      }
+      return fBatchMask;
+   }
+
    // recursive chain of `Report`s
    // RRange simply forwards these calls to the previous node
    void Report(ROOT::RDF::RCutFlowReport &rep) const final { fPrevData.PartialReport(rep); }
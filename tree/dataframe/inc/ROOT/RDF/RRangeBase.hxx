@@ -38,6 +38,8 @@ protected:
    bool fLastResult{true};
    ULong64_t fNProcessedEntries{0};
    bool fHasStopped{false};    ///< True if the end of the range has been reached
+   Long64_t fLastCheckedBatch{-1};      ///< Batch mode: first entry of the last batch checked
+   ROOT::VecOps::RVec<char> fBatchMask; ///< Batch mode: selection mask of the last batch
    const unsigned int fNSlots; ///< Number of thread slots used by this node, inherited from parent node.
 
    void ResetCounters();
@@ -48,6 +48,9 @@ public:
    RDataFrame(TTree &tree, const ColumnNames_t &defaultBranches = {});
    RDataFrame(ULong64_t numEntries);
    RDataFrame(std::unique_ptr<ROOT::RDF::RDataSource>, const ColumnNames_t &defaultBranches = {});
+
+   void SetBatchSize(unsigned int batchSize);
+   void ShareEventLoop(RDataFrame &other);
 };
 
 } // ns ROOT
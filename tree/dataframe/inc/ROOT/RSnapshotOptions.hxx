@@ -35,6 +35,12 @@ struct RSnapshotOptions {
    int fAutoFlush = 0;                        ///< AutoFlush value for output tree
    int fSplitLevel = 99;                      ///< Split level of output tree
    bool fLazy = false;                        ///< Delay the snapshot of the dataset
+   /// In multi-thread runs, let each worker compress its baskets and append them to the output tree, instead of
+   /// merging the workers' in-memory files through a TBufferMerger
+   bool fMTBasketMerge = false;
+   /// In multi-thread runs, number of entries each worker fills before handing them over to the output file.
+   /// If zero, the autoflush setting of the output tree is used
+   int fMTFlushEntries = 0;
 };
 } // ns RDF
 } // ns ROOT
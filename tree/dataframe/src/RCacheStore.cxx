@@ -0,0 +1,224 @@
+/*************************************************************************
+ * Copyright (C) 1995-2018, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#include "ROOT/RDF/RCacheStore.hxx"
+#include "RZip.h"
+#include "TError.h"
+#include "TString.h"
+#include "TSystem.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace ROOT {
+namespace Internal {
+namespace RDF {
+
+RCacheStore::RCacheStore(const ROOT::RDF::RCacheOptions &options) : fOptions(options)
+{
+}
+
+RCacheStore::~RCacheStore()
+{
+   if (!fSpillFile.is_open())
+      return;
+   fSpillFile.close();
+   gSystem->Unlink(fSpillFileName.c_str());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Create the spill file in the directory given by the options. Must be called with fMutex held.
+bool RCacheStore::OpenSpillFile()
+{
+   if (!fSpillFileName.empty())
+      return fSpillFile.is_open();
+
+   TString name("rdf_cache");
+   FILE *fp = gSystem->TempFileName(name, fOptions.fSpillDirectory.empty() ? nullptr
+                                                                         : fOptions.fSpillDirectory.c_str());
+   if (!fp) {
+      Error("Cache", "Cannot create the spill file in %s: the memory budget will be exceeded.",
+            fOptions.fSpillDirectory.empty() ? gSystem->TempDirectory() : fOptions.fSpillDirectory.c_str());
+      fSpillFileName = "-";
+      return false;
+   }
+   fclose(fp);
+   fSpillFileName = name.Data();
+   fSpillFile.open(fSpillFileName, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+   if (!fSpillFile.is_open()) {
+      Error("Cache", "Cannot open the spill file %s: the memory budget will be exceeded.", fSpillFileName.c_str());
+      gSystem->Unlink(fSpillFileName.c_str());
+   }
+   return fSpillFile.is_open();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Move the data of the chunk to the end of the spill file. Must be called with fMutex held.
+void RCacheStore::Spill(RChunk &chunk)
+{
+   if (!OpenSpillFile())
+      return;
+   fSpillFile.seekp(fSpilledBytes);
+   fSpillFile.write(chunk.fData.data(), chunk.fNbytes);
+   if (!fSpillFile.good()) {
+      Error("Cache", "Cannot write to the spill file %s: the memory budget will be exceeded.", fSpillFileName.c_str());
+      fSpillFile.clear();
+      return;
+   }
+   chunk.fSpillOffset = fSpilledBytes;
+   fSpilledBytes += chunk.fNbytes;
+   std::vector<char>().swap(chunk.fData);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Add a chunk of `nEntries` entries serialized in `buffer`. The compression, which is the expensive part, is done
+/// by the calling thread before the chunk is registered.
+void RCacheStore::AddChunk(ULong64_t nEntries, const char *buffer, Int_t len)
+{
+   RChunk chunk;
+   chunk.fNEntries = nEntries;
+   chunk.fObjLen = len;
+
+   const int cxlevel = fOptions.fCompressionLevel;
+   if (cxlevel > 0 && len > 256) {
+      const Int_t nbuffers = 1 + (len - 1) / kMAXZIPBUF;
+      chunk.fData.resize(len + 9 * nbuffers + 28);
+      char *src = const_cast<char *>(buffer);
+      char *tgt = chunk.fData.data();
+      Int_t noutot = 0;
+      for (Int_t i = 0; i < nbuffers; ++i) {
+         Int_t bufmax = (i == nbuffers - 1) ? len - i * kMAXZIPBUF : kMAXZIPBUF;
+         Int_t nout = 0;
+         R__zipMultipleAlgorithm(cxlevel, &bufmax, src, &bufmax, tgt, &nout, fOptions.fCompressionAlgorithm);
+         if (nout == 0 || noutot + nout >= len) { // the buffer cannot be compressed
+            noutot = 0;
+            break;
+         }
+         src += kMAXZIPBUF;
+         tgt += nout;
+         noutot += nout;
+      }
+      chunk.fNbytes = noutot;
+   }
+   if (chunk.fNbytes == 0) {
+      chunk.fData.assign(buffer, buffer + len);
+      chunk.fNbytes = len;
+   } else {
+      chunk.fData.resize(chunk.fNbytes);
+      chunk.fData.shrink_to_fit();
+   }
+
+   std::lock_guard<std::mutex> lock(fMutex);
+   fNEntries += nEntries;
+   if (fOptions.fMemoryBudget > 0 && fMemoryUsage + chunk.fNbytes > fOptions.fMemoryBudget)
+      Spill(chunk);
+   if (chunk.fSpillOffset < 0)
+      fMemoryUsage += chunk.fNbytes;
+   fChunks.emplace_back(std::move(chunk));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Add a chunk of `nEntries` entries kept as the `columns` they were filled in, which take about `size` bytes.
+/// Such chunks cannot be spilled: a warning is issued the first time they exceed the memory budget.
+void RCacheStore::AddChunk(ULong64_t nEntries, std::shared_ptr<void> columns, ULong64_t size)
+{
+   RChunk chunk;
+   chunk.fNEntries = nEntries;
+   chunk.fColumns = std::move(columns);
+
+   std::lock_guard<std::mutex> lock(fMutex);
+   fNEntries += nEntries;
+   fMemoryUsage += size;
+   if (fOptions.fMemoryBudget > 0 && fMemoryUsage > fOptions.fMemoryBudget && !fBudgetWarningIssued) {
+      Warning("Cache", "The memory budget of %llu bytes is exceeded, but the cached columns cannot be spilled to disk "
+                       "because some of their types have no dictionary.",
+              fOptions.fMemoryBudget);
+      fBudgetWarningIssued = true;
+   }
+   fChunks.emplace_back(std::move(chunk));
+}
+
+ULong64_t RCacheStore::GetNEntries() const
+{
+   std::lock_guard<std::mutex> lock(fMutex);
+   return fNEntries;
+}
+
+ULong64_t RCacheStore::GetMemoryUsage() const
+{
+   std::lock_guard<std::mutex> lock(fMutex);
+   return fMemoryUsage;
+}
+
+ULong64_t RCacheStore::GetSpilledBytes() const
+{
+   std::lock_guard<std::mutex> lock(fMutex);
+   return fSpilledBytes;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Fill `buffer` with the uncompressed serialized columns of the i-th chunk, reading it from the spill file if
+/// needed. Can be called concurrently. Return false in case of error.
+bool RCacheStore::LoadChunk(std::size_t i, std::vector<char> &buffer) const
+{
+   const RChunk &chunk = fChunks[i];
+   buffer.resize(chunk.fObjLen);
+
+   std::vector<char> spilled;
+   const char *data = chunk.fData.data();
+   if (chunk.fSpillOffset >= 0) {
+      // Read straight into the output if the chunk is not compressed
+      const bool isCompressed = chunk.fNbytes != chunk.fObjLen;
+      if (isCompressed)
+         spilled.resize(chunk.fNbytes);
+      char *dest = isCompressed ? spilled.data() : buffer.data();
+      {
+         std::lock_guard<std::mutex> lock(fMutex);
+         fSpillFile.seekg(chunk.fSpillOffset);
+         fSpillFile.read(dest, chunk.fNbytes);
+         if (!fSpillFile.good()) {
+            fSpillFile.clear();
+            Error("Cache", "Cannot read chunk %lu from the spill file %s.", (unsigned long)i, fSpillFileName.c_str());
+            return false;
+         }
+      }
+      if (!isCompressed)
+         return true;
+      data = spilled.data();
+   }
+
+   if (chunk.fNbytes == chunk.fObjLen) {
+      std::memcpy(buffer.data(), data, chunk.fObjLen);
+      return true;
+   }
+
+   auto src = reinterpret_cast<unsigned char *>(const_cast<char *>(data));
+   auto tgt = reinterpret_cast<unsigned char *>(buffer.data());
+   Int_t noutot = 0;
+   while (noutot < chunk.fObjLen) {
+      Int_t nin = 0, nbuf = 0, nout = 0;
+      if (R__unzip_header(&nin, src, &nbuf) != 0)
+         break;
+      R__unzip(&nin, src, &nbuf, tgt, &nout);
+      if (!nout)
+         break;
+      noutot += nout;
+      src += nin;
+      tgt += nout;
+   }
+   if (noutot != chunk.fObjLen) {
+      Error("Cache", "Cannot uncompress chunk %lu of the cache.", (unsigned long)i);
+      return false;
+   }
+   return true;
+}
+
+} // ns RDF
+} // ns Internal
+} // ns ROOT
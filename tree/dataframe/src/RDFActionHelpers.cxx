@@ -24,6 +24,14 @@ void CountHelper::Exec(unsigned int slot)
    fCounts[slot]++;
 }
 
+void CountHelper::BatchExec(unsigned int slot, unsigned int n, const char *mask)
+{
+   ULong64_t count = 0;
+   for (auto i = 0u; i < n; ++i)
+      count += mask[i] != 0;
+   fCounts[slot] += count;
+}
+
 void CountHelper::Finalize()
 {
    *fResultCount = 0;
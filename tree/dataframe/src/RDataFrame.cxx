@@ -713,6 +713,44 @@ Most `Filter`/`Define` functions will in fact be pure in the functional programm
 All actions are built to be thread-safe with the exception of `Foreach`, in which case users are responsible of
 thread-safety, see [here](#generic-actions).
 
+### Memory usage of histograms
+In multi-thread event loops, `Histo1D`, `Histo2D` and `Histo3D` normally fill a copy of the histogram per worker thread
+and merge the copies at the end. When these copies would exceed four million cells in total, e.g. for a fine-grained
+`TH3D`, all threads fill the result directly through a `ROOT::TH1ConcurrentFillManager` instead: each thread buffers its
+entries and adds them to the histogram in bulk, locking only the ranges of bins it updates.
+
+### <a name="batch-mode"></a>Batch mode
+By default each node of the computation graph is invoked once per entry. `RDataFrame::SetBatchSize` switches to
+processing entries in batches: the values of the input columns of a batch of consecutive entries are buffered,
+filters compute a selection mask for the whole batch and actions then run over the selected entries. The values of
+`Define`d columns are computed once per entry and kept for the whole batch. `Count`, `Sum` and the `Histo1D`,
+`Histo2D` and `Histo3D` actions over arithmetic columns process a whole batch in one call, looping over contiguous
+arrays of values; the other actions process the selected entries one at a time. The `rdfbatchbm` program in the
+`test` directory compares the two modes.
+~~~{.cpp}
+ROOT::RDataFrame d("myTree", "file.root");
+d.SetBatchSize(1024);
+auto h = d.Filter("x > 0").Histo1D("x");
+~~~
+Results are the same as in the default mode. Event loops that book actions which need stable addresses of the column
+values, such as `Snapshot`, or callbacks registered with `OnPartialResult`, fall back to processing one entry at a
+time.
+
+### <a name="shared-event-loops"></a>Shared event loops
+Independent `RDataFrame` objects over the same dataset, e.g. one per systematic variation, normally run one event loop
+each, reading and decompressing the same baskets every time. `RDataFrame::ShareEventLoop` lets them run a single event
+loop instead: triggering the actions of any of them runs the computation graphs of all of them in one pass over the
+dataset, in which the columns needed by all graphs are read.
+~~~{.cpp}
+ROOT::RDataFrame nominal("myTree", "file.root");
+ROOT::RDataFrame shifted("myTree", "file.root");
+nominal.ShareEventLoop(shifted);
+auto h1 = nominal.Filter("pt > 20").Histo1D("pt");
+auto h2 = shifted.Define("pt_up", "pt * 1.02").Filter("pt_up > 20").Histo1D("pt_up");
+h1->Draw(); // fills both h1 and h2
+~~~
+Dataframes reading from a data source cannot share their event loop.
+
 <a name="reference"></a>
 */
 // clang-format on
@@ -833,6 +871,27 @@ RDataFrame::RDataFrame(std::unique_ptr<ROOT::RDF::RDataSource> ds, const ColumnN
 {
 }
 
+//////////////////////////////////////////////////////////////////////////
+/// \brief Process entries in batches of batchSize consecutive entries.
+/// \param[in] batchSize The number of entries per batch, 0 (the default) to process entries one at a time.
+///
+/// See the section on [batch mode](#batch-mode) and RLoopManager::SetBatchSize.
+void RDataFrame::SetBatchSize(unsigned int batchSize)
+{
+   GetLoopManager()->SetBatchSize(batchSize);
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// \brief Run the event loops of this and of another dataframe over the same dataset as a single event loop.
+/// \param[in] other A dataframe processing the same TTree or TChain, or the same number of entries if it has no input
+/// files. The dataframes already sharing their event loop with `other` join as well.
+///
+/// See the section on [shared event loops](#shared-event-loops) and RLoopManager::ShareEventLoop.
+void RDataFrame::ShareEventLoop(RDataFrame &other)
+{
+   GetLoopManager()->ShareEventLoop(*other.GetLoopManager());
+}
+
 } // namespace ROOT
 
 namespace cling {
@@ -16,8 +16,8 @@ using namespace ROOT::Detail::RDF;
 
 RFilterBase::RFilterBase(RLoopManager *implPtr, std::string_view name, const unsigned int nSlots,
                          const RDFInternal::RBookedCustomColumns &customColumns)
-   : RNodeBase(implPtr), fLastResult(nSlots), fAccepted(nSlots), fRejected(nSlots), fName(name), fNSlots(nSlots),
-     fCustomColumns(customColumns) {}
+   : RNodeBase(implPtr), fLastResult(nSlots), fAccepted(nSlots), fRejected(nSlots), fLastCheckedBatch(nSlots, -1),
+     fBatchMasks(nSlots), fName(name), fNSlots(nSlots), fCustomColumns(customColumns) {}
 
 RFilterBase::~RFilterBase()
 {
@@ -46,6 +46,7 @@ void RFilterBase::FillReport(ROOT::RDF::RCutFlowReport &rep) const
 void RFilterBase::InitNode()
 {
    fLastCheckedEntry = std::vector<Long64_t>(fNSlots, -1);
+   fLastCheckedBatch = std::vector<Long64_t>(fNSlots, -1);
    if (!fName.empty()) // if this is a named filter we care about its report count
       ResetReportCount();
 }
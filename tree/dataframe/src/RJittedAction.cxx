@@ -24,6 +24,18 @@ void RJittedAction::Run(unsigned int slot, Long64_t entry)
    fConcreteAction->Run(slot, entry);
 }
 
+void RJittedAction::RunBatch(unsigned int slot, Long64_t firstEntry, unsigned int n)
+{
+   R__ASSERT(fConcreteAction != nullptr);
+   fConcreteAction->RunBatch(slot, firstEntry, n);
+}
+
+bool RJittedAction::SupportsBatchMode() const
+{
+   R__ASSERT(fConcreteAction != nullptr);
+   return fConcreteAction->SupportsBatchMode();
+}
+
 void RJittedAction::Initialize()
 {
    R__ASSERT(fConcreteAction != nullptr);
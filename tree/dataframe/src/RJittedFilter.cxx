@@ -35,6 +35,12 @@ bool RJittedFilter::CheckFilters(unsigned int slot, Long64_t entry)
    return fConcreteFilter->CheckFilters(slot, entry);
 }
 
+const ROOT::VecOps::RVec<char> &RJittedFilter::CheckFiltersBatch(unsigned int slot, Long64_t firstEntry, unsigned int n)
+{
+   R__ASSERT(fConcreteFilter != nullptr);
+   return fConcreteFilter->CheckFiltersBatch(slot, firstEntry, n);
+}
+
 void RJittedFilter::Report(ROOT::RDF::RCutFlowReport &cr) const
 {
    R__ASSERT(fConcreteFilter != nullptr);
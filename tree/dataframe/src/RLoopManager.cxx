@@ -7,6 +7,9 @@
 #include "ROOT/RDF/RSlotStack.hxx"
 #include "ROOT/TTreeProcessorMT.hxx"
 #include "RtypesCore.h" // Long64_t
+#include "TChain.h"
+#include "TChainElement.h"
+#include "TDirectory.h"
 #include "TError.h"
 #include "TInterpreter.h"
 #include "TROOT.h" // IsImplicitMTEnabled
@@ -16,7 +19,10 @@
 #include "ROOT/TThreadExecutor.hxx"
 #endif
 
+#include <algorithm>
+#include <cstring>
 #include <functional>
+#include <iterator>
 #include <memory>
 #include <stdexcept>
 #include <string>
@@ -46,6 +52,12 @@ RLoopManager::RLoopManager(std::unique_ptr<RDataSource> ds, const ColumnNames_t
    fDataSource->SetNSlots(fNSlots);
 }
 
+RLoopManager::~RLoopManager()
+{
+   if (fSharedScan)
+      RDFInternal::Erase(this, *fSharedScan);
+}
+
 /// Run event loop with no source files, in parallel.
 void RLoopManager::RunEmptySourceMT()
 {
@@ -88,9 +100,12 @@ void RLoopManager::RunEmptySourceMT()
 void RLoopManager::RunEmptySource()
 {
    InitNodeSlots(nullptr, 0);
-   for (ULong64_t currEntry = 0; currEntry < fNEmptyEntries && fNStopsReceived < fNChildren; ++currEntry) {
+   for (ULong64_t currEntry = 0; currEntry < fNEmptyEntries && !AllStopped(); ++currEntry) {
       RunAndCheckFilters(0, currEntry);
    }
+   FinishBatch(0);
+   for (auto lm : fSharedLoops)
+      lm->FinishBatch(0);
 }
 
 /// Run event loop over one or multiple ROOT files, in parallel.
@@ -123,9 +138,12 @@ void RLoopManager::RunTreeReader()
 
    // recursive call to check filters and conditionally execute actions
    // in the non-MT case processing can be stopped early by ranges, hence the check on fNStopsReceived
-   while (r.Next() && fNStopsReceived < fNChildren) {
+   while (r.Next() && !AllStopped()) {
       RunAndCheckFilters(0, r.GetCurrentEntry());
    }
+   FinishBatch(0);
+   for (auto lm : fSharedLoops)
+      lm->FinishBatch(0);
    fTree->GetEntry(0);
 }
 
@@ -146,6 +164,7 @@ void RLoopManager::RunDataSource()
             }
          }
       }
+      FinishBatch(0u);
       fDataSource->FinaliseSlot(0u);
       ranges = fDataSource->GetEntryRanges();
    }
@@ -190,6 +209,12 @@ void RLoopManager::RunDataSourceMT()
 /// Named filters must be called even if the analysis logic would not require it, lest they report confusing results.
 void RLoopManager::RunAndCheckFilters(unsigned int slot, Long64_t entry)
 {
+   for (auto lm : fSharedLoops)
+      lm->RunAndCheckFilters(slot, entry);
+   if (fBatchSize > 0) {
+      CollectBatchEntry(slot, entry);
+      return;
+   }
    for (auto &actionPtr : fBookedActions)
       actionPtr->Run(slot, entry);
    for (auto &namedFilterPtr : fBookedNamedFilters)
@@ -198,6 +223,57 @@ void RLoopManager::RunAndCheckFilters(unsigned int slot, Long64_t entry)
       callback(slot);
 }
 
+/// Batch mode: copy the values of the current entry in the batch buffers of the columns and run the computation
+/// graph once a full batch has been collected.
+/// Batches only contain consecutive entries: a gap in the entry numbers (e.g. entries skipped by a data source)
+/// flushes the current batch.
+void RLoopManager::CollectBatchEntry(unsigned int slot, Long64_t entry)
+{
+   auto &batch = fBatches[slot].top();
+   if (batch.fSize > 0 && entry != batch.fFirstEntry + batch.fSize)
+      FlushBatch(slot);
+   if (batch.fSize == 0)
+      batch.fFirstEntry = entry;
+   for (auto &load : batch.fLoaders)
+      load(batch.fSize, entry);
+   if (++batch.fSize == fBatchSize)
+      FlushBatch(slot);
+}
+
+/// Batch mode: execute actions and named filters on the entries collected so far.
+void RLoopManager::FlushBatch(unsigned int slot)
+{
+   auto &batch = fBatches[slot].top();
+   const auto n = batch.fSize;
+   if (n == 0)
+      return;
+   ++fBatchIds[slot];
+   for (auto &actionPtr : fBookedActions)
+      actionPtr->RunBatch(slot, batch.fFirstEntry, n);
+   for (auto &namedFilterPtr : fBookedNamedFilters)
+      namedFilterPtr->CheckFiltersBatch(slot, batch.fFirstEntry, n);
+   batch.fSize = 0;
+}
+
+/// Batch mode: process the last, possibly incomplete, batch of a task and forget about it.
+/// Must be called before the column readers of the task are cleared.
+void RLoopManager::FinishBatch(unsigned int slot)
+{
+   if (fBatchSize == 0 || fBatches[slot].empty())
+      return;
+   FlushBatch(slot);
+   fBatches[slot].pop();
+}
+
+/// Return true if all booked actions can consume batches of entries.
+/// Callbacks must see the partial results of the actions after each entry, so they also require processing
+/// entries one at a time.
+bool RLoopManager::CanRunInBatches() const
+{
+   return fCallbacks.empty() && std::all_of(fBookedActions.begin(), fBookedActions.end(),
+                      [](RDFInternal::RActionBase *a) { return a->SupportsBatchMode(); });
+}
+
 /// Build TTreeReaderValues for all nodes
 /// This method loops over all filters, actions and other booked objects and
 /// calls their `InitRDFValues` methods. It is called once per node per slot, before
@@ -205,12 +281,16 @@ void RLoopManager::RunAndCheckFilters(unsigned int slot, Long64_t entry)
 /// a particular slot will be using.
 void RLoopManager::InitNodeSlots(TTreeReader *r, unsigned int slot)
 {
+   if (fBatchSize > 0)
+      fBatches[slot].emplace();
    for (auto &ptr : fBookedActions)
       ptr->InitSlot(r, slot);
    for (auto &ptr : fBookedFilters)
       ptr->InitSlot(r, slot);
    for (auto &callback : fCallbacksOnce)
       callback(slot);
+   for (auto lm : fSharedLoops)
+      lm->InitNodeSlots(r, slot);
 }
 
 /// Initialize all nodes of the functional graph before running the event loop.
@@ -257,10 +337,13 @@ void RLoopManager::CleanUpNodes()
 /// Perform clean-up operations. To be called at the end of each task execution.
 void RLoopManager::CleanUpTask(unsigned int slot)
 {
+   FinishBatch(slot);
    for (auto &ptr : fBookedActions)
       ptr->FinalizeSlot(slot);
    for (auto &ptr : fBookedFilters)
       ptr->ClearTask(slot);
+   for (auto lm : fSharedLoops)
+      lm->CleanUpTask(slot);
 }
 
 /// Jit all actions that required runtime column type inference, and clean the `fToJit` member variable.
@@ -290,6 +373,14 @@ void RLoopManager::EvalChildrenCounts()
       namedFilterPtr->TriggerChildrenCount();
 }
 
+/// Return true if the ranges of all the computation graphs run by this event loop have stopped processing.
+bool RLoopManager::AllStopped() const
+{
+   return fNStopsReceived >= fNChildren &&
+          std::all_of(fSharedLoops.begin(), fSharedLoops.end(),
+                      [](const RLoopManager *lm) { return lm->fNStopsReceived >= lm->fNChildren; });
+}
+
 unsigned int RLoopManager::GetNextID() const
 {
    static unsigned int id = 0;
@@ -299,12 +390,31 @@ unsigned int RLoopManager::GetNextID() const
 
 /// Start the event loop with a different mechanism depending on IMT/no IMT, data source/no data source.
 /// Also perform a few setup and clean-up operations (jit actions if necessary, clear booked actions after the loop...).
+/// If the event loop is shared with other loop managers (see ShareEventLoop), their computation graphs are run as well.
 void RLoopManager::Run()
 {
-   if (!fToJit.empty())
-      BuildJittedNodes();
-
-   InitNodes();
+   fSharedLoops.clear();
+   if (fSharedScan)
+      std::copy_if(fSharedScan->begin(), fSharedScan->end(), std::back_inserter(fSharedLoops),
+                   [this](RLoopManager *lm) { return lm != this; });
+   std::vector<RLoopManager *> loops(1, this);
+   loops.insert(loops.end(), fSharedLoops.begin(), fSharedLoops.end());
+
+   std::vector<unsigned int> batchSizes;
+   for (auto lm : loops) {
+      if (!lm->fToJit.empty())
+         lm->BuildJittedNodes();
+
+      lm->InitNodes();
+
+      // Actions that keep pointers to the column values across entries, and callbacks, cannot consume batches
+      batchSizes.emplace_back(lm->fBatchSize);
+      if (lm->fBatchSize > 0 && !lm->CanRunInBatches()) {
+         Warning("RLoopManager::Run", "Some of the booked actions or callbacks do not support batch mode: processing "
+                                      "entry by entry.");
+         lm->fBatchSize = 0;
+      }
+   }
 
    switch (fLoopType) {
    case ELoopType::kNoFilesMT: RunEmptySourceMT(); break;
@@ -315,7 +425,11 @@ void RLoopManager::Run()
    case ELoopType::kDataSource: RunDataSource(); break;
    }
 
-   CleanUpNodes();
+   for (std::size_t i = 0; i < loops.size(); ++i) {
+      loops[i]->fBatchSize = batchSizes[i];
+      loops[i]->CleanUpNodes();
+   }
+   fSharedLoops.clear();
 }
 
 /// Return the list of default columns -- empty if none was provided when constructing the RDataFrame
@@ -371,6 +485,109 @@ bool RLoopManager::CheckFilters(unsigned int, Long64_t)
    return true;
 }
 
+// end of recursive chain of calls: all entries pass
+const ROOT::VecOps::RVec<char> &RLoopManager::CheckFiltersBatch(unsigned int slot, Long64_t, unsigned int n)
+{
+   auto &mask = fBatchAllPass[slot];
+   if (mask.size() < n)
+      mask.resize(n, 1);
+   return mask;
+}
+
+/// Process entries in batches of `batchSize` consecutive entries instead of one at a time.
+///
+/// In batch mode the event loop copies the values of the TTree (or data-source) columns used by the computation
+/// graph into per-column buffers while it advances through a batch. Filters then compute a selection mask for the
+/// whole batch, each in a single call, and actions run over the selected entries. Values of user-defined columns are
+/// computed from the buffered inputs once per entry and kept until the end of the batch.
+///
+/// Batch mode costs memory (one copy of each input and user-defined column per batch). Action helpers which implement
+/// `BatchExec` for the column types (Count, Sum, and the histogram fills of arithmetic columns) receive the selection
+/// mask and one contiguous array of values per column for the whole batch; the others are run on the selected entries
+/// one at a time. 0 switches batch mode off (the default). Actions that need stable addresses of
+/// the column values across entries, such as Snapshot, and callbacks registered with `OnPartialResult` do not support
+/// batch mode: if any is booked, the event loop falls back to processing one entry at a time.
+void RLoopManager::SetBatchSize(unsigned int batchSize)
+{
+   fBatchSize = batchSize;
+   fBatches.clear();
+   fBatchAllPass.clear();
+   if (fBatchSize > 0) {
+      fBatches.resize(fNSlots);
+      fBatchAllPass.resize(fNSlots);
+      fBatchIds.resize(fNSlots); // keep counting from the previous values: identifiers must never be reused
+   }
+}
+
+/// Return the batch loaders of the task running on `slot`, or nullptr if batch mode is off.
+RDFInternal::BatchLoaders_t *RLoopManager::GetBatchLoaders(unsigned int slot)
+{
+   if (fBatchSize == 0 || fBatches[slot].empty())
+      return nullptr;
+   return &fBatches[slot].top().fLoaders;
+}
+
+/// Return true if the two trees read the same entries of the same files.
+static bool IsSameDataset(TTree &t1, TTree &t2)
+{
+   if (&t1 == &t2)
+      return true;
+   auto hasFriends = [](TTree &t) { return t.GetListOfFriends() && t.GetListOfFriends()->GetEntries() > 0; };
+   if (hasFriends(t1) || hasFriends(t2) || t1.GetEntryList() || t2.GetEntryList())
+      return false;
+   if (t1.IsA() != t2.IsA() || strcmp(t1.GetName(), t2.GetName()) != 0)
+      return false;
+
+   auto c1 = dynamic_cast<TChain *>(&t1);
+   auto c2 = dynamic_cast<TChain *>(&t2);
+   if (c1 && c2) {
+      auto files1 = c1->GetListOfFiles();
+      auto files2 = c2->GetListOfFiles();
+      if (files1->GetEntries() != files2->GetEntries())
+         return false;
+      for (int i = 0; i < files1->GetEntries(); ++i) {
+         auto e1 = static_cast<TChainElement *>(files1->At(i));
+         auto e2 = static_cast<TChainElement *>(files2->At(i));
+         if (strcmp(e1->GetName(), e2->GetName()) != 0 || strcmp(e1->GetTitle(), e2->GetTitle()) != 0)
+            return false;
+      }
+      return true;
+   }
+
+   // Trees not attached to a file are different datasets
+   auto d1 = t1.GetDirectory();
+   auto d2 = t2.GetDirectory();
+   return d1 && d2 && d1->GetFile() && d2->GetFile() && strcmp(d1->GetPath(), d2->GetPath()) == 0;
+}
+
+/// Run the computation graph of `other`, and of the loop managers already sharing the event loop with it, in the
+/// same event loop as this one: running any of them runs all of them, reading the dataset once.
+/// The loop managers must process the same TTree or TChain, or the same number of entries if they have no input
+/// files, with the same number of slots. Loop managers reading from a data source cannot share their event loop.
+/// The event loop stays shared until the loop managers are destroyed.
+void RLoopManager::ShareEventLoop(RLoopManager &other)
+{
+   if (&other == this || (fSharedScan && fSharedScan == other.fSharedScan))
+      return;
+   if (fDataSource || other.fDataSource)
+      throw std::runtime_error("ShareEventLoop: dataframes reading from a data source cannot share their event loop.");
+   if (fLoopType != other.fLoopType || fNSlots != other.fNSlots)
+      throw std::runtime_error("ShareEventLoop: the dataframes must be created with the same implicit multi-threading "
+                               "settings to share their event loop.");
+   const bool isSameDataset = fTree ? (other.fTree && IsSameDataset(*fTree, *other.fTree))
+                                    : (!other.fTree && fNEmptyEntries == other.fNEmptyEntries);
+   if (!isSameDataset)
+      throw std::runtime_error("ShareEventLoop: the dataframes do not process the same dataset.");
+
+   if (!fSharedScan)
+      fSharedScan = std::make_shared<std::vector<RLoopManager *>>(1, this);
+   const auto others = other.fSharedScan ? *other.fSharedScan : std::vector<RLoopManager *>(1, &other);
+   for (auto lm : others) {
+      fSharedScan->emplace_back(lm);
+      lm->fSharedScan = fSharedScan;
+   }
+}
+
 /// Call `FillReport` on all booked filters
 void RLoopManager::Report(ROOT::RDF::RCutFlowReport &rep) const
 {
@@ -21,6 +21,7 @@ RRangeBase::RRangeBase(RLoopManager *implPtr, unsigned int start, unsigned int s
 void RRangeBase::ResetCounters()
 {
    fLastCheckedEntry = -1;
+   fLastCheckedBatch = -1;
    fNProcessedEntries = 0;
    fHasStopped = false;
 }
@@ -0,0 +1,256 @@
+#include "ROOT/RDataFrame.hxx"
+#include "ROOT/RTrivialDS.hxx"
+#include "ROOT/RVec.hxx"
+#include "TFile.h"
+#include "TROOT.h"
+#include "TSystem.h"
+#include "TTree.h"
+#include "gtest/gtest.h"
+
+#include <utility>
+#include <vector>
+
+using namespace ROOT;
+using namespace ROOT::VecOps;
+
+class RDFBatch : public ::testing::Test {
+protected:
+   RDFBatch() : fTree("t", "t")
+   {
+      fTree.SetDirectory(nullptr);
+      int x = 0;
+      double y = 0.;
+      std::vector<float> v;
+      fTree.Branch("x", &x);
+      fTree.Branch("y", &y);
+      fTree.Branch("v", &v);
+      for (auto i = 0; i < 1000; ++i) {
+         x = i;
+         y = 0.5 * i;
+         v.assign(i % 4, float(i));
+         fTree.Fill();
+      }
+   }
+   TTree &GetTree() { return fTree; }
+
+private:
+   TTree fTree;
+};
+
+TEST_F(RDFBatch, EmptySource)
+{
+   RDataFrame d(1000);
+   d.SetBatchSize(64);
+   auto df = d.Define("x", [](ULong64_t e) { return int(e); }, {"rdfentry_"});
+   auto c = df.Filter([](int x) { return x % 3 == 0; }, {"x"}).Count();
+   auto s = df.Filter([](int x) { return x < 100; }, {"x"}).Sum<int>("x");
+   EXPECT_EQ(334u, *c);
+   EXPECT_EQ(4950, *s);
+}
+
+TEST_F(RDFBatch, TreeColumns)
+{
+   RDataFrame d(GetTree());
+   d.SetBatchSize(100);
+   auto f = d.Filter([](int x) { return x >= 10; }, {"x"});
+   auto sumy = f.Sum<double>("y");
+   auto maxx = f.Filter([](double y) { return y < 100.; }, {"y"}).Max<int>("x");
+   auto sizes = f.Define("n", [](const RVec<float> &v) { return int(v.size()); }, {"v"}).Sum<int>("n");
+   auto vals = d.Take<RVec<float>>("v");
+
+   double expectedSum = 0.;
+   int expectedSizes = 0;
+   for (auto i = 10; i < 1000; ++i) {
+      expectedSum += 0.5 * i;
+      expectedSizes += i % 4;
+   }
+   EXPECT_DOUBLE_EQ(expectedSum, *sumy);
+   EXPECT_EQ(199, *maxx);
+   EXPECT_EQ(expectedSizes, *sizes);
+   ASSERT_EQ(1000u, vals->size());
+   for (auto i = 0u; i < vals->size(); ++i) {
+      const auto &v = (*vals)[i];
+      ASSERT_EQ(i % 4, v.size());
+      for (auto e : v)
+         EXPECT_EQ(float(i), e);
+   }
+}
+
+TEST_F(RDFBatch, SameResultsAsDefault)
+{
+   auto book = [](RDataFrame &d) {
+      return d.Filter([](int x) { return x % 2 == 0; }, {"x"}, "even")
+         .Filter([](double y) { return y > 10.; }, {"y"}, "y10")
+         .Histo1D<double>({"h", "h", 100, 0., 500.}, "y");
+   };
+   RDataFrame d1(GetTree());
+   RDataFrame d2(GetTree());
+   d2.SetBatchSize(256);
+   auto h1 = book(d1);
+   auto h2 = book(d2);
+   auto r1 = d1.Report();
+   auto r2 = d2.Report();
+   EXPECT_EQ(h1->GetEntries(), h2->GetEntries());
+   EXPECT_DOUBLE_EQ(h1->GetMean(), h2->GetMean());
+   EXPECT_EQ(r1->At("even").GetPass(), r2->At("even").GetPass());
+   EXPECT_EQ(r1->At("y10").GetPass(), r2->At("y10").GetPass());
+   EXPECT_EQ(r1->At("y10").GetAll(), r2->At("y10").GetAll());
+}
+
+TEST_F(RDFBatch, Ranges)
+{
+   RDataFrame d(GetTree());
+   d.SetBatchSize(32);
+   auto t = d.Filter([](int x) { return x % 2 == 1; }, {"x"}).Range(5, 100, 10).Take<int>("x");
+   std::vector<int> expected;
+   // the k-th odd entry is 2k-1; Range keeps k = 10, 20, ..., 100
+   for (auto k = 10; k <= 100; k += 10)
+      expected.push_back(2 * k - 1);
+   EXPECT_EQ(expected, *t);
+}
+
+TEST_F(RDFBatch, StatefulDefine)
+{
+   // the expression is not pure: batch mode must call it exactly once per entry, like the default mode
+   auto book = [](RDataFrame &d, int &nCalls) {
+      auto df = d.Define("n", [&nCalls](int x) { return x + 1000 * nCalls++; }, {"x"});
+      auto f = df.Filter([](int n) { return n % 3 != 0; }, {"n"});
+      return std::make_pair(f.Take<int>("n"), f.Define("m", [](int n) { return 2 * n; }, {"n"}).Sum<int>("m"));
+   };
+   RDataFrame d1(GetTree());
+   RDataFrame d2(GetTree());
+   d2.SetBatchSize(100);
+   int nCalls1 = 0;
+   int nCalls2 = 0;
+   auto r1 = book(d1, nCalls1);
+   auto r2 = book(d2, nCalls2);
+   EXPECT_EQ(*r1.first, *r2.first);
+   EXPECT_EQ(*r1.second, *r2.second);
+   EXPECT_EQ(1000, nCalls1);
+   EXPECT_EQ(1000, nCalls2);
+}
+
+TEST_F(RDFBatch, Callbacks)
+{
+   // callbacks must see the partial results after each entry: the event loop processes entries one at a time
+   RDataFrame d(GetTree());
+   d.SetBatchSize(128);
+   auto c = d.Count();
+   std::vector<ULong64_t> partialCounts;
+   c.OnPartialResult(100, [&partialCounts](ULong64_t n) { partialCounts.push_back(n); });
+   EXPECT_EQ(1000u, *c);
+   ASSERT_EQ(10u, partialCounts.size());
+   for (auto i = 0u; i < partialCounts.size(); ++i)
+      EXPECT_EQ(100u * (i + 1), partialCounts[i]);
+}
+
+TEST_F(RDFBatch, DataSource)
+{
+   std::unique_ptr<ROOT::RDF::RDataSource> tds(new ROOT::RDF::RTrivialDS(100));
+   RDataFrame d(std::move(tds));
+   d.SetBatchSize(16);
+   auto m = d.Filter([](ULong64_t c) { return c < 50; }, {"col0"}).Max<ULong64_t>("col0");
+   EXPECT_EQ(49u, *m);
+}
+
+TEST_F(RDFBatch, SnapshotFallsBack)
+{
+   RDataFrame d(GetTree());
+   d.SetBatchSize(64);
+   const auto fname = "dataframe_batch_snapshot.root";
+   auto out = d.Filter([](int x) { return x < 10; }, {"x"}).Snapshot<int, double>("t", fname, {"x", "y"});
+   EXPECT_EQ(10u, *out->Count());
+   EXPECT_DOUBLE_EQ(4.5, *out->Max<double>("y"));
+   gSystem->Unlink(fname);
+}
+
+TEST_F(RDFBatch, Kernels)
+{
+   // Count, Sum and Histo1D receive whole batches: the results must not depend on the batch size
+   auto book = [](RDataFrame &d) {
+      auto f = d.Filter([](int x) { return x % 3 != 0; }, {"x"});
+      auto w = f.Define("w", [](int x) { return 0.25 * (x % 4); }, {"x"});
+      return std::make_tuple(f.Count(), f.Sum<int>("x"), f.Sum<double>("y"), f.Histo1D<int>("x"),
+                             f.Histo1D<double>({"h", "h", 64, 0., 500.}, "y"), w.Histo1D<double, double>("y", "w"),
+                             w.Histo1D<double, double>({"hw", "hw", 64, 0., 500.}, "y", "w"));
+   };
+   RDataFrame d1(GetTree());
+   auto r1 = book(d1);
+   for (auto batchSize : {1u, 7u, 256u, 5000u}) {
+      RDataFrame d2(GetTree());
+      d2.SetBatchSize(batchSize);
+      auto r2 = book(d2);
+      EXPECT_EQ(*std::get<0>(r1), *std::get<0>(r2));
+      EXPECT_EQ(*std::get<1>(r1), *std::get<1>(r2));
+      EXPECT_EQ(*std::get<2>(r1), *std::get<2>(r2));
+      EXPECT_EQ(std::get<3>(r1)->GetEntries(), std::get<3>(r2)->GetEntries());
+      EXPECT_DOUBLE_EQ(std::get<3>(r1)->GetMean(), std::get<3>(r2)->GetMean());
+      EXPECT_DOUBLE_EQ(std::get<3>(r1)->GetXaxis()->GetXmin(), std::get<3>(r2)->GetXaxis()->GetXmin());
+      EXPECT_DOUBLE_EQ(std::get<3>(r1)->GetXaxis()->GetXmax(), std::get<3>(r2)->GetXaxis()->GetXmax());
+      for (auto h : {std::make_pair(std::get<4>(r1), std::get<4>(r2)), std::make_pair(std::get<5>(r1), std::get<5>(r2)),
+                     std::make_pair(std::get<6>(r1), std::get<6>(r2))}) {
+         EXPECT_EQ(h.first->GetEntries(), h.second->GetEntries());
+         for (auto bin = 0; bin < h.first->GetNcells(); ++bin)
+            EXPECT_DOUBLE_EQ(h.first->GetBinContent(bin), h.second->GetBinContent(bin));
+      }
+   }
+}
+
+#ifdef R__USE_IMT
+TEST(RDFBatchMT, SameResultsAsDefault)
+{
+   const auto fname = "dataframe_batch_mt.root";
+   {
+      TFile f(fname, "RECREATE");
+      TTree t("t", "t");
+      int x = 0;
+      double y = 0.;
+      t.Branch("x", &x);
+      t.Branch("y", &y);
+      t.SetAutoFlush(1000);
+      for (auto i = 0; i < 20000; ++i) {
+         x = i;
+         y = 0.5 * i;
+         t.Fill();
+      }
+      t.Write();
+   }
+
+   // weights and bin contents are multiples of 1/4, so that the results do not depend on the order of the entries
+   auto book = [](RDataFrame &d) {
+      auto f = d.Filter([](int x) { return x % 3 != 0; }, {"x"}, "x3");
+      auto w = f.Define("w", [](int x) { return 0.25 * (x % 4); }, {"x"});
+      return std::make_tuple(f.Count(), f.Sum<int>("x"), f.Histo1D<double>({"h", "h", 64, 0., 10000.}, "y"),
+                             w.Histo1D<double, double>({"hw", "hw", 64, 0., 10000.}, "y", "w"), d.Report());
+   };
+
+   ROOT::EnableImplicitMT(4);
+   {
+      RDataFrame d1("t", fname);
+      RDataFrame d2("t", fname);
+      d2.SetBatchSize(100);
+      auto r1 = book(d1);
+      auto r2 = book(d2);
+      EXPECT_EQ(13333u, *std::get<0>(r2));
+      EXPECT_EQ(*std::get<0>(r1), *std::get<0>(r2));
+      EXPECT_EQ(*std::get<1>(r1), *std::get<1>(r2));
+      for (auto h : {std::make_pair(std::get<2>(r1), std::get<2>(r2)), std::make_pair(std::get<3>(r1), std::get<3>(r2))}) {
+         EXPECT_EQ(h.first->GetEntries(), h.second->GetEntries());
+         for (auto bin = 0; bin < h.first->GetNcells(); ++bin)
+            EXPECT_DOUBLE_EQ(h.first->GetBinContent(bin), h.second->GetBinContent(bin));
+      }
+      EXPECT_EQ(std::get<4>(r1)->At("x3").GetPass(), std::get<4>(r2)->At("x3").GetPass());
+
+      // custom columns only: the kernels receive the values evaluated entry by entry
+      RDataFrame e(20000);
+      e.SetBatchSize(64);
+      auto df = e.Define("x", [](ULong64_t entry) { return int(entry); }, {"rdfentry_"});
+      auto c = df.Filter([](int x) { return x % 3 != 0; }, {"x"}).Count();
+      auto s = df.Filter([](int x) { return x < 100; }, {"x"}).Sum<int>("x");
+      EXPECT_EQ(13333u, *c);
+      EXPECT_EQ(4950, *s);
+   }
+   ROOT::DisableImplicitMT();
+   gSystem->Unlink(fname);
+}
+#endif // R__USE_IMT
@@ -3,11 +3,15 @@
 #include "ROOT/RTrivialDS.hxx"
 #include "TH1F.h"
 #include "TRandom.h"
+#include "TROOT.h"
 #include "TSystem.h"
 
 #include "gtest/gtest.h"
 
 #include <algorithm>
+#include <cstring>
+#include <tuple>
+#include <vector>
 
 using namespace ROOT::RDF;
 using namespace ROOT::VecOps;
@@ -227,6 +231,133 @@ TEST(Cache, evtCounter)
 
 }
 
+TEST(Cache, Options)
+{
+   ROOT::RDataFrame tdf(1000);
+   auto d = tdf.Define("i", [](ULong64_t e) { return int(e); }, {"rdfentry_"})
+               .Define("x", [](int i) { return 0.5 * i; }, {"i"})
+               .Define("b", [](int i) { return i % 3 == 0; }, {"i"})
+               .Define("v", [](int i) { return std::vector<float>(i % 4, i); }, {"i"});
+
+   auto check = [](RInterface<ROOT::Detail::RDF::RLoopManager> &c) {
+      int n = 0;
+      c.Foreach(
+         [&n](int i, double x, bool b, std::vector<float> v) {
+            EXPECT_EQ(n, i);
+            EXPECT_EQ(0.5 * i, x);
+            EXPECT_EQ(i % 3 == 0, b);
+            EXPECT_EQ(std::vector<float>(i % 4, i), v);
+            ++n;
+         },
+         {"i", "x", "b", "v"});
+      EXPECT_EQ(1000, n);
+   };
+
+   // The chunks are kept in memory as they are
+   RCacheOptions opts;
+   opts.fChunkSize = 64;
+   auto cached = d.Cache<int, double, bool, std::vector<float>>({"i", "x", "b", "v"}, opts);
+   check(cached);
+
+   // The chunks are compressed, and all but the first few are spilled to disk
+   opts.fCompressionLevel = 1;
+   opts.fMemoryBudget = 2048;
+   auto spilled = d.Cache<int, double, bool, std::vector<float>>({"i", "x", "b", "v"}, opts);
+   check(spilled);
+   check(spilled);
+
+   // same but jitted, from a cached dataframe
+   auto cachedj = cached.Cache({"i", "x", "b", "v"}, opts);
+   check(cachedj);
+   EXPECT_EQ(334UL, *cachedj.Filter("b").Count());
+}
+
+// The entries of the columns i, x and v of a dataframe, sorted, so that multi-thread event loops can be compared
+template <typename D>
+static std::vector<std::tuple<int, double, std::vector<float>>> GetSortedEntries(D &d)
+{
+   auto is = d.template Take<int>("i");
+   auto xs = d.template Take<double>("x");
+   auto vs = d.template Take<std::vector<float>>("v");
+   std::vector<std::tuple<int, double, std::vector<float>>> entries;
+   for (std::size_t k = 0; k < is->size(); ++k)
+      entries.emplace_back((*is)[k], (*xs)[k], (*vs)[k]);
+   std::sort(entries.begin(), entries.end());
+   return entries;
+}
+
+template <typename D, typename C>
+static void CheckSameEntries(D &uncached, C &cached)
+{
+   const auto expected = GetSortedEntries(uncached);
+   EXPECT_EQ(expected, GetSortedEntries(cached));
+   EXPECT_EQ(*uncached.Filter("b").Count(), *cached.Filter("b").Count());
+}
+
+static int CountFilesInDirectory(const char *dirName)
+{
+   int n = 0;
+   auto dir = gSystem->OpenDirectory(dirName);
+   while (auto name = gSystem->GetDirEntry(dir)) {
+      if (strcmp(name, ".") && strcmp(name, ".."))
+         ++n;
+   }
+   gSystem->FreeDirectory(dir);
+   return n;
+}
+
+TEST(Cache, OptionsSpillDirectory)
+{
+   ROOT::RDataFrame tdf(1000);
+   auto d = tdf.Define("i", [](ULong64_t e) { return int(e); }, {"rdfentry_"})
+               .Define("x", [](int i) { return 0.5 * i; }, {"i"})
+               .Define("b", [](int i) { return i % 3 == 0; }, {"i"})
+               .Define("v", [](int i) { return std::vector<float>(i % 4, i); }, {"i"});
+
+   const char *spillDir = "dataframe_cache_spill";
+   gSystem->mkdir(spillDir);
+   {
+      RCacheOptions opts;
+      opts.fChunkSize = 64;
+      opts.fMemoryBudget = 1024;
+      opts.fSpillDirectory = spillDir;
+      auto cached = d.Cache<int, double, bool, std::vector<float>>({"i", "x", "b", "v"}, opts);
+      CheckSameEntries(d, cached);
+      // the chunks beyond the budget are in a spill file in the requested directory
+      EXPECT_EQ(1, CountFilesInDirectory(spillDir));
+      CheckSameEntries(d, cached);
+   }
+   // the spill file is removed with the cached dataframe
+   EXPECT_EQ(0, CountFilesInDirectory(spillDir));
+   gSystem->Unlink(spillDir);
+}
+
+#ifdef R__USE_IMT
+TEST(Cache, OptionsMT)
+{
+   ROOT::EnableImplicitMT(4);
+   {
+      ROOT::RDataFrame tdf(10000);
+      auto d = tdf.Define("i", [](ULong64_t e) { return int(e); }, {"rdfentry_"})
+                  .Define("x", [](int i) { return 0.5 * i; }, {"i"})
+                  .Define("b", [](int i) { return i % 3 == 0; }, {"i"})
+                  .Define("v", [](int i) { return std::vector<float>(i % 4, i); }, {"i"});
+
+      RCacheOptions opts;
+      opts.fChunkSize = 100;
+      auto cached = d.Cache<int, double, bool, std::vector<float>>({"i", "x", "b", "v"}, opts);
+      CheckSameEntries(d, cached);
+
+      opts.fCompressionLevel = 1;
+      opts.fMemoryBudget = 16384;
+      auto spilled = d.Cache<int, double, bool, std::vector<float>>({"i", "x", "b", "v"}, opts);
+      CheckSameEntries(d, spilled);
+      CheckSameEntries(d, spilled);
+   }
+   ROOT::DisableImplicitMT();
+}
+#endif // R__USE_IMT
+
 #ifdef R__B64
 
 TEST(Cache, Regex)
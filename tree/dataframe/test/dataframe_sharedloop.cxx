@@ -0,0 +1,108 @@
+#include "ROOT/RDataFrame.hxx"
+#include "ROOT/RTrivialDS.hxx"
+#include "TChain.h"
+#include "TFile.h"
+#include "TSystem.h"
+#include "TTree.h"
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+
+using namespace ROOT;
+
+class RDFSharedLoop : public ::testing::Test {
+protected:
+   static constexpr const char *fFileName = "dataframe_sharedloop.root";
+   static void SetUpTestCase()
+   {
+      TFile f(fFileName, "RECREATE");
+      TTree t("t", "t");
+      int x = 0;
+      double y = 0.;
+      t.Branch("x", &x);
+      t.Branch("y", &y);
+      for (auto i = 0; i < 1000; ++i) {
+         x = i;
+         y = 0.5 * i;
+         t.Fill();
+      }
+      t.Write();
+   }
+   static void TearDownTestCase() { gSystem->Unlink(fFileName); }
+};
+
+constexpr const char *RDFSharedLoop::fFileName;
+
+TEST_F(RDFSharedLoop, EmptySource)
+{
+   RDataFrame d1(100);
+   RDataFrame d2(100);
+   RDataFrame d3(100);
+   d1.ShareEventLoop(d2);
+   d3.ShareEventLoop(d2);
+
+   std::atomic<int> n1(0);
+   auto c1 = d1.Filter([&n1]() {
+                  ++n1;
+                  return true;
+               })
+                .Count();
+   auto c2 = d2.Filter([](ULong64_t e) { return e % 2 == 0; }, {"rdfentry_"}).Count();
+   auto m3 = d3.Define("z", [](ULong64_t e) { return int(e); }, {"rdfentry_"}).Max<int>("z");
+   EXPECT_EQ(50u, *c2);
+   // The event loop triggered by c2 also ran the other computation graphs, once
+   EXPECT_EQ(100, n1);
+   EXPECT_EQ(100u, *c1);
+   EXPECT_EQ(99, *m3);
+   EXPECT_EQ(100, n1);
+}
+
+TEST_F(RDFSharedLoop, TreeColumns)
+{
+   RDataFrame nominal("t", fFileName);
+   RDataFrame shifted("t", fFileName);
+   nominal.ShareEventLoop(shifted);
+
+   auto s1 = nominal.Filter([](int x) { return x >= 10; }, {"x"}).Sum<double>("y");
+   std::atomic<int> n2(0);
+   auto s2 = shifted.Define("y2",
+                            [&n2](double y) {
+                               ++n2;
+                               return 2 * y;
+                            },
+                            {"y"})
+                .Sum<double>("y2");
+
+   EXPECT_DOUBLE_EQ(0.5 * (999 * 1000 / 2 - 45), *s1);
+   EXPECT_EQ(1000, n2);
+   EXPECT_DOUBLE_EQ(999 * 1000 / 2, *s2);
+   EXPECT_EQ(1000, n2);
+
+   // Results booked on a single dataframe still work, and the other ones are not rerun
+   auto m1 = nominal.Max<int>("x");
+   EXPECT_EQ(999, *m1);
+}
+
+TEST_F(RDFSharedLoop, Ranges)
+{
+   RDataFrame d1("t", fFileName);
+   RDataFrame d2("t", fFileName);
+   d1.ShareEventLoop(d2);
+   auto c1 = d1.Range(10).Count();
+   auto c2 = d2.Range(500).Count();
+   EXPECT_EQ(10u, *c1);
+   EXPECT_EQ(500u, *c2);
+}
+
+TEST_F(RDFSharedLoop, DifferentDatasets)
+{
+   RDataFrame d1("t", fFileName);
+   RDataFrame d2(1000);
+   EXPECT_THROW(d1.ShareEventLoop(d2), std::runtime_error);
+   RDataFrame d3(999);
+   EXPECT_THROW(d2.ShareEventLoop(d3), std::runtime_error);
+   RDataFrame d4(std::unique_ptr<RDF::RDataSource>(new RDF::RTrivialDS(1000)));
+   EXPECT_THROW(d2.ShareEventLoop(d4), std::runtime_error);
+}
@@ -201,7 +201,11 @@ void test_snapshot_options(RInterface<RLoopManager> &tdf)
    opts.fCompressionLevel = 6;
 
    const auto outfile = "snapshot_test_opts.root";
-   for (auto algorithm : {ROOT::kZLIB, ROOT::kLZMA, ROOT::kLZ4}) {
+   std::vector<ROOT::ECompressionAlgorithm> algorithms{ROOT::kZLIB, ROOT::kLZMA, ROOT::kLZ4};
+#ifdef R__HAS_ZSTD
+   algorithms.push_back(ROOT::kZSTD);
+#endif
+   for (auto algorithm : algorithms) {
       opts.fCompressionAlgorithm = algorithm;
 
       auto s = tdf.Snapshot<int>("t", outfile, {"ans"}, opts);
@@ -671,4 +675,92 @@ TEST(RDFSnapshotMore, EmptyBuffersMT)
    gSystem->Unlink(fname);
 }
 
+TEST(RDFSnapshotMore, EmptyBuffersBasketMergeMT)
+{
+   const auto fname = "emptybuffersbasketmergemt.root";
+   const auto treename = "t";
+   ROOT::EnableImplicitMT(4);
+   ROOT::RDF::RSnapshotOptions opts;
+   opts.fMTBasketMerge = true;
+   {
+      // some slots do not see any entry
+      ROOT::RDataFrame d(10);
+      auto dd = d.DefineSlot("x", [](unsigned int s) { return s == 3 ? 0 : 1; })
+                  .Filter([](int x) { return x == 0; }, {"x"}, "f");
+      auto r = dd.Report();
+      dd.Snapshot<int>(treename, fname, {"x"}, opts);
+
+      const auto passed = r->At("f").GetPass();
+      EXPECT_GT(passed, 0u);
+
+      TFile f(fname);
+      TTree *t = nullptr;
+      f.GetObject(treename, t);
+      ASSERT_NE(t, nullptr);
+      EXPECT_EQ(t->GetListOfBranches()->GetEntries(), 1);
+      EXPECT_EQ(t->GetEntries(), Long64_t(passed));
+   }
+   {
+      // all the entries are filtered out: the output tree must still be written
+      ROOT::RDataFrame d(10);
+      d.Define("x", []() { return 1; }).Filter([](int x) { return x == 0; }, {"x"}).Snapshot<int>(treename, fname, {"x"},
+                                                                                                 opts);
+
+      TFile f(fname);
+      TTree *t = nullptr;
+      f.GetObject(treename, t);
+      ASSERT_NE(t, nullptr);
+      EXPECT_EQ(t->GetEntries(), 0);
+   }
+
+   ROOT::DisableImplicitMT();
+   gSystem->Unlink(fname);
+}
+
+TEST(RDFSnapshotMore, BasketMergeMT)
+{
+   const auto fname = "snapshot_basketmergemt.root";
+   const auto nEntries = 10000ull;
+   ROOT::EnableImplicitMT(4);
+   {
+      // several input files so that each worker runs several tasks
+      const std::string inputFilePrefix = "snapshot_basketmergemt_in_";
+      const auto nInputFiles = 8u;
+      for (auto i = 0u; i < nInputFiles; ++i) {
+         ROOT::RDataFrame d(nEntries / nInputFiles);
+         d.Define("x", [i](ULong64_t e) { return double(e + i * (nEntries / nInputFiles)); }, {"rdfentry_"})
+            .Define("v", [](double x) { return RVec<int>(int(x) % 5, 1); }, {"x"})
+            .Snapshot<double, RVec<int>>("t", inputFilePrefix + std::to_string(i) + ".root", {"x", "v"});
+      }
+
+      ROOT::RDF::RSnapshotOptions opts;
+      opts.fMTBasketMerge = true;
+      opts.fMTFlushEntries = 100;
+      opts.fAutoFlush = 100;
+      ROOT::RDataFrame d("t", (inputFilePrefix + "*.root").c_str());
+      auto out = d.Snapshot<double, RVec<int>>("outdir/t", fname, {"x", "v"}, opts);
+
+      auto sumx = out->Sum<double>("x");
+      auto count = out->Count();
+      auto sumv = out->Define("nv", [](const RVec<int> &v) { return int(v.size()); }, {"v"}).Sum<int>("nv");
+      EXPECT_EQ(*count, nEntries);
+      EXPECT_DOUBLE_EQ(*sumx, double(nEntries) * (nEntries - 1) / 2);
+      EXPECT_EQ(*sumv, int(nEntries / 5 * (0 + 1 + 2 + 3 + 4)));
+
+      for (auto i = 0u; i < nInputFiles; ++i)
+         gSystem->Unlink((inputFilePrefix + std::to_string(i) + ".root").c_str());
+   }
+
+   // the output tree is a single tree in the requested directory
+   TFile f(fname);
+   TTree *t = nullptr;
+   f.GetObject("outdir/t", t);
+   ASSERT_NE(t, nullptr);
+   EXPECT_EQ(t->GetEntries(), Long64_t(nEntries));
+   EXPECT_EQ(t->GetListOfBranches()->GetEntries(), 2);
+
+   ROOT::DisableImplicitMT();
+   gSystem->Unlink(fname);
+}
+
 #endif // R__USE_IMT
@@ -25,6 +25,7 @@
 #pragma link C++ class TBasketSQL+;
 #pragma link C++ class TChain-;
 #pragma link C++ class TChainElement;
+#pragma link C++ class TCompressionDict+;
 #pragma link C++ class TCut+;
 #pragma link C++ class TEntryList-;
 #pragma link C++ class TEntryListArray+;
@@ -27,6 +27,8 @@
 
 #include "TKey.h"
 
+#include <memory>
+
 class TFile;
 class TTree;
 class TBranch;
@@ -44,6 +46,9 @@ private:
    // Helper for managing the compressed buffer.
    void InitializeCompressedBuffer(Int_t len, TFile* file);
 
+   // Helper for LoadBasketBuffers.
+   char *PrepareLoadBuffer(Int_t len, TFile *file);
+
    // Handles special logic around deleting / reseting the entry offset pointer.
    void ResetEntryOffset();
 
@@ -67,6 +72,7 @@ protected:
                                                   /// of `-1` indicates that the offset generation MUST be performed on first read.
    TBranch    *fBranch{nullptr};                  ///<Pointer to the basket support branch
    TBuffer    *fCompressedBufferRef{nullptr};     ///<! Compressed buffer.
+   std::shared_ptr<const char> fMappedRegion;     ///<! File mapping (see TFile::GetMappedRegion) that fBufferRef points into, if any.
    Int_t       fLastWriteBufferSize[3] = {0,0,0}; ///<! Size of the buffer last three buffers we wrote it to disk
    Bool_t      fResetAllocation{false};           ///<! True if last reset re-allocated the memory
    UChar_t     fNextBufferSizeRecord{0};          ///<! Index into fLastWriteBufferSize of the last buffer written to disk
@@ -88,11 +94,14 @@ public:
    // in the fIOBits -- then the zombie flag will be set for this object.
    //
    enum class EIOBits : Char_t {
-      // The following to bits are reserved for now; when supported, set
-      // kSupported = kGenerateOffsetMap | kBasketClassMap
+      // The following bit is reserved for now; when supported, set
+      // kSupported = kGenerateOffsetMap | kLittleEndian | kBasketClassMap
       kGenerateOffsetMap = BIT(0),
-      // kBasketClassMap = BIT(1),
-      kSupported = kGenerateOffsetMap
+      // Fixed-size fundamental values are stored in little-endian rather than
+      // big-endian byte order, i.e. in the native layout of common hardware.
+      kLittleEndian = BIT(1),
+      // kBasketClassMap = BIT(2),
+      kSupported = kGenerateOffsetMap | kLittleEndian
    };
    // This enum covers IOBits that are known to this ROOT release but
    // not supported; provides a mechanism for us to have experimental
@@ -101,7 +110,7 @@ public:
    // (kUnsupported | kSupported) should result in the '|' of all IOBits.
    enum class EUnsupportedIOBits : Char_t { kUnsupported = 0 };
    // The number of known, defined IOBits.
-   static constexpr int kIOBitCount = 1;
+   static constexpr int kIOBitCount = 2;
 
    TBasket();
    TBasket(TDirectory *motherDir);
@@ -122,6 +131,7 @@ public:
            Int_t   GetNevBuf() const {return fNevBuf;}
            Int_t   GetNevBufSize() const {return fNevBufSize;}
            Int_t   GetLast() const {return fLast;}
+           Bool_t  TestIOBits(EIOBits bits) const {return (fIOBits & static_cast<UChar_t>(bits)) != 0;}
    virtual void    MoveEntries(Int_t dentries);
    virtual void    PrepareBasket(Long64_t /* entry */) {};
            Int_t   ReadBasketBuffers(Long64_t pos, Int_t len, TFile *file);
@@ -136,6 +146,7 @@ public:
    Bool_t          GetResetAllocationCount() const { return fResetAllocation; }
 
    Int_t           LoadBasketBuffers(Long64_t pos, Int_t len, TFile *file, TTree *tree = 0);
+   Int_t           LoadBasketBuffers(const char *buffer, Int_t len, TFile *file);
    Long64_t        CopyTo(TFile *to);
 
            void    SetBranch(TBranch *branch) { fBranch = branch; }
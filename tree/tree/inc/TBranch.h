@@ -24,6 +24,7 @@
 //////////////////////////////////////////////////////////////////////////
 
 #include <memory>
+#include <vector>
 
 #include "TNamed.h"
 
@@ -46,6 +47,7 @@ class TFile;
 class TClonesArray;
 class TTreeCloner;
 class TTreeCache;
+class TCompressionDict;
 
    const Int_t kDoNotProcess = BIT(10); // Active bit for branches
    const Int_t kIsClone      = BIT(11); // to indicate a TBranchClones
@@ -63,6 +65,7 @@ class TBranch : public TNamed , public TAttFill {
    using TIOFeatures = ROOT::TIOFeatures;
 
 protected:
+   friend class TBasket;
    friend class TTreeCache;
    friend class TTreeCloner;
    friend class TTree;
@@ -121,6 +124,14 @@ protected:
    using CacheInfo_t = ROOT::Internal::TBranchCacheInfo;
    CacheInfo_t fCacheInfo;        ///<! Hold info about which basket are in the cache and if they have been retrieved from the cache.
 
+   Int_t       fDictTrainBaskets{0};          ///<! Number of baskets still to be sampled before training a compression dictionary
+   Int_t       fDictMaxSize{0};               ///<! Maximum size of the trained compression dictionary
+   std::vector<char>   fDictSamples;          ///<! Uncompressed content of the baskets sampled for the dictionary training
+   std::vector<size_t> fDictSampleSizes;      ///<! Size of each sample in fDictSamples
+   TCompressionDict   *fWriteDict{nullptr};   ///<! Dictionary used to compress new baskets
+   Bool_t              fWriteDictPending{kFALSE}; ///<! True if fWriteDict is not yet stored in the file
+   TCompressionDict   *fReadDict{nullptr};    ///<! Last dictionary loaded to uncompress baskets
+
    typedef void (TBranch::*ReadLeaves_t)(TBuffer &b);
    ReadLeaves_t fReadLeaves;      ///<! Pointer to the ReadLeaves implementation to use.
    typedef void (TBranch::*FillLeaves_t)(TBuffer &b);
@@ -140,7 +151,15 @@ protected:
 
    TString  GetRealFileName() const;
 
+   void     AddCompressionDictionarySample(const char *buffer, Int_t size);
+   const TCompressionDict *GetCompressionDictionary(UInt_t id);
+   const TCompressionDict *GetWriteCompressionDictionary() const { return fWriteDict; }
+   Int_t    WriteCompressionDictionaries();
+
 private:
+   const char *GetBulkRange(Long64_t entry, Long64_t &nentries, TBasket *&basket);
+   Int_t    ReadBulkImpl(Long64_t entry, TBuffer &user_buf, Bool_t deserialize);
+   void     ReadLeavesLittleEndian(TBuffer &b);
    Int_t FillEntryBuffer(TBasket* basket,TBuffer* buf, Int_t& lnew);
    Int_t    WriteBasketImpl(TBasket* basket, Int_t where, ROOT::Internal::TBranchIMTHelper *);
    TBranch(const TBranch&) = delete;             // not implemented
@@ -168,6 +187,7 @@ public:
 
    virtual char     *GetAddress() const {return fAddress;}
            TBasket  *GetBasket(Int_t basket);
+           Int_t     GetBulkEntries(Long64_t entry, TBuffer &user_buf);
            Int_t    *GetBasketBytes() const {return fBasketBytes;}
            Long64_t *GetBasketEntry() const {return fBasketEntry;}
    virtual Long64_t  GetBasketSeek(Int_t basket) const;
@@ -181,6 +201,8 @@ public:
    virtual Int_t     GetEntry(Long64_t entry=0, Int_t getall = 0);
    virtual Int_t     GetEntryExport(Long64_t entry, Int_t getall, TClonesArray *list, Int_t n);
            Int_t     GetEntryOffsetLen() const { return fEntryOffsetLen; }
+           Int_t     GetEntriesSerialized(Long64_t entry, TBuffer &user_buf);
+           Int_t     GetEntriesView(Long64_t entry, const char *&data);
            Int_t     GetEvent(Long64_t entry=0) {return GetEntry(entry);}
    const char       *GetIconName() const;
    virtual Int_t     GetExpectedType(TClass *&clptr,EDataType &type);
@@ -230,6 +252,7 @@ public:
    void              SetCompressionAlgorithm(Int_t algorithm=0);
    void              SetCompressionLevel(Int_t level=4);
    void              SetCompressionSettings(Int_t settings=4);
+   void              SetCompressionDictionaryTraining(Int_t nbaskets, Int_t maxsize=16384);
    virtual void      SetEntries(Long64_t entries);
    virtual void      SetEntryOffsetLen(Int_t len, Bool_t updateSubBranches = kFALSE);
    virtual void      SetFirstEntry( Long64_t entry );
@@ -241,6 +264,7 @@ public:
    virtual void      SetStatus(Bool_t status=1);
    virtual void      SetTree(TTree *tree) { fTree = tree;}
    virtual void      SetupAddresses();
+           Bool_t    SupportsBulkRead() const;
    virtual void      UpdateAddress() {;}
    virtual void      UpdateFile();
 
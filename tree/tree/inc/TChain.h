@@ -30,6 +30,12 @@ class TEntryList;
 class TEventList;
 class TCollection;
 
+namespace ROOT {
+namespace Internal {
+class TChainNextFile;
+}
+}
+
 class TChain : public TTree {
 
 protected:
@@ -43,6 +49,8 @@ protected:
    TObjArray   *fFiles;            ///< -> List of file names containing the trees (TChainElement, owned)
    TList       *fStatus;           ///< -> List of active/inactive branches (TChainElement, owned)
    TChain      *fProofChain;       ///<! chain proxy when going to be processed by PROOF
+   Bool_t       fPrefetchNextFile; ///<! If true, the file of the next tree is opened in the background
+   ROOT::Internal::TChainNextFile *fNextFile; ///<! File of the next tree, being opened in the background (owned)
 
 private:
    TChain(const TChain&);            // not implemented
@@ -52,6 +60,7 @@ private:
 protected:
    void InvalidateCurrentTree();
    void ReleaseChainProof();
+   void StartNextFile();
 
 public:
    // TChain constants
@@ -93,6 +102,7 @@ public:
    virtual Long64_t  GetChainEntryNumber(Long64_t entry) const;
    virtual TClusterIterator GetClusterIterator(Long64_t firstentry);
            Int_t     GetNtrees() const { return fNtrees; }
+           Bool_t    GetPrefetchNextFile() const { return fPrefetchNextFile; }
    virtual Long64_t  GetEntries() const;
    virtual Long64_t  GetEntries(const char *sel) { return TTree::GetEntries(sel); }
    virtual Int_t     GetEntry(Long64_t entry=0, Int_t getall=0);
@@ -160,6 +170,7 @@ public:
    virtual void      SetMakeClass(Int_t make) { TTree::SetMakeClass(make); if (fTree) fTree->SetMakeClass(make);}
    virtual void      SetName(const char *name);
    virtual void      SetPacketSize(Int_t size = 100);
+           void      SetPrefetchNextFile(Bool_t prefetch = kTRUE);
    virtual void      SetProof(Bool_t on = kTRUE, Bool_t refresh = kFALSE, Bool_t gettreeheader = kFALSE);
    virtual void      SetWeight(Double_t w=1, Option_t *option="");
    virtual void      UseCache(Int_t maxCacheSize = 10, Int_t pageSize = 0);
@@ -0,0 +1,49 @@
+// @(#)root/tree:$Id$
+
+/*************************************************************************
+ * Copyright (C) 1995-2018, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef ROOT_TCompressionDict
+#define ROOT_TCompressionDict
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TCompressionDict                                                     //
+//                                                                      //
+// A compression dictionary trained on the content of the first         //
+// baskets of a branch, used to compress the following baskets.         //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+#include "TObject.h"
+#include "TString.h"
+
+#include <vector>
+
+class TCompressionDict : public TObject {
+
+private:
+   std::vector<char> fBuffer; ///< The dictionary, as produced by R__zip_train_dict
+   UInt_t fID = 0;            ///<! Dictionary ID, cached from fBuffer
+
+public:
+   TCompressionDict() = default;
+   TCompressionDict(std::vector<char> &&buffer);
+
+   const char *GetBuffer() const { return fBuffer.data(); }
+   Int_t GetSize() const { return fBuffer.size(); }
+   UInt_t GetID() const;
+
+   static TString GetKeyName(UInt_t id);
+   static TCompressionDict *Train(const std::vector<char> &samples, const std::vector<size_t> &sampleSizes,
+                                  Int_t maxSize);
+
+   ClassDef(TCompressionDict, 1); // Trained dictionary for basket compression
+};
+
+#endif
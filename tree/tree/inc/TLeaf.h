@@ -112,6 +112,9 @@ public:
    virtual void     SetOffset(Int_t offset = 0) { fOffset = offset; }
    virtual void     SetRange(Bool_t range = kTRUE) { fIsRange = range; }
    virtual void     SetUnsigned() { fIsUnsigned = kTRUE; }
+   /// Return true if the baskets of this leaf hold a plain big-endian array of fixed-size
+   /// values that TBranch::GetBulkEntries can decode in one pass.
+   virtual Bool_t   SupportsBulkRead() const { return kFALSE; }
 
    ClassDef(TLeaf, 2); // Leaf: description of a Branch data type
 };
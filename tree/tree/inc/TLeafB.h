@@ -50,6 +50,7 @@ public:
    virtual void    ReadBasketExport(TBuffer&, TClonesArray* list, Int_t n);
    virtual void    ReadValue(std::istream &s, Char_t delim = ' ');
    virtual void    SetAddress(void* addr = 0);
+   virtual Bool_t  SupportsBulkRead() const { return !fLeafCount; }
    virtual void    SetMaximum(Char_t max) { fMaximum = max; }
    virtual void    SetMinimum(Char_t min) { fMinimum = min; }
 
@@ -47,6 +47,7 @@ public:
    virtual void    ReadBasketExport(TBuffer &b, TClonesArray *list, Int_t n);
    virtual void    ReadValue(std::istream& s, Char_t delim = ' ');
    virtual void    SetAddress(void *add=0);
+   virtual Bool_t  SupportsBulkRead() const { return !fLeafCount; }
 
    ClassDef(TLeafF,1);  //A TLeaf for a 32 bit floating point data type.
 };
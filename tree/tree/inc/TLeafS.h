@@ -50,6 +50,7 @@ public:
    virtual void    ReadBasketExport(TBuffer &b, TClonesArray *list, Int_t n);
    virtual void    ReadValue(std::istream& s, Char_t delim = ' ');
    virtual void    SetAddress(void *add=0);
+   virtual Bool_t  SupportsBulkRead() const { return !fLeafCount; }
    virtual void    SetMaximum(Short_t max) { fMaximum = max; }
    virtual void    SetMinimum(Short_t min) { fMinimum = min; }
 
@@ -26,6 +26,8 @@
 
 #include <cstdint>
 #include <memory>
+#include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -37,6 +39,31 @@ class TTreeCache : public TFileCacheRead {
 public:
    enum EPrefillType { kNoPrefill, kAllBranches };
 
+   /// I/O statistics of one branch, as seen by the cache (see GetBranchStats()).
+   struct BranchStats {
+      BranchStats(const char *name) : fName(name) {}
+
+      std::string fName;                     ///< Name of the branch
+      Long64_t    fBytesPrefetched{0};       ///< Bytes of the baskets prefetched by the cache
+      Long64_t    fBytesMissed{0};           ///< Bytes of the baskets read outside of the (primary) cache (see SetMissStats())
+      Int_t       fNPrefetched{0};           ///< Number of baskets prefetched by the cache
+      Int_t       fNMissed{0};               ///< Number of baskets read outside of the (primary) cache, learning phase excluded
+      Bool_t      fTriggeredLearning{kFALSE}; ///< True if a miss on this branch restarted the learning phase
+   };
+
+   /// Baskets read ahead of time, before the cache is attached to their file
+   /// (see StageBaskets() and TChain::SetPrefetchNextFile()).
+   struct StagedBaskets {
+      std::vector<Long64_t> fPos;      ///< Sorted positions of the baskets in the file
+      std::vector<Int_t>    fLen;      ///< Length of each basket
+      std::vector<size_t>   fIndex;    ///< Location in fData of each basket
+      std::vector<char>     fData;     ///< Content of the baskets
+      Long64_t              fEntryEnd{0}; ///< End of the entry range the baskets were read for
+
+      Bool_t Contains(Long64_t pos) const;
+      Bool_t ReadBuffer(char *buf, Long64_t pos, Int_t len) const;
+   };
+
 protected:
    Long64_t     fEntryMin{0};         ///<! first entry in the cache
    Long64_t     fEntryMax{1};         ///<! last entry in the cache
@@ -105,6 +132,19 @@ protected:
 
    std::unique_ptr<MissCache> fMissCache; ///<! Cache contents for misses
 
+   // Online per-branch statistics and auto-tuning of the cache.
+   std::vector<BranchStats> fBranchStats;                     ///<! Per-branch statistics
+   std::unordered_map<std::string, size_t> fBranchStatsIndex; ///<! Index in fBranchStats of each branch name
+   Int_t  fAutoResizeMax{0};      ///<! Upper bound of the buffer size when resizing automatically (0: disabled)
+   Int_t  fNResize{0};            ///<  Number of automatic resizing of the buffer
+   Bool_t fLearnOnMiss{kFALSE};   ///<! true if a miss on a branch not in the cache restarts the learning phase
+   Bool_t fMissStats{kFALSE};     ///<! true if the reads not served by the cache are accounted in the per-branch statistics
+   Int_t  fNRelearn{0};           ///<  Number of times the learning phase was restarted after a miss
+   std::unique_ptr<StagedBaskets> fStaged; ///<! Baskets read before the cache was attached to the file
+   std::unordered_map<Long64_t, std::pair<TBranch *, Bool_t>> fBasketIndex; ///<! Branch, and whether it is cached, of each basket seek
+   TTree *fBasketIndexTree{nullptr}; ///<! Tree of the baskets in fBasketIndex, nullptr if the index must be rebuilt
+   Int_t  fBasketIndexLeaves{0};     ///<! Number of leaves of fBasketIndexTree whose branch baskets are in fBasketIndex
+
 private:
    TTreeCache(const TTreeCache &) = delete; ///< this class cannot be copied
    TTreeCache &operator=(const TTreeCache &) = delete;
@@ -125,6 +165,16 @@ private:
    TBranch *CalculateMissEntries(Long64_t, int, bool);    ///< Given an file read, try to determine the corresponding branch.
    Bool_t   ProcessMiss(Long64_t pos, int len); ///<! Given a file read not in the miss cache, handle (possibly) loading the data.
 
+   // Bookkeeping of the per-branch statistics and auto-tuning.
+   BranchStats &GetBranchStatsFor(TBranch *b);   ///< Return (creating it if needed) the statistics for a branch.
+   Bool_t   IsCachedBranch(TBranch *b) const;    ///< Whether the branch is among the cached ones.
+   void     IndexBaskets(TBranch *b);             ///< Add the baskets of a branch to the index of the basket positions.
+   void     SetBasketIndexCached(TBranch *b, Bool_t cached); ///< Update the cached flag of the indexed baskets of a branch.
+   TBranch *FindBranchOfRead(Long64_t pos, Bool_t &cached); ///< Find the branch owning the basket read at pos.
+   void     RecordMiss(Long64_t pos, Int_t len);  ///< Account for a read not served by the primary cache.
+   Long64_t CalculateClusterBytes(Long64_t start, Long64_t end); ///< Bytes of the cached branches' baskets in [start, end).
+   void     AutoResize(Long64_t start, Long64_t end); ///< Adapt the buffer size to the content of [start, end).
+
 public:
 
    TTreeCache();
@@ -136,8 +186,15 @@ public:
    virtual Int_t        DropBranch(const char *branch, Bool_t subbranches = kFALSE);
    virtual void         Disable() {fEnabled = kFALSE;}
    virtual void         Enable() {fEnabled = kTRUE;}
+   Int_t                GetAutoResize() const { return fAutoResizeMax; }
+   const std::vector<BranchStats> &GetBranchStats() const { return fBranchStats; }
+   Bool_t               GetLearnOnMiss() const { return fLearnOnMiss; }
+   Bool_t               GetMissStats() const { return fMissStats; }
+   Int_t                GetNRelearn() const { return fNRelearn; }
+   Int_t                GetNResize() const { return fNResize; }
    Bool_t               GetOptimizeMisses() const { return fOptimizeMisses; }
    const TObjArray     *GetCachedBranches() const { return fBranches; }
+   const TList         *GetCachedBranchNames() const { return fBrNames; }
    EPrefillType         GetConfiguredPrefillType() const;
    Double_t             GetEfficiency() const;
    Double_t             GetEfficiencyRel() const;
@@ -160,19 +217,25 @@ public:
    virtual Int_t        ReadBufferNormal(char *buf, Long64_t pos, Int_t len);
    virtual Int_t        ReadBufferPrefetch(char *buf, Long64_t pos, Int_t len);
    virtual void         ResetCache();
+   void                 ResetBranchStats();
    void                 ResetMissCache(); // Reset the miss cache.
    void                 SetAutoCreated(Bool_t val) {fAutoCreated = val;}
+   void                 SetAutoResize(Int_t maxbuffersize);
    virtual Int_t        SetBufferSize(Int_t buffersize);
    virtual void         SetEntryRange(Long64_t emin,   Long64_t emax);
    virtual void         SetFile(TFile *file, TFile::ECacheAction action=TFile::kDisconnect);
    virtual void         SetLearnPrefill(EPrefillType type = kNoPrefill);
    static void          SetLearnEntries(Int_t n = 10);
+   void                 SetLearnOnMiss(Bool_t learn = kTRUE) { fLearnOnMiss = learn; }
+   void                 SetMissStats(Bool_t stats = kTRUE) { fMissStats = stats; }
    void                 SetOptimizeMisses(Bool_t opt);
+   void                 SetStagedBaskets(std::unique_ptr<StagedBaskets> staged);
+   static std::unique_ptr<StagedBaskets> StageBaskets(TTree &tree, const std::vector<std::string> &branches, Int_t maxbytes);
    void                 StartLearningPhase();
    virtual void         StopLearningPhase();
    virtual void         UpdateBranches(TTree *tree);
 
-   ClassDef(TTreeCache,3)  //Specialization of TFileCacheRead for a TTree
+   ClassDef(TTreeCache,4)  //Specialization of TFileCacheRead for a TTree
 };
 
 #endif
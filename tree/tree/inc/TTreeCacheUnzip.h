@@ -29,8 +29,10 @@
 #include "TTreeCache.h"
 #include "ROOT/TTaskGroup.hxx"
 #include <atomic>
+#include <condition_variable>
 #include <queue>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 class TBasket;
@@ -89,7 +91,12 @@ protected:
    Int_t       fCycle;
    Bool_t      fParallel; ///< Indicate if we want to activate the parallelism (for this instance)
 
-   TMutex     *fIOMutex;
+   TMutex     *fIOMutex;         ///<! Protects the file reads and the unzipping state seen by the readers
+   std::mutex  fTaskGroupMutex;  ///<! Serializes the (re)creation of the unzipping tasks
+
+   std::mutex              fUnzipDoneMutex;     ///<! Protects fUnzipDone
+   std::condition_variable fUnzipDoneCondition; ///<! Signaled when a block is unzipped or the cache is reset
+   Long64_t                fUnzipDone;          ///<! Number of signals sent through fUnzipDoneCondition
 
    static TTreeCacheUnzip::EParUnzipMode fgParallel;  ///< Indicate if we want to activate the parallelism
 
@@ -100,26 +107,29 @@ protected:
 
    // Unzipping related members
    Int_t       fNseekMax;         ///<!  fNseek can change so we need to know its max size
-   Int_t       fUnzipGroupSize;   ///<!  Min accumulated size of a group of baskets ready to be unzipped by a IMT task
-   Long64_t    fUnzipBufferSize;  ///<!  Max Size for the ready unzipped blocks (default is 2*fBufferSize)
+   Int_t       fUnzipGroupSize;   ///<!  Min accumulated size of a group of baskets ready to be unzipped by a IMT task (0: automatic)
+   Long64_t    fUnzipBufferSize;  ///<!  Max Size for the ready unzipped blocks (default is fgRelBuffSize*fBufferSize)
+   std::atomic<Long64_t> fUnzipPendingBytes; ///<! Size of the unzipped blocks waiting to be picked up
+   std::vector<Int_t> fUnzipDeferred; ///<! Blocks put aside while the unzip buffer was full, to be unzipped once it drains
 
    static Double_t fgRelBuffSize; ///< This is the percentage of the TTreeCacheUnzip that will be used
 
    // Members use to keep statistics
-   Int_t       fNFound;           ///<! number of blocks that were found in the cache
-   Int_t       fNMissed;          ///<! number of blocks that were not found in the cache and were unzipped
-   Int_t       fNStalls;          ///<! number of hits which caused a stall
-   Int_t       fNUnzip;           ///<! number of blocks that were unzipped
+   std::atomic<Int_t> fNFound;    ///<! number of blocks that were found in the cache
+   std::atomic<Int_t> fNMissed;   ///<! number of blocks that were not found in the cache and were unzipped
+   std::atomic<Int_t> fNStalls;   ///<! number of hits which caused a stall
+   std::atomic<Int_t> fNUnzip;    ///<! number of blocks that were unzipped
 
 private:
    TTreeCacheUnzip(const TTreeCacheUnzip &);            //this class cannot be copied
    TTreeCacheUnzip& operator=(const TTreeCacheUnzip &);
 
-   char *fCompBuffer;
-   Int_t fCompBufferSize;
-
    // Private methods
    void  Init();
+   void  NotifyUnzipDone();
+#ifdef R__USE_IMT
+   void  ResumeUnzipping(const std::vector<Int_t> &indices, Int_t cycle);
+#endif
 
 public:
    TTreeCacheUnzip();
@@ -158,6 +168,7 @@ public:
    Int_t  GetNUnzip() { return fNUnzip; }
    Int_t  GetNMissed(){ return fNMissed; }
    Int_t  GetNFound() { return fNFound; }
+   Int_t  GetNStalls(){ return fNStalls; }
 
    void Print(Option_t* option = "") const;
 
@@ -54,6 +54,7 @@ class TTreeCloner {
    Long64_t  *fBasketSeek;       ///<[fMaxBaskets] list of basket position to be read.
    Long64_t  *fBasketEntry;      ///<[fMaxBaskets] list of basket start entries.
    UInt_t    *fBasketIndex;      ///<[fMaxBaskets] ordered list of basket indices to be written.
+   Long64_t  *fBasketCluster;    ///<[fMaxBaskets] index of the cluster containing the basket start entry (only for kSortBasketsByCluster).
 
    UShort_t   fPidOffset;        ///< Offset to be added to the copied key/basket.
 
@@ -63,12 +64,14 @@ class TTreeCloner {
    Int_t           fCacheSize;   ///< Requested size of the file cache
    TFileCacheRead *fFileCache;   ///< File Cache used to reduce the number of individual reads
    TFileCacheRead *fPrevCache;   ///< Cache that set before the TTreeCloner ctor for the 'from' TTree if any.
+   Bool_t          fParallelRead; ///< Read the baskets in a separate task while writing them (option "ParallelRead").
 
    enum ECloneMethod {
       kDefault             = 0,
       kSortBasketsByBranch = 1,
       kSortBasketsByOffset = 2,
-      kSortBasketsByEntry  = 3
+      kSortBasketsByEntry  = 3,
+      kSortBasketsByCluster = 4
    };
 
    class CompareSeek {
@@ -85,13 +88,22 @@ class TTreeCloner {
       Bool_t operator()(UInt_t i1, UInt_t i2);
    };
 
+   class CompareCluster {
+      TTreeCloner *fObject;
+   public:
+      CompareCluster(TTreeCloner *obj) : fObject(obj) {}
+      Bool_t operator()(UInt_t i1, UInt_t i2);
+   };
+
    friend class CompareSeek;
    friend class CompareEntry;
+   friend class CompareCluster;
 
    void ImportClusterRanges();
    void CreateCache();
    UInt_t FillCache(UInt_t from);
    void RestoreCache();
+   void WriteBasketsParallelRead();
 
 private:
    TTreeCloner(const TTreeCloner&) = delete;
@@ -113,6 +125,7 @@ public:
    UInt_t CollectBranches(TObjArray *from, TObjArray *to);
    UInt_t CollectBranches();
    void   CollectBaskets();
+   void   CopyCompressionDicts();
    void   CopyMemoryBaskets();
    void   CopyStreamerInfos();
    void   CopyProcessIds();
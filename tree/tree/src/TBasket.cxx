@@ -15,6 +15,7 @@
 #include "TBufferFile.h"
 #include "TTree.h"
 #include "TBranch.h"
+#include "TCompressionDict.h"
 #include "TFile.h"
 #include "TLeaf.h"
 #include "TBufferFile.h"
@@ -28,6 +29,7 @@
 #include "RZip.h"
 
 #include <bitset>
+#include <cstring>
 
 const UInt_t kDisplacementMask = 0xFF000000;  // In the streamer the two highest bytes of
                                               // the fEntryOffset are used to stored displacement.
@@ -63,6 +65,10 @@ TBasket::TBasket(const char *name, const char *title, TBranch *branch)
    : TKey(branch->GetDirectory()), fBufferSize(branch->GetBasketSize()), fNevBufSize(branch->GetEntryOffsetLen()),
      fHeaderOnly(kTRUE), fIOBits(branch->GetIOFeatures().GetFeatures())
 {
+   // The little-endian layout is only implemented for plain arrays of fundamental types.
+   if ((fIOBits & static_cast<UChar_t>(EIOBits::kLittleEndian)) && !branch->SupportsBulkRead()) {
+      fIOBits &= ~static_cast<UChar_t>(EIOBits::kLittleEndian);
+   }
    SetName(name);
    SetTitle(title);
    fClassName   = "TBasket";
@@ -234,11 +240,10 @@ Int_t TBasket::GetEntryPointer(Int_t entry)
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// Load basket buffers in memory without unziping.
-/// This function is called by TTreeCloner.
-/// The function returns 0 in case of success, 1 in case of error.
+/// Make fBufferRef big enough to hold a basket of `len` bytes read from `file`
+/// and return its buffer.
 
-Int_t TBasket::LoadBasketBuffers(Long64_t pos, Int_t len, TFile *file, TTree *tree)
+char *TBasket::PrepareLoadBuffer(Int_t len, TFile *file)
 {
    if (fBufferRef) {
       // Reuse the buffer if it exist.
@@ -255,7 +260,17 @@ Int_t TBasket::LoadBasketBuffers(Long64_t pos, Int_t len, TFile *file, TTree *tr
       fBufferRef = new TBufferFile(TBuffer::kRead, len);
    }
    fBufferRef->SetParent(file);
-   char *buffer = fBufferRef->Buffer();
+   return fBufferRef->Buffer();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Load basket buffers in memory without unziping.
+/// This function is called by TTreeCloner.
+/// The function returns 0 in case of success, 1 in case of error.
+
+Int_t TBasket::LoadBasketBuffers(Long64_t pos, Int_t len, TFile *file, TTree *tree)
+{
+   char *buffer = PrepareLoadBuffer(len, file);
    file->Seek(pos);
    TFileCacheRead *pf = file->GetCacheRead(tree);
    if (pf) {
@@ -299,6 +314,25 @@ Int_t TBasket::LoadBasketBuffers(Long64_t pos, Int_t len, TFile *file, TTree *tr
    return 0;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Load basket buffers, already read from `file` into `buffer`, without
+/// unziping.  The file is not accessed: this lets TTreeCloner read the
+/// baskets and write them to the output file in different threads.
+/// The function returns 0 in case of success, 1 in case of error.
+
+Int_t TBasket::LoadBasketBuffers(const char *buffer, Int_t len, TFile *file)
+{
+   if (!buffer || len <= 0)
+      return 1;
+   memcpy(PrepareLoadBuffer(len, file), buffer, len);
+
+   fBufferRef->SetReadMode();
+   fBufferRef->SetBufferOffset(0);
+   Streamer(*fBufferRef);
+
+   return 0;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Remove the first dentries of this basket, moving entries at
 /// dentries to the start of the buffer.
@@ -383,6 +417,7 @@ Int_t TBasket::ReadBasketBuffersUnzip(char* buffer, Int_t size, Bool_t mustFree,
       fBufferRef = new TBufferFile(TBuffer::kRead, size, buffer, mustFree);
    }
    fBufferRef->SetParent(file);
+   fMappedRegion.reset();
 
    Streamer(*fBufferRef);
 
@@ -409,7 +444,11 @@ static inline TBuffer* R__InitializeReadBasketBuffer(TBuffer* bufferRef, Int_t l
    if (R__likely(bufferRef)) {
       bufferRef->SetReadMode();
       Int_t curBufferSize = bufferRef->BufferSize();
-      if (curBufferSize < len) {
+      if (R__unlikely(!bufferRef->TestBit(TBuffer::kIsOwner))) {
+         // The buffer is borrowed (from the unzip cache or a file mapping); do
+         // not write into it but get our own.
+         bufferRef->SetBuffer(new char[len], len, kTRUE);
+      } else if (curBufferSize < len) {
          // Experience shows that giving 5% "wiggle-room" decreases churn.
          bufferRef->Expand(Int_t(len*1.05));
       }
@@ -487,6 +526,49 @@ Int_t TBasket::ReadBasketBuffers(Long64_t pos, Int_t len, TFile *file)
       }
    }
 
+   // For memory mapped files, avoid the read entirely: unstream the key from
+   // the mapping, decompress straight from it or, if the basket is not
+   // compressed, use the mapping as basket buffer.
+   if (file->IsMemoryMapped()) {
+      const char *mapped = nullptr;
+      {
+         R__LOCKGUARD_IMT(gROOTMutex); // Lock for parallel TTree I/O
+         TVirtualPerfStats* temp = gPerfStats;
+         if (fBranch->GetTree()->GetPerfStats() != 0) gPerfStats = fBranch->GetTree()->GetPerfStats();
+         mapped = file->ReadMappedBuffer(pos, len);
+         gPerfStats = temp;
+      }
+      if (mapped) {
+         fBranch->GetTree()->IncrementTotalBuffers(-fBufferSize);
+         {
+            TBufferFile keyBuffer(TBuffer::kRead, len, const_cast<char *>(mapped), kFALSE);
+            keyBuffer.SetParent(file);
+            Streamer(keyBuffer);
+         }
+         if (IsZombie()) {
+            return 1;
+         }
+         rawCompressedBuffer = const_cast<char *>(mapped);
+         oldCase = OLD_CASE_EXPRESSION;
+         if (fObjlen+fKeylen == fNbytes && !oldCase) {
+            if (fBufferRef) {
+               fBufferRef->SetBuffer(rawCompressedBuffer, len, kFALSE);
+               fBufferRef->SetReadMode();
+               fBufferRef->Reset();
+            } else {
+               fBufferRef = new TBufferFile(TBuffer::kRead, len, rawCompressedBuffer, kFALSE);
+            }
+            fBufferRef->SetParent(file);
+            fBuffer = fBufferRef->Buffer();
+            // Keep the mapping alive as long as the buffer points into it,
+            // even if the file is closed.
+            fMappedRegion = file->GetMappedRegion();
+            goto AfterBuffer;
+         }
+         goto Uncompress;
+      }
+   }
+
    // Determine which buffer to use, so that we can avoid a memcpy in case of
    // the basket was not compressed.
    TBuffer* readBufferRef;
@@ -506,6 +588,9 @@ Int_t TBasket::ReadBasketBuffers(Long64_t pos, Int_t len, TFile *file)
       Error("ReadBasketBuffers", "Unable to allocate buffer.");
       return 1;
    }
+   if (readBufferRef == fBufferRef) {
+      fMappedRegion.reset();
+   }
 
    if (pf) {
       TVirtualPerfStats* temp = gPerfStats;
@@ -571,12 +656,14 @@ Int_t TBasket::ReadBasketBuffers(Long64_t pos, Int_t len, TFile *file)
       }
    }
 
+Uncompress:
    // Initialize buffer to hold the uncompressed data
    // Note that in previous versions we didn't allocate buffers until we verified
    // the zip headers; this is no longer beforehand as the buffer lifetime is scoped
    // to the TBranch.
    uncompressedBufferLen = len > fObjlen+fKeylen ? len : fObjlen+fKeylen;
    fBufferRef = R__InitializeReadBasketBuffer(fBufferRef, uncompressedBufferLen, file);
+   fMappedRegion.reset();
    rawUncompressedBuffer = fBufferRef->Buffer();
    fBuffer = rawUncompressedBuffer;
 
@@ -612,7 +699,18 @@ Int_t TBasket::ReadBasketBuffers(Long64_t pos, Int_t len, TFile *file)
             goto AfterBuffer;
          }
 
-         R__unzip(&nin, rawCompressedObjectBuffer, &nbuf, (unsigned char*) rawUncompressedObjectBuffer, &nout);
+         UInt_t dictID = R__unzip_dict_id(nin, rawCompressedObjectBuffer);
+         if (R__unlikely(dictID)) {
+            const TCompressionDict *dict = fBranch->GetCompressionDictionary(dictID);
+            if (!dict) {
+               Error("ReadBasketBuffers", "Compression dictionary %u needed by basket %s of branch %s not found", dictID, GetName(), fBranch->GetName());
+               break;
+            }
+            R__unzipWithDict(&nin, rawCompressedObjectBuffer, &nbuf, (unsigned char*) rawUncompressedObjectBuffer, &nout,
+                             dict->GetBuffer(), dict->GetSize());
+         } else {
+            R__unzip(&nin, rawCompressedObjectBuffer, &nbuf, (unsigned char*) rawUncompressedObjectBuffer, &nout);
+         }
          if (!nout) break;
          noutot += nout;
          nintot += nin;
@@ -1114,6 +1212,11 @@ Int_t TBasket::WriteBuffer()
    Int_t cxlevel = fBranch->GetCompressionLevel();
    ROOT::ECompressionAlgorithm cxAlgorithm = static_cast<ROOT::ECompressionAlgorithm>(fBranch->GetCompressionAlgorithm());
    if (cxlevel > 0) {
+      // Feed the dictionary training, if requested; once trained, the dictionary
+      // is used for this and all the following baskets of the branch.
+      fBranch->AddCompressionDictionarySample(fBufferRef->Buffer() + fKeylen, fObjlen);
+      const TCompressionDict *dict = fBranch->GetWriteCompressionDictionary();
+
       Int_t nbuffers = 1 + (fObjlen - 1) / kMAXZIPBUF;
       Int_t buflen = fKeylen + fObjlen + 9 * nbuffers + 28; //add 28 bytes in case object is placed in a deleted gap
       InitializeCompressedBuffer(buflen, file);
@@ -1139,7 +1242,11 @@ Int_t TBasket::WriteBuffer()
          // NOTE this is declared with C linkage, so it shouldn't except.  Also, when
          // USE_IMT is defined, we are guaranteed that the compression buffer is unique per-branch.
          // (see fCompressedBufferRef in constructor).
-         R__zipMultipleAlgorithm(cxlevel, &bufmax, objbuf, &bufmax, bufcur, &nout, cxAlgorithm);
+         if (dict) {
+            R__zipWithDict(cxlevel, &bufmax, objbuf, &bufmax, bufcur, &nout, dict->GetBuffer(), dict->GetSize());
+         } else {
+            R__zipMultipleAlgorithm(cxlevel, &bufmax, objbuf, &bufmax, bufcur, &nout, cxAlgorithm);
+         }
 #ifdef R__USE_IMT
          sentry.lock();
 #endif  // R__USE_IMT
@@ -21,6 +21,7 @@
 #include "TClass.h"
 #include "TBufferFile.h"
 #include "TClonesArray.h"
+#include "TCompressionDict.h"
 #include "TFile.h"
 #include "TLeaf.h"
 #include "TLeafB.h"
@@ -53,6 +54,71 @@
 #include <stdio.h>
 
 
+namespace {
+
+#ifdef R__BYTESWAP
+constexpr Bool_t kHostIsLittleEndian = kTRUE;
+#else
+constexpr Bool_t kHostIsLittleEndian = kFALSE;
+#endif
+
+inline UShort_t BulkSwap(UShort_t x) { return (x >> 8) | (x << 8); }
+inline UInt_t BulkSwap(UInt_t x)
+{
+   return ((x & 0xff000000u) >> 24) | ((x & 0x00ff0000u) >> 8) | ((x & 0x0000ff00u) << 8) | ((x & 0x000000ffu) << 24);
+}
+inline ULong64_t BulkSwap(ULong64_t x)
+{
+   return (ULong64_t(BulkSwap(UInt_t(x))) << 32) | BulkSwap(UInt_t(x >> 32));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Copy `n` values of type T from `src` to `dst`, reversing the byte order of
+/// each.  `src` and `dst` may be identical.  The loop is kept branch-free and
+/// uses unaligned loads/stores so that the compiler can turn it into SIMD
+/// shuffles.
+
+template <typename T>
+void BulkSwapArray(const char *src, char *dst, Long64_t n)
+{
+   for (Long64_t i = 0; i < n; ++i) {
+      T v;
+      memcpy(&v, src + i * sizeof(T), sizeof(T));
+      v = BulkSwap(v);
+      memcpy(dst + i * sizeof(T), &v, sizeof(T));
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Copy `n` values of `size` bytes from `src` to `dst`, reversing their byte
+/// order if `swap` is true.  Returns false for unsupported value sizes.
+
+Bool_t BulkCopy(const char *src, char *dst, Long64_t n, Int_t size, Bool_t swap)
+{
+   if (!swap || size == 1) {
+      if (src != dst) memcpy(dst, src, n * size);
+   } else if (size == 2) {
+      BulkSwapArray<UShort_t>(src, dst, n);
+   } else if (size == 4) {
+      BulkSwapArray<UInt_t>(src, dst, n);
+   } else if (size == 8) {
+      BulkSwapArray<ULong64_t>(src, dst, n);
+   } else {
+      return kFALSE;
+   }
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Reverse the byte order of `n` values of `size` bytes stored at `data`.
+
+inline void BulkSwapInPlace(char *data, Long64_t n, Int_t size)
+{
+   BulkCopy(data, data, n, size, kTRUE);
+}
+
+} // anonymous namespace
+
 Int_t TBranch::fgCount = 0;
 
 /** \class TBranch
@@ -427,6 +493,11 @@ TBranch::~TBranch()
    delete fBrowsables;
    fBrowsables = 0;
 
+   delete fWriteDict;
+   fWriteDict = nullptr;
+   delete fReadDict;
+   fReadDict = nullptr;
+
    // Note: We do *not* have ownership of the buffer.
    fEntryBuffer = 0;
 
@@ -859,6 +930,11 @@ Int_t TBranch::FillImpl(ROOT::Internal::TBranchIMTHelper *imtHelper)
       }
       lnew = buf->Length();
       nbytes = lnew - lold;
+      if (R__unlikely(basket->TestIOBits(TBasket::EIOBits::kLittleEndian))) {
+         // The leaf wrote its values big-endian, turn them around.
+         TLeaf *leaf = (TLeaf*) fLeaves.UncheckedAt(0);
+         BulkSwapInPlace(buf->Buffer() + lold, nbytes / leaf->GetLenType(), leaf->GetLenType());
+      }
    }
 
    if (fEntryOffsetLen) {
@@ -1405,7 +1481,11 @@ Int_t TBranch::GetEntry(Long64_t entry, Int_t getall)
    }
 
    // Int_t bufbegin = buf->Length();
-   (this->*fReadLeaves)(*buf);
+   if (R__unlikely(basket->TestIOBits(TBasket::EIOBits::kLittleEndian))) {
+      ReadLeavesLittleEndian(*buf);
+   } else {
+      (this->*fReadLeaves)(*buf);
+   }
    return buf->Length() - bufbegin;
 }
 
@@ -1453,6 +1533,10 @@ Int_t TBranch::GetEntryExport(Long64_t entry, Int_t /*getall*/, TClonesArray* li
       fNextBasketEntry = -1;
       return 0;
    }
+   if (R__unlikely(basket->TestIOBits(TBasket::EIOBits::kLittleEndian))) {
+      Error("GetEntryExport", "Branch %s is stored little-endian, which is not supported here", GetName());
+      return -1;
+   }
    TBuffer* buf = basket->GetBufferRef();
    // Set entry offset in buffer and read data from all leaves.
    if (!TestBit(kDoNotUseBufferMap)) {
@@ -1480,6 +1564,175 @@ Int_t TBranch::GetEntryExport(Long64_t entry, Int_t /*getall*/, TClonesArray* li
    return nbytes;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Return true if the content of this branch can be read with GetBulkEntries
+/// and GetEntriesSerialized, i.e. if the branch has a single leaf of a
+/// fundamental type with a fixed number of elements per entry.
+
+Bool_t TBranch::SupportsBulkRead() const
+{
+   if (fNleaves != 1 || !fLeaves.GetEntriesFast()) return kFALSE;
+   TLeaf *leaf = (TLeaf*) fLeaves.UncheckedAt(0);
+   return leaf->SupportsBulkRead() && fEntryOffsetLen == 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Read, in one go, all the entries from `entry` to the end of the basket
+/// containing it and store them in `user_buf` as a contiguous array of values
+/// in host byte order.
+///
+/// The buffer is expanded if needed; on return the values start at
+/// `user_buf.Buffer()` and the buffer offset is reset to 0.  Since the storage
+/// comes from operator new, it is suitably aligned for any fundamental type.
+///
+/// Returns the number of entries stored in the buffer, or -1 if the branch
+/// does not support bulk reading (see SupportsBulkRead) or on error.  The
+/// addresses set with SetAddress are not updated.
+
+Int_t TBranch::GetBulkEntries(Long64_t entry, TBuffer &user_buf)
+{
+   return ReadBulkImpl(entry, user_buf, kTRUE);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Same as GetBulkEntries, but the values are left in their on-disk
+/// representation: big-endian, or little-endian if the branch was written with
+/// the ROOT::Experimental::EIOFeatures::kLittleEndian feature.  This is useful
+/// to hand the content of a basket to code that does its own decoding, or to
+/// copy it without interpretation.
+
+Int_t TBranch::GetEntriesSerialized(Long64_t entry, TBuffer &user_buf)
+{
+   return ReadBulkImpl(entry, user_buf, kFALSE);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Give direct access to all the entries from `entry` to the end of the basket
+/// containing it, without any copy or decoding.
+///
+/// This is only possible if the values are stored in host byte order, i.e.
+/// for branches written with the ROOT::Experimental::EIOFeatures::kLittleEndian
+/// feature read on a little-endian machine.  On success `data` points to the
+/// values of `entry` inside the basket buffer; combined with an uncompressed
+/// branch and a memory mapped file (see TFile's `mmap` option), it points into
+/// the file mapping itself.  The pointer is valid until the next basket of
+/// this branch is read and is not necessarily aligned for the value type.
+///
+/// Returns the number of entries available at `data`, or -1 if the basket
+/// needs decoding (use GetBulkEntries instead) or on error.
+
+Int_t TBranch::GetEntriesView(Long64_t entry, const char *&data)
+{
+   data = nullptr;
+   Long64_t nentries = 0;
+   TBasket *basket = nullptr;
+   const char *src = GetBulkRange(entry, nentries, basket);
+   if (!src) {
+      return -1;
+   }
+   if (!basket->TestIOBits(TBasket::EIOBits::kLittleEndian) || !kHostIsLittleEndian) {
+      TLeaf *leaf = (TLeaf*) fLeaves.UncheckedAt(0);
+      if (leaf->GetLenType() != 1) {
+         return -1;
+      }
+   }
+   data = src;
+   return nentries;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Locate the basket holding `entry` for a bulk read and return a pointer to
+/// the serialized value of `entry` in the basket buffer, or nullptr on error.
+/// `nentries` is set to the number of entries from `entry` to the end of the
+/// basket.
+
+const char *TBranch::GetBulkRange(Long64_t entry, Long64_t &nentries, TBasket *&basket)
+{
+   if (R__unlikely(!SupportsBulkRead())) {
+      return nullptr;
+   }
+   // Remember which entry we are reading.
+   fReadEntry = entry;
+
+   if (TestBit(kDoNotProcess) || (entry < fFirstEntry) || (entry >= fEntryNumber)) {
+      return nullptr;
+   }
+   basket = fCurrentBasket;
+   if (!basket || (entry < fFirstBasketEntry) || (entry >= fNextBasketEntry)) {
+      fReadBasket = TMath::BinarySearch(fWriteBasket + 1, fBasketEntry, entry);
+      if (fReadBasket < 0) {
+         fNextBasketEntry = -1;
+         Error("GetBulkEntries", "In the branch %s, no basket contains the entry %lld\n", GetName(), entry);
+         return nullptr;
+      }
+      if (fReadBasket == fWriteBasket) {
+         fNextBasketEntry = fEntryNumber;
+      } else {
+         fNextBasketEntry = fBasketEntry[fReadBasket+1];
+      }
+      fFirstBasketEntry = fBasketEntry[fReadBasket];
+      basket = GetBasket(fReadBasket);
+      fCurrentBasket = basket;
+      if (!basket) {
+         fFirstBasketEntry = -1;
+         fNextBasketEntry = -1;
+         return nullptr;
+      }
+   }
+   basket->PrepareBasket(entry);
+   TBuffer *buf = basket->GetBufferRef();
+   if (R__unlikely(!buf)) {
+      TFile *file = GetFile(0);
+      if (!file) return nullptr;
+      basket->ReadBasketBuffers(fBasketSeek[fReadBasket], fBasketBytes[fReadBasket], file);
+      buf = basket->GetBufferRef();
+   }
+   if (R__unlikely(!buf->IsReading())) {
+      basket->SetReadMode();
+   }
+
+   TLeaf *leaf = (TLeaf*) fLeaves.UncheckedAt(0);
+   const Int_t entrySize = basket->GetNevBufSize();
+   if (R__unlikely(basket->GetEntryOffset() || entrySize != leaf->GetLenType() * leaf->GetLenStatic())) {
+      return nullptr;
+   }
+   nentries = fNextBasketEntry - entry;
+   const Int_t bufbegin = basket->GetKeylen() + (entry - fFirstBasketEntry) * entrySize;
+   if (R__unlikely(bufbegin + nentries * entrySize > buf->BufferSize())) {
+      Error("GetBulkEntries", "In the branch %s, the basket for entry %lld is too short", GetName(), entry);
+      return nullptr;
+   }
+   return buf->Buffer() + bufbegin;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Implementation of GetBulkEntries and GetEntriesSerialized.
+
+Int_t TBranch::ReadBulkImpl(Long64_t entry, TBuffer &user_buf, Bool_t deserialize)
+{
+   Long64_t nentries = 0;
+   TBasket *basket = nullptr;
+   const char *src = GetBulkRange(entry, nentries, basket);
+   if (!src) {
+      return -1;
+   }
+   TLeaf *leaf = (TLeaf*) fLeaves.UncheckedAt(0);
+   const Int_t elemSize = leaf->GetLenType();
+   const Long64_t nelems = nentries * leaf->GetLenStatic();
+   const Int_t nbytes = nelems * elemSize;
+
+   user_buf.SetBufferOffset(0);
+   if (user_buf.BufferSize() < nbytes) {
+      user_buf.Expand(nbytes, kFALSE);
+   }
+   const Bool_t littleEndian = basket->TestIOBits(TBasket::EIOBits::kLittleEndian);
+   const Bool_t swap = deserialize && (littleEndian != kHostIsLittleEndian);
+   if (!BulkCopy(src, user_buf.Buffer(), nelems, elemSize, swap)) {
+      return -1;
+   }
+   return nentries;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Fill expectedClass and expectedType with information on the data type of the
 /// object/values contained in this branch (and thus the type of pointers
@@ -2073,6 +2326,23 @@ void TBranch::ReadLeaves2Impl(TBuffer& b)
    ((TLeaf*) fLeaves.UncheckedAt(1))->ReadBasket(b);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Read the single leaf of a basket written with the kLittleEndian IO feature.
+/// On little-endian machines this is a plain copy into the leaf's value.
+
+void TBranch::ReadLeavesLittleEndian(TBuffer& b)
+{
+   TLeaf *leaf = (TLeaf*) fLeaves.UncheckedAt(0);
+   const Int_t size = leaf->GetLenType();
+   const Int_t n = leaf->GetLenStatic();
+   if (R__unlikely(b.Length() + size * n > b.BufferSize())) {
+      Error("ReadLeaves", "In the branch %s, the basket for entry %lld is too short", GetName(), fReadEntry);
+      return;
+   }
+   BulkCopy(b.Buffer() + b.Length(), (char*)leaf->GetValuePointer(), n, size, !kHostIsLittleEndian);
+   b.SetBufferOffset(b.Length() + size * n);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Loop on all leaves of this branch to fill Basket buffer.
 
@@ -2396,6 +2666,143 @@ void TBranch::SetCompressionSettings(Int_t settings)
    }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Compress the baskets of this branch and its sub-branches against a trained dictionary.
+///
+/// The content of the next `nbaskets` baskets written is used to train a dictionary
+/// of at most `maxsize` bytes; these baskets are compressed as usual. The dictionary
+/// is then stored in the file as a TCompressionDict and all following baskets are
+/// compressed against it with ZSTD, whatever the compression algorithm of the branch
+/// (its compression level still applies).
+///
+/// This pays off for branches with small baskets of repetitive content (flags, small
+/// integers, short vectors), which barely compress on their own because every basket
+/// starts from an empty compression window.  Files written this way can only be read
+/// by ROOT builds with ZSTD support; without it, the training is silently skipped.
+/// nbaskets = 0 disables the training for the baskets not written yet.
+
+void TBranch::SetCompressionDictionaryTraining(Int_t nbaskets, Int_t maxsize)
+{
+   fDictTrainBaskets = nbaskets > 0 ? nbaskets : 0;
+   fDictMaxSize = maxsize;
+   fDictSamples.clear();
+   fDictSampleSizes.clear();
+
+   Int_t nb = fBranches.GetEntriesFast();
+   for (Int_t i=0;i<nb;i++) {
+      TBranch *branch = (TBranch*)fBranches.UncheckedAt(i);
+      branch->SetCompressionDictionaryTraining(nbaskets, maxsize);
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Record the uncompressed content of a basket being written as a sample for the
+/// dictionary training. Once enough samples are collected, train the dictionary;
+/// the following baskets are compressed against it (see SetCompressionDictionaryTraining).
+///
+/// This is called by TBasket::WriteBuffer while it holds the write lock of the file:
+/// the dictionary is stored in the file later, by WriteCompressionDictionaries.
+
+void TBranch::AddCompressionDictionarySample(const char *buffer, Int_t size)
+{
+   if (fDictTrainBaskets <= 0 || fWriteDict || size <= 0) {
+      return;
+   }
+   fDictSamples.insert(fDictSamples.end(), buffer, buffer + size);
+   fDictSampleSizes.push_back(size);
+   if ((Int_t)fDictSampleSizes.size() < fDictTrainBaskets) {
+      return;
+   }
+
+   std::unique_ptr<TCompressionDict> dict(TCompressionDict::Train(fDictSamples, fDictSampleSizes, fDictMaxSize));
+   fDictTrainBaskets = 0;
+   std::vector<char>().swap(fDictSamples);
+   std::vector<size_t>().swap(fDictSampleSizes);
+   if (!dict) {
+      if (gDebug > 0) {
+         Info("AddCompressionDictionarySample", "could not train a compression dictionary for branch %s", GetName());
+      }
+      return;
+   }
+
+   const Int_t kWrite = 1;
+   TFile *file = GetFile(kWrite);
+   if (!file || !file->IsWritable()) {
+      return;
+   }
+   fWriteDict = dict.release();
+   fWriteDictPending = kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Store in the file of the baskets the compression dictionaries trained since
+/// the last call, for this branch and its sub-branches. Called by TTree::FlushBaskets,
+/// outside of the basket writing, so that the file is not written while a basket
+/// holds its write lock.
+///
+/// Return the number of bytes written, or -1 in case of write error.
+
+Int_t TBranch::WriteCompressionDictionaries()
+{
+   Int_t nbytes = 0;
+   if (fWriteDictPending) {
+      fWriteDictPending = kFALSE;
+      const Int_t kWrite = 1;
+      TFile *file = GetFile(kWrite);
+      // Dictionaries are named after their content: identical ones are stored only once.
+      TString keyname = TCompressionDict::GetKeyName(fWriteDict->GetID());
+      if (file && !file->GetKey(keyname)) {
+         Int_t nwrite = file->WriteTObject(fWriteDict, keyname);
+         if (nwrite <= 0) {
+            Error("WriteCompressionDictionaries", "could not write the compression dictionary for branch %s", GetName());
+            return -1;
+         }
+         nbytes += nwrite;
+      }
+   }
+
+   Int_t nb = fBranches.GetEntriesFast();
+   for (Int_t i = 0; i < nb; ++i) {
+      TBranch *branch = (TBranch*)fBranches.UncheckedAt(i);
+      Int_t nwrite = branch->WriteCompressionDictionaries();
+      if (nwrite < 0) {
+         return -1;
+      }
+      nbytes += nwrite;
+   }
+   return nbytes;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return the dictionary with the given ID needed to uncompress a basket of this
+/// branch, loading it from the file of the baskets if needed. Return nullptr if
+/// the dictionary cannot be found.
+
+const TCompressionDict *TBranch::GetCompressionDictionary(UInt_t id)
+{
+   if (fReadDict && fReadDict->GetID() == id) {
+      return fReadDict;
+   }
+   if (fWriteDict && fWriteDict->GetID() == id) {
+      return fWriteDict;
+   }
+   TFile *file = GetFile();
+   if (!file) {
+      return nullptr;
+   }
+   TCompressionDict *dict = nullptr;
+   {
+      R__LOCKGUARD_IMT(gROOTMutex); // Lock for parallel TTree I/O
+      dict = dynamic_cast<TCompressionDict *>(file->Get(TCompressionDict::GetKeyName(id)));
+   }
+   if (!dict) {
+      return nullptr;
+   }
+   delete fReadDict;
+   fReadDict = dict;
+   return fReadDict;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Update the default value for the branch's fEntryOffsetLen if and only if
 /// it was already non zero (and the new value is not zero)
@@ -54,9 +54,82 @@ the trees in the chain.
 #include "TFileStager.h"
 #include "TFilePrefetch.h"
 #include "TVirtualMutex.h"
+#include "TEnv.h"
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 
 ClassImp(TChain);
 
+namespace ROOT {
+namespace Internal {
+
+////////////////////////////////////////////////////////////////////////////////
+/// Opens, in a background thread, the file holding the next tree of a TChain
+/// and reads its metadata (header, StreamerInfo and TTree) as well as, when the
+/// names of the cached branches are known, the baskets of its first cluster.
+
+class TChainNextFile {
+   Int_t fTreeNumber;                                   ///< Number of the tree in the chain
+   std::string fUrl;                                    ///< Name of the file
+   TFile *fFile = nullptr;                              ///< The opened file (owned until Take())
+   std::unique_ptr<TTreeCache::StagedBaskets> fStaged;  ///< Baskets of the first cluster
+   std::thread fThread;                                 ///< Must be last: it uses the members above
+
+   void Open(const std::string &treename, const std::vector<std::string> &branches, Int_t maxbytes)
+   {
+      TDirectory::TContext ctxt;
+      TFile *file = TFile::Open(fUrl.c_str());
+      if (!file || file->IsZombie()) {
+         // The chain will try again and report the error.
+         delete file;
+         return;
+      }
+      TTree *tree = dynamic_cast<TTree *>(file->Get(treename.c_str()));
+      if (tree && !branches.empty())
+         fStaged = TTreeCache::StageBaskets(*tree, branches, maxbytes);
+      fFile = file;
+   }
+
+   void Wait()
+   {
+      if (fThread.joinable())
+         fThread.join();
+   }
+
+public:
+   TChainNextFile(Int_t treenumber, const char *url, const char *treename, std::vector<std::string> &&branches,
+                  Int_t maxbytes)
+      : fTreeNumber(treenumber), fUrl(url),
+        fThread(&TChainNextFile::Open, this, std::string(treename), std::move(branches), maxbytes)
+   {
+   }
+
+   ~TChainNextFile()
+   {
+      Wait();
+      delete fFile;
+   }
+
+   Bool_t IsFor(Int_t treenumber, const char *url) const { return fTreeNumber == treenumber && fUrl == url; }
+
+   /// Wait for the background work and hand over the file (nullptr if it could
+   /// not be opened) and the staged baskets.
+   TFile *Take(std::unique_ptr<TTreeCache::StagedBaskets> &staged)
+   {
+      Wait();
+      staged = std::move(fStaged);
+      TFile *file = fFile;
+      fFile = nullptr;
+      return file;
+   }
+};
+
+} // namespace Internal
+} // namespace ROOT
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Default constructor.
 
@@ -72,6 +145,8 @@ TChain::TChain()
 , fFiles(0)
 , fStatus(0)
 , fProofChain(0)
+, fPrefetchNextFile(gEnv->GetValue("TChain.PrefetchNextFile", 0))
+, fNextFile(0)
 {
    fTreeOffset = new Long64_t[fTreeOffsetLen];
    fFiles = new TObjArray(fTreeOffsetLen);
@@ -146,6 +221,8 @@ TChain::TChain(const char* name, const char* title)
 , fFiles(0)
 , fStatus(0)
 , fProofChain(0)
+, fPrefetchNextFile(gEnv->GetValue("TChain.PrefetchNextFile", 0))
+, fNextFile(0)
 {
    //
    //*-*
@@ -183,6 +260,7 @@ TChain::~TChain()
    }
 
    SafeDelete(fProofChain);
+   SafeDelete(fNextFile);
    fStatus->Delete();
    delete fStatus;
    fStatus = 0;
@@ -1471,11 +1549,20 @@ Long64_t TChain::LoadTree(Long64_t entry)
       }
    }
 
+   // Use the file opened in the background, if it is the one we need.
+   TFile *prefetchedFile = nullptr;
+   std::unique_ptr<TTreeCache::StagedBaskets> staged;
+   if (fNextFile) {
+      if (fNextFile->IsFor(treenum, element->GetTitle()))
+         prefetchedFile = fNextFile->Take(staged);
+      SafeDelete(fNextFile);
+   }
+
    // FIXME: We leak memory here, we've just lost the open file
    //        if we did not delete it above.
    {
       TDirectory::TContext ctxt;
-      fFile = TFile::Open(element->GetTitle());
+      fFile = prefetchedFile ? prefetchedFile : TFile::Open(element->GetTitle());
       if (fFile) fFile->SetBit(kMustCleanup);
    }
 
@@ -1527,6 +1614,10 @@ Long64_t TChain::LoadTree(Long64_t entry)
          this->SetCacheSize(fCacheSize);
       }
    }
+   if (staged && fTree) {
+      if (TTreeCache *cache = dynamic_cast<TTreeCache *>(fFile->GetCacheRead(fTree)))
+         cache->SetStagedBaskets(std::move(staged));
+   }
 
    // Check if fTreeOffset has really been set.
    Long64_t nentries = 0;
@@ -1678,10 +1769,50 @@ Long64_t TChain::LoadTree(Long64_t entry)
       fNotify->Notify();
    }
 
+   if (fPrefetchNextFile) {
+      StartNextFile();
+   }
+
    // Return the new local entry number.
    return treeReadEntry;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Start opening, in the background, the file of the tree following the
+/// current one (see SetPrefetchNextFile()).
+
+void TChain::StartNextFile()
+{
+   Int_t next = fTreeNumber + 1;
+   if (fTreeNumber < 0 || next >= fNtrees) {
+      return;
+   }
+   TChainElement *element = (TChainElement *)fFiles->At(next);
+   if (!element) {
+      return;
+   }
+   if (fNextFile && fNextFile->IsFor(next, element->GetTitle())) {
+      return;
+   }
+   SafeDelete(fNextFile);
+   ROOT::EnableThreadSafety();
+
+   // Stage the first cluster of the branches the cache has learnt so far.
+   std::vector<std::string> branches;
+   Int_t maxbytes = 0;
+   TTreeCache *cache = (fFile && fTree) ? dynamic_cast<TTreeCache *>(fFile->GetCacheRead(fTree)) : nullptr;
+   if (cache && !cache->IsLearning() && cache->GetCachedBranchNames()) {
+      TIter nextname(cache->GetCachedBranchNames());
+      while (TObject *name = nextname()) {
+         branches.emplace_back(name->GetName());
+      }
+      maxbytes = cache->GetBufferSize();
+   }
+
+   fNextFile = new ROOT::Internal::TChainNextFile(next, element->GetTitle(), element->GetName(), std::move(branches),
+                                                  maxbytes);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Check / locate the files in the chain.
 /// By default only the files not yet looked up are checked.
@@ -2270,6 +2401,7 @@ void TChain::RemoveFriend(TTree* oldFriend)
 
 void TChain::Reset(Option_t*)
 {
+   SafeDelete(fNextFile);
    delete fFile;
    fFile = 0;
    fNtrees         = 0;
@@ -2292,6 +2424,7 @@ void TChain::Reset(Option_t*)
 
 void TChain::ResetAfterMerge(TFileMergeInfo *info)
 {
+   SafeDelete(fNextFile);
    fNtrees         = 0;
    fTreeNumber     = -1;
    fTree           = 0;
@@ -2781,6 +2914,30 @@ void TChain::SetName(const char* name)
 
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Enable or disable the opening of the next file of the chain in the
+/// background.
+///
+/// When enabled, each time the chain switches to a new tree, a background
+/// thread opens the file holding the following tree and reads its header,
+/// StreamerInfo and TTree metadata. Once the TTreeCache of the chain has
+/// finished learning, it also reads the baskets of the first cluster of the
+/// cached branches, which the cache then uses for the first entries of that
+/// tree. This hides most of the latency of switching files on remote storage.
+///
+/// Enabling it also enables ROOT's thread safety (see ROOT::EnableThreadSafety).
+/// The default is taken from the resource TChain.PrefetchNextFile.
+
+void TChain::SetPrefetchNextFile(Bool_t prefetch)
+{
+   fPrefetchNextFile = prefetch;
+   if (!prefetch) {
+      SafeDelete(fNextFile);
+   } else if (fTree) {
+      StartNextFile();
+   }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Set number of entries per packet for parallel root.
 
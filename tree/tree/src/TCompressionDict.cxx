@@ -0,0 +1,76 @@
+// @(#)root/tree:$Id$
+
+/*************************************************************************
+ * Copyright (C) 1995-2018, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+/** \class TCompressionDict
+\ingroup tree
+
+A compression dictionary for the baskets of a branch.
+
+Baskets of branches holding small, repetitive data (flags, small integers,
+short vectors) are often only a few kilobytes large and barely compress, since
+every basket starts the compression from an empty window. A dictionary trained
+on the first baskets of the branch primes the compressor with the typical
+content, see TBranch::SetCompressionDictionaryTraining.
+
+Dictionaries are stored in the file as keys named after their ID (see GetKeyName),
+so that identical dictionaries are written only once; the compressed baskets
+record the ID of the dictionary they need.
+*/
+
+#include "TCompressionDict.h"
+
+#include "RZip.h"
+
+ClassImp(TCompressionDict);
+
+////////////////////////////////////////////////////////////////////////////////
+/// Take ownership of a dictionary produced by R__zip_train_dict.
+
+TCompressionDict::TCompressionDict(std::vector<char> &&buffer) : fBuffer(std::move(buffer))
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return the ID of the dictionary, as recorded in the baskets compressed with it.
+
+UInt_t TCompressionDict::GetID() const
+{
+   if (!fID && !fBuffer.empty()) {
+      const_cast<TCompressionDict *>(this)->fID = R__zip_dict_id(fBuffer.data(), fBuffer.size());
+   }
+   return fID;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return the name of the key holding the dictionary with the given ID.
+
+TString TCompressionDict::GetKeyName(UInt_t id)
+{
+   return TString::Format("TCompressionDict_%u", id);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Train a dictionary of at most maxSize bytes on the concatenated samples.
+/// Return nullptr if no dictionary could be trained, e.g. because ROOT was
+/// built without ZSTD support or the samples are too few or too small.
+
+TCompressionDict *TCompressionDict::Train(const std::vector<char> &samples, const std::vector<size_t> &sampleSizes,
+                                          Int_t maxSize)
+{
+   if (samples.empty() || sampleSizes.empty() || maxSize <= 0)
+      return nullptr;
+
+   std::vector<char> buffer(maxSize);
+   Int_t size = R__zip_train_dict(buffer.data(), maxSize, samples.data(), sampleSizes.data(), sampleSizes.size());
+   if (size <= 0)
+      return nullptr;
+   buffer.resize(size);
+   return new TCompressionDict(std::move(buffer));
+}
@@ -44,6 +44,14 @@ using namespace ROOT;
  *
  * The method `TTree::SetIOFeatures` creates a copy of the feature set; subsequent changes
  * to the `TIOFeatures` object do not propogate to the `TTree`.
+ *
+ * The currently available experimental features are:
+ *  - `kGenerateOffsetMap`: do not store the entry offset array of baskets whose leaves
+ *    can regenerate it at read time.
+ *  - `kLittleEndian`: store branches holding a fixed number of values of a fundamental
+ *    type (see `TBranch::SupportsBulkRead`) in little-endian byte order.  On little-endian
+ *    machines such baskets are read without any decoding step and can be accessed in
+ *    place with `TBranch::GetEntriesView`.  The feature is ignored for all other branches.
  */
 
 
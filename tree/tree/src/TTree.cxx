@@ -2937,11 +2937,12 @@ Int_t TTree::CheckBranchAddressType(TBranch* branch, TClass* ptrClass, EDataType
 /// When 'fast' is specified, 'option' can also contain a sorting
 /// order for the baskets in the output file.
 ///
-/// There are currently 3 supported sorting order:
+/// There are currently 4 supported sorting order:
 ///
 /// - SortBasketsByOffset (the default)
 /// - SortBasketsByBranch
 /// - SortBasketsByEntry
+/// - SortBasketsByCluster
 ///
 /// When using SortBasketsByOffset the baskets are written in the
 /// output file in the same order as in the original file (i.e. the
@@ -2962,6 +2963,10 @@ Int_t TTree::CheckBranchAddressType(TBranch* branch, TClass* ptrClass, EDataType
 /// the file the baskets will be in the order in which they will be
 /// needed when reading the whole tree sequentially.
 ///
+/// When using SortBasketsByCluster the baskets are grouped by cluster
+/// and, within a cluster, by branch, so that all the baskets of a cluster
+/// are contiguous in the output file.
+///
 /// For examples of CloneTree, see tutorials:
 ///
 /// - copytree.C:
@@ -3338,13 +3343,23 @@ namespace {
 /// When 'fast' is specified, 'option' can also contains a sorting order for the
 /// baskets in the output file.
 ///
-/// There are currently 3 supported sorting order:
+/// There are currently 4 supported sorting order:
 ///
 /// - SortBasketsByOffset (the default)
 /// - SortBasketsByBranch
 /// - SortBasketsByEntry
+/// - SortBasketsByCluster
+///
+/// See TTree::CloneTree for a detailed explanation of the semantics of these 4 options.
+///
+/// When 'fast' is specified and 'option' contains 'ParallelRead', the baskets
+/// are read from the input file by a separate task, one file cache worth of
+/// baskets ahead of the copy to this tree's file (see TTreeCloner).
 ///
-/// See TTree::CloneTree for a detailed explanation of the semantics of these 3 options.
+/// If 'option' contains 'ClusterSize=<size>' (for example ClusterSize=30MB), the
+/// entries are copied without the 'fast' method so that the baskets can be
+/// re-sized to produce clusters of about `<size>` compressed bytes (see
+/// TTree::SetAutoFlush).  The cluster size is set when this tree is still empty.
 ///
 /// If the tree or any of the underlying tree of the chain has an index, that index and any
 /// index in the subsequent underlying TTree objects will be merged.
@@ -3395,6 +3410,22 @@ Long64_t TTree::CopyEntries(TTree* tree, Long64_t nentries /* = -1 */, Option_t*
       }
    }
    if (gDebug > 0 && cacheSize != -1) Info("CopyEntries","Using Cache size: %d\n",cacheSize);
+   Ssiz_t clusterSizeLoc = opt.Index("clustersize=");
+   if (clusterSizeLoc != TString::kNPOS) {
+      Int_t clusterSize = -1;
+      Ssiz_t clusterSizeEnd = opt.Index(" ",clusterSizeLoc+12);
+      if (clusterSizeEnd == TString::kNPOS) clusterSizeEnd = opt.Length();
+      TSubString clusterSizeStr( opt(clusterSizeLoc+12,clusterSizeEnd-(clusterSizeLoc+12)) );
+      auto parseResult = ROOT::FromHumanReadableSize(clusterSizeStr,clusterSize);
+      if (parseResult != ROOT::EFromHumanReadableSize::kSuccess || clusterSize <= 0) {
+         Warning("CopyEntries","The clustersize option can not be parsed: %s. The clusters will not be resized.",clusterSizeStr.String().Data());
+      } else {
+         // The baskets need to be rewritten to be resized.
+         fastClone = kFALSE;
+         // Once set, the cluster size is kept for the following inputs.
+         if (GetEntries() == 0) SetAutoFlush(-clusterSize);
+      }
+   }
 
    Long64_t nbytes = 0;
    Long64_t treeEntries = tree->GetEntriesFast();
@@ -4964,18 +4995,29 @@ Int_t TTree::FlushBasketsImpl() const
       const_cast<TTree*>(this)->AddTotBytes(fIMTTotBytes);
       const_cast<TTree*>(this)->AddZipBytes(fIMTZipBytes);
 
-      return nerrpar ? -1 : nbpar.load();
-   }
+      nerror = nerrpar.load();
+      nbytes = nbpar.load();
+   } else
 #endif
+   {
+      for (Int_t j = 0; j < nb; j++) {
+         TBranch* branch = (TBranch*) lb->UncheckedAt(j);
+         if (branch) {
+            Int_t nwrite = branch->FlushBaskets();
+            if (nwrite<0) {
+               ++nerror;
+            } else {
+               nbytes += nwrite;
+            }
+         }
+      }
+   }
+   // The compression dictionaries trained while writing the baskets are stored
+   // now that no basket is being written.
    for (Int_t j = 0; j < nb; j++) {
       TBranch* branch = (TBranch*) lb->UncheckedAt(j);
-      if (branch) {
-         Int_t nwrite = branch->FlushBaskets();
-         if (nwrite<0) {
-            ++nerror;
-         } else {
-            nbytes += nwrite;
-         }
+      if (branch && branch->WriteCompressionDictionaries() < 0) {
+         ++nerror;
       }
    }
    if (nerror) {
@@ -5406,7 +5448,7 @@ Int_t TTree::GetEntry(Long64_t entry, Int_t getall)
 
 #ifdef R__USE_IMT
    const auto nBranches = GetListOfBranches()->GetEntries();
-   if (nBranches > 1 && ROOT::IsImplicitMTEnabled() && fIMTEnabled && !TTreeCacheUnzip::IsParallelUnzip()) {
+   if (nBranches > 1 && ROOT::IsImplicitMTEnabled() && fIMTEnabled) {
       if (fSortedBranches.empty())
          InitializeBranchLists(true);
 
@@ -8387,6 +8429,10 @@ Int_t TTree::SetCacheSizeAux(Bool_t autocache /* = kTRUE */, Long64_t cacheSize
             }
             return -1;
          }
+         if (file->IsMemoryMapped()) {
+            // Baskets are read straight from the file mapping, a cache would only add a copy.
+            return 0;
+         }
       }
    }
 
@@ -8504,6 +8550,39 @@ void TTree::SetCircular(Long64_t maxEntries)
    }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Compress the baskets of the matching branches against per-branch
+/// dictionaries, trained on their first `nbaskets` baskets.
+///
+/// - if bname="*", apply to all branches.
+/// - if bname="xxx*", apply to all branches with name starting with xxx
+///
+/// See TBranch::SetCompressionDictionaryTraining for the details. Typical usage
+/// for a tree with many small branches:
+/// ~~~ {.cpp}
+///    tree->SetCompressionDictionaryTraining("*", 5);
+/// ~~~
+
+void TTree::SetCompressionDictionaryTraining(const char *bname, Int_t nbaskets, Int_t maxsize)
+{
+   Int_t nleaves = fLeaves.GetEntriesFast();
+   TRegexp re(bname, kTRUE);
+   Int_t nb = 0;
+   for (Int_t i = 0; i < nleaves; i++)  {
+      TLeaf* leaf = (TLeaf*) fLeaves.UncheckedAt(i);
+      TBranch* branch = (TBranch*) leaf->GetBranch();
+      TString s = branch->GetName();
+      if (strcmp(bname, branch->GetName()) && (s.Index(re) == kNPOS)) {
+         continue;
+      }
+      nb++;
+      branch->SetCompressionDictionaryTraining(nbaskets, maxsize);
+   }
+   if (!nb) {
+      Error("SetCompressionDictionaryTraining", "unknown branch -> '%s'", bname);
+   }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Set the debug level and the debug range.
 ///
@@ -8837,6 +8916,12 @@ void TTree::SetObject(const char* name, const char* title)
 
 ////////////////////////////////////////////////////////////////////////////////
 /// Enable or disable parallel unzipping of Tree buffers.
+///
+/// The baskets of the cluster in the TTreeCache are then unzipped by background
+/// tasks. This can be combined with implicit multi-threading, in which case
+/// GetEntry also reads the branches in parallel.
+/// RelSize, if positive, sets the maximum size of the unzipped baskets waiting to
+/// be read, relative to the size of the TTreeCache.
 
 void TTree::SetParallelUnzip(Bool_t opt, Float_t RelSize)
 {
@@ -241,6 +241,26 @@ of effective system reads for a given file with a code like
 ~~~ {.cpp}
     printf("Reading %lld bytes in %d transactions\n",f->GetBytesRead(),  f->GetReadCalls());
 ~~~
+The cache also records, for each branch, the bytes and number of baskets it
+prefetched and, if TTreeCache::SetMissStats() is enabled (or the resource
+TTreeCache.MissStats), those that had to be read outside of the cache. They are
+available from TTreeCache::GetBranchStats() and printed by
+`TTreeCache::Print("branchstats")`.
+
+## Automatic tuning
+
+Two optional behaviours let the cache follow the analysis:
+ - TTreeCache::SetAutoResize(maxsize) (or the resource TTreeCache.AutoResize)
+   lets the buffer grow when the baskets of the cached branches for a cluster
+   do not fit, up to maxsize bytes, and shrink when most of it is unused.
+ - TTreeCache::SetLearnOnMiss() (or the resource TTreeCache.LearnOnMiss)
+   restarts the learning phase when a branch that is not in the cache starts
+   being read, for example because a new RDataFrame Define uses it.
+~~~ {.cpp}
+    TTreeCache *tc = (TTreeCache*)f->GetCacheRead(T);
+    tc->SetAutoResize(100000000); // at most 100 MBytes
+    tc->SetLearnOnMiss();
+~~~
 */
 
 #include "TSystem.h"
@@ -260,6 +280,7 @@ of effective system reads for a given file with a code like
 #include "TBranchCacheInfo.h"
 #include "TVirtualPerfStats.h"
 #include <limits.h>
+#include <algorithm>
 
 Int_t TTreeCache::fgLearnEntries = 100;
 
@@ -282,6 +303,9 @@ TTreeCache::TTreeCache(TTree *tree, Int_t buffersize)
    fEntryNext = fEntryMin + fgLearnEntries;
    Int_t nleaves = tree->GetListOfLeaves()->GetEntries();
    fBranches = new TObjArray(nleaves);
+   SetAutoResize(gEnv->GetValue("TTreeCache.AutoResize", 0));
+   SetLearnOnMiss(gEnv->GetValue("TTreeCache.LearnOnMiss", 0));
+   SetMissStats(gEnv->GetValue("TTreeCache.MissStats", 0));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -352,6 +376,7 @@ Int_t TTreeCache::AddBranch(TBranch *b, Bool_t subbranches /*= kFALSE*/)
       }
       fBrNames->Add(new TObjString(bname));
       fNbranches++;
+      SetBasketIndexCached(b, kTRUE);
       if (gDebug > 0) printf("Entry: %lld, registering branch: %s\n",b->GetTree()->GetReadEntry(),b->GetName());
    }
 
@@ -491,6 +516,7 @@ Int_t TTreeCache::DropBranch(TBranch *b, Bool_t subbranches /*= kFALSE*/)
    //Is branch already in the cache?
    if (fBranches->Remove(b)) {
       --fNbranches;
+      SetBasketIndexCached(b, kFALSE);
       if (gDebug > 0) printf("Entry: %lld, un-registering branch: %s\n",b->GetTree()->GetReadEntry(),b->GetName());
    }
    delete fBrNames->Remove(fBrNames->FindObject(b->GetName()));
@@ -846,7 +872,7 @@ Bool_t TTreeCache::ProcessMiss(Long64_t pos, int len)
    fMissCache->fData.reserve(cumulative);
    // printf("Reading %lu bytes into miss cache for %lu entries.\n", cumulative, fEntries->size());
    fNMissReadPref += fMissCache->fEntries.size();
-   fFile->ReadBuffers(&(fMissCache->fData[0]), &(positions[0]), &(lengths[0]), fMissCache->fEntries.size());
+   fFile->ReadBuffersViaBlockCache(&(fMissCache->fData[0]), &(positions[0]), &(lengths[0]), fMissCache->fEntries.size());
    fFirstMiss = fLastMiss = fEntryCurrent;
 
    return kTRUE;
@@ -918,6 +944,328 @@ Bool_t TTreeCache::CheckMissCache(char *buf, Long64_t pos, int len)
 /// End of methods for miss cache.
 ////////////////////////////////////////////////////////////////////////////////
 
+////////////////////////////////////////////////////////////////////////////////
+/// Start of methods for the per-branch statistics and auto-tuning.
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return the statistics of branch `b`, creating them on first use.
+/// The statistics are keyed by branch name so that they are carried over
+/// from one tree of a TChain to the next.
+
+TTreeCache::BranchStats &TTreeCache::GetBranchStatsFor(TBranch *b)
+{
+   const char *name = b->GetName();
+   auto iter = fBranchStatsIndex.find(name);
+   if (iter != fBranchStatsIndex.end())
+      return fBranchStats[iter->second];
+   fBranchStatsIndex.emplace(name, fBranchStats.size());
+   fBranchStats.emplace_back(name);
+   return fBranchStats.back();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return whether the branch is among the branches in the cache.
+
+Bool_t TTreeCache::IsCachedBranch(TBranch *b) const
+{
+   for (Int_t i = 0; i < fNbranches; ++i) {
+      if (fBranches->UncheckedAt(i) == b)
+         return kTRUE;
+   }
+   return kFALSE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Add the baskets of the branch stored in the file of the cache to the index
+/// of the basket positions.
+
+void TTreeCache::IndexBaskets(TBranch *b)
+{
+   if (!b || !b->GetDirectory() || b->GetDirectory()->GetFile() != fFile)
+      return;
+   const Bool_t cached = IsCachedBranch(b);
+   Int_t nbaskets = b->GetWriteBasket();
+   for (Int_t i = 0; i < nbaskets; ++i) {
+      if (b->GetBasketSeek(i) > 0)
+         fBasketIndex.emplace(b->GetBasketSeek(i), std::make_pair(b, cached));
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Update the cached flag of the baskets of the branch, if they are already
+/// in the index, after the branch was added to or dropped from the cache.
+
+void TTreeCache::SetBasketIndexCached(TBranch *b, Bool_t cached)
+{
+   if (!fBasketIndexTree || fBasketIndex.empty())
+      return;
+   Int_t nbaskets = b->GetWriteBasket();
+   for (Int_t i = 0; i < nbaskets; ++i) {
+      auto iter = fBasketIndex.find(b->GetBasketSeek(i));
+      if (iter != fBasketIndex.end() && iter->second.first == b)
+         iter->second.second = cached;
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Find the branch whose basket starts at `pos` in the file; `cached` tells
+/// whether the branch is in the cache.
+///
+/// The baskets are indexed by their position in the file. The index is built
+/// incrementally: the branches of the current tree are only indexed, in the
+/// order of its leaves, until the one owning `pos` is found. It is discarded
+/// when the tree or the file of the cache changes.
+///
+/// Returns nullptr if no branch matches.
+
+TBranch *TTreeCache::FindBranchOfRead(Long64_t pos, Bool_t &cached)
+{
+   cached = kFALSE;
+   TTree *tree = fTree ? fTree->GetTree() : nullptr;
+   if (!tree)
+      return nullptr;
+   if (fBasketIndexTree != tree) {
+      fBasketIndex.clear();
+      fBasketIndexTree = tree;
+      fBasketIndexLeaves = 0;
+   }
+
+   auto iter = fBasketIndex.find(pos);
+   if (iter == fBasketIndex.end()) {
+      TObjArray *leaves = tree->GetListOfLeaves();
+      const Int_t nleaves = leaves ? leaves->GetEntriesFast() : 0;
+      while (iter == fBasketIndex.end() && fBasketIndexLeaves < nleaves) {
+         IndexBaskets(static_cast<TLeaf *>(leaves->UncheckedAt(fBasketIndexLeaves++))->GetBranch());
+         iter = fBasketIndex.find(pos);
+      }
+      if (iter == fBasketIndex.end())
+         return nullptr;
+   }
+   cached = iter->second.second;
+   return iter->second.first;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Account for a read of `len` bytes at `pos` that was not served by the
+/// primary cache. Only called if SetMissStats() or SetLearnOnMiss() is
+/// enabled, since it has to find the branch owning the basket.
+///
+/// If SetLearnOnMiss() is enabled and the basket belongs to a branch that is
+/// not in the cache, the access pattern has changed since the end of the
+/// learning phase (for example a new RDataFrame Define started to use that
+/// branch): the branch is added to the cache and a new learning phase of
+/// GetLearnEntries() entries starts, keeping the branches already learnt.
+/// Each branch can restart the learning phase only once, so that branches
+/// read too rarely to be picked up by the learning do not keep restarting it.
+
+void TTreeCache::RecordMiss(Long64_t pos, Int_t len)
+{
+   // During the learning phase the reads are expected to miss the cache
+   if (fIsLearning)
+      return;
+   Bool_t cached = kFALSE;
+   TBranch *b = FindBranchOfRead(pos, cached);
+   if (!b)
+      return;
+   BranchStats &stats = GetBranchStatsFor(b);
+   if (fMissStats) {
+      ++stats.fNMissed;
+      stats.fBytesMissed += len;
+   }
+
+   if (!fLearnOnMiss || cached || fIsManual || fEnablePrefetching || stats.fTriggeredLearning)
+      return;
+   if (fTree->GetTree() != b->GetTree())
+      return;
+
+   stats.fTriggeredLearning = kTRUE;
+   ++fNRelearn;
+   Long64_t entry = b->GetTree()->GetReadEntry();
+   if (gDebug > 0)
+      Info("RecordMiss", "Branch %s is read but not cached, restarting the learning phase at entry %lld", b->GetName(),
+           entry);
+
+   fIsLearning = kTRUE;
+   AddBranch(b);
+   fEntryCurrent = -1;
+   fEntryNext = entry + fgLearnEntries;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return the number of bytes of the baskets of the cached branches holding
+/// entries in the range [start, end).
+
+Long64_t TTreeCache::CalculateClusterBytes(Long64_t start, Long64_t end)
+{
+   Long64_t total = 0;
+   for (Int_t i = 0; i < fNbranches; ++i) {
+      TBranch *b = (TBranch *)fBranches->UncheckedAt(i);
+      if (!b->GetDirectory() || b->GetDirectory()->GetFile() != fFile)
+         continue;
+      Int_t nbaskets = b->GetWriteBasket();
+      Int_t *lbaskets = b->GetBasketBytes();
+      Long64_t *entries = b->GetBasketEntry();
+      if (nbaskets <= 0 || !lbaskets || !entries)
+         continue;
+      Long64_t j = TMath::BinarySearch(nbaskets, entries, start);
+      if (j < 0)
+         j = 0;
+      for (; j < nbaskets && entries[j] < end; ++j) {
+         if (b->GetBasketSeek(j) > 0)
+            total += lbaskets[j];
+      }
+   }
+   return total;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Adapt the size of the buffer to the baskets of the cached branches for the
+/// entries [start, end), within the limit set by SetAutoResize().
+/// The buffer grows as soon as the range does not fit and shrinks only when
+/// less than half of it would be used, to avoid reallocating it for every
+/// cluster.
+
+void TTreeCache::AutoResize(Long64_t start, Long64_t end)
+{
+   Long64_t needed = CalculateClusterBytes(start, end);
+   if (needed <= 0)
+      return;
+   // Leave some room for the clusters that are slightly larger.
+   Long64_t target = std::min<Long64_t>(needed + needed / 8, fAutoResizeMax);
+   Int_t current = fBufferSizeMin;
+   if ((needed > current && target > current) || 2 * target < current) {
+      if (gDebug > 0)
+         Info("AutoResize", "Resizing the cache from %d to %lld bytes (%lld bytes for the entries [%lld, %lld[)",
+              current, target, needed, start, end);
+      TFileCacheRead::SetBufferSize((Int_t)target);
+      ++fNResize;
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Clear the per-branch statistics.
+
+void TTreeCache::ResetBranchStats()
+{
+   fBranchStats.clear();
+   fBranchStatsIndex.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Let the cache adapt its buffer size to the data held by the cached
+/// branches in each cluster, up to `maxbuffersize` bytes.
+/// A value of 0 disables the automatic resizing and the buffer keeps the size
+/// given by SetBufferSize(). The default is taken from the resource
+/// TTreeCache.AutoResize.
+
+void TTreeCache::SetAutoResize(Int_t maxbuffersize)
+{
+   fAutoResizeMax = maxbuffersize > 0 ? maxbuffersize : 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// End of methods for the per-branch statistics and auto-tuning.
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return true if a staged basket starts at `pos`.
+
+Bool_t TTreeCache::StagedBaskets::Contains(Long64_t pos) const
+{
+   return std::binary_search(fPos.begin(), fPos.end(), pos);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Copy into `buf` the staged basket starting at `pos`, if any.
+/// Returns true if the request was satisfied.
+
+Bool_t TTreeCache::StagedBaskets::ReadBuffer(char *buf, Long64_t pos, Int_t len) const
+{
+   auto iter = std::lower_bound(fPos.begin(), fPos.end(), pos);
+   if (iter == fPos.end() || *iter != pos)
+      return kFALSE;
+   auto idx = iter - fPos.begin();
+   if (len > fLen[idx])
+      return kFALSE;
+   memcpy(buf, &fData[fIndex[idx]], len);
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Read, with a single vectored read, the baskets of the first cluster of
+/// `tree` for the given branches, up to `maxbytes` bytes.
+///
+/// This does not use nor modify any cache and can thus be run in another
+/// thread than the one using the tree's file, as long as the file itself is
+/// not used concurrently. The result is meant to be handed to the cache
+/// reading the tree with SetStagedBaskets().
+/// Returns nullptr if nothing could be read.
+
+std::unique_ptr<TTreeCache::StagedBaskets>
+TTreeCache::StageBaskets(TTree &tree, const std::vector<std::string> &branches, Int_t maxbytes)
+{
+   TFile *file = tree.GetCurrentFile();
+   if (!file || branches.empty() || maxbytes <= 0)
+      return nullptr;
+
+   TTree::TClusterIterator clusterIter = tree.GetClusterIterator(0);
+   clusterIter();
+   Long64_t end = std::min(clusterIter.GetNextEntry(), tree.GetEntries());
+
+   std::vector<IOPos> baskets;
+   Long64_t total = 0;
+   for (const auto &name : branches) {
+      TBranch *b = tree.GetBranch(name.c_str());
+      if (!b || !b->GetDirectory() || b->GetDirectory()->GetFile() != file)
+         continue;
+      Int_t nbaskets = b->GetWriteBasket();
+      Int_t *lbaskets = b->GetBasketBytes();
+      Long64_t *entries = b->GetBasketEntry();
+      if (nbaskets <= 0 || !lbaskets || !entries)
+         continue;
+      for (Int_t j = 0; j < nbaskets && entries[j] < end; ++j) {
+         Long64_t pos = b->GetBasketSeek(j);
+         Int_t len = lbaskets[j];
+         if (pos <= 0 || len <= 0 || total + len > maxbytes)
+            continue;
+         baskets.emplace_back(pos, len);
+         total += len;
+      }
+   }
+   if (baskets.empty())
+      return nullptr;
+
+   std::sort(baskets.begin(), baskets.end(), [](const IOPos &a, const IOPos &b) { return a.fPos < b.fPos; });
+   baskets.erase(std::unique(baskets.begin(), baskets.end(),
+                             [](const IOPos &a, const IOPos &b) { return a.fPos == b.fPos; }),
+                 baskets.end());
+
+   std::unique_ptr<StagedBaskets> staged(new StagedBaskets);
+   size_t cumulative = 0;
+   for (const auto &basket : baskets) {
+      staged->fPos.push_back(basket.fPos);
+      staged->fLen.push_back(basket.fLen);
+      staged->fIndex.push_back(cumulative);
+      cumulative += basket.fLen;
+   }
+   staged->fData.resize(cumulative);
+   staged->fEntryEnd = end;
+   if (file->ReadBuffersViaBlockCache(staged->fData.data(), staged->fPos.data(), staged->fLen.data(), (Int_t)staged->fPos.size()))
+      return nullptr;
+   return staged;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Give the cache baskets already read from its current file (see
+/// StageBaskets()).  They are used to serve the reads until the cache moves
+/// past the entries they were read for, and are not read a second time.
+
+void TTreeCache::SetStagedBaskets(std::unique_ptr<StagedBaskets> staged)
+{
+   fStaged = std::move(staged);
+}
+
 namespace {
 struct BasketRanges {
    struct Range {
@@ -1199,6 +1547,9 @@ Bool_t TTreeCache::FillBuffer()
    fEntryCurrent = entryCurrent;
    fEntryNext = entryNext;
 
+   if (fStaged && fEntryCurrent >= fStaged->fEntryEnd)
+      fStaged.reset();
+
 
    auto firstClusterEnd = fEntryNext;
    if (showMore || gDebug > 6)
@@ -1228,6 +1579,9 @@ Bool_t TTreeCache::FillBuffer()
       // Start the next cluster set.
       fCurrentClusterStart = fEntryCurrent;
       fNextClusterStart = firstClusterEnd;
+
+      if (fAutoResizeMax > 0 && !fEnablePrefetching)
+         AutoResize(fEntryCurrent, firstClusterEnd);
    }
 
    // Check if owner has a TEventList set. If yes we optimize for this
@@ -1269,6 +1623,7 @@ Bool_t TTreeCache::FillBuffer()
    Int_t prevNtot;
    Long64_t maxReadEntry = minEntry; // If we are stopped before the end of the 2nd pass, this marker will where we need to start next time.
    Int_t nReadPrefRequest = 0;
+   std::vector<std::pair<Int_t, Long64_t>> prefetched(fNbranches); // Number and bytes of baskets per branch.
    auto perfStats = GetTree()->GetPerfStats();
    do {
       prevNtot = ntotCurrentBuf;
@@ -1300,7 +1655,7 @@ Bool_t TTreeCache::FillBuffer()
       auto CollectBaskets = [this, elist, chainOffset, entry, clusterIterations, resetBranchInfo, perfStats,
        &cursor, &lowestMaxEntry, &maxReadEntry, &minEntry,
        &reachedEnd, &skippedFirst, &oncePerBranch, &nDistinctLoad, &progress,
-       &ranges, &memRanges, &reqRanges,
+       &ranges, &memRanges, &reqRanges, &prefetched,
        &ntotCurrentBuf, &nReadPrefRequest](EPass pass, ENarrow narrow, Long64_t maxCollectEntry) {
          // The first pass we add one basket per branches around the requested entry
          // then in the second pass we add the other baskets of the cluster.
@@ -1386,6 +1741,8 @@ Bool_t TTreeCache::FillBuffer()
                Int_t len = lbaskets[j];
                if (pos <= 0 || len <= 0)
                   continue;
+               if (R__unlikely(fStaged) && fStaged->Contains(pos))
+                  continue;
                if (len > fBufferSizeMin) {
                   // Do not cache a basket if it is bigger than the cache size!
                   if ((showMore || gDebug > 7) &&
@@ -1511,6 +1868,8 @@ Bool_t TTreeCache::FillBuffer()
                }
 
                ++nReadPrefRequest;
+               ++prefetched[i].first;
+               prefetched[i].second += len;
 
                reqRanges.Update(i, j, entries, nb, fEntryMax);
                if (showMore || gDebug > 6)
@@ -1705,6 +2064,13 @@ Bool_t TTreeCache::FillBuffer()
    }
 
    fNReadPref += nReadPrefRequest;
+   for (Int_t i = 0; i < fNbranches; ++i) {
+      if (!prefetched[i].first)
+         continue;
+      BranchStats &stats = GetBranchStatsFor((TBranch *)fBranches->UncheckedAt(i));
+      stats.fNPrefetched += prefetched[i].first;
+      stats.fBytesPrefetched += prefetched[i].second;
+   }
    if (fEnablePrefetching) {
       if (fIsLearning) {
          fFirstBuffer = !fFirstBuffer;
@@ -1820,6 +2186,8 @@ Int_t TTreeCache::GetLearnEntries()
 ///   see also class TTreePerfStats.
 /// - if option contains 'cachedbranches', the list of branches being
 ///   cached is printed.
+/// - if option contains 'branchstats', the bytes and number of baskets
+///   prefetched and missed for each branch are printed (see GetBranchStats()).
 
 void TTreeCache::Print(Option_t *option) const
 {
@@ -1833,6 +2201,10 @@ void TTreeCache::Print(Option_t *option) const
    printf("Secondary Efficiency ..............: %f\n", GetMissEfficiency());
    printf("Secondary Efficiency Rel ..........: %f\n", GetMissEfficiencyRel());
    printf("Learn entries......................: %d\n",TTreeCache::GetLearnEntries());
+   if (fAutoResizeMax > 0)
+      printf("Automatic resizing ................: %d times, up to %d bytes\n", fNResize, fAutoResizeMax);
+   if (fLearnOnMiss)
+      printf("Learning restarted after a miss ...: %d times\n", fNRelearn);
    if ( opt.Contains("cachedbranches") ) {
       opt.ReplaceAll("cachedbranches","");
       printf("Cached branches....................:\n");
@@ -1843,6 +2215,14 @@ void TTreeCache::Print(Option_t *option) const
          printf("Branch name........................: %s\n",branch->GetName());
       }
    }
+   if ( opt.Contains("branchstats") ) {
+      opt.ReplaceAll("branchstats","");
+      printf("%-30s %12s %10s %12s %10s\n", "Branch", "Prefetched", "Baskets", "Missed", "Baskets");
+      for (const auto &stats : fBranchStats) {
+         printf("%-30s %12lld %10d %12lld %10d\n", stats.fName.c_str(), stats.fBytesPrefetched, stats.fNPrefetched,
+                stats.fBytesMissed, stats.fNMissed);
+      }
+   }
    TFileCacheRead::Print(opt);
 }
 
@@ -1883,6 +2263,8 @@ Int_t TTreeCache::ReadBufferNormal(char *buf, Long64_t pos, Int_t len){
          fNReadOk++;
       else if (res == 0) {
          fNReadMiss++;
+         if (fMissStats || fLearnOnMiss)
+            RecordMiss(pos, len);
          auto perfStats = GetTree()->GetPerfStats();
          if (perfStats)
             recordMiss(perfStats, fBranches, bufferFilled, pos);
@@ -1891,6 +2273,8 @@ Int_t TTreeCache::ReadBufferNormal(char *buf, Long64_t pos, Int_t len){
       return res;
    }
 
+   if (fMissStats || fLearnOnMiss)
+      RecordMiss(pos, len);
    if (CheckMissCache(buf, pos, len)) {
       return 1;
    }
@@ -1930,6 +2314,8 @@ Int_t TTreeCache::ReadBufferPrefetch(char *buf, Long64_t pos, Int_t len)
       fNReadMiss++;
       counter++;
       if (counter>1) {
+        if (fMissStats || fLearnOnMiss)
+          RecordMiss(pos, len);
         return 0;
       }
    }
@@ -1953,6 +2339,12 @@ Int_t TTreeCache::ReadBuffer(char *buf, Long64_t pos, Int_t len)
 {
    if (!fEnabled) return 0;
 
+   if (R__unlikely(fStaged) && fStaged->ReadBuffer(buf, pos, len)) {
+      fFile->SetOffset(pos + len);
+      fNReadOk++;
+      return 1;
+   }
+
    if (fEnablePrefetching)
       return TTreeCache::ReadBufferPrefetch(buf, pos, len);
    else
@@ -1965,6 +2357,7 @@ Int_t TTreeCache::ReadBuffer(char *buf, Long64_t pos, Int_t len)
 void TTreeCache::ResetCache()
 {
    TFileCacheRead::Prefetch(0,0);
+   fStaged.reset();
 
    if (fEnablePrefetching) {
       fFirstTime = kTRUE;
@@ -2038,6 +2431,10 @@ void TTreeCache::SetEntryRange(Long64_t emin, Long64_t emax)
 
 void TTreeCache::SetFile(TFile *file, TFile::ECacheAction action)
 {
+   // The staged baskets, if any, belong to the previous file.
+   fStaged.reset();
+   fBasketIndexTree = nullptr;
+
    // The infinite recursion is 'broken' by the fact that
    // TFile::SetCacheRead remove the entry from fCacheReadMap _before_
    // calling SetFile (and also by setting fFile to zero before the calling).
@@ -2084,6 +2481,8 @@ void TTreeCache::StartLearningPhase()
    fIsManual = kFALSE;
    fNbranches  = 0;
    if (fBrNames) fBrNames->Delete();
+   for (auto &basket : fBasketIndex)
+      basket.second.second = kFALSE;
    fIsTransferred = kFALSE;
    fEntryCurrent = -1;
 }
@@ -2138,6 +2537,7 @@ void TTreeCache::UpdateBranches(TTree *tree)
       fEntryNext = -1;
    }
    fNbranches = 0;
+   fBasketIndexTree = nullptr;
 
    TIter next(fBrNames);
    TObjString *os;
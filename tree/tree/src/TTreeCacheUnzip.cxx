@@ -35,9 +35,22 @@ The application reading data is carefully synchronized, in order to:
 This is supposed to cancel a part of the unzipping latency, at the
 expenses of cpu time.
 
-The default parameters are the same of the prev version, i.e. 20%
-of the TTreeCache cache size. To change it use
-TTreeCache::SetUnzipBufferSize(Long64_t bufferSize)
+Several threads can read from the cache at the same time, e.g. when
+TTree::GetEntry reads the branches in parallel with implicit multi-threading:
+the baskets of the current cluster are then decompressed by background tasks
+while the branches are being read and deserialized.
+
+When it is refilled, the cache also takes the baskets of the next cluster if
+they fit in its buffer, so that they are read and unzipped in the background
+while the current cluster is being processed.
+
+The baskets are grouped in tasks of similar compressed size, a few per worker
+thread, unless a minimum group size is set with SetUnzipGroupSize.
+The memory used by the unzipped baskets waiting to be read is bounded by
+the unzip buffer size, by default 50% of the TTreeCache cache size. Baskets
+that do not fit are put aside and unzipped in the background as soon as the
+readers have picked up enough of the pending ones. To change it use
+TTreeCacheUnzip::SetUnzipBufferSize(Long64_t bufferSize)
 where bufferSize must be passed in bytes.
 */
 
@@ -58,6 +71,7 @@ where bufferSize must be passed in bytes.
 
 extern "C" void R__unzip(Int_t *nin, UChar_t *bufin, Int_t *lout, char *bufout, Int_t *nout);
 extern "C" int R__unzip_header(Int_t *nin, UChar_t *bufin, Int_t *lout);
+extern "C" unsigned int R__unzip_dict_id(Int_t nin, UChar_t *bufin);
 
 TTreeCacheUnzip::EParUnzipMode TTreeCacheUnzip::fgParallel = TTreeCacheUnzip::kDisable;
 
@@ -150,6 +164,13 @@ void TTreeCacheUnzip::UnzipState::SetFinished(Int_t index) {
    fUnzipStatus[index].store((Byte_t)kFinished);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Give the basket back to the background tasks.
+
+void TTreeCacheUnzip::UnzipState::SetUntouched(Int_t index) {
+   fUnzipStatus[index].store((Byte_t)kUntouched);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 void TTreeCacheUnzip::UnzipState::SetMissed(Int_t index) {
@@ -181,9 +202,11 @@ TTreeCacheUnzip::TTreeCacheUnzip() : TTreeCache(),
    fAsyncReading(kFALSE),
    fEmpty(kTRUE),
    fCycle(0),
+   fUnzipDone(0),
    fNseekMax(0),
    fUnzipGroupSize(0),
    fUnzipBufferSize(0),
+   fUnzipPendingBytes(0),
    fNFound(0),
    fNMissed(0),
    fNStalls(0),
@@ -200,9 +223,11 @@ TTreeCacheUnzip::TTreeCacheUnzip(TTree *tree, Int_t buffersize) : TTreeCache(tre
    fAsyncReading(kFALSE),
    fEmpty(kTRUE),
    fCycle(0),
+   fUnzipDone(0),
    fNseekMax(0),
    fUnzipGroupSize(0),
    fUnzipBufferSize(0),
+   fUnzipPendingBytes(0),
    fNFound(0),
    fNMissed(0),
    fNStalls(0),
@@ -221,10 +246,7 @@ void TTreeCacheUnzip::Init()
 #endif
    fIOMutex = new TMutex(kTRUE);
 
-   fCompBuffer = new char[16384];
-   fCompBufferSize = 16384;
-
-   fUnzipGroupSize = 102400; // Each task unzips at least 100 KB
+   fUnzipGroupSize = 0; // Automatic, see CreateTasks
 
    if (fgParallel == kDisable) {
       fParallel = kFALSE;
@@ -330,38 +352,64 @@ Bool_t TTreeCacheUnzip::FillBuffer()
    //clear cache buffer
    TFileCacheRead::Prefetch(0,0);
 
-   //store baskets
-   for (Int_t i = 0; i < fNbranches; i++) {
-      TBranch *b = (TBranch*)fBranches->UncheckedAt(i);
-      if (b->GetDirectory() == 0) continue;
-      if (b->GetDirectory()->GetFile() != fFile) continue;
-      Int_t nb = b->GetMaxBaskets();
-      Int_t *lbaskets   = b->GetBasketBytes();
-      Long64_t *entries = b->GetBasketEntry();
-      if (!lbaskets || !entries) continue;
-      //we have found the branch. We now register all its baskets
-      //from the requested offset to the basket below fEntrymax
-      Int_t blistsize = b->GetListOfBaskets()->GetSize();
-      for (Int_t j=0;j<nb;j++) {
-         // This basket has already been read, skip it
-         if (j<blistsize && b->GetListOfBaskets()->UncheckedAt(j)) continue;
-
-         Long64_t pos = b->GetBasketSeek(j);
-         Int_t len = lbaskets[j];
-         if (pos <= 0 || len <= 0) continue;
-         //important: do not try to read fEntryNext, otherwise you jump to the next autoflush
-         if (entries[j] >= fEntryNext) continue;
-         if (entries[j] < entry && (j < nb - 1 && entries[j+1] <= entry)) continue;
-         if (elist) {
-            Long64_t emax = fEntryMax;
-            if (j < nb - 1) emax = entries[j+1] - 1;
-            if (!elist->ContainsRange(entries[j] + chainOffset, emax + chainOffset)) continue;
+   // Register (or, if doPrefetch is false, only measure) the baskets of the branches
+   // that are not read yet and hold entries in [emin, emax). With nextCluster, the
+   // baskets starting before emin were already taken with the previous cluster.
+   auto registerBaskets = [&](Long64_t emin, Long64_t emax, Bool_t nextCluster, Bool_t doPrefetch) {
+      Long64_t bytes = 0;
+      for (Int_t i = 0; i < fNbranches; i++) {
+         TBranch *b = (TBranch*)fBranches->UncheckedAt(i);
+         if (b->GetDirectory() == 0) continue;
+         if (b->GetDirectory()->GetFile() != fFile) continue;
+         Int_t nb = b->GetMaxBaskets();
+         Int_t *lbaskets   = b->GetBasketBytes();
+         Long64_t *entries = b->GetBasketEntry();
+         if (!lbaskets || !entries) continue;
+         //we have found the branch. We now register all its baskets
+         //from the requested offset to the basket below emax
+         Int_t blistsize = b->GetListOfBaskets()->GetSize();
+         for (Int_t j=0;j<nb;j++) {
+            // This basket has already been read, skip it
+            if (j<blistsize && b->GetListOfBaskets()->UncheckedAt(j)) continue;
+
+            Long64_t pos = b->GetBasketSeek(j);
+            Int_t len = lbaskets[j];
+            if (pos <= 0 || len <= 0) continue;
+            //important: do not try to read emax, otherwise you jump to the next autoflush
+            if (entries[j] >= emax) continue;
+            if (nextCluster && entries[j] < emin) continue;
+            if (entries[j] < emin && (j < nb - 1 && entries[j+1] <= emin)) continue;
+            if (elist) {
+               Long64_t elmax = fEntryMax;
+               if (j < nb - 1) elmax = entries[j+1] - 1;
+               if (!elist->ContainsRange(entries[j] + chainOffset, elmax + chainOffset)) continue;
+            }
+            bytes += len;
+            if (!doPrefetch) continue;
+            fNReadPref++;
+
+            TFileCacheRead::Prefetch(pos, len);
          }
-         fNReadPref++;
+         if (doPrefetch && gDebug > 0) printf("Entry: %lld, registering baskets branch %s, fEntryNext=%lld, fNseek=%d, fNtot=%d\n", emin, b->GetName(), emax, fNseek, fNtot);
+      }
+      return bytes;
+   };
 
-         TFileCacheRead::Prefetch(pos, len);
+   //store baskets
+   registerBaskets(entry, fEntryNext, kFALSE, kTRUE);
+
+   // Also take the baskets of the next cluster if they fit in the buffer: the background
+   // tasks then unzip them while the current cluster is being read, and reaching them
+   // does not require another read of the file.
+   if (fEntryNext < fEntryMax) {
+      TTree::TClusterIterator nextIter = tree->GetClusterIterator(fEntryNext);
+      nextIter();
+      Long64_t nextEnd = nextIter.GetNextEntry();
+      if (nextEnd > fEntryMax) nextEnd = fEntryMax;
+      if (nextEnd > fEntryNext && fNtot + registerBaskets(fEntryNext, nextEnd, kTRUE, kFALSE) <= fBufferSizeMin) {
+         registerBaskets(fEntryNext, nextEnd, kTRUE, kTRUE);
+         fEntryNext = nextEnd;
       }
-      if (gDebug > 0) printf("Entry: %lld, registering baskets branch %s, fEntryNext=%lld, fNseek=%d, fNtot=%d\n", entry, ((TBranch*)fBranches->UncheckedAt(i))->GetName(), fEntryNext, fNseek, fNtot);
    }
 
    // Now fix the size of the status arrays
@@ -525,6 +573,8 @@ void TTreeCacheUnzip::ResetCache()
    // Reset all the lists and wipe all the chunks
    fCycle++;
    fUnzipState.Clear(fNseekMax);
+   fUnzipPendingBytes = 0;
+   fUnzipDeferred.clear();
 
    if(fNseekMax < fNseek){
       if (gDebug > 0)
@@ -534,6 +584,22 @@ void TTreeCacheUnzip::ResetCache()
       fNseekMax = fNseek;
    }
    fEmpty = kTRUE;
+
+   // Wake up the readers waiting for a block of the previous content
+   NotifyUnzipDone();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Wake up the readers waiting in GetUnzipBuffer for a block being unzipped by
+/// a background task. Called each time a task is done with a block.
+
+void TTreeCacheUnzip::NotifyUnzipDone()
+{
+   {
+      std::lock_guard<std::mutex> lock(fUnzipDoneMutex);
+      ++fUnzipDone;
+   }
+   fUnzipDoneCondition.notify_all();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -563,6 +629,7 @@ Int_t TTreeCacheUnzip::UnzipCache(Int_t index)
 
    Int_t loc = -1;
    if (!fNseek || fIsLearning) {
+      if (index < fNseekMax) fUnzipState.SetFinished(index); // Do not leave it in progress, main thread will take charge
       return 1;
    }
 
@@ -571,16 +638,21 @@ Int_t TTreeCacheUnzip::UnzipCache(Int_t index)
       return 1;
    }
 
-   // Prepare a memory buffer of adequate size
-   char* locbuff = 0;
-   if (rdlen > 16384) {
-      locbuff = new char[rdlen];
-   } else if (rdlen * 3 < 16384) {
-      locbuff = new char[rdlen * 2];
-   } else {
-      locbuff = new char[16384];
+   // Do not run ahead of the readers by more than fUnzipBufferSize bytes: put the block aside, it is
+   // unzipped once the readers have picked up enough of the pending ones (or by a reader that needs it first)
+   if (fUnzipBufferSize > 0 && fUnzipPendingBytes >= fUnzipBufferSize) {
+      R__LOCKGUARD(fIOMutex);
+      if (myCycle != fCycle) {
+         fUnzipState.SetFinished(index);
+      } else {
+         fUnzipState.SetUntouched(index);
+         fUnzipDeferred.push_back(index);
+      }
+      return 0;
    }
 
+   char *locbuff = new char[rdlen];
+
    readbuf = ReadBufferExt(locbuff, rdoffs, rdlen, loc);
 
    if (readbuf <= 0) {
@@ -614,6 +686,7 @@ Int_t TTreeCacheUnzip::UnzipCache(Int_t index)
          if (locbuff) delete [] locbuff;
          return 1;
       }
+      fUnzipPendingBytes += loclen;
       fUnzipState.SetUnzipped(index, ptr, loclen); // Set it as done
       fNUnzip++;
    } else {
@@ -626,9 +699,12 @@ Int_t TTreeCacheUnzip::UnzipCache(Int_t index)
 
 #ifdef R__USE_IMT
 ////////////////////////////////////////////////////////////////////////////////
-/// We create a TTaskGroup and asynchronously maps each group of baskets(> 100 kB in total)
-/// to a task. In TTaskGroup, we use TThreadExecutor to do the actually work of unzipping 
+/// We create a TTaskGroup and asynchronously maps each group of baskets to a task.
+/// In TTaskGroup, we use TThreadExecutor to do the actually work of unzipping
 /// a group of basket. The purpose of creating TTaskGroup is to avoid competing with main thread.
+///
+/// Unless a minimum group size was set with SetUnzipGroupSize, the baskets in the cache are
+/// split in about four groups of similar compressed size per worker thread, each of at least 10 KB.
 
 Int_t TTreeCacheUnzip::CreateTasks()
 {
@@ -640,6 +716,7 @@ Int_t TTreeCacheUnzip::CreateTasks()
          for (auto ii : indices) {
             if(fUnzipState.TryUnzipping(ii)) {
                Int_t res = UnzipCache(ii);
+               NotifyUnzipDone();
                if(res)
                   if (gDebug > 0)
                      Info("UnzipCache", "Unzipping failed or cache is in learning state");
@@ -648,23 +725,32 @@ Int_t TTreeCacheUnzip::CreateTasks()
          return nullptr;
       };
 
-      Int_t accusz = 0;
+      ROOT::TThreadExecutor pool;
+
+      Long64_t groupSize = fUnzipGroupSize;
+      if (groupSize <= 0) {
+         Long64_t totSize = 0;
+         for (Int_t i = 0; i < fNseek; i++)
+            totSize += fSeekLen[i];
+         const Long64_t nGroups = 4 * std::max(1u, pool.GetPoolSize());
+         groupSize = std::max(10240LL, totSize / nGroups);
+      }
+
       std::vector<std::vector<Int_t>> basketIndices;
       std::vector<Int_t> indices;
-      if (fUnzipGroupSize <= 0) fUnzipGroupSize = 102400;
+      Long64_t accusz = 0;
       for (Int_t i = 0; i < fNseek; i++) {
-         while (accusz < fUnzipGroupSize) {
-            accusz += fSeekLen[i];
-            indices.push_back(i);
-            i++;
-            if (i >= fNseek) break;
+         accusz += fSeekLen[i];
+         indices.push_back(i);
+         if (accusz >= groupSize) {
+            basketIndices.push_back(std::move(indices));
+            indices.clear();
+            accusz = 0;
          }
-         if (i < fNseek) i--;
-         basketIndices.push_back(indices);
-         indices.clear();
-         accusz = 0;
       }
-      ROOT::TThreadExecutor pool;
+      if (!indices.empty())
+         basketIndices.push_back(std::move(indices));
+
       pool.Foreach(unzipFunction, basketIndices);
    };
 
@@ -673,6 +759,29 @@ Int_t TTreeCacheUnzip::CreateTasks()
 
    return 0;
 }
+
+////////////////////////////////////////////////////////////////////////////////
+/// Unzip in a background task the blocks that were put aside because the unzip
+/// buffer was full, unless the cache was refilled since then.
+
+void TTreeCacheUnzip::ResumeUnzipping(const std::vector<Int_t> &indices, Int_t cycle)
+{
+   std::lock_guard<std::mutex> taskGroupLock(fTaskGroupMutex);
+   if (!fUnzipTaskGroup) return;
+   {
+      R__LOCKGUARD(fIOMutex);
+      if (cycle != fCycle) return;
+   }
+   fUnzipTaskGroup->Run([this, indices, cycle]() {
+      for (auto ii : indices) {
+         if (!fIsTransferred || cycle != fCycle) return;
+         if (fUnzipState.TryUnzipping(ii)) {
+            UnzipCache(ii);
+            NotifyUnzipDone();
+         }
+      }
+   });
+}
 #endif
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -684,11 +793,15 @@ Int_t TTreeCacheUnzip::CreateTasks()
 /// Note!! : If *buf == 0 we will allocate the buffer and it will be the
 /// responsability of the caller to free it... it is useful for example
 /// to pass it to the creator of TBuffer
+///
+/// This method can be called concurrently by several threads, e.g. when
+/// TTree::GetEntry reads branches in parallel: the unzipping state is only
+/// accessed under fIOMutex, and the lock is released while waiting (on
+/// fUnzipDoneCondition) for a block that is being unzipped by a background task.
 
 Int_t TTreeCacheUnzip::GetUnzipBuffer(char **buf, Long64_t pos, Int_t len, Bool_t *free)
 {
    Int_t res = 0;
-   Int_t loc = -1;
 
    // We go straight to TTreeCache/TfileCacheRead, in order to get the info we need
    //  pointer to the original zipped chunk
@@ -699,117 +812,168 @@ Int_t TTreeCacheUnzip::GetUnzipBuffer(char **buf, Long64_t pos, Int_t len, Bool_
    // Also, here we prefer not to trigger the (re)population of the chunks in the TFileCacheRead. That is
    // better to be done in the main thread.
 
-   Int_t myCycle = fCycle;
+   // Hand over the unzipped block at seekidx to the caller. Must be called with fIOMutex held.
+   auto takeUnzipped = [&](Int_t seekidx) {
+      const Int_t unzipLen = fUnzipState.fUnzipLen[seekidx];
+      if(!(*buf)) {
+         *buf = fUnzipState.fUnzipChunks[seekidx].get();
+         fUnzipState.fUnzipChunks[seekidx].release();
+         *free = kTRUE;
+      } else {
+         memcpy(*buf, fUnzipState.fUnzipChunks[seekidx].get(), unzipLen);
+         fUnzipState.fUnzipChunks[seekidx].reset();
+         *free = kFALSE;
+      }
+      fUnzipState.fUnzipLen[seekidx] = 0;
+      fUnzipPendingBytes -= unzipLen;
+      return unzipLen;
+   };
+
+   // Blocks put aside by the background tasks, to be resumed once a block was picked up
+   std::vector<Int_t> resume;
+
+   // Whether the block is not part of the current content of the cache, which is then going to be refilled
+   Bool_t refill = kFALSE;
+   Int_t oldCycle = 0;
 
    if (fParallel && !fIsLearning) {
 
-      if(fNseekMax < fNseek){
-         if (gDebug > 0)
-            Info("GetUnzipBuffer", "Changing fNseekMax from:%d to:%d", fNseekMax, fNseek);
+      Int_t seekidx = -1;
+      Int_t myCycle = 0;
+      Bool_t stalled = kFALSE;
+      Int_t found = -1;
 
-         fUnzipState.Reset(fNseekMax, fNseek);
-         fNseekMax = fNseek;
-      }
+      while (kTRUE) {
+         Long64_t done = 0;
+         {
+            R__LOCKGUARD(fIOMutex);
 
-      loc = (Int_t)TMath::BinarySearch(fNseek, fSeekSort, pos);
-      if ((fCycle == myCycle) && (loc >= 0) && (loc < fNseek) && (pos == fSeekSort[loc])) {
+            // Taken before looking at the block, so that no signal sent after that is missed
+            {
+               std::lock_guard<std::mutex> doneLock(fUnzipDoneMutex);
+               done = fUnzipDone;
+            }
 
-         // The buffer is, at minimum, in the file cache. We must know its index in the requests list
-         // In order to get its info
-         Int_t seekidx = fSeekIndex[loc];
+            if (seekidx < 0) {
+               if(fNseekMax < fNseek){
+                  if (gDebug > 0)
+                     Info("GetUnzipBuffer", "Changing fNseekMax from:%d to:%d", fNseekMax, fNseek);
 
-         do {
+                  fUnzipState.Reset(fNseekMax, fNseek);
+                  fNseekMax = fNseek;
+               }
+
+               Int_t loc = (Int_t)TMath::BinarySearch(fNseek, fSeekSort, pos);
+               if (loc < 0 || loc >= fNseek || pos != fSeekSort[loc]) {
+                  fIsTransferred = kFALSE;
+                  refill = kTRUE;
+                  oldCycle = fCycle;
+                  break;
+               }
+
+               // The buffer is, at minimum, in the file cache. We must know its index in the requests list
+               // In order to get its info
+               seekidx = fSeekIndex[loc];
+               myCycle = fCycle;
+            } else if (myCycle != fCycle) {
+               // The cache was refilled by another thread while we were waiting
+               if (gDebug > 0)
+                  Info("GetUnzipBuffer", "Sudden paging Break!!! fNseek: %d, fIsLearning:%d", fNseek, fIsLearning);
+               break;
+            }
 
             // If the block is ready we get it immediately.
-            // And also we don't have to alloc the blks. This is supposed to be
-            // the main thread of the app.
             if (fUnzipState.IsUnzipped(seekidx)) {
-               if(!(*buf)) {
-                  *buf = fUnzipState.fUnzipChunks[seekidx].get();
-                  fUnzipState.fUnzipChunks[seekidx].release();
-                  *free = kTRUE;
-               } else {
-                  memcpy(*buf, fUnzipState.fUnzipChunks[seekidx].get(), fUnzipState.fUnzipLen[seekidx]);
-                  fUnzipState.fUnzipChunks[seekidx].reset();
-                  *free = kFALSE;
-               }
+               if (stalled)
+                  fNStalls++;
+               else
+                  fNFound++;
+               found = takeUnzipped(seekidx);
+               if (!fUnzipDeferred.empty() && fUnzipPendingBytes < fUnzipBufferSize)
+                  resume.swap(fUnzipDeferred);
+               break;
+            }
 
-               fNFound++;
-               return fUnzipState.fUnzipLen[seekidx];
+            if (!fUnzipState.IsProgress(seekidx)) {
+               // This is a complete miss. We want to avoid the background tasks
+               // to try unzipping this block in the future.
+               fUnzipState.SetMissed(seekidx);
+               break;
             }
 
-            // If the requested basket is being unzipped by a background task, we try to steal a blk to unzip.
+            // The requested basket is being unzipped by a background task, we try to steal a blk to unzip
+            // unless that would exceed the unzip buffer.
+            stalled = kTRUE;
             Int_t reqi = -1;
-            
-            if (fUnzipState.IsProgress(seekidx)) {
-               if (fEmpty) {
-                  for (Int_t ii = 0; ii < fNseek; ++ii) {
-                     Int_t idx = (seekidx + 1 + ii) % fNseek;
-                     if (fUnzipState.IsUntouched(idx)) {
-                        if(fUnzipState.TryUnzipping(idx)) {
-                           reqi = idx;
-                           break;
-                        }
+            if (fEmpty && (fUnzipBufferSize <= 0 || fUnzipPendingBytes < fUnzipBufferSize)) {
+               for (Int_t ii = 0; ii < fNseek; ++ii) {
+                  Int_t idx = (seekidx + 1 + ii) % fNseek;
+                  if (fUnzipState.IsUntouched(idx)) {
+                     if(fUnzipState.TryUnzipping(idx)) {
+                        reqi = idx;
+                        break;
                      }
                   }
-                  if (reqi < 0) {
-                     fEmpty = kFALSE;
-                  } else {
-                     UnzipCache(reqi);
-                  }
                }
- 
-               if ( myCycle != fCycle ) {
-                  if (gDebug > 0)
-                     Info("GetUnzipBuffer", "Sudden paging Break!!! fNseek: %d, fIsLearning:%d",
-                          fNseek, fIsLearning);
-
-                  seekidx = -1;
-                  break;
+               if (reqi < 0) {
+                  fEmpty = kFALSE;
+               } else {
+                  UnzipCache(reqi);
+                  NotifyUnzipDone();
+                  continue;
                }
             }
+         } // end of lock scope
 
-         } while (fUnzipState.IsProgress(seekidx));
-
-         // Here the block is not pending. It could be done or aborted or not yet being processed.
-         if ( (seekidx >= 0) && (fUnzipState.IsUnzipped(seekidx)) ) {
-            if(!(*buf)) {
-              *buf = fUnzipState.fUnzipChunks[seekidx].get();
-               fUnzipState.fUnzipChunks[seekidx].release();
-               *free = kTRUE;
-            } else {
-               memcpy(*buf, fUnzipState.fUnzipChunks[seekidx].get(), fUnzipState.fUnzipLen[seekidx]);
-               fUnzipState.fUnzipChunks[seekidx].reset();
-               *free = kFALSE;
-            }
+         // Sleep until a background task is done with a block or the cache is reset
+         std::unique_lock<std::mutex> doneLock(fUnzipDoneMutex);
+         fUnzipDoneCondition.wait(doneLock, [&]() { return fUnzipDone != done; });
+      }
 
-            fNStalls++;
-            return fUnzipState.fUnzipLen[seekidx];
-         } else {
-            // This is a complete miss. We want to avoid the background tasks
-            // to try unzipping this block in the future.
-            fUnzipState.SetMissed(seekidx);
-         }
-      } else {
-         loc = -1;
-         fIsTransferred = kFALSE;
+      if (found >= 0) {
+#ifdef R__USE_IMT
+         if (!resume.empty())
+            ResumeUnzipping(resume, myCycle);
+#endif
+         return found;
       }
    }
 
-   if (len > fCompBufferSize) {
-      if(fCompBuffer) delete [] fCompBuffer;
-      fCompBuffer = new char[len];
-      fCompBufferSize = len;
-   } else {
-      if (fCompBufferSize > len * 4) {
-         if(fCompBuffer) delete [] fCompBuffer;
-         fCompBuffer = new char[len*2];
-         fCompBufferSize = len * 2;
+   // Read and unzip the block ourselves. Several threads can get here at the same time,
+   // so the compressed data goes to a buffer owned by this call.
+   std::unique_ptr<char[]> compBuffer(new char[len]);
+   Int_t loc = -1;
+#ifdef R__USE_IMT
+   if (refill) {
+      // The tasks unzipping the current content of the cache must be done before it is replaced
+      std::lock_guard<std::mutex> taskGroupLock(fTaskGroupMutex);
+      if(fUnzipTaskGroup) {
+         fUnzipTaskGroup->Cancel();
+         fUnzipTaskGroup.reset();
       }
    }
-
-   res = 0;
-   if (!ReadBufferExt(fCompBuffer, pos, len, loc)) {
+#endif
+   if (ReadBufferExt(compBuffer.get(), pos, len, loc)) {
+#ifdef R__USE_IMT
+      // If the cache was refilled with the next cluster, start unzipping its baskets in the background
+      // while this block and the next ones are read
+      if (refill) {
+         std::lock_guard<std::mutex> taskGroupLock(fTaskGroupMutex);
+         Bool_t refilled = kFALSE;
+         {
+            R__LOCKGUARD(fIOMutex);
+            refilled = fCycle != oldCycle;
+            // This block is unzipped right below, keep the background tasks away from it
+            Int_t l = (Int_t)TMath::BinarySearch(fNseek, fSeekSort, pos);
+            if (refilled && l >= 0 && l < fNseek && pos == fSeekSort[l] && fSeekIndex[l] < fNseekMax)
+               fUnzipState.SetMissed(fSeekIndex[l]);
+         }
+         if (refilled && !fUnzipTaskGroup)
+            CreateTasks();
+      }
+#endif
+   } else {
+      std::lock_guard<std::mutex> taskGroupLock(fTaskGroupMutex);
       // Cache is invalidated and we need to wait for all unzipping tasks to befinished before fill new baskets in cache.
 #ifdef R__USE_IMT
       if(fUnzipTaskGroup) {
@@ -820,8 +984,8 @@ Int_t TTreeCacheUnzip::GetUnzipBuffer(char **buf, Long64_t pos, Int_t len, Bool_
       {
          // Fill new baskets into cache.
          R__LOCKGUARD(fIOMutex);
-	 fFile->Seek(pos);
-	 res = fFile->ReadBuffer(fCompBuffer, len);
+         fFile->Seek(pos);
+         res = fFile->ReadBuffer(compBuffer.get(), len);
       } // end of lock scope
 #ifdef R__USE_IMT
       CreateTasks();
@@ -831,14 +995,14 @@ Int_t TTreeCacheUnzip::GetUnzipBuffer(char **buf, Long64_t pos, Int_t len, Bool_
    if (res) res = -1;
 
    if (!res) {
-      res = UnzipBuffer(buf, fCompBuffer);
+      res = UnzipBuffer(buf, compBuffer.get());
       *free = kTRUE;
    }
 
    if (!fIsLearning) {
       fNMissed++;
    }
-   
+
    return res;
 }
 
@@ -929,6 +1093,13 @@ Int_t TTreeCacheUnzip::UnzipBuffer(char **dest, char *src)
             return uzlen;
          }
 
+         // Baskets compressed against a dictionary are left to TBasket, which knows their branch.
+         if (R__unzip_dict_id(nin, bufcur)) {
+            if (alloc) delete [] *dest;
+            *dest = 0;
+            return -1;
+         }
+
          R__unzip(&nin, bufcur, &nbuf, objbuf, &nout);
 
          if (gDebug > 2)
@@ -966,10 +1137,10 @@ void  TTreeCacheUnzip::Print(Option_t* option) const {
 
    printf("******TreeCacheUnzip statistics for file: %s ******\n",fFile->GetName());
    printf("Max allowed mem for pending buffers: %lld\n", fUnzipBufferSize);
-   printf("Number of blocks unzipped by threads: %d\n", fNUnzip);
-   printf("Number of hits: %d\n", fNFound);
-   printf("Number of stalls: %d\n", fNStalls);
-   printf("Number of misses: %d\n", fNMissed);
+   printf("Number of blocks unzipped by threads: %d\n", fNUnzip.load());
+   printf("Number of hits: %d\n", fNFound.load());
+   printf("Number of stalls: %d\n", fNStalls.load());
+   printf("Number of misses: %d\n", fNMissed.load());
 
    TTreeCache::Print(option);
 }
@@ -21,6 +21,7 @@ Class implementing or helping  the various TTree cloning method
 #include "TBranchElement.h"
 #include "TStreamerInfo.h"
 #include "TBranchRef.h"
+#include "TCompressionDict.h"
 #include "TError.h"
 #include "TProcessID.h"
 #include "TMath.h"
@@ -36,6 +37,21 @@ Class implementing or helping  the various TTree cloning method
 #include "TFileCacheRead.h"
 
 #include <algorithm>
+#include <future>
+#include <vector>
+
+namespace {
+
+/// Raw content of consecutive baskets, in the order they are written, read
+/// ahead by TTreeCloner::WriteBasketsParallelRead.
+struct TBasketChunk {
+   UInt_t              fEnd = 0;   ///< One past the last basket of the chunk
+   std::vector<char>   fBuffer;    ///< Content of the baskets stored in a file, one after the other
+   std::vector<Int_t>  fLength;    ///< Length in fBuffer of each basket: 0 if it is in memory, -1 if it could not be read
+   std::vector<TFile*> fFile;      ///< File each basket was read from
+};
+
+}
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -60,6 +76,19 @@ Bool_t TTreeCloner::CompareEntry::operator()(UInt_t i1, UInt_t i2)
    return  fObject->fBasketEntry[i1] <  fObject->fBasketEntry[i2];
 }
 
+////////////////////////////////////////////////////////////////////////////////
+
+Bool_t TTreeCloner::CompareCluster::operator()(UInt_t i1, UInt_t i2)
+{
+   if (fObject->fBasketCluster[i1] == fObject->fBasketCluster[i2]) {
+      if (fObject->fBasketBranchNum[i1] == fObject->fBasketBranchNum[i2]) {
+         return fObject->fBasketNum[i1] < fObject->fBasketNum[i2];
+      }
+      return fObject->fBasketBranchNum[i1] < fObject->fBasketBranchNum[i2];
+   }
+   return fObject->fBasketCluster[i1] < fObject->fBasketCluster[i2];
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Constructor.  This object would transfer the data from
 /// 'from' to 'to' using the method indicated in method.
@@ -73,11 +102,12 @@ Bool_t TTreeCloner::CompareEntry::operator()(UInt_t i1, UInt_t i2)
 /// of branches that contain 'large' data chunk are written to
 /// the disk more often.
 ///
-/// There is currently 3 supported sorting order:
+/// There is currently 4 supported sorting order:
 ///
 ///     SortBasketsByOffset (the default)
 ///     SortBasketsByBranch
 ///     SortBasketsByEntry
+///     SortBasketsByCluster
 ///
 /// When using SortBasketsByOffset the baskets are written in
 /// the output file in the same order as in the original file
@@ -99,6 +129,13 @@ Bool_t TTreeCloner::CompareEntry::operator()(UInt_t i1, UInt_t i2)
 /// This means that on the file the baskets will be in the order
 /// in which they will be needed when reading the whole tree
 /// sequentially.
+///
+/// When using SortBasketsByCluster the baskets are grouped by the
+/// cluster (see TTree::SetAutoFlush) containing their first entry and,
+/// within a cluster, ordered by branch.  All the baskets needed to read
+/// a cluster are then contiguous in the output file and can be fetched
+/// with a single read, even if the input file had them scattered (for
+/// example when it was produced by TBufferMerger).
 
 TTreeCloner::TTreeCloner(TTree *from, TTree *to, Option_t *method, UInt_t options) :
    fWarningMsg(),
@@ -116,12 +153,14 @@ TTreeCloner::TTreeCloner(TTree *from, TTree *to, Option_t *method, UInt_t option
    fBasketSeek(new Long64_t[fMaxBaskets]),
    fBasketEntry(new Long64_t[fMaxBaskets]),
    fBasketIndex(new UInt_t[fMaxBaskets]),
+   fBasketCluster(nullptr),
    fPidOffset(0),
    fCloneMethod(TTreeCloner::kDefault),
    fToStartEntries(0),
    fCacheSize(0LL),
    fFileCache(nullptr),
-   fPrevCache(nullptr)
+   fPrevCache(nullptr),
+   fParallelRead(kFALSE)
 {
    TString opt(method);
    opt.ToLower();
@@ -131,10 +170,14 @@ TTreeCloner::TTreeCloner(TTree *from, TTree *to, Option_t *method, UInt_t option
    } else if (opt.Contains("sortbasketsbyentry")) {
       //::Info("TTreeCloner::TTreeCloner","use: kSortBasketsByEntry");
       fCloneMethod = TTreeCloner::kSortBasketsByEntry;
+   } else if (opt.Contains("sortbasketsbycluster")) {
+      //::Info("TTreeCloner::TTreeCloner","use: kSortBasketsByCluster");
+      fCloneMethod = TTreeCloner::kSortBasketsByCluster;
    } else {
       //::Info("TTreeCloner::TTreeCloner","use: kSortBasketsByOffset");
       fCloneMethod = TTreeCloner::kSortBasketsByOffset;
    }
+   fParallelRead = opt.Contains("parallelread");
    if (fToTree) fToStartEntries = fToTree->GetEntries();
 
    if (fFromTree == nullptr) {
@@ -200,6 +243,7 @@ Bool_t TTreeCloner::Exec()
    ImportClusterRanges();
    CopyStreamerInfos();
    CopyProcessIds();
+   CopyCompressionDicts();
    CloseOutWriteBaskets();
    CollectBaskets();
    SortBaskets();
@@ -223,6 +267,7 @@ TTreeCloner::~TTreeCloner()
    delete [] fBasketSeek;
    delete [] fBasketEntry;
    delete [] fBasketIndex;
+   delete [] fBasketCluster;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -474,6 +519,28 @@ void TTreeCloner::CopyStreamerInfos()
    delete l;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Make sure that the compression dictionaries needed by the copied
+/// baskets are present in the output file
+
+void TTreeCloner::CopyCompressionDicts()
+{
+   TFile *fromfile = fFromTree->GetDirectory()->GetFile();
+   TFile *tofile = fToTree->GetDirectory()->GetFile();
+
+   TIter next(fromfile->GetListOfKeys());
+   TKey *key;
+   while ((key = (TKey*)next())) {
+      if (strcmp(key->GetClassName(),"TCompressionDict") || tofile->GetKey(key->GetName())) {
+         continue;
+      }
+      TCompressionDict *dict = (TCompressionDict*)key->ReadObjectAny(TCompressionDict::Class());
+      if (!dict) continue;
+      tofile->WriteTObject(dict, key->GetName());
+      delete dict;
+   }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Transfer the basket from the input file to the output file
 
@@ -642,6 +709,22 @@ void TTreeCloner::SortBaskets()
          std::sort(fBasketIndex, fBasketIndex+fMaxBaskets, CompareEntry( this) );
          break;
       }
+      case kSortBasketsByCluster: {
+         // Find the start entry of each cluster of the input tree.
+         std::vector<Long64_t> clusterStarts;
+         TTree::TClusterIterator clusterIter = fFromTree->GetClusterIterator(0);
+         Long64_t start;
+         while ((start = clusterIter()) < fFromTree->GetEntries()) {
+            clusterStarts.push_back(start);
+         }
+         if (!fBasketCluster) fBasketCluster = new Long64_t[fMaxBaskets];
+         for(UInt_t i = 0; i < fMaxBaskets; ++i) {
+            fBasketIndex[i] = i;
+            fBasketCluster[i] = std::upper_bound(clusterStarts.begin(), clusterStarts.end(), fBasketEntry[i]) - clusterStarts.begin();
+         }
+         std::sort(fBasketIndex, fBasketIndex+fMaxBaskets, CompareCluster( this) );
+         break;
+      }
       case kSortBasketsByOffset:
       default: {
          for(UInt_t i = 0; i < fMaxBaskets; ++i) { fBasketIndex[i] = i; }
@@ -685,6 +768,10 @@ UInt_t TTreeCloner::FillCache(UInt_t from)
 
 void TTreeCloner::WriteBaskets()
 {
+   if (fParallelRead && fFileCache) {
+      WriteBasketsParallelRead();
+      return;
+   }
    TBasket *basket = new TBasket();
    for(UInt_t j = 0, notCached = 0; j<fMaxBaskets; ++j) {
       TBranch *from = (TBranch*)fFromBranches.UncheckedAt( fBasketBranchNum[ fBasketIndex[j] ] );
@@ -721,3 +808,81 @@ void TTreeCloner::WriteBaskets()
    }
    delete basket;
 }
+
+////////////////////////////////////////////////////////////////////////////////
+/// Same as WriteBaskets, but the baskets are read by a separate task, one
+/// file cache worth of baskets at a time: while the calling thread writes the
+/// baskets of a chunk to the output file, in order, the task reads the next
+/// chunk.  The input files are only accessed by the task and the output file
+/// only by the calling thread.
+
+void TTreeCloner::WriteBasketsParallelRead()
+{
+   if (fMaxBaskets == 0) return;
+
+   auto readChunk = [this](UInt_t first) {
+      TBasketChunk chunk;
+      // A basket larger than the cache is read on its own.
+      chunk.fEnd = TMath::Max(FillCache(first), first + 1);
+      chunk.fLength.resize(chunk.fEnd - first, 0);
+      chunk.fFile.resize(chunk.fEnd - first, nullptr);
+      TBasket basket;
+      for (UInt_t j = first; j < chunk.fEnd; ++j) {
+         TBranch *from = (TBranch*)fFromBranches.UncheckedAt( fBasketBranchNum[ fBasketIndex[j] ] );
+         Int_t index = fBasketNum[ fBasketIndex[j] ];
+         Long64_t pos = from->GetBasketSeek(index);
+         if (pos == 0) continue;
+         TFile *fromfile = from->GetFile(0);
+         if (from->GetBasketBytes()[index] == 0) {
+            from->GetBasketBytes()[index] = basket.ReadBasketBytes(pos, fromfile);
+         }
+         Int_t len = from->GetBasketBytes()[index];
+         chunk.fFile[j - first] = fromfile;
+         if (basket.LoadBasketBuffers(pos, len, fromfile, fFromTree)) {
+            Error("TTreeCloner::WriteBaskets", "Could not read basket %d of branch %s from %s", index, from->GetName(),
+                  fromfile->GetName());
+            chunk.fLength[j - first] = -1;
+            continue;
+         }
+         chunk.fBuffer.insert(chunk.fBuffer.end(), basket.GetBufferRef()->Buffer(), basket.GetBufferRef()->Buffer() + len);
+         chunk.fLength[j - first] = len;
+      }
+      return chunk;
+   };
+
+   TBasket *basket = new TBasket();
+   std::future<TBasketChunk> next = std::async(std::launch::async, readChunk, 0u);
+   for (UInt_t first = 0; first < fMaxBaskets; ) {
+      TBasketChunk chunk = next.get();
+      const UInt_t end = chunk.fEnd;
+      if (end < fMaxBaskets) {
+         next = std::async(std::launch::async, readChunk, end);
+      }
+      const char *buffer = chunk.fBuffer.data();
+      for (UInt_t j = first; j < end; ++j) {
+         TBranch *from = (TBranch*)fFromBranches.UncheckedAt( fBasketBranchNum[ fBasketIndex[j] ] );
+         TBranch *to   = (TBranch*)fToBranches.UncheckedAt( fBasketBranchNum[ fBasketIndex[j] ] );
+         Int_t index = fBasketNum[ fBasketIndex[j] ];
+         Int_t len = chunk.fLength[j - first];
+
+         if (len > 0) {
+            TFile *tofile = to->GetFile(0);
+            basket->LoadBasketBuffers(buffer, len, chunk.fFile[j - first]);
+            buffer += len;
+            basket->IncrementPidOffset(fPidOffset);
+            basket->CopyTo(tofile);
+            to->AddBasket(*basket,kTRUE,fToStartEntries + from->GetBasketEntry()[index]);
+         } else if (len == 0) {
+            TBasket *frombasket = from->GetBasket( index );
+            if (frombasket && frombasket->GetNevBuf()>0) {
+               TBasket *tobasket = (TBasket*)frombasket->Clone();
+               tobasket->SetBranch(to);
+               to->AddBasket(*tobasket, kFALSE, fToStartEntries+from->GetBasketEntry()[index]);
+               to->FlushOneBasket(to->GetWriteBasket());
+            }
+         }
+      }
+      first = end;
+   }
+   delete basket;
+}
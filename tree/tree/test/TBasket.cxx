@@ -4,6 +4,7 @@
 #include "TBranch.h"
 #include "TEnum.h"
 #include "TEnumConstant.h"
+#include "TKey.h"
 #include "TMemFile.h"
 #include "TTree.h"
 
@@ -403,3 +404,48 @@ TEST(TBasket, TestSettingIOBits)
    readEntryOffset = reinterpret_cast<Bool_t *>(reinterpret_cast<char *>(basket2) + offset);
    EXPECT_EQ(*readEntryOffset, kTRUE);
 }
+
+#ifdef R__HAS_ZSTD
+// Write many small baskets compressed against a trained dictionary and read them back.
+TEST(TBasket, CompressionDictionary)
+{
+   const Int_t nEvents = 20000;
+   std::vector<char> memBuffer;
+   {
+      TMemFile f("tbasket_dict.root", "CREATE");
+      TTree t1("t1", "Tree with small baskets.");
+      Int_t flag;
+      t1.Branch("flag", &flag, "flag/I");
+      t1.SetBasketSize("*", 1000);
+      t1.SetCompressionDictionaryTraining("*", 10, 4096);
+      for (Int_t idx = 0; idx < nEvents; idx++) {
+         flag = (idx * 7) % 5 ? 0 : (idx % 13);
+         t1.Fill();
+      }
+      t1.Write();
+
+      TKey *dictKey = nullptr;
+      for (auto key : ROOT::Detail::TRangeStaticCast<TKey>(*f.GetListOfKeys())) {
+         if (!strcmp(key->GetClassName(), "TCompressionDict"))
+            dictKey = key;
+      }
+      EXPECT_NE(dictKey, nullptr);
+      f.Close();
+
+      memBuffer.resize(f.GetSize());
+      f.CopyTo(&memBuffer[0], f.GetSize());
+   }
+
+   TMemFile f2("tbasket_dict.root", &memBuffer[0], memBuffer.size(), "READ");
+   TTree *tree = nullptr;
+   f2.GetObject("t1", tree);
+   ASSERT_NE(tree, nullptr);
+   Int_t flag;
+   tree->SetBranchAddress("flag", &flag);
+   ASSERT_EQ(tree->GetEntries(), nEvents);
+   for (Int_t idx = 0; idx < nEvents; idx++) {
+      ASSERT_GT(tree->GetEntry(idx), 0);
+      EXPECT_EQ(flag, (idx * 7) % 5 ? 0 : (idx % 13));
+   }
+}
+#endif
@@ -1,7 +1,14 @@
+#include "ROOT/TIOFeatures.hxx"
+#include "TBufferFile.h"
 #include "TFile.h"
+#include "TMemFile.h"
 #include "TTree.h"
 #include "TBranch.h"
 #include "TRandom.h"
+#include "TSystem.h"
+#include "Bytes.h"
+
+#include <cstring>
 
 #include "gtest/gtest.h"
 
@@ -178,3 +185,168 @@ TEST_F(TBranchTest, twoPreviousTest)
    ASSERT_TRUE(branch->GetListOfBaskets()->At(7));
    delete file;
 }
+
+TEST(TBranch, BulkRead)
+{
+   TMemFile file("TBranchBulkRead.root", "RECREATE");
+   TTree tree("tree", "A test tree");
+   Float_t f = 0;
+   Short_t s = 0;
+   Long64_t l = 0;
+   Double_t d[3] = {0, 0, 0};
+   Int_t n = 0;
+   Float_t var[4] = {0, 0, 0, 0};
+   tree.Branch("f", &f, "f/F", 256);
+   tree.Branch("s", &s, "s/S", 256);
+   tree.Branch("l", &l, "l/L", 256);
+   tree.Branch("d", d, "d[3]/D", 256);
+   tree.Branch("n", &n, "n/I");
+   tree.Branch("var", var, "var[n]/F");
+   const Int_t nevts = 1000;
+   for (Int_t ev = 0; ev < nevts; ++ev) {
+      f = ev * 0.5f;
+      s = -ev;
+      l = 1000000000000LL + ev;
+      d[0] = ev; d[1] = -ev; d[2] = 2. * ev;
+      n = ev % 4;
+      tree.Fill();
+   }
+   tree.FlushBaskets();
+
+   EXPECT_FALSE(tree.GetBranch("var")->SupportsBulkRead());
+   TBufferFile unused(TBuffer::kRead, 16);
+   EXPECT_EQ(-1, tree.GetBranch("var")->GetBulkEntries(0, unused));
+
+   TBranch *bf = tree.GetBranch("f");
+   TBranch *bs = tree.GetBranch("s");
+   TBranch *bl = tree.GetBranch("l");
+   TBranch *bd = tree.GetBranch("d");
+   ASSERT_TRUE(bf->SupportsBulkRead());
+   ASSERT_TRUE(bd->SupportsBulkRead());
+
+   TBufferFile buf(TBuffer::kRead, 16);
+   Long64_t entry = 0;
+   while (entry < nevts) {
+      Int_t count = bf->GetBulkEntries(entry, buf);
+      ASSERT_GT(count, 0);
+      const Float_t *values = reinterpret_cast<const Float_t *>(buf.Buffer());
+      for (Int_t i = 0; i < count; ++i) {
+         EXPECT_FLOAT_EQ((entry + i) * 0.5f, values[i]);
+      }
+      entry += count;
+   }
+   EXPECT_EQ(nevts, entry);
+
+   // Start in the middle of a basket.
+   Int_t count = bs->GetBulkEntries(17, buf);
+   ASSERT_GT(count, 0);
+   for (Int_t i = 0; i < count; ++i) {
+      EXPECT_EQ(-(17 + i), reinterpret_cast<const Short_t *>(buf.Buffer())[i]);
+   }
+
+   count = bl->GetBulkEntries(nevts - 1, buf);
+   ASSERT_EQ(1, count);
+   EXPECT_EQ(1000000000000LL + nevts - 1, reinterpret_cast<const Long64_t *>(buf.Buffer())[0]);
+
+   for (entry = 0; entry < nevts; entry += count) {
+      count = bd->GetBulkEntries(entry, buf);
+      ASSERT_GT(count, 0);
+      const Double_t *values = reinterpret_cast<const Double_t *>(buf.Buffer());
+      for (Int_t i = 0; i < count; ++i) {
+         EXPECT_EQ(entry + i, values[3 * i]);
+         EXPECT_EQ(-(entry + i), values[3 * i + 1]);
+         EXPECT_EQ(2. * (entry + i), values[3 * i + 2]);
+      }
+   }
+
+   // The serialized form is the big-endian on-disk representation.
+   count = bf->GetEntriesSerialized(2, buf);
+   ASSERT_GT(count, 0);
+   char *ptr = buf.Buffer();
+   Float_t first;
+   frombuf(ptr, &first);
+   EXPECT_FLOAT_EQ(1.f, first);
+
+   // The regular interface is unaffected.
+   bf->SetAddress(&f);
+   bf->GetEntry(123);
+   EXPECT_FLOAT_EQ(61.5f, f);
+}
+
+TEST(TBranch, LittleEndian)
+{
+   const char *fname = "TBranchLittleEndian.root";
+   {
+      TFile file(fname, "RECREATE", "", 0);
+      TTree tree("tree", "A test tree");
+      ROOT::TIOFeatures features;
+      EXPECT_TRUE(features.Set(ROOT::Experimental::EIOFeatures::kLittleEndian));
+      tree.SetIOFeatures(features);
+      Float_t f = 0;
+      Int_t i[2] = {0, 0};
+      Int_t n = 0;
+      Double_t var[4] = {0, 0, 0, 0};
+      tree.Branch("f", &f, "f/F", 256);
+      tree.Branch("i", i, "i[2]/I", 256);
+      tree.Branch("n", &n, "n/I");
+      tree.Branch("var", var, "var[n]/D");
+      for (Int_t ev = 0; ev < 1000; ++ev) {
+         f = ev * 0.5f;
+         i[0] = ev;
+         i[1] = -ev;
+         n = ev % 4;
+         for (Int_t j = 0; j < n; ++j)
+            var[j] = ev + j;
+         tree.Fill();
+      }
+      tree.Write();
+   }
+
+   TFile file(fname);
+   TTree *tree = nullptr;
+   file.GetObject("tree", tree);
+   ASSERT_NE(nullptr, tree);
+   Float_t f = 0;
+   Int_t i[2] = {0, 0};
+   Int_t n = 0;
+   Double_t var[4] = {0, 0, 0, 0};
+   tree->SetBranchAddress("f", &f);
+   tree->SetBranchAddress("i", i);
+   tree->SetBranchAddress("n", &n);
+   tree->SetBranchAddress("var", var);
+   for (Int_t ev = 0; ev < 1000; ++ev) {
+      tree->GetEntry(ev);
+      EXPECT_FLOAT_EQ(ev * 0.5f, f);
+      EXPECT_EQ(ev, i[0]);
+      EXPECT_EQ(-ev, i[1]);
+      ASSERT_EQ(ev % 4, n);
+      for (Int_t j = 0; j < n; ++j)
+         EXPECT_EQ(ev + j, var[j]);
+   }
+
+   // The bulk interface decodes little-endian baskets as well.
+   TBranch *bi = tree->GetBranch("i");
+   TBufferFile buf(TBuffer::kRead, 16);
+   Int_t count = bi->GetBulkEntries(10, buf);
+   ASSERT_GT(count, 0);
+   EXPECT_EQ(10, reinterpret_cast<const Int_t *>(buf.Buffer())[0]);
+   EXPECT_EQ(-10, reinterpret_cast<const Int_t *>(buf.Buffer())[1]);
+
+   // On little-endian machines the baskets can be used in place.
+   const char *data = nullptr;
+   count = tree->GetBranch("f")->GetEntriesView(4, data);
+#ifdef R__BYTESWAP
+   ASSERT_GT(count, 0);
+   for (Int_t k = 0; k < count; ++k) {
+      Float_t value;
+      memcpy(&value, data + k * sizeof(Float_t), sizeof(Float_t));
+      EXPECT_FLOAT_EQ((4 + k) * 0.5f, value);
+   }
+#else
+   EXPECT_EQ(-1, count);
+#endif
+
+   delete tree;
+   file.Close();
+   gSystem->Unlink(fname);
+}
@@ -0,0 +1,256 @@
+#include "TBranch.h"
+#include "TChain.h"
+#include "TFile.h"
+#include "TSystem.h"
+#include "TTree.h"
+#include "TTreeCache.h"
+
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+static const char *kFileName = "ttreecache_stats_test.root";
+static const Int_t kEntries = 20000;
+static const Int_t kArraySize = 32;
+
+class TTreeCacheTest : public ::testing::Test {
+protected:
+   static void SetUpTestCase()
+   {
+      TFile f(kFileName, "RECREATE", "", 0);
+      TTree t("t", "t");
+      Int_t i;
+      Double_t d;
+      Double_t arr[kArraySize];
+      t.Branch("i", &i, "i/I");
+      t.Branch("d", &d, "d/D");
+      t.Branch("arr", arr, TString::Format("arr[%d]/D", kArraySize));
+      t.SetAutoFlush(5000);
+      for (i = 0; i < kEntries; ++i) {
+         d = 0.5 * i;
+         for (auto j = 0; j < kArraySize; ++j)
+            arr[j] = i + j;
+         t.Fill();
+      }
+      t.Write();
+   }
+
+   static void TearDownTestCase() { gSystem->Unlink(kFileName); }
+
+   static const TTreeCache::BranchStats *FindStats(const TTreeCache &cache, const char *name)
+   {
+      for (const auto &stats : cache.GetBranchStats())
+         if (stats.fName == name)
+            return &stats;
+      return nullptr;
+   }
+};
+
+TEST_F(TTreeCacheTest, BranchStats)
+{
+   TFile f(kFileName);
+   TTree *t = nullptr;
+   f.GetObject("t", t);
+   ASSERT_NE(t, nullptr);
+   t->SetCacheSize(10000000);
+   auto cache = dynamic_cast<TTreeCache *>(f.GetCacheRead(t));
+   ASSERT_NE(cache, nullptr);
+
+   Int_t i;
+   Double_t d;
+   t->SetBranchStatus("*", 0);
+   t->SetBranchStatus("i", 1);
+   t->SetBranchStatus("d", 1);
+   t->SetBranchAddress("i", &i);
+   t->SetBranchAddress("d", &d);
+   for (Long64_t e = 0; e < kEntries; ++e) {
+      ASSERT_GT(t->GetEntry(e), 0);
+      EXPECT_EQ(i, e);
+   }
+
+   auto statsI = FindStats(*cache, "i");
+   auto statsD = FindStats(*cache, "d");
+   ASSERT_NE(statsI, nullptr);
+   ASSERT_NE(statsD, nullptr);
+   EXPECT_GT(statsI->fNPrefetched, 0);
+   EXPECT_GT(statsD->fBytesPrefetched, statsI->fBytesPrefetched);
+   // The reads of the learning phase are not misses
+   EXPECT_EQ(statsI->fNMissed, 0);
+   EXPECT_EQ(statsD->fNMissed, 0);
+   EXPECT_EQ(FindStats(*cache, "arr"), nullptr);
+}
+
+TEST_F(TTreeCacheTest, MissStats)
+{
+   TFile f(kFileName);
+   TTree *t = nullptr;
+   f.GetObject("t", t);
+   ASSERT_NE(t, nullptr);
+   t->SetCacheSize(10000000);
+   auto cache = dynamic_cast<TTreeCache *>(f.GetCacheRead(t));
+   ASSERT_NE(cache, nullptr);
+   EXPECT_FALSE(cache->GetMissStats());
+
+   Int_t i;
+   Double_t d;
+   TBranch *bi = nullptr;
+   TBranch *bd = nullptr;
+   t->SetBranchAddress("i", &i, &bi);
+   t->SetBranchAddress("d", &d, &bd);
+
+   // 'd' is only read after the learning phase, in the first half without miss statistics.
+   for (Long64_t e = 0; e < kEntries; ++e) {
+      if (e == kEntries / 2)
+         cache->SetMissStats();
+      t->LoadTree(e);
+      bi->GetEntry(e);
+      EXPECT_EQ(i, e);
+      if (e >= kEntries / 4) {
+         bd->GetEntry(e);
+         EXPECT_DOUBLE_EQ(d, 0.5 * e);
+      }
+   }
+
+   auto statsI = FindStats(*cache, "i");
+   auto statsD = FindStats(*cache, "d");
+   ASSERT_NE(statsI, nullptr);
+   ASSERT_NE(statsD, nullptr);
+   EXPECT_EQ(statsI->fNMissed, 0);
+   // The clusters start every 5000 entries: only the baskets of 'd' of the second half are accounted.
+   Int_t nSecondHalf = 0;
+   for (Int_t b = 0; b < bd->GetWriteBasket(); ++b)
+      if (bd->GetBasketEntry()[b] >= kEntries / 2)
+         ++nSecondHalf;
+   EXPECT_GT(nSecondHalf, 0);
+   EXPECT_EQ(statsD->fNMissed, nSecondHalf);
+   EXPECT_GT(statsD->fBytesMissed, 0);
+   EXPECT_FALSE(statsD->fTriggeredLearning);
+}
+
+TEST_F(TTreeCacheTest, LearnOnMiss)
+{
+   TFile f(kFileName);
+   TTree *t = nullptr;
+   f.GetObject("t", t);
+   ASSERT_NE(t, nullptr);
+   t->SetCacheSize(10000000);
+   auto cache = dynamic_cast<TTreeCache *>(f.GetCacheRead(t));
+   ASSERT_NE(cache, nullptr);
+   cache->SetLearnOnMiss();
+
+   Int_t i;
+   Double_t d;
+   TBranch *bi = nullptr;
+   TBranch *bd = nullptr;
+   t->SetBranchAddress("i", &i, &bi);
+   t->SetBranchAddress("d", &d, &bd);
+   for (Long64_t e = 0; e < kEntries; ++e) {
+      t->LoadTree(e);
+      bi->GetEntry(e);
+      EXPECT_EQ(i, e);
+      // Only start reading 'd' once the learning phase is over.
+      if (e >= kEntries / 4) {
+         bd->GetEntry(e);
+         EXPECT_DOUBLE_EQ(d, 0.5 * e);
+      }
+   }
+
+   EXPECT_EQ(cache->GetNRelearn(), 1);
+   auto statsD = FindStats(*cache, "d");
+   ASSERT_NE(statsD, nullptr);
+   EXPECT_TRUE(statsD->fTriggeredLearning);
+   EXPECT_GT(statsD->fNPrefetched, 0);
+   ASSERT_NE(cache->GetCachedBranches(), nullptr);
+   EXPECT_NE(cache->GetCachedBranches()->FindObject(bd), nullptr);
+}
+
+TEST_F(TTreeCacheTest, AutoResize)
+{
+   TFile f(kFileName);
+   TTree *t = nullptr;
+   f.GetObject("t", t);
+   ASSERT_NE(t, nullptr);
+   t->SetCacheSize(200000);
+   auto cache = dynamic_cast<TTreeCache *>(f.GetCacheRead(t));
+   ASSERT_NE(cache, nullptr);
+   const Int_t maxSize = 4000000;
+   cache->SetAutoResize(maxSize);
+
+   Double_t arr[kArraySize];
+   t->SetBranchAddress("arr", arr);
+   for (Long64_t e = 0; e < kEntries; ++e) {
+      ASSERT_GT(t->GetEntry(e), 0);
+      EXPECT_DOUBLE_EQ(arr[kArraySize - 1], e + kArraySize - 1);
+   }
+
+   // A cluster of 'arr' holds 5000 * 32 doubles.
+   EXPECT_GE(cache->GetNResize(), 1);
+   EXPECT_GE(cache->GetBufferSize(), 5000 * kArraySize * (Int_t)sizeof(Double_t));
+   EXPECT_LE(cache->GetBufferSize(), maxSize);
+   auto statsArr = FindStats(*cache, "arr");
+   ASSERT_NE(statsArr, nullptr);
+   EXPECT_GT(statsArr->fNPrefetched, 0);
+}
+
+TEST_F(TTreeCacheTest, StagedBaskets)
+{
+   TFile f(kFileName);
+   TTree *t = nullptr;
+   f.GetObject("t", t);
+   ASSERT_NE(t, nullptr);
+   t->SetCacheSize(10000000);
+   auto cache = dynamic_cast<TTreeCache *>(f.GetCacheRead(t));
+   ASSERT_NE(cache, nullptr);
+
+   auto staged = TTreeCache::StageBaskets(*t, std::vector<std::string>{"i", "d"}, 10000000);
+   ASSERT_NE(staged, nullptr);
+   EXPECT_EQ(staged->fEntryEnd, 5000);
+   cache->SetStagedBaskets(std::move(staged));
+
+   Int_t i;
+   Double_t d;
+   t->SetBranchStatus("*", 0);
+   t->SetBranchStatus("i", 1);
+   t->SetBranchStatus("d", 1);
+   t->SetBranchAddress("i", &i);
+   t->SetBranchAddress("d", &d);
+   // The whole first cluster is served by the staged baskets.
+   const Int_t readCalls = f.GetReadCalls();
+   for (Long64_t e = 0; e < 5000; ++e) {
+      ASSERT_GT(t->GetEntry(e), 0);
+      EXPECT_EQ(i, e);
+      EXPECT_DOUBLE_EQ(d, 0.5 * e);
+   }
+   EXPECT_EQ(f.GetReadCalls(), readCalls);
+
+   for (Long64_t e = 5000; e < kEntries; ++e) {
+      ASSERT_GT(t->GetEntry(e), 0);
+      EXPECT_EQ(i, e);
+   }
+   EXPECT_GT(f.GetReadCalls(), readCalls);
+}
+
+TEST_F(TTreeCacheTest, ChainPrefetchNextFile)
+{
+   TChain chain("t");
+   for (Int_t n = 0; n < 3; ++n)
+      chain.Add(kFileName);
+   chain.SetPrefetchNextFile();
+   EXPECT_TRUE(chain.GetPrefetchNextFile());
+   chain.SetCacheSize(10000000);
+
+   Int_t i;
+   Double_t d;
+   chain.SetBranchStatus("*", 0);
+   chain.SetBranchStatus("i", 1);
+   chain.SetBranchStatus("d", 1);
+   chain.SetBranchAddress("i", &i);
+   chain.SetBranchAddress("d", &d);
+   for (Long64_t e = 0; e < 3 * kEntries; ++e) {
+      ASSERT_GT(chain.GetEntry(e), 0);
+      EXPECT_EQ(i, e % kEntries);
+      EXPECT_DOUBLE_EQ(d, 0.5 * (e % kEntries));
+   }
+   EXPECT_EQ(chain.GetTreeNumber(), 2);
+}
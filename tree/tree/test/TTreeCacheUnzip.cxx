@@ -0,0 +1,124 @@
+#include "TFile.h"
+#include "TROOT.h"
+#include "TSystem.h"
+#include "TTree.h"
+#include "TTreeCacheUnzip.h"
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <thread>
+
+static const char *kFileName = "ttreecacheunzip_test.root";
+static const Int_t kEntries = 20000;
+
+class TTreeCacheUnzipTest : public ::testing::Test {
+protected:
+   static void SetUpTestCase()
+   {
+      TFile f(kFileName, "RECREATE");
+      TTree t("t", "t");
+      Int_t i;
+      Double_t d;
+      Float_t arr[4];
+      t.Branch("i", &i, "i/I");
+      t.Branch("d", &d, "d/D");
+      t.Branch("arr", arr, "arr[4]/F");
+      t.SetAutoFlush(1000);
+      for (i = 0; i < kEntries; ++i) {
+         d = 0.5 * i;
+         for (auto j = 0; j < 4; ++j)
+            arr[j] = i + j;
+         t.Fill();
+      }
+      t.Write();
+   }
+
+   static void TearDownTestCase() { gSystem->Unlink(kFileName); }
+
+   void TearDown() override
+   {
+      TTreeCacheUnzip::SetParallelUnzip(TTreeCacheUnzip::kDisable);
+#ifdef R__USE_IMT
+      ROOT::DisableImplicitMT();
+#endif
+   }
+
+   // Read all the entries and check their values. With pause, wait a bit after the first entry
+   // of each cluster so that the background tasks can unzip the baskets ahead of the reads.
+   void ReadAndCheck(Long64_t unzipBufferSize = -1, bool pause = false)
+   {
+      TFile f(kFileName);
+      TTree *t = nullptr;
+      f.GetObject("t", t);
+      ASSERT_NE(t, nullptr);
+
+      t->LoadTree(0); // creates the cache
+      auto cache = dynamic_cast<TTreeCacheUnzip *>(f.GetCacheRead(t));
+      ASSERT_NE(cache, nullptr);
+      if (unzipBufferSize >= 0)
+         cache->SetUnzipBufferSize(unzipBufferSize);
+
+      Int_t i;
+      Double_t d;
+      Float_t arr[4];
+      t->SetBranchAddress("i", &i);
+      t->SetBranchAddress("d", &d);
+      t->SetBranchAddress("arr", arr);
+      for (Long64_t e = 0; e < kEntries; ++e) {
+         ASSERT_GT(t->GetEntry(e), 0);
+         EXPECT_EQ(i, e);
+         EXPECT_DOUBLE_EQ(d, 0.5 * e);
+         for (auto j = 0; j < 4; ++j)
+            EXPECT_FLOAT_EQ(arr[j], e + j);
+         if (pause && e % 1000 == 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      }
+
+      // Each basket read once the cache has learnt its branches is either found unzipped (possibly
+      // after waiting for it) or missed; only the baskets of the first cluster are read while learning.
+      Int_t nBaskets = 0;
+      for (auto b : TRangeDynCast<TBranch>(t->GetListOfBranches()))
+         nBaskets += b->GetWriteBasket();
+      const Int_t nRead = cache->GetNFound() + cache->GetNStalls() + cache->GetNMissed();
+      EXPECT_LE(nRead, nBaskets);
+      EXPECT_GE(nRead, nBaskets - t->GetListOfBranches()->GetEntries());
+#ifdef R__USE_IMT
+      EXPECT_LE(cache->GetNFound() + cache->GetNStalls(), cache->GetNUnzip());
+      if (pause) {
+         // The baskets of the next cluster are unzipped in the background while the current one is read
+         EXPECT_GT(cache->GetNFound() + cache->GetNStalls(), 0);
+      }
+#endif
+   }
+};
+
+TEST_F(TTreeCacheUnzipTest, ParallelUnzip)
+{
+   TTreeCacheUnzip::SetParallelUnzip(TTreeCacheUnzip::kEnable);
+   ReadAndCheck();
+}
+
+#ifdef R__USE_IMT
+TEST_F(TTreeCacheUnzipTest, ParallelUnzipAhead)
+{
+   TTreeCacheUnzip::SetParallelUnzip(TTreeCacheUnzip::kEnable);
+   ReadAndCheck(-1, true);
+}
+
+TEST_F(TTreeCacheUnzipTest, ParallelUnzipSmallBuffer)
+{
+   // Most baskets do not fit in the unzip buffer and are put aside until the readers pick up the pending ones
+   TTreeCacheUnzip::SetParallelUnzip(TTreeCacheUnzip::kEnable);
+   ReadAndCheck(1, true);
+}
+
+TEST_F(TTreeCacheUnzipTest, ParallelUnzipWithIMT)
+{
+   // Branches are read in parallel by GetEntry while baskets are unzipped in the background
+   ROOT::EnableImplicitMT(4);
+   TTreeCacheUnzip::SetParallelUnzip(TTreeCacheUnzip::kEnable);
+   ReadAndCheck();
+   ReadAndCheck(1);
+}
+#endif
@@ -2,6 +2,10 @@
 #include "TTree.h"
 #include "TBranch.h"
 #include "TRandom.h"
+#include "TSystem.h"
+
+#include <algorithm>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -53,3 +57,81 @@ TEST_F(TTreeClusterTest, countBaskets)
 
    delete file;
 }
+
+TEST(TTreeCluster, SortBasketsByCluster)
+{
+   {
+      TFile file("TTreeClusterSortInput.root", "RECREATE");
+      TTree tree("tree", "A tree with baskets of different sizes");
+      tree.SetAutoFlush(200);
+      Int_t small = 0;
+      Double_t large[10];
+      tree.Branch("small", &small);
+      auto largeBranch = tree.Branch("large", large, "large[10]/D");
+      largeBranch->SetBasketSize(1000);
+      for (Int_t ev = 0; ev < 1000; ev++) {
+         small = ev;
+         for (auto &l : large)
+            l = ev * 0.5;
+         tree.Fill();
+      }
+      file.Write();
+   }
+
+   TFile input("TTreeClusterSortInput.root");
+   auto intree = static_cast<TTree *>(input.Get("tree"));
+   ASSERT_TRUE(intree != nullptr);
+   TFile output("TTreeClusterSortOutput.root", "RECREATE");
+   auto outtree = intree->CloneTree(-1, "fast SortBasketsByCluster");
+   ASSERT_TRUE(outtree != nullptr);
+   outtree->Write();
+   ASSERT_EQ(intree->GetEntries(), outtree->GetEntries());
+
+   // Collect the cluster starts of the output tree.
+   std::vector<Long64_t> clusterStarts;
+   auto clusterIter = outtree->GetClusterIterator(0);
+   Long64_t start;
+   while ((start = clusterIter()) < outtree->GetEntries())
+      clusterStarts.push_back(start);
+   ASSERT_EQ(5u, clusterStarts.size());
+
+   // When ordered by position in the file, the baskets must be ordered by cluster, then by branch.
+   struct BasketInfo {
+      Long64_t fSeek;
+      Long64_t fCluster;
+      Int_t fBranch;
+   };
+   std::vector<BasketInfo> baskets;
+   for (Int_t b = 0; b < outtree->GetListOfBranches()->GetEntries(); ++b) {
+      auto branch = static_cast<TBranch *>(outtree->GetListOfBranches()->At(b));
+      for (Int_t i = 0; i < branch->GetWriteBasket(); ++i) {
+         Long64_t cluster = std::upper_bound(clusterStarts.begin(), clusterStarts.end(), branch->GetBasketEntry()[i]) -
+                            clusterStarts.begin();
+         baskets.push_back({branch->GetBasketSeek(i), cluster, b});
+      }
+   }
+   std::sort(baskets.begin(), baskets.end(),
+             [](const BasketInfo &a, const BasketInfo &b) { return a.fSeek < b.fSeek; });
+   for (size_t i = 1; i < baskets.size(); ++i) {
+      EXPECT_LE(baskets[i - 1].fCluster, baskets[i].fCluster);
+      if (baskets[i - 1].fCluster == baskets[i].fCluster)
+         EXPECT_LE(baskets[i - 1].fBranch, baskets[i].fBranch);
+   }
+
+   Int_t small = -1;
+   Double_t large[10];
+   outtree->SetBranchAddress("small", &small);
+   outtree->SetBranchAddress("large", large);
+   for (Long64_t ev = 0; ev < outtree->GetEntries(); ++ev) {
+      outtree->GetEntry(ev);
+      EXPECT_EQ(ev, small);
+      EXPECT_DOUBLE_EQ(ev * 0.5, large[9]);
+   }
+   outtree->ResetBranchAddresses();
+
+   delete outtree;
+   output.Close();
+   input.Close();
+   gSystem->Unlink("TTreeClusterSortInput.root");
+   gSystem->Unlink("TTreeClusterSortOutput.root");
+}
@@ -25,6 +25,7 @@
 
 #include <string.h>
 #include <functional>
+#include <mutex>
 #include <vector>
 
 
@@ -52,6 +53,7 @@ namespace ROOT {
       struct EntryCluster {
          Long64_t start;
          Long64_t end;
+         Long64_t bytes; ///< Compressed size of the baskets starting in the cluster
       };
 
       /// Names, aliases, and file names of a TTree's or TChain's friends
@@ -64,10 +66,6 @@ namespace ROOT {
          std::vector<std::vector<std::string>> fFriendFileNames;
       };
 
-      // EntryClusters and number of entries per file
-      using ClustersAndEntries = std::pair<std::vector<std::vector<EntryCluster>>, std::vector<Long64_t>>;
-      ClustersAndEntries MakeClusters(const std::string &treename, const std::vector<std::string> &filenames);
-
       class TTreeView {
       private:
          using TreeReaderEntryListPair = std::pair<std::unique_ptr<TTreeReader>, std::unique_ptr<TEntryList>>;
@@ -192,6 +190,24 @@ namespace ROOT {
 
       ROOT::TThreadedObject<ROOT::Internal::TTreeView> treeView; ///<! Thread-local TreeViews
 
+   public:
+      /// Statistics about one of the tasks run by the last call to Process
+      struct TaskStats {
+         std::size_t fFileIdx; ///< Index of the input file the task's clusters belong to
+         Long64_t fStart;      ///< First entry of the task
+         Long64_t fEnd;        ///< Entry after the last entry of the task
+         Long64_t fBytes;      ///< Compressed size of the clusters of the task
+         unsigned fNClusters;  ///< Number of clusters grouped in the task
+         unsigned fWorker;     ///< Index of the worker that ran the task
+         bool fStolen;         ///< Whether the worker stole the task from another worker's queue
+         double fRealTime;     ///< Time spent processing the task, in seconds
+      };
+
+   private:
+      unsigned fTasksPerWorker = 4;      ///< Target number of tasks per worker used to balance the load
+      std::vector<TaskStats> fTaskStats; ///< Statistics of the tasks run by the last call to Process
+      std::mutex fTaskStatsMutex;        ///<! Protects fTaskStats while tasks are running
+
       Internal::FriendInfo GetFriendInfo(TTree &tree);
       std::string FindTreeName();
 
@@ -202,6 +218,10 @@ namespace ROOT {
       TTreeProcessorMT(TTree &tree);
 
       void Process(std::function<void(TTreeReader &)> func);
+
+      void SetTasksPerWorker(unsigned n);
+      unsigned GetTasksPerWorker() const { return fTasksPerWorker; }
+      const std::vector<TaskStats> &GetTaskStats() const { return fTaskStats; }
    };
 
 } // End of namespace ROOT
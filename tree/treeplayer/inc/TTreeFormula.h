@@ -131,8 +131,20 @@ protected:
 
    RealInstanceCache fRealInstanceCache; //! Cache accelerating the GetRealInstance function
 
+   // Signature of the functions generated by JitCompile: the addresses of the
+   // leaves read directly by the compiled code, the values of the other tree
+   // variables and aliases (in order of appearance) and the constants.
+   typedef Double_t (*JitFunc_t)(const void *const *leaves, const Double_t *inputs, const Double_t *consts);
+
+   JitFunc_t            fJitFunction = nullptr; //! Compiled version of the expression, if any
+   std::vector<Int_t>   fJitInputs;             //! Operations that still need to be evaluated before calling fJitFunction
+   std::vector<Int_t>   fJitLeaves;             //! Codes of the leaves read directly by fJitFunction
+
+   static Int_t         fgJitExpressions;       //  -1 (undecided, see TTreeFormula.JitExpressions in .rootrc), 0 or 1
+
    TTreeFormula(const char *name, const char *formula, TTree *tree, const std::vector<std::string>& aliases);
    void Init(const char *name, const char *formula);
+   void        JitCompile();
    Bool_t      BranchHasMethod(TLeaf* leaf, TBranch* branch, const char* method,const char* params, Long64_t readentry) const;
    Int_t       DefineAlternate(const char* expression);
    void        DefineDimensions(Int_t code, Int_t size, TFormLeafInfoMultiVarDim * info, Int_t& virt_dim);
@@ -185,6 +197,7 @@ public:
    virtual const char *EvalStringInstance(Int_t i=0);
    virtual void*       EvalObject(Int_t i=0);
    // EvalInstance should be const.  See comment on GetNdata()
+   static  Bool_t      GetJitExpressions();
    TFormLeafInfo      *GetLeafInfo(Int_t code) const;
    TTreeFormulaManager*GetManager() const { return fManager; }
    TMethodCall        *GetMethodCall(Int_t code) const;
@@ -198,12 +211,14 @@ public:
    //the mutable keyword.
    //NOTE: Also modify the code in PrintValue which current goes around this limitation :(
    virtual Bool_t      IsInteger(Bool_t fast=kTRUE) const;
+           Bool_t      IsJitted() const { return fJitFunction != nullptr; }
            Bool_t      IsQuickLoad() const { return fQuickLoad; }
    virtual Bool_t      IsString() const;
    virtual Bool_t      Notify() { UpdateFormulaLeaves(); return kTRUE; }
    virtual char       *PrintValue(Int_t mode=0) const;
    virtual char       *PrintValue(Int_t mode, Int_t instance, const char *decform = "9.9") const;
    virtual void        SetAxis(TAxis *axis=0);
+   static  void        SetJitExpressions(Bool_t enable = kTRUE);
            void        SetQuickLoad(Bool_t quick) { fQuickLoad = quick; }
    virtual void        SetTree(TTree *tree) {fTree = tree;}
    virtual void        ResetLoading();
@@ -18,6 +18,12 @@
 #include "TClonesArray.h"
 #include "TLeafB.h"
 #include "TLeafC.h"
+#include "TLeafD.h"
+#include "TLeafF.h"
+#include "TLeafI.h"
+#include "TLeafL.h"
+#include "TLeafO.h"
+#include "TLeafS.h"
 #include "TLeafObject.h"
 #include "TDataMember.h"
 #include "TMethodCall.h"
@@ -36,6 +42,8 @@
 #include "TString.h"
 #include "TTimeStamp.h"
 #include "TMath.h"
+#include "TEnv.h"
+#include "TVirtualMutex.h"
 
 #include "TVirtualRefProxy.h"
 #include "TTreeFormulaManager.h"
@@ -52,6 +60,9 @@
 #include <stdlib.h>
 #include <typeinfo>
 #include <algorithm>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
 
 const Int_t kMaxLen     = 1024;
 
@@ -91,10 +102,33 @@ The following method are available from the TFormLeafInfo interface:
  -  IsString()
  -  ReadValue(char *where, Int_t instance = 0) : Internal function to interpret the location 'where'
  -  Update() : react to the possible loading of a shared library.
+
+### Compiled expressions
+
+When TTreeFormula::SetJitExpressions() is enabled (or `TTreeFormula.JitExpressions: yes`
+is set in the .rootrc), the expression is translated into C++ and compiled by cling
+into a native function.  The scalar leaves of a basic type (for example `x/F` or
+`n/I`) are read by the compiled function straight from their buffer, with their
+actual type; their branches are still loaded by TTreeFormula.  The other tree
+variables (arrays, data members, methods, ...) and the aliases are evaluated by the
+interpreter loop and passed to the compiled function, which then evaluates the
+operators and the mathematical functions instead of walking the operation stack.
+The generated functions are cached by the structure of the expression and the types
+of the leaves it reads (constants are passed as arguments), so that the compilation
+happens only once per process for each distinct expression, even across the trees
+of a TChain.  The benchmark `test/treeformulajitbm` compares both evaluations.
+
+The following constructs are not compiled and fall back to the interpreter:
+strings, function calls, `rndm`, the conditional operator, the `Alt$`, `MinIf$`
+and `MaxIf$` helpers and, for expressions using arrays, the boolean operators
+`&&` and `||` (whose short-circuit may guard an array access).
+TTreeFormula::IsJitted() tells whether a given formula was compiled.
 */
 
 ClassImp(TTreeFormula);
 
+Int_t TTreeFormula::fgJitExpressions = -1;
+
 ////////////////////////////////////////////////////////////////////////////////
 
 inline static void R__LoadBranch(TBranch* br, Long64_t entry, Bool_t quickLoad)
@@ -316,9 +350,269 @@ void TTreeFormula::Init(const char*name, const char* expression)
 
    }
 
+   if (GetJitExpressions()) JitCompile();
+
    if(savedir) savedir->cd();
 }
 
+namespace {
+
+// Helpers used by the compiled expressions.  They reproduce the corner
+// cases of the interpreted evaluation in TTreeFormula::EvalInstance
+// (division by zero, arguments out of range, etc.).
+const char *gJitPrologue = R"JITCODE(
+#include "TMath.h"
+#include <cmath>
+#include <algorithm>
+namespace ROOT { namespace Internal { namespace TTreeFormulaJit {
+inline double Div(double a, double b) { return b == 0 ? 0 : a / b; }
+inline double Mod(double a, double b) { return double(Long64_t(a) % Long64_t(b)); }
+inline double Tan(double x) { return TMath::Cos(x) == 0 ? 0 : TMath::Tan(x); }
+inline double ACos(double x) { return TMath::Abs(x) > 1 ? 0 : TMath::ACos(x); }
+inline double ASin(double x) { return TMath::Abs(x) > 1 ? 0 : TMath::ASin(x); }
+inline double TanH(double x) { return TMath::CosH(x) == 0 ? 0 : TMath::TanH(x); }
+inline double ACosH(double x) { return x < 1 ? 0 : TMath::ACosH(x); }
+inline double ATanH(double x) { return TMath::Abs(x) > 1 ? 0 : TMath::ATanH(x); }
+inline double Sq(double x) { return x * x; }
+inline double Sqrt(double x) { return TMath::Sqrt(TMath::Abs(x)); }
+inline double Log(double x) { return x > 0 ? TMath::Log(x) : 0; }
+inline double Log10(double x) { return x > 0 ? TMath::Log10(x) : 0; }
+inline double Exp(double x) { return x < -700 ? 0 : TMath::Exp(x > 700 ? 700 : x); }
+inline double Sign(double x) { return x < 0 ? -1 : 1; }
+inline double Int(double x) { return double(Long64_t(x)); }
+inline double BitAnd(double a, double b) { return double(ULong64_t(a) & ULong64_t(b)); }
+inline double BitOr(double a, double b) { return double(ULong64_t(a) | ULong64_t(b)); }
+inline double LeftShift(double a, double b) { return double(ULong64_t(a) << ULong64_t(b)); }
+inline double RightShift(double a, double b) { return double(ULong64_t(a) >> ULong64_t(b)); }
+}}}
+)JITCODE";
+
+std::string JitCall(const char *func, const std::string &a)
+{
+   return std::string(func) + "(" + a + ")";
+}
+
+std::string JitCall(const char *func, const std::string &a, const std::string &b)
+{
+   return std::string(func) + "(" + a + ", " + b + ")";
+}
+
+std::string JitInfix(const char *op, const std::string &a, const std::string &b)
+{
+   return "(" + a + " " + op + " " + b + ")";
+}
+
+std::string JitBool(const std::string &cond)
+{
+   return "double(" + cond + ")";
+}
+
+// Return the type of the value of the leaf if the compiled code can read it
+// directly from the leaf's buffer, i.e. for a single number of a basic type.
+const char *JitLeafType(TLeaf *leaf)
+{
+   if (!leaf || leaf->GetLeafCount() || leaf->GetLenStatic() != 1) return nullptr;
+   TClass *cl = leaf->IsA();
+   if (cl != TLeafB::Class() && cl != TLeafS::Class() && cl != TLeafI::Class() && cl != TLeafL::Class() &&
+       cl != TLeafF::Class() && cl != TLeafD::Class() && cl != TLeafO::Class()) return nullptr;
+   return leaf->GetTypeName();
+}
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Translate the operations of the formula into C++ and compile them with cling.
+///
+/// On success, fJitFunction points to the compiled function, fJitLeaves lists
+/// the codes of the leaves it reads directly and fJitInputs lists the
+/// operations (other tree variables and aliases) whose values must be passed
+/// to it.  If the expression contains any construct that is not supported (see
+/// the class documentation) the formula is left unchanged and is evaluated by
+/// the interpreter.
+///
+/// This is called again by UpdateFormulaLeaves, since the types of the leaves
+/// may differ between the trees of a chain.
+
+void TTreeFormula::JitCompile()
+{
+   fJitFunction = nullptr;
+   fJitInputs.clear();
+   fJitLeaves.clear();
+
+   if (fNoper < 2 || TestBit(kIsCharacter) || !gInterpreter) return;
+
+   // Without short-circuit, both sides of && and || are always evaluated.  This
+   // is only harmless if there is no array access the left side could be guarding.
+   Bool_t canEvaluateBothSides = (fMultiplicity == 0);
+   for (Int_t k = 0; k < fNcodes; ++k) {
+      if (fNdimensions[k] > 0) canEvaluateBothSides = kFALSE;
+   }
+
+   std::vector<std::string> stack;
+   std::vector<Int_t> inputs;
+   std::vector<Int_t> leaves;
+   auto pop = [&stack]() { std::string top = stack.back(); stack.pop_back(); return top; };
+
+   for (Int_t i = 0; i < fNoper; ++i) {
+      const Int_t oper = GetOper()[i];
+      const Int_t action = oper >> kTFOperShift;
+      const Int_t param = oper & kTFOperMask;
+
+      // Check that the operands are there before popping them.
+      switch (action) {
+         case kConstant: case kpi: case kDefinedVariable: case kAlias: case kBoolOptimize: case kEnd:
+            break;
+         case kcos: case ksin: case ktan: case kacos: case kasin: case katan:
+         case kcosh: case ksinh: case ktanh: case kacosh: case kasinh: case katanh:
+         case ksq: case ksqrt: case klog: case kexp: case klog10:
+         case kabs: case ksign: case kint: case kSignInv: case kNot:
+            if (stack.size() < 1) return;
+            break;
+         default:
+            if (stack.size() < 2) return;
+      }
+
+      std::string b;
+      switch (action) {
+         case kConstant:    stack.push_back("c[" + std::to_string(param) + "]"); continue;
+         case kpi:          stack.push_back("TMath::ACos(-1)"); continue;
+         case kDefinedVariable: {
+            const char *type = (fLookupType[param] == kDirect && fNdimensions[param] == 0)
+                               ? JitLeafType((TLeaf*)fLeaves.UncheckedAt(param)) : nullptr;
+            if (type) {
+               size_t n = std::find(leaves.begin(), leaves.end(), param) - leaves.begin();
+               if (n == leaves.size()) leaves.push_back(param);
+               stack.push_back("double(*static_cast<const " + std::string(type) + "*>(l[" + std::to_string(n) + "]))");
+               continue;
+            }
+         }
+         // fallthrough
+         case kAlias:       stack.push_back("v[" + std::to_string(inputs.size()) + "]");
+                            inputs.push_back(i);
+                            continue;
+         case kBoolOptimize: if (!canEvaluateBothSides) return;
+                            continue;
+         case kEnd:         i = fNoper; continue;
+
+         case kAdd:         b = pop(); stack.push_back(JitInfix("+", pop(), b)); continue;
+         case kSubstract:   b = pop(); stack.push_back(JitInfix("-", pop(), b)); continue;
+         case kMultiply:    b = pop(); stack.push_back(JitInfix("*", pop(), b)); continue;
+         case kDivide:      b = pop(); stack.push_back(JitCall("Div", pop(), b)); continue;
+         case kModulo:      b = pop(); stack.push_back(JitCall("Mod", pop(), b)); continue;
+         case katan2:       b = pop(); stack.push_back(JitCall("TMath::ATan2", pop(), b)); continue;
+         case kfmod:        b = pop(); stack.push_back(JitCall("std::fmod", pop(), b)); continue;
+         case kpow:         b = pop(); stack.push_back(JitCall("TMath::Power", pop(), b)); continue;
+         case kmin:         b = pop(); stack.push_back(JitCall("std::min", pop(), b)); continue;
+         case kmax:         b = pop(); stack.push_back(JitCall("std::max", pop(), b)); continue;
+         case kBitAnd:      b = pop(); stack.push_back(JitCall("BitAnd", pop(), b)); continue;
+         case kBitOr:       b = pop(); stack.push_back(JitCall("BitOr", pop(), b)); continue;
+         case kLeftShift:   b = pop(); stack.push_back(JitCall("LeftShift", pop(), b)); continue;
+         case kRightShift:  b = pop(); stack.push_back(JitCall("RightShift", pop(), b)); continue;
+
+         case kAnd:         b = pop(); stack.push_back(JitBool("(" + pop() + " != 0 && " + b + " != 0)")); continue;
+         case kOr:          b = pop(); stack.push_back(JitBool("(" + pop() + " != 0 || " + b + " != 0)")); continue;
+         case kEqual:       b = pop(); stack.push_back(JitBool(JitInfix("==", pop(), b))); continue;
+         case kNotEqual:    b = pop(); stack.push_back(JitBool(JitInfix("!=", pop(), b))); continue;
+         case kLess:        b = pop(); stack.push_back(JitBool(JitInfix("<", pop(), b))); continue;
+         case kGreater:     b = pop(); stack.push_back(JitBool(JitInfix(">", pop(), b))); continue;
+         case kLessThan:    b = pop(); stack.push_back(JitBool(JitInfix("<=", pop(), b))); continue;
+         case kGreaterThan: b = pop(); stack.push_back(JitBool(JitInfix(">=", pop(), b))); continue;
+         case kNot:         stack.push_back(JitBool("(" + pop() + " == 0)")); continue;
+
+         case kcos:         stack.push_back(JitCall("TMath::Cos", pop())); continue;
+         case ksin:         stack.push_back(JitCall("TMath::Sin", pop())); continue;
+         case ktan:         stack.push_back(JitCall("Tan", pop())); continue;
+         case kacos:        stack.push_back(JitCall("ACos", pop())); continue;
+         case kasin:        stack.push_back(JitCall("ASin", pop())); continue;
+         case katan:        stack.push_back(JitCall("TMath::ATan", pop())); continue;
+         case kcosh:        stack.push_back(JitCall("TMath::CosH", pop())); continue;
+         case ksinh:        stack.push_back(JitCall("TMath::SinH", pop())); continue;
+         case ktanh:        stack.push_back(JitCall("TanH", pop())); continue;
+         case kacosh:       stack.push_back(JitCall("ACosH", pop())); continue;
+         case kasinh:       stack.push_back(JitCall("TMath::ASinH", pop())); continue;
+         case katanh:       stack.push_back(JitCall("ATanH", pop())); continue;
+         case ksq:          stack.push_back(JitCall("Sq", pop())); continue;
+         case ksqrt:        stack.push_back(JitCall("Sqrt", pop())); continue;
+         case klog:         stack.push_back(JitCall("Log", pop())); continue;
+         case kexp:         stack.push_back(JitCall("Exp", pop())); continue;
+         case klog10:       stack.push_back(JitCall("Log10", pop())); continue;
+         case kabs:         stack.push_back(JitCall("TMath::Abs", pop())); continue;
+         case ksign:        stack.push_back(JitCall("Sign", pop())); continue;
+         case kint:         stack.push_back(JitCall("Int", pop())); continue;
+         case kSignInv:     stack.push_back("(-" + pop() + ")"); continue;
+
+         default:
+            // Strings, function calls, random numbers, jumps and the
+            // TTreeFormula specific helpers are left to the interpreter.
+            return;
+      }
+   }
+   if (stack.size() != 1 || (inputs.empty() && leaves.empty())) return;
+
+   const std::string body = stack.back();
+
+   // The cache is keyed by the generated code, which depends only on the
+   // structure of the expression and on the types of the leaves read directly
+   // (they appear in the casts): the literals are passed at run time.
+   R__LOCKGUARD(gInterpreterMutex);
+   static std::unordered_map<std::string, JitFunc_t> gJitCache;
+   static Bool_t gJitPrologueDeclared = kFALSE;
+
+   auto cached = gJitCache.find(body);
+   if (cached == gJitCache.end()) {
+      JitFunc_t func = nullptr;
+      if (!gJitPrologueDeclared) {
+         gJitPrologueDeclared = gInterpreter->Declare(gJitPrologue);
+      }
+      if (gJitPrologueDeclared) {
+         const std::string name = "TTreeFormulaExpr" + std::to_string(gJitCache.size());
+         const std::string code = "namespace ROOT { namespace Internal { namespace TTreeFormulaJit {\n"
+                                  "double " + name + "(const void *const *l, const double *v, const double *c) {\n"
+                                  "   (void)l; (void)v; (void)c;\n"
+                                  "   return " + body + ";\n"
+                                  "}\n}}}\n";
+         if (gInterpreter->Declare(code.c_str())) {
+            TInterpreter::EErrorCode error = TInterpreter::kNoError;
+            const Long_t addr = gInterpreter->Calc(("(long)&ROOT::Internal::TTreeFormulaJit::" + name).c_str(), &error);
+            if (error == TInterpreter::kNoError && addr) func = reinterpret_cast<JitFunc_t>(addr);
+         }
+      }
+      if (!func) Warning("JitCompile", "Could not compile the expression %s, it will be interpreted.", GetTitle());
+      // Remember failures too, to not retry them for each new formula.
+      cached = gJitCache.insert(std::make_pair(body, func)).first;
+   }
+
+   if (cached->second) {
+      fJitFunction = cached->second;
+      fJitInputs.swap(inputs);
+      fJitLeaves.swap(leaves);
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return whether the expressions of the TTreeFormula created from now on
+/// are compiled (see the class documentation).
+///
+/// Unless set with SetJitExpressions, the default is taken from
+/// `TTreeFormula.JitExpressions` in the .rootrc (off by default).
+
+Bool_t TTreeFormula::GetJitExpressions()
+{
+   if (fgJitExpressions < 0) {
+      fgJitExpressions = gEnv->GetValue("TTreeFormula.JitExpressions", 0) ? 1 : 0;
+   }
+   return fgJitExpressions;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Enable or disable the compilation of the expressions of the TTreeFormula
+/// created from now on.  Formulas that already exist are not affected.
+
+void TTreeFormula::SetJitExpressions(Bool_t enable)
+{
+   fgJitExpressions = enable ? 1 : 0;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Tree Formula default destructor.
 
@@ -4000,10 +4294,34 @@ T TTreeFormula::EvalInstance(Int_t instance, const char *stringStackArg[])
    const Bool_t willLoad = (instance==0 || fNeedLoading); fNeedLoading = kFALSE;
    if (willLoad) fDidBooleanOptimization = kFALSE;
 
+   // With a compiled expression, the branches of the leaves it reads are
+   // loaded here and only the other tree variables and the aliases are
+   // evaluated, the compiled function takes care of the rest.
+   const Bool_t jitted = fJitFunction && std::is_same<T, Double_t>::value;
+   size_t jitInput = 0;
+   const void *jitLeaves[kMAXCODES];
+   if (jitted) {
+      for (size_t n = 0; n < fJitLeaves.size(); ++n) {
+         const Int_t code = fJitLeaves[n];
+         TLeaf *leaf = (TLeaf*)fLeaves.UncheckedAt(code);
+         if (willLoad) {
+            TBranch *branch = (TBranch*)fBranches.UncheckedAt(code);
+            if (!branch) branch = leaf->GetBranch();
+            R__LoadBranch(branch, branch->GetTree()->GetReadEntry(), fQuickLoad);
+         }
+         jitLeaves[n] = leaf->GetValuePointer();
+      }
+   }
+
    Int_t pos  = 0;
    Int_t pos2 = 0;
    for (Int_t i=0; i<fNoper ; ++i) {
 
+      if (jitted) {
+         if (jitInput == fJitInputs.size()) break;
+         i = fJitInputs[jitInput++];
+      }
+
       const Int_t oper = GetOper()[i];
       const Int_t newaction = oper >> kTFOperShift;
 
@@ -4382,6 +4700,8 @@ T TTreeFormula::EvalInstance(Int_t instance, const char *stringStackArg[])
       R__ASSERT(i<fNoper);
    }
 
+   if (jitted) return fJitFunction(jitLeaves, reinterpret_cast<const Double_t*>(tab), fConst);
+
    //std::cout << __PRETTY_FUNCTION__ << "  returning " << tab[0] << std::endl;
    return tab[0];
 }
@@ -5113,6 +5433,8 @@ void TTreeFormula::UpdateFormulaLeaves()
             break;
       }
    }
+   // The leaves read by the compiled expression may have another type in the new tree.
+   if (!fJitLeaves.empty() && !TestBit(kMissingLeaf)) JitCompile();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -22,50 +22,243 @@ The implementation of ROOT::TTreeProcessorMT parallelizes the processing of the
 each corresponding to a cluster in the TTree. This is possible thanks to the use
 of a ROOT::TThreadedObject, so that each thread works with its own TFile and TTree
 objects.
+
+Each input file is opened by the first worker thread that needs work from it: its clusters
+are collected, together with their compressed size, and contiguous clusters are grouped in
+tasks (see SetTasksPerWorker). If friend trees or an entry list require global entry numbers,
+all files are instead looked at before processing and the tasks are balanced over the whole dataset. Tasks are split among the worker threads in contiguous ranges;
+a worker that runs out of tasks steals the last task of the worker with the most remaining
+work, so that uneven datasets do not leave cores idle at the end of the processing.
+Statistics about each task of the last run can be retrieved with GetTaskStats.
 */
 
 #include "TROOT.h"
+#include "TBranch.h"
+#include "TLeaf.h"
+#include "TStopwatch.h"
 #include "ROOT/TTreeProcessorMT.hxx"
 #include "ROOT/TThreadExecutor.hxx"
+#include "ROOT/TSeq.hxx"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
 
 using namespace ROOT;
 
-namespace ROOT {
-namespace Internal {
+namespace {
 ////////////////////////////////////////////////////////////////////////
-/// Return a vector of cluster boundaries for the given tree and files.
-ClustersAndEntries
-MakeClusters(const std::string &treeName, const std::vector<std::string> &fileNames)
+/// Return the clusters (with local entry numbers) and the number of entries of the tree in the given file.
+/// The size of each cluster is the sum of the compressed sizes of the baskets that start in it.
+std::pair<std::vector<ROOT::Internal::EntryCluster>, Long64_t>
+MakeFileClusters(const std::string &treeName, const std::string &fileName)
 {
-   // Note that as a side-effect of opening all files that are going to be used in the
-   // analysis once, all necessary streamers will be loaded into memory.
+   using ROOT::Internal::EntryCluster;
    TDirectory::TContext c;
-   std::vector<std::vector<EntryCluster>> clustersPerFile;
-   std::vector<Long64_t> entriesPerFile;
-   const auto nFileNames = fileNames.size();
-   Long64_t offset = 0ll;
-   for (auto i = 0u; i < nFileNames; ++i) {
-      std::unique_ptr<TFile> f(TFile::Open(fileNames[i].c_str())); // need TFile::Open to load plugins if need be
-      TTree *t = nullptr; // not a leak, t will be deleted by f
-      f->GetObject(treeName.c_str(), t);
-      auto clusterIter = t->GetClusterIterator(0);
-      Long64_t start = 0ll, end = 0ll;
-      const Long64_t entries = t->GetEntries();
-      // Iterate over the clusters in the current file
-      std::vector<EntryCluster> clusters;
-      while ((start = clusterIter()) < entries) {
-         end = clusterIter.GetNextEntry();
-         // Add the current file's offset to start and end to make them (chain) global
-         clusters.emplace_back(EntryCluster{start + offset, end + offset});
+   std::unique_ptr<TFile> f(TFile::Open(fileName.c_str())); // need TFile::Open to load plugins if need be
+   TTree *t = nullptr; // not a leak, t will be deleted by f
+   f->GetObject(treeName.c_str(), t);
+   auto clusterIter = t->GetClusterIterator(0);
+   Long64_t start = 0ll, end = 0ll;
+   const Long64_t entries = t->GetEntries();
+   // Iterate over the clusters in the current file
+   std::vector<EntryCluster> clusters;
+   std::vector<Long64_t> starts;
+   while ((start = clusterIter()) < entries) {
+      end = clusterIter.GetNextEntry();
+      clusters.emplace_back(EntryCluster{start, end, 0ll});
+      starts.emplace_back(start);
+   }
+   if (clusters.empty())
+      return std::make_pair(std::move(clusters), entries);
+
+   // Attribute each basket written to the file to the cluster containing its first entry
+   for (auto leafObj : *t->GetListOfLeaves()) {
+      auto br = static_cast<TLeaf *>(leafObj)->GetBranch();
+      if (br->GetListOfLeaves()->First() != leafObj)
+         continue; // count each branch once, also if it has several leaves
+      const auto nBaskets = br->GetWriteBasket();
+      const auto basketBytes = br->GetBasketBytes();
+      const auto basketEntry = br->GetBasketEntry();
+      for (auto b = 0; b < nBaskets; ++b) {
+         const auto it = std::upper_bound(starts.begin(), starts.end(), basketEntry[b]);
+         const auto clusterIdx = it == starts.begin() ? 0 : std::distance(starts.begin(), it) - 1;
+         clusters[clusterIdx].bytes += basketBytes[b];
       }
-      offset += entries;
-      clustersPerFile.emplace_back(std::move(clusters));
-      entriesPerFile.emplace_back(entries);
    }
 
-   return std::make_pair(std::move(clustersPerFile), std::move(entriesPerFile));
+   return std::make_pair(std::move(clusters), entries);
 }
 
+/// A group of contiguous clusters of the same file, processed by one call to the user function
+struct ClusterTask {
+   std::size_t fFileIdx;
+   Long64_t fFileEntries; ///< Number of entries of the task's file
+   Long64_t fStart;
+   Long64_t fEnd;
+   Long64_t fCost;
+   Long64_t fBytes;
+   unsigned fNClusters;
+};
+
+////////////////////////////////////////////////////////////////////////
+/// Group the clusters of each file into tasks of roughly totalCost / nTasks.
+/// The cost of a cluster is its compressed size, or its number of entries if no size is known.
+/// clusters[i] and entries[i] describe the file with index firstFileIdx + i.
+std::vector<ClusterTask>
+MakeClusterTasks(const std::vector<std::vector<ROOT::Internal::EntryCluster>> &clusters,
+                 const std::vector<Long64_t> &entries, unsigned nTasks, std::size_t firstFileIdx = 0)
+{
+   Long64_t totBytes = 0ll, totEntries = 0ll;
+   for (const auto &fileClusters : clusters) {
+      for (const auto &c : fileClusters) {
+         totBytes += c.bytes;
+         totEntries += c.end - c.start;
+      }
+   }
+   const bool useBytes = totBytes > 0;
+   auto costOf = [useBytes](const ROOT::Internal::EntryCluster &c) { return useBytes ? c.bytes : c.end - c.start; };
+   const Long64_t target = std::max(1ll, (useBytes ? totBytes : totEntries) / std::max(1u, nTasks));
+
+   std::vector<ClusterTask> tasks;
+   const auto nFiles = clusters.size();
+   for (auto i = 0u; i < nFiles; ++i) {
+      bool open = false;
+      for (const auto &c : clusters[i]) {
+         if (!open) {
+            tasks.emplace_back(ClusterTask{firstFileIdx + i, entries[i], c.start, c.end, 0ll, 0ll, 0u});
+            open = true;
+         }
+         auto &task = tasks.back();
+         task.fEnd = c.end;
+         task.fCost += costOf(c);
+         task.fBytes += c.bytes;
+         ++task.fNClusters;
+         if (task.fCost >= target)
+            open = false;
+      }
+   }
+   return tasks;
+}
+
+/// Per-worker task queues. Each worker processes its own tasks front to back, so that consecutive tasks of a worker
+/// tend to read the same file, and steals from the back of the queue with the most remaining work once it runs dry.
+/// The queues are either filled up front, or lazily one file at a time: a worker whose queue is empty claims the next
+/// file that nobody looked at yet and queues its tasks, and only steals once all files have been claimed.
+class TClusterTaskQueues {
+public:
+   using TaskMaker_t = std::function<std::vector<ClusterTask>(std::size_t)>;
+
+private:
+   struct TQueue {
+      std::mutex fMutex;
+      std::deque<ClusterTask> fTasks;
+      std::atomic<Long64_t> fCost{0ll};
+   };
+   std::vector<std::unique_ptr<TQueue>> fQueues;
+   TaskMaker_t fMakeFileTasks;          ///< Return the tasks of a file, called once per file if the queues are lazy
+   std::size_t fNFiles = 0;             ///< Number of files whose tasks are made lazily
+   std::atomic<std::size_t> fNextFile{0}; ///< Index of the next file to be claimed by a worker
+
+   //////////////////////////////////////////////////////////////////////
+   /// Claim the next file, if any, and move its tasks to the queue of worker w. Return false if no file is left.
+   bool ClaimFile(unsigned w)
+   {
+      std::size_t fileIdx;
+      while ((fileIdx = fNextFile++) < fNFiles) {
+         auto tasks = fMakeFileTasks(fileIdx);
+         if (tasks.empty())
+            continue; // empty tree, try the next file
+         auto &q = *fQueues[w];
+         std::lock_guard<std::mutex> lock(q.fMutex);
+         for (auto &t : tasks) {
+            q.fCost += t.fCost;
+            q.fTasks.emplace_back(t);
+         }
+         return true;
+      }
+      return false;
+   }
+
+public:
+   //////////////////////////////////////////////////////////////////////
+   /// Distribute the tasks in contiguous ranges of similar cost among nWorkers queues.
+   TClusterTaskQueues(const std::vector<ClusterTask> &tasks, unsigned nWorkers)
+   {
+      Long64_t totCost = 0ll;
+      for (const auto &t : tasks)
+         totCost += t.fCost;
+      for (auto i = 0u; i < nWorkers; ++i)
+         fQueues.emplace_back(new TQueue());
+
+      Long64_t cumCost = 0ll;
+      for (const auto &t : tasks) {
+         // assign the task according to the position of its midpoint in the cumulative cost
+         const auto mid = cumCost + t.fCost / 2;
+         const auto w = totCost > 0 ? std::min<Long64_t>(nWorkers - 1, mid * nWorkers / totCost) : 0;
+         fQueues[w]->fTasks.emplace_back(t);
+         fQueues[w]->fCost += t.fCost;
+         cumCost += t.fCost;
+      }
+   }
+
+   //////////////////////////////////////////////////////////////////////
+   /// Create nWorkers empty queues, which are fed with the tasks returned by makeFileTasks for each of nFiles files
+   /// as the workers run out of work.
+   TClusterTaskQueues(std::size_t nFiles, unsigned nWorkers, TaskMaker_t makeFileTasks)
+      : fMakeFileTasks(std::move(makeFileTasks)), fNFiles(nFiles)
+   {
+      for (auto i = 0u; i < nWorkers; ++i)
+         fQueues.emplace_back(new TQueue());
+   }
+
+   //////////////////////////////////////////////////////////////////////
+   /// Retrieve the next task for worker w. Return false if no task is left in any queue.
+   bool Pop(unsigned w, ClusterTask &task, bool &stolen)
+   {
+      auto &q = *fQueues[w];
+      do {
+         std::lock_guard<std::mutex> lock(q.fMutex);
+         if (!q.fTasks.empty()) {
+            task = q.fTasks.front();
+            q.fTasks.pop_front();
+            q.fCost -= task.fCost;
+            stolen = false;
+            return true;
+         }
+      } while (ClaimFile(w));
+
+      while (true) {
+         // pick the victim with the most remaining work
+         TQueue *victim = nullptr;
+         Long64_t maxCost = -1ll;
+         for (auto &q : fQueues) {
+            std::lock_guard<std::mutex> lock(q->fMutex);
+            if (!q->fTasks.empty() && q->fCost > maxCost) {
+               maxCost = q->fCost;
+               victim = q.get();
+            }
+         }
+         if (!victim)
+            return false;
+
+         std::lock_guard<std::mutex> lock(victim->fMutex);
+         if (victim->fTasks.empty())
+            continue; // somebody else got there first, look again
+         task = victim->fTasks.back();
+         victim->fTasks.pop_back();
+         victim->fCost -= task.fCost;
+         stolen = true;
+         return true;
+      }
+   }
+};
+} // anonymous namespace
+
+namespace ROOT {
+namespace Internal {
 ////////////////////////////////////////////////////////////////////////
 /// Return a vector containing the number of entries of each file of each friend TChain
 std::vector<std::vector<Long64_t>> GetFriendEntries(const std::vector<std::pair<std::string, std::string>> &friendNames,
@@ -247,69 +440,117 @@ TTreeProcessorMT::TTreeProcessorMT(TTree &tree) : TTreeProcessorMT(tree, TEntryL
 /// be processed in parallel. This means that the code of the user function
 /// should be thread safe.
 ///
+/// After the call, GetTaskStats returns the entry range, size, worker and
+/// processing time of each of the tasks that were run.
+///
 /// \param[in] func User-defined function that processes a subrange of entries
 void TTreeProcessorMT::Process(std::function<void(TTreeReader &)> func)
 {
    const std::vector<Internal::NameAlias> &friendNames = fFriendInfo.fFriendNames;
    const std::vector<std::vector<std::string>> &friendFileNames = fFriendInfo.fFriendFileNames;
 
-   // If an entry list or friend trees are present, we need to generate clusters with global entry numbers,
-   // so we do it here for all files.
+   // If an entry list or friend trees are present, we need to use clusters with global entry numbers
+   // and TChains containing all the input files. Otherwise each task only opens the file it processes.
    const bool hasFriends = !friendNames.empty();
    const bool hasEntryList = fEntryList.GetN() > 0;
-   const bool shouldRetrieveAllClusters = hasFriends || hasEntryList;
-   const auto clustersAndEntries =
-      shouldRetrieveAllClusters ? Internal::MakeClusters(fTreeName, fFileNames) : Internal::ClustersAndEntries{};
-   const auto &clusters = clustersAndEntries.first;
-   const auto &entries = clustersAndEntries.second;
+   const bool shouldUseGlobalEntries = hasFriends || hasEntryList;
+
+   TThreadExecutor pool;
+   const auto nFiles = fFileNames.size();
+   const auto nWorkers = std::max(1u, pool.GetPoolSize());
+
+   // Number of entries of each file, only needed (and only known up front) with global entry numbers
+   std::vector<Long64_t> entries;
+   std::unique_ptr<TClusterTaskQueues> queues;
+   if (shouldUseGlobalEntries) {
+      // Global entry numbers require the number of entries of all files, so we build the cluster list of the whole
+      // dataset up front, looking at the files in parallel
+      auto getFileClusters = [&](unsigned fileIdx) { return MakeFileClusters(fTreeName, fFileNames[fileIdx]); };
+      auto clustersAndEntriesPerFile = pool.Map(getFileClusters, ROOT::TSeqU(nFiles));
+      std::vector<std::vector<Internal::EntryCluster>> clusters;
+      Long64_t offset = 0ll;
+      for (auto &clustersAndEntries : clustersAndEntriesPerFile) {
+         for (auto &c : clustersAndEntries.first) {
+            c.start += offset;
+            c.end += offset;
+         }
+         offset += clustersAndEntries.second;
+         clusters.emplace_back(std::move(clustersAndEntries.first));
+         entries.emplace_back(clustersAndEntries.second);
+      }
+      // Group clusters into tasks of balanced size and distribute them among the workers
+      const auto tasks = MakeClusterTasks(clusters, entries, nWorkers * fTasksPerWorker);
+      queues.reset(new TClusterTaskQueues(tasks, nWorkers));
+   } else {
+      // Otherwise each file is opened by the worker that claims it, which splits it in tasks. Sizes are not known
+      // before the files are opened, so the tasks are spread evenly over the files.
+      const auto tasksPerFile =
+         std::max<std::size_t>(1u, (nWorkers * fTasksPerWorker + nFiles - 1) / std::max<std::size_t>(1u, nFiles));
+      auto makeFileTasks = [&, tasksPerFile](std::size_t fileIdx) {
+         auto clustersAndEntries = MakeFileClusters(fTreeName, fFileNames[fileIdx]);
+         return MakeClusterTasks({std::move(clustersAndEntries.first)}, {clustersAndEntries.second}, tasksPerFile,
+                                 fileIdx);
+      };
+      queues.reset(new TClusterTaskQueues(nFiles, nWorkers, makeFileTasks));
+   }
 
    // Retrieve number of entries for each file for each friend tree
    const auto friendEntries =
       hasFriends ? Internal::GetFriendEntries(friendNames, friendFileNames) : std::vector<std::vector<Long64_t>>{};
 
-   TThreadExecutor pool;
-   // Parent task, spawns tasks that process each of the entry clusters for each input file
-   using Internal::EntryCluster;
-   auto processFile = [&](std::size_t fileIdx) {
+   fTaskStats.clear();
 
-      // If cluster information is already present, build TChains with all input files and use global entry numbers
-      // Otherwise get cluster information only for the file we need to process and use local entry numbers
-      const bool shouldUseGlobalEntries = hasFriends || hasEntryList;
+   auto processTask = [&](const ClusterTask &task, unsigned worker, bool stolen) {
       // theseFiles contains either all files or just the single file to process
-      const auto &theseFiles = shouldUseGlobalEntries ? fFileNames : std::vector<std::string>({fFileNames[fileIdx]});
-      // Evaluate clusters (with local entry numbers) and number of entries for this file, if needed
-      const auto theseClustersAndEntries =
-         shouldUseGlobalEntries ? Internal::ClustersAndEntries{} : Internal::MakeClusters(fTreeName, theseFiles);
-
-      // All clusters for the file to process, either with global or local entry numbers
-      const auto &thisFileClusters = shouldUseGlobalEntries ? clusters[fileIdx] : theseClustersAndEntries.first[0];
-
+      const auto &theseFiles =
+         shouldUseGlobalEntries ? fFileNames : std::vector<std::string>({fFileNames[task.fFileIdx]});
       // Either all number of entries or just the ones for this file
-      const auto &theseEntries =
-         shouldUseGlobalEntries ? entries : std::vector<Long64_t>({theseClustersAndEntries.second[0]});
+      const auto &theseEntries = shouldUseGlobalEntries ? entries : std::vector<Long64_t>({task.fFileEntries});
 
-      auto processCluster = [&](const Internal::EntryCluster &c) {
-         // This task will operate with the tree that contains start
-         treeView->PushTaskFirstEntry(c.start);
+      TStopwatch sw;
+      // This task will operate with the tree that contains start
+      treeView->PushTaskFirstEntry(task.fStart);
 
-         std::unique_ptr<TTreeReader> reader;
-         std::unique_ptr<TEntryList> elist;
-         std::tie(reader, elist) = treeView->GetTreeReader(c.start, c.end, fTreeName, theseFiles, fFriendInfo,
-                                                           fEntryList, theseEntries, friendEntries);
-         func(*reader);
+      std::unique_ptr<TTreeReader> reader;
+      std::unique_ptr<TEntryList> elist;
+      std::tie(reader, elist) = treeView->GetTreeReader(task.fStart, task.fEnd, fTreeName, theseFiles, fFriendInfo,
+                                                        fEntryList, theseEntries, friendEntries);
+      func(*reader);
 
-         // In case of task interleaving, we need to load here the tree of the parent task
-         treeView->PopTaskFirstEntry();
-      };
+      // In case of task interleaving, we need to load here the tree of the parent task
+      treeView->PopTaskFirstEntry();
+      sw.Stop();
 
-      pool.Foreach(processCluster, thisFileClusters);
+      std::lock_guard<std::mutex> lock(fTaskStatsMutex);
+      fTaskStats.emplace_back(TaskStats{task.fFileIdx, task.fStart, task.fEnd, task.fBytes, task.fNClusters, worker,
+                                        stolen, sw.RealTime()});
    };
 
-   std::vector<std::size_t> fileIdxs(fFileNames.size());
-   std::iota(fileIdxs.begin(), fileIdxs.end(), 0u);
+   // Each worker drains its own queue, then steals from the others until no task is left
+   auto runWorker = [&](unsigned worker) {
+      ClusterTask task;
+      bool stolen = false;
+      while (queues->Pop(worker, task, stolen))
+         processTask(task, worker, stolen);
+   };
 
    // Enable this IMT use case (activate its locks)
    Internal::TParTreeProcessingRAII ptpRAII;
 
-   pool.Foreach(processFile, fileIdxs);
+   pool.Foreach(runWorker, ROOT::TSeqU(nWorkers));
+}
+
+////////////////////////////////////////////////////////////////////////
+/// Set the target number of tasks per worker thread.
+/// Process groups the clusters of the input files in about n tasks per worker thread, spread evenly over
+/// the files, or of similar compressed size if global entry numbers require looking at all files up front:
+/// more tasks give finer load balancing at the price of more per-task overhead.
+/// \param[in] n Number of tasks per worker, must be larger than zero.
+void TTreeProcessorMT::SetTasksPerWorker(unsigned n)
+{
+   if (n == 0) {
+      Error("TTreeProcessorMT::SetTasksPerWorker", "the number of tasks per worker must be larger than zero");
+      return;
+   }
+   fTasksPerWorker = n;
 }
@@ -0,0 +1,186 @@
+#include "TChain.h"
+#include "TFile.h"
+#include "TSystem.h"
+#include "TTree.h"
+#include "TTreeFormula.h"
+
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <vector>
+
+namespace {
+
+std::unique_ptr<TTree> MakeFormulaTree()
+{
+   Int_t i = 0;
+   Float_t f = 0;
+   Double_t d = 0;
+   Int_t n = 0;
+   Double_t arr[4]{};
+
+   std::unique_ptr<TTree> tree(new TTree("T", "formula test tree"));
+   tree->SetDirectory(nullptr);
+   tree->Branch("i", &i);
+   tree->Branch("f", &f);
+   tree->Branch("d", &d);
+   tree->Branch("n", &n);
+   tree->Branch("arr", arr, "arr[n]/D");
+   for (Int_t e = 0; e < 20; ++e) {
+      i = e - 10;
+      f = 0.25f * e;
+      d = -1.5 + 0.3 * e;
+      n = e % 5;
+      for (Int_t k = 0; k < n; ++k)
+         arr[k] = e * 0.5 + k;
+      tree->Fill();
+   }
+   return tree;
+}
+
+struct JitGuard {
+   Bool_t fOld;
+   JitGuard(Bool_t enable) : fOld(TTreeFormula::GetJitExpressions()) { TTreeFormula::SetJitExpressions(enable); }
+   ~JitGuard() { TTreeFormula::SetJitExpressions(fOld); }
+};
+
+// Evaluate `expr` on all the entries with and without compilation and
+// check that both give the same results.
+void CompareJitted(TTree &tree, const char *expr, Bool_t expectJitted)
+{
+   std::unique_ptr<TTreeFormula> interpreted, jitted;
+   {
+      JitGuard guard(kFALSE);
+      interpreted.reset(new TTreeFormula("interpreted", expr, &tree));
+   }
+   {
+      JitGuard guard(kTRUE);
+      jitted.reset(new TTreeFormula("jitted", expr, &tree));
+   }
+   EXPECT_FALSE(interpreted->IsJitted()) << expr;
+   EXPECT_EQ(expectJitted, jitted->IsJitted()) << expr;
+
+   for (Long64_t e = 0; e < tree.GetEntries(); ++e) {
+      tree.LoadTree(e);
+      const Int_t ndata = interpreted->GetNdata();
+      ASSERT_EQ(ndata, jitted->GetNdata()) << expr;
+      for (Int_t inst = 0; inst < ndata; ++inst) {
+         EXPECT_DOUBLE_EQ(interpreted->EvalInstance(inst), jitted->EvalInstance(inst))
+            << expr << " entry " << e << " instance " << inst;
+      }
+   }
+}
+
+} // anonymous namespace
+
+TEST(TTreeFormula, JitMatchesInterpreter)
+{
+   auto tree = MakeFormulaTree();
+
+   const std::vector<const char *> exprs{"i + f*d - 3",
+                                         "d/i",
+                                         "i%3 + (i&6) + (i|1) + (abs(i)<<2)",
+                                         "sqrt(d) + log(d) + exp(i*80) + log10(f)",
+                                         "sin(d)*cos(f) + tan(i) + acos(d) + asin(f)",
+                                         "atan2(d,f) + pow(f,2) + sq(d) + fmod(d,1.2) + min(i,f) + max(d,f)",
+                                         "sign(d) + int(d) + -d + pi",
+                                         "i>0 && f<3 || !(d==0) && d!=1.2",
+                                         "arr*2 + n"};
+   for (auto expr : exprs)
+      CompareJitted(*tree, expr, kTRUE);
+
+   // Same structure, different literals: reuses the cached function.
+   CompareJitted(*tree, "i + f*d - 7", kTRUE);
+
+   // Not compiled: short-circuit guarding an array access, conditional
+   // operator, single variable.
+   CompareJitted(*tree, "n<2 || arr[1]>3", kFALSE);
+   CompareJitted(*tree, "i>0 ? d : f", kFALSE);
+   CompareJitted(*tree, "d", kFALSE);
+}
+
+TEST(TTreeFormula, JitLeafTypes)
+{
+   Char_t b = 0;
+   UChar_t ub = 0;
+   Short_t s = 0;
+   UInt_t ui = 0;
+   Long64_t l = 0;
+   Bool_t o = kFALSE;
+
+   TTree tree("T", "leaf types");
+   tree.SetDirectory(nullptr);
+   tree.Branch("b", &b, "b/B");
+   tree.Branch("ub", &ub, "ub/b");
+   tree.Branch("s", &s, "s/S");
+   tree.Branch("ui", &ui, "ui/i");
+   tree.Branch("l", &l, "l/L");
+   tree.Branch("o", &o, "o/O");
+   for (Int_t e = 0; e < 20; ++e) {
+      b = e - 10;
+      ub = 200 + e;
+      s = -1000 * e;
+      ui = 4000000000u + e;
+      l = -(Long64_t(1) << 40) * e;
+      o = e % 3 == 0;
+      tree.Fill();
+   }
+
+   CompareJitted(tree, "b*ub + s - ui + l*o", kTRUE);
+   CompareJitted(tree, "b + b*2 + (o ? 1 : 0)", kFALSE);
+   CompareJitted(tree, "(ub&7) + (l>>20) + (s<0)", kTRUE);
+}
+
+TEST(TTreeFormula, JitChainWithDifferentLeafTypes)
+{
+   const char *fname1 = "formula_jitchain1.root";
+   const char *fname2 = "formula_jitchain2.root";
+   {
+      TFile f(fname1, "RECREATE");
+      Float_t x = 0;
+      Int_t n = 0;
+      TTree t("T", "float x");
+      t.Branch("x", &x);
+      t.Branch("n", &n);
+      for (Int_t e = 0; e < 10; ++e) {
+         x = 0.5f * e;
+         n = e;
+         t.Fill();
+      }
+      t.Write();
+   }
+   {
+      TFile f(fname2, "RECREATE");
+      Double_t x = 0;
+      Int_t n = 0;
+      TTree t("T", "double x");
+      t.Branch("x", &x);
+      t.Branch("n", &n);
+      for (Int_t e = 0; e < 10; ++e) {
+         x = 1. / 3 * e;
+         n = -e;
+         t.Fill();
+      }
+      t.Write();
+   }
+
+   TChain chain("T");
+   chain.Add(fname1);
+   chain.Add(fname2);
+   std::unique_ptr<TTreeFormula> jitted;
+   {
+      JitGuard guard(kTRUE);
+      jitted.reset(new TTreeFormula("jitted", "x*n + 1", &chain));
+   }
+   chain.SetNotify(jitted.get());
+   EXPECT_TRUE(jitted->IsJitted());
+   for (Long64_t e = 0; e < chain.GetEntries(); ++e) {
+      chain.LoadTree(e);
+      const Double_t expected = e < 10 ? 0.5 * e * e + 1 : 1. / 3 * (e - 10) * -(e - 10) + 1;
+      EXPECT_DOUBLE_EQ(expected, jitted->EvalInstance()) << "entry " << e;
+   }
+   EXPECT_TRUE(jitted->IsJitted());
+
+   gSystem->Unlink(fname1);
+   gSystem->Unlink(fname2);
+}
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <random>
@@ -71,3 +72,71 @@ TEST(TreeProcessorMT, ManyFiles)
 
    DeleteFiles(filenames);
 }
+
+TEST(TreeProcessorMT, TaskStats)
+{
+   // files of very different sizes, with several clusters each
+   const std::string treename = "t";
+   const std::vector<int> nEntries = {1000, 10, 5000, 1, 200};
+   std::vector<std::string> filenames;
+   for (auto i = 0u; i < nEntries.size(); ++i) {
+      filenames.emplace_back("treeprocmt_stats_" + std::to_string(i) + ".root");
+      TFile file(filenames.back().c_str(), "recreate");
+      TTree t(treename.c_str(), treename.c_str());
+      int v = 0;
+      t.Branch("v", &v);
+      t.SetAutoFlush(100);
+      for (v = 0; v < nEntries[i]; ++v)
+         t.Fill();
+      t.Write();
+   }
+
+   std::vector<std::string_view> fnames;
+   for (const auto &f : filenames)
+      fnames.emplace_back(f);
+
+   ROOT::TTreeProcessorMT proc(fnames, treename);
+   proc.SetTasksPerWorker(8);
+   EXPECT_EQ(proc.GetTasksPerWorker(), 8u);
+
+   std::atomic<long long> sum(0);
+   std::atomic_int count(0);
+   proc.Process([&](TTreeReader &r) {
+      TTreeReaderValue<int> v(r, "v");
+      while (r.Next()) {
+         sum += *v;
+         ++count;
+      }
+   });
+
+   long long expectedSum = 0;
+   int expectedCount = 0;
+   for (auto n : nEntries) {
+      expectedSum += (long long)n * (n - 1) / 2;
+      expectedCount += n;
+   }
+   EXPECT_EQ(count.load(), expectedCount);
+   EXPECT_EQ(sum.load(), expectedSum);
+
+   // the tasks must cover each file exactly once, without overlaps
+   auto stats = proc.GetTaskStats();
+   ASSERT_FALSE(stats.empty());
+   std::sort(stats.begin(), stats.end(), [](const ROOT::TTreeProcessorMT::TaskStats &a,
+                                            const ROOT::TTreeProcessorMT::TaskStats &b) {
+      return a.fFileIdx != b.fFileIdx ? a.fFileIdx < b.fFileIdx : a.fStart < b.fStart;
+   });
+   std::vector<Long64_t> covered(nEntries.size(), 0ll);
+   for (const auto &s : stats) {
+      ASSERT_LT(s.fFileIdx, nEntries.size());
+      EXPECT_EQ(s.fStart, covered[s.fFileIdx]);
+      EXPECT_GT(s.fEnd, s.fStart);
+      EXPECT_GT(s.fBytes, 0ll);
+      EXPECT_GE(s.fNClusters, 1u);
+      EXPECT_GE(s.fRealTime, 0.);
+      covered[s.fFileIdx] = s.fEnd;
+   }
+   for (auto i = 0u; i < nEntries.size(); ++i)
+      EXPECT_EQ(covered[i], nEntries[i]);
+
+   DeleteFiles(filenames);
+}